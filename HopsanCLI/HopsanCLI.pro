@@ -126,7 +126,9 @@ SOURCES += main.cpp \
     ModelValidation.cpp \
     core_cli.cpp \
     ModelUtilities.cpp \
-    BuildUtilities.cpp
+    BuildUtilities.cpp \
+    WarmMode.cpp \
+    SweepMode.cpp
 
 HEADERS += \
     version_cli.h \
@@ -134,4 +136,6 @@ HEADERS += \
     ModelValidation.h \
     core_cli.h \
     ModelUtilities.h \
-    BuildUtilities.h
+    BuildUtilities.h \
+    WarmMode.h \
+    SweepMode.h
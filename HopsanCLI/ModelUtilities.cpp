@@ -30,6 +30,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cstdlib>
 
 #include "ModelUtilities.h"
 #include "version_cli.h"
@@ -89,6 +90,53 @@ HString generateFullPortVariableName(const Port *pPort, const size_t dataId)
    return fullName;
 }
 
+//! @brief Parse the parallel simulation option, given as: threads or threads,algorithm
+//! @param [in] rOption The option string
+//! @param [out] rNumThreads The number of threads (0 means auto-detect)
+//! @param [out] rAlgorithm The parallel algorithm, apriori (default), taskpool, taskstealing, forkjoin or clusteredforkjoin
+//! @returns True if the option could be parsed, else false
+bool parseParallelOption(const string &rOption, int &rNumThreads, ParallelAlgorithmT &rAlgorithm)
+{
+    vector<string> parts;
+    splitStringOnDelimiter(rOption, ',', parts);
+    if (parts.empty() || parts.size() > 2)
+    {
+        return false;
+    }
+
+    rNumThreads = atoi(parts[0].c_str());
+    rAlgorithm = APrioriScheduling;
+    if (parts.size() == 2)
+    {
+        const string &algorithm = parts[1];
+        if (algorithm == "apriori")
+        {
+            rAlgorithm = APrioriScheduling;
+        }
+        else if (algorithm == "taskpool")
+        {
+            rAlgorithm = TaskPoolAlgorithm;
+        }
+        else if (algorithm == "taskstealing")
+        {
+            rAlgorithm = TaskStealingAlgorithm;
+        }
+        else if (algorithm == "forkjoin")
+        {
+            rAlgorithm = ForkJoinAlgorithm;
+        }
+        else if (algorithm == "clusteredforkjoin")
+        {
+            rAlgorithm = ClusteredForkJoinAlgorithm;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 
 //! @brief Helpfunction to print timestep info for a system
 //! @param[in] pSystem The system to print info for
@@ -219,12 +267,34 @@ void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentS
         if (!pFile->good())
         {
             printErrorMessage("Could not open: " + rFileName + " for writing!");
-            return;
             delete pFile;
+            return;
         }
         doCloseFile = true;
     }
 
+    std::vector<std::pair<std::string, std::string> > parameters;
+    getParameterValues(pSystem, parameters, prefix);
+    for (size_t p=0; p<parameters.size(); ++p)
+    {
+        *pFile << parameters[p].first << "," << parameters[p].second << endl;
+    }
+
+    if (doCloseFile)
+    {
+        pFile->close();
+        delete pFile;
+    }
+
+}
+
+//! @brief Get the full names and values of all parameters in a system and its subsystems
+//! @details The names have the same format as in the parameter CSV files, FullComponentName#ParameterName
+//! @param[in] pSystem The system
+//! @param[out] rParameters The parameter names and values are appended to this vector
+//! @param[in] prefix The name prefix for the system, empty for the top-level system
+void getParameterValues(hopsan::ComponentSystem* pSystem, std::vector<std::pair<std::string, std::string> > &rParameters, std::string prefix)
+{
     if (pSystem)
     {
         // Handle own system parameters
@@ -234,7 +304,7 @@ void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentS
             //! @todo what about alias name
             HString fullSelfName = prefix.empty() ? "self" : prefix.c_str();
             HString fullname = fullSelfName + "#" + pSysParameters->at(p)->getName();
-            *pFile << fullname.c_str() << "," << pSysParameters->at(p)->getValue().c_str() << endl;
+            rParameters.push_back(std::make_pair(string(fullname.c_str()), string(pSysParameters->at(p)->getValue().c_str())));
         }
 
         // Now handle subcomponent parameters
@@ -246,7 +316,7 @@ void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentS
             {
                 if (pComp->isComponentSystem())
                 {
-                    exportParameterValuesToCSV(rFileName, static_cast<ComponentSystem*>(pComp), prefix+pComp->getName().c_str()+"$", pFile);
+                    getParameterValues(static_cast<ComponentSystem*>(pComp), rParameters, prefix+pComp->getName().c_str()+"$");
                 }
                 else
                 {
@@ -256,30 +326,74 @@ void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentS
                         //! @todo what about alias name
                         HString parname = pParameters->at(p)->getName();
                         HString fullname = prefix.c_str() + pComp->getName() + "#" + parname;
-                        *pFile << fullname.c_str() << "," << pParameters->at(p)->getValue().c_str() << endl;
+                        rParameters.push_back(std::make_pair(string(fullname.c_str()), string(pParameters->at(p)->getValue().c_str())));
                     }
                 }
             }
         }
     }
+}
 
-    if (doCloseFile)
-    {
-        pFile->close();
-        delete pFile;
-    }
+//! @brief Set a parameter value using its full name
+//! @param[in] pSystem The top-level system
+//! @param[in] rFullName The full parameter name, FullComponentName#ParameterName, or self#ParameterName for top-level system parameters
+//! @param[in] rValue The new parameter value
+//! @returns True if the parameter was found and set
+bool setParameterValueWithFullName(hopsan::ComponentSystem* pSystem, const std::string &rFullName, const std::string &rValue)
+{
+    std::vector<std::string> nameParts;
+    string fullComponentName, parameterName;
+    splitStringOnDelimiter(rFullName, '#', nameParts);
+
+    // Split last name part into fullcomponent and parameter#value name
+    if (nameParts.size() == 2 || nameParts.size() == 3 ) {
+        if (nameParts.size() == 2) {
+            fullComponentName = nameParts[0];
+            parameterName = nameParts[1];
+        }
+        if (nameParts.size() == 3) {
+            // Set component name and reset the parameter (startvalue) name
+            fullComponentName = nameParts[0];
+            parameterName = nameParts[1]+"#"+nameParts[2];
+        }
 
+        hopsan::Component* pComponent;
+        if (fullComponentName == "self") {
+            pComponent = pSystem;
+        }
+        else {
+            pComponent = getComponentWithFullName(pSystem, fullComponentName);
+        }
+        if (pComponent) {
+            //! @todo what about parameter alias
+            bool ok = pComponent->setParameterValue(parameterName.c_str(), rValue.c_str());
+            if (!ok) {
+                printErrorMessage("Setting parameter: " + parameterName + " in component: " + fullComponentName);
+            }
+            return ok;
+        }
+    }
+    else {
+        printErrorMessage(rFullName + " should be FullComponentName#ParameterName");
+    }
+    return false;
 }
 
+//! @brief Set parameter values from a csv file with one FullComponentName#ParameterName,value pair per line
+//! @param[in] filePath The file to read from
+//! @param[in] pSystem The top-level system
+//! @returns True if the file could be read and all parameters were set
 //! @todo should we use CSV parser instead?
-void importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentSystem* pSystem)
+bool importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentSystem* pSystem)
 {
+    bool success = false;
     if (pSystem)
     {
         std::ifstream file;
         file.open(filePath.c_str());
         if ( file.is_open() )
         {
+            success = true;
             std::vector<std::string> lineVec;
             std::string line;
             while ( file.good() )
@@ -293,42 +407,8 @@ void importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentS
                     // Parse line vector
                     if (lineVec.size() == 2)
                     {
-                        std::vector<std::string> nameParts;
-                        string fullComponentName, parameterName;
-                        splitStringOnDelimiter(lineVec[0], '#', nameParts);
-
-                        // Split last name part into fullcomponent and parameter#value name
-                        if (nameParts.size() == 2 || nameParts.size() == 3 ) {
-                            if (nameParts.size() == 2) {
-                                fullComponentName = nameParts[0];
-                                parameterName = nameParts[1];
-                            }
-                            if (nameParts.size() == 3) {
-                                // Set component name and reset the parameter (startvalue) name
-                                fullComponentName = nameParts[0];
-                                parameterName = nameParts[1]+"#"+nameParts[2];
-                            }
-
-
-                            hopsan::Component* pComponent;
-                            if (fullComponentName == "self") {
-                                pComponent = pSystem;
-                            }
-                            else {
-                                pComponent = getComponentWithFullName(pSystem, fullComponentName);
-                            }
-                            if (pComponent) {
-                                // lineVec[1] should be the parameter value
-                                //! @todo what about parameter alias
-                                bool ok = pComponent->setParameterValue(parameterName.c_str(), lineVec[1].c_str());
-                                if (!ok) {
-                                    printErrorMessage("Setting parameter: " + parameterName + " in component: " + fullComponentName);
-                                }
-                            }
-                        }
-                        else {
-                            printErrorMessage(lineVec[0] + " should be FullComponentName#ParameterName on line: " + line);
-                        }
+                        // lineVec[1] should be the parameter value
+                        success = setParameterValueWithFullName(pSystem, lineVec[0], lineVec[1]) && success;
                     }
                     else
                     {
@@ -336,6 +416,7 @@ void importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentS
                         if (lineVec.size() > 0)
                         {
                             printWarningMessage(string("Wrong line format: ") + line);
+                            success = false;
                         }
                     }
                 }
@@ -347,6 +428,7 @@ void importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentS
             printErrorMessage(string("Could not open file: ")+filePath);
         }
     }
+    return success;
 }
 
 
@@ -388,6 +470,34 @@ void readNodesToSaveFromTxtFile(const std::string filePath, std::vector<std::str
     }
 }
 
+//! @brief Read full port or variable names from a file (one name per line) or from a comma separated list
+//! @param[in] rFileOrList The file name or the list
+//! @param[out] rNames The names are appended to this vector
+void readPortOrVariableNames(const string &rFileOrList, std::vector<string> &rNames)
+{
+    // Check if argument is a file, if so, read from it line-by-line
+    std::ifstream port_name_file(rFileOrList);
+    if (port_name_file.is_open())
+    {
+        std::string line;
+        while(std::getline(port_name_file, line))
+        {
+            if (!line.empty())
+            {
+                rNames.push_back(line);
+            }
+        }
+        port_name_file.close();
+    }
+    // Else read , separated string
+    else
+    {
+        std::vector<string> names;
+        splitStringOnDelimiter(rFileOrList, ',', names);
+        rNames.insert(rNames.end(), names.begin(), names.end());
+    }
+}
+
 Component *getComponentWithFullName(ComponentSystem *pRootSystem, const string &fullComponentName)
 {
     std::vector<std::string> nameParts;
@@ -470,18 +580,15 @@ void saveResultsToHDF5(ComponentSystem *pRootSystem, const string &rFileName, co
     };
 
     auto addVariable = [&exporter, howMany](const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
-        const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
+        const vector<double> *pLogData = pPort->getLogDataColumnPtr(variableIndex);
         const size_t numLoggedSamples = pSystem->getNumActuallyLoggedSamples();
-        if( (pLogData != nullptr) && !pLogData->empty() && (numLoggedSamples > 0)) {
+        if( (pLogData != nullptr) && (numLoggedSamples > 0)) {
             HVector<double> dataVector;
             if(howMany == Full) {
-                dataVector.reserve(numLoggedSamples);
-                for (size_t t=0; t < numLoggedSamples; ++t) {
-                    dataVector.append((*pLogData)[t][variableIndex]);
-                }
+                dataVector.assign_from(pLogData->data(), numLoggedSamples);
             }
             else {
-                dataVector.append((*pLogData)[numLoggedSamples-1][variableIndex]);
+                dataVector.append((*pLogData)[numLoggedSamples-1]);
             }
 
             HString parentSystemNames = generateFullSubSystemHierarchyName(pSystem,".", false);
@@ -503,6 +610,32 @@ void saveResultsToHDF5(ComponentSystem *pRootSystem, const string &rFileName, co
 #endif
 }
 
+//! @brief Create a log data sink for streaming results to file during simulation
+//! @details Files ending with .h5 or .hdf5 are written as chunked HDF5 (if supported), other files in the Hopsan binary log format
+//! @param [in] pRootSystem Pointer to component system
+//! @param [in] rFileName File name for output file
+//! @param [in] chunkSize The number of log samples per chunk
+//! @returns The sink (owned by the caller), or nullptr if the format is not supported
+LogDataSink *createResultsStreamSink(ComponentSystem *pRootSystem, const string &rFileName, const size_t chunkSize)
+{
+    LogDataSink *pSink = nullptr;
+    const string::size_type dotPos = rFileName.rfind('.');
+    const string extension = (dotPos != string::npos) ? rFileName.substr(dotPos+1) : "";
+    if (extension == "h5" || extension == "hdf5") {
+#ifdef USEHDF5
+        pSink = new HopsanHDF5StreamSink(rFileName.c_str(), pRootSystem->getName().c_str(), std::string("HopsanCLI "+std::string(HOPSANCLIVERSION)).c_str());
+#else
+        printErrorMessage("HopsanCLI was built without HDF5 support");
+        return nullptr;
+#endif
+    }
+    else {
+        pSink = new BinaryLogDataSink(rFileName.c_str());
+    }
+    pSink->setChunkSize(chunkSize);
+    return pSink;
+}
+
 //! @brief Save results to HDF5 format
 //! @param [in] pRootSystem Pointer to component system
 //! @param [in] rFileName File name for output file
@@ -536,8 +669,8 @@ void saveResultsToCSV(ComponentSystem *pRootSystem, const string &rFileName, con
 
             auto addVariable = [&outfile, howMany](const ComponentSystem* pSystem, const Component* pComponent, const Port* pPort, size_t variableIndex) {
                 const NodeDataDescription& variable = *pPort->getNodeDataDescription(variableIndex);
-                const vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-                if( (pLogData != nullptr) && !pLogData->empty()) {
+                const vector<double> *pLogData = pPort->getLogDataColumnPtr(variableIndex);
+                if(pLogData != nullptr) {
                     const HString fullVarName = generateFullSubSystemHierarchyName(pSystem,"$") + pComponent->getName() + "#" + pPort->getName() + "#" + variable.name;
                     if (howMany == Final) {
                         outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
@@ -547,10 +680,10 @@ void saveResultsToCSV(ComponentSystem *pRootSystem, const string &rFileName, con
                     {
                         // Only write something if data has been logged (skip ports that are not logged)
                         // We assume that the data vector has been cleared
-                        if (pPort->getLogDataVectorPtr()->size() > 0) {
+                        if (pLogData->size() > 0) {
                             outfile << fullVarName.c_str() << "," << pPort->getVariableAlias(variableIndex).c_str() << "," << variable.unit.c_str();
                             for (size_t t=0; t<pSystem->getNumActuallyLoggedSamples(); ++t) {
-                                outfile << "," << std::scientific << (*pLogData)[t][variableIndex];
+                                outfile << "," << std::scientific << (*pLogData)[t];
                             }
                             outfile << endl;
                         }
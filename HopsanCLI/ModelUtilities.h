@@ -33,8 +33,10 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 #include "core_cli.h"
 #include "HopsanEssentials.h"
+#include "CoreUtilities/LogDataSink.h"
 
 void printTsInfo(const hopsan::ComponentSystem* pSystem);
 void printSystemParams(hopsan::ComponentSystem* pSystem);
@@ -46,18 +48,23 @@ void printComponentHierarchy(hopsan::ComponentSystem *pSystem, std::string prefi
 enum SaveResults {Final, Full};
 void saveResultsToCSV(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const SaveResults howMany, const std::vector<std::string>& includeFilter);
 void saveResultsToHDF5(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const std::vector<std::string>& includeFilter, const SaveResults howMany);
+hopsan::LogDataSink *createResultsStreamSink(hopsan::ComponentSystem *pRootSystem, const std::string &rFileName, const size_t chunkSize);
 
 void transposeCSVresults(const std::string &rFileName);
 void exportParameterValuesToCSV(const std::string &rFileName, hopsan::ComponentSystem* pSystem, std::string prefix="", std::ofstream *pFile=0);
+void getParameterValues(hopsan::ComponentSystem* pSystem, std::vector<std::pair<std::string, std::string> > &rParameters, std::string prefix="");
 
 // ===== Load Functions =====
-void importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentSystem* pSystem);
+bool importParameterValuesFromCSV(const std::string filePath, hopsan::ComponentSystem* pSystem);
+bool setParameterValueWithFullName(hopsan::ComponentSystem* pSystem, const std::string &rFullName, const std::string &rValue);
 void readNodesToSaveFromTxtFile(const std::string filePath, std::vector<std::string> &rComps, std::vector<std::string> &rPorts);
+void readPortOrVariableNames(const std::string &rFileOrList, std::vector<std::string> &rNames);
 
 // ===== Help Functions =====
 void generateFullSubSystemHierarchyName(const hopsan::ComponentSystem *pSys, hopsan::HString &rFullSysName, const hopsan::HString &separator);
 hopsan::HString generateFullSubSystemHierarchyName(const hopsan::Component *pComponent, const hopsan::HString &separator, bool includeLastSeparator=true);
 hopsan::HString generateFullPortVariableName(const hopsan::Port *pPort, const size_t dataId);
+bool parseParallelOption(const std::string &rOption, int &rNumThreads, hopsan::ParallelAlgorithmT &rAlgorithm);
 
 
 hopsan::Component *getComponentWithFullName(hopsan::ComponentSystem *pRootSystem, const std::string &fullComponentName);
@@ -122,9 +129,8 @@ void saveResultsTo(hopsan::ComponentSystem *pCurrentSystem, const std::vector<st
                 {
                     const hopsan::NodeDataDescription* pVariable = &pVariables->at(v);
 
-                    // Create data vector
-                    const std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-                    if(pLogData == nullptr || pLogData->empty()) {
+                    // Skip variables that have not been logged
+                    if(pPort->getLogDataColumnPtr(v) == nullptr) {
                         continue;
                     }
 
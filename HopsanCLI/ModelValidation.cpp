@@ -43,6 +43,7 @@
 #include "ComponentUtilities/LookupTable.h"
 #include "Nodes.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <ctime>
@@ -142,21 +143,16 @@ bool exportHVCData(const string modelpath, const string baseFilePath, const std:
             appendValueNode(pVariableNode, "tolerance", to_string(tol));
 
             // Write data line to csv
-            std::vector< std::vector<double> > *pLogData = rPorts[p]->getLogDataVectorPtr();
+            const std::vector<double> *pLogData = rPorts[p]->getLogDataColumnPtr(rDataIds[p]);
             if (pLogData &&  pLogData->size() > 0)
             {
                 size_t nRows = pLogData->size();
-                size_t nCols = pLogData->front().size();
-                const size_t c = rDataIds[p];
-                if (rDataIds[p] < nCols)
+                for (size_t r=0; r<nRows-1; ++r)
                 {
-                    for (size_t r=0; r<nRows-1; ++r)
-                    {
-                        csvFile << std::scientific << (*pLogData)[r][c] << ", ";
-                    }
-                    csvFile << std::scientific << (*pLogData)[nRows-1][c] << std::endl;
-                    ++csvRow;
+                    csvFile << std::scientific << (*pLogData)[r] << ", ";
                 }
+                csvFile << std::scientific << (*pLogData)[nRows-1] << std::endl;
+                ++csvRow;
             }
         }
 
@@ -306,12 +302,13 @@ bool extractTestData(ComponentSystem *pRootSystem, string fullVarName, std::vect
         printErrorMessage("No such varaiable name: " + varName + " in: " + pPort->getNodeType().c_str());
         return false;
     }
-    vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-    rvSim.reserve(rvTime.size());
-    for(size_t i=0; i<rvTime.size(); ++i)
+    const vector<double> *pLogData = pPort->getLogDataColumnPtr(size_t(dataId));
+    if (!pLogData)
     {
-        rvSim.push_back(pLogData->at(i).at(dataId));
+        printErrorMessage("Variable is not logged: " + varName + " in: " + pPort->getNodeType().c_str());
+        return false;
     }
+    rvSim.assign(pLogData->begin(), pLogData->begin()+std::min(rvTime.size(), pLogData->size()));
     return true;
 }
 
@@ -492,10 +489,13 @@ bool performModelTest(const std::string hvcFilePath)
                                     return false;
                                 }
 
-                                for(size_t i=0; i<vTime.size(); ++i)
+                                const vector<double> *pLogData1 = pPort->getLogDataColumnPtr(size_t(dataId));
+                                if (!pLogData1)
                                 {
-                                    vSim1.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    printErrorMessage("Variable is not logged: " + varname + " in: " + pPort->getNodeType().c_str());
+                                    return false;
                                 }
+                                vSim1.assign(pLogData1->begin(), pLogData1->begin()+std::min(vTime.size(), pLogData1->size()));
 
                                 //Second simulation
                                 if (pRootSystem->initialize(startTime, stopTime))
@@ -510,10 +510,13 @@ bool performModelTest(const std::string hvcFilePath)
                                 }
                                 pRootSystem->finalize();
 
-                                for(size_t i=0; i<vTime.size(); ++i)
+                                const vector<double> *pLogData2 = pPort->getLogDataColumnPtr(size_t(dataId));
+                                if (!pLogData2)
                                 {
-                                    vSim2.push_back(pRootSystem->getSubComponent(compName.c_str())->getPort(portName.c_str())->getLogDataVectorPtr()->at(i).at(dataId));
+                                    printErrorMessage("Variable is not logged: " + varname + " in: " + pPort->getNodeType().c_str());
+                                    return false;
                                 }
+                                vSim2.assign(pLogData2->begin(), pLogData2->begin()+std::min(vTime.size(), pLogData2->size()));
 
                                 // Print the messages if there were any errors or warnings
                                 if ( (gHopsanCore.getNumErrorMessages() + gHopsanCore.getNumFatalMessages() + gHopsanCore.getNumWarningMessages()) != 0)
@@ -529,9 +532,10 @@ bool performModelTest(const std::string hvcFilePath)
                             }
 
 
-                            for(size_t i=0; i<vTime.size(); ++i)
+                            vRef.resize(vTime.size());
+                            if (!vTime.empty())
                             {
-                                vRef.push_back(refDataTable.interpolate(vTime[i]));
+                                refDataTable.interpolate(&vTime[0], &vRef[0], vTime.size());
                             }
 
                             //std::cout.rdbuf(cout_sbuf); // restore the original stream buffer
@@ -709,10 +713,10 @@ bool performModelTest(const std::string hvcFilePath)
 
                         // Build the reference vector for each variable, by interpolating from reference data file
                         // Interpolation prevents failure if nLogSamples would change (provided sample frequency is not decreased to much)
-                        vReferenceData.reserve(vTime.size());
-                        for(size_t i=0; i<vTime.size(); ++i)
+                        vReferenceData.resize(vTime.size());
+                        if (!vTime.empty())
                         {
-                            vReferenceData.push_back(refDataTable.interpolate(vTime[i]));
+                            refDataTable.interpolate(&vTime[0], &vReferenceData[0], vTime.size());
                         }
 
                         for (size_t c=0; c<vvvSimulationData1.size(); ++c)
@@ -0,0 +1,544 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   SweepMode.cpp
+//! @brief Contains the sweep mode, that simulates a resident model once for each row in a parameter table
+//!
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <limits>
+#include <set>
+#include <algorithm>
+
+#include "SweepMode.h"
+#include "ModelUtilities.h"
+#include "CliUtilities.h"
+#include "core_cli.h"
+#include "TicToc.hpp"
+
+#include "ComponentSystem.h"
+#include "Parameters.h"
+#include "CoreUtilities/SimulationHandler.h"
+
+using namespace std;
+using namespace hopsan;
+
+SweepModeSettings::SweepModeSettings()
+{
+    startTime = 0;
+    stepTime = 0.001;
+    stopTime = 1;
+    numInstances = 0;
+    printDebug = false;
+    silent = false;
+}
+
+namespace {
+
+//! @brief A model variable that is written to the sweep results
+struct SweepVariable
+{
+    Port *pPort;
+    size_t dataId;
+};
+
+//! @brief Remove leading and trailing white space, including carriage return from files written on Windows
+string trimmed(const string &rString)
+{
+    const size_t first = rString.find_first_not_of(" \t\r");
+    if (first == string::npos)
+    {
+        return string();
+    }
+    const size_t last = rString.find_last_not_of(" \t\r");
+    return rString.substr(first, last-first+1);
+}
+
+//! @brief Check if a string is a number, so that it can be set with a parameter handle
+bool isNumber(const string &rString)
+{
+    char *pEnd = 0;
+    strtod(rString.c_str(), &pEnd);
+    return !rString.empty() && (*pEnd == '\0');
+}
+
+//! @brief Read a sweep table, the first line contains the full parameter names and each following line one set of parameter values
+//! @details Empty lines and lines starting with # are ignored
+//! @param[in] rFilePath The comma separated table file
+//! @param[out] rParameterNames The full parameter names
+//! @param[out] rRows The parameter values, one vector per row
+//! @returns True if the table could be read
+bool readSweepTable(const string &rFilePath, vector<string> &rParameterNames, vector< vector<string> > &rRows)
+{
+    ifstream file(rFilePath.c_str());
+    if (!file.is_open())
+    {
+        printErrorMessage("Could not open sweep table: "+rFilePath);
+        return false;
+    }
+
+    string line;
+    size_t lineNumber = 0;
+    while (getline(file, line))
+    {
+        ++lineNumber;
+        line = trimmed(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        vector<string> fields;
+        splitStringOnDelimiter(line, ',', fields);
+        for (size_t f=0; f<fields.size(); ++f)
+        {
+            fields[f] = trimmed(fields[f]);
+        }
+
+        if (rParameterNames.empty())
+        {
+            rParameterNames = fields;
+        }
+        else if (fields.size() != rParameterNames.size())
+        {
+            stringstream ss;
+            ss << "Wrong number of values on line " << lineNumber << " in sweep table: " << rFilePath;
+            printErrorMessage(ss.str());
+            return false;
+        }
+        else
+        {
+            rRows.push_back(fields);
+        }
+    }
+
+    if (rParameterNames.empty())
+    {
+        printErrorMessage("No parameter names in sweep table: "+rFilePath);
+        return false;
+    }
+    return true;
+}
+
+//! @brief Expand full port names to the names of all variables in the port, full variable names are kept as they are
+//! @param[in] pRootSystem The model
+//! @param[in] rNames Full port names (Component#Port) or full variable names (Component#Port#Variable), if empty all variables in the model are used
+//! @param[out] rVariableNames The full variable names
+//! @returns True if all ports could be found
+bool expandVariableNames(ComponentSystem *pRootSystem, const vector<string> &rNames, vector<string> &rVariableNames)
+{
+    rVariableNames.clear();
+    if (rNames.empty())
+    {
+        forEachPort(pRootSystem, [&rVariableNames](Port &rPort)
+        {
+            const vector<NodeDataDescription> *pVariables = rPort.isMultiPort() ? 0 : rPort.getNodeDataDescriptions();
+            for (size_t v=0; pVariables && v<pVariables->size(); ++v)
+            {
+                rVariableNames.push_back(generateFullPortVariableName(&rPort, v).c_str());
+            }
+        });
+        return true;
+    }
+
+    for (size_t n=0; n<rNames.size(); ++n)
+    {
+        vector<string> nameParts;
+        splitStringOnDelimiter(rNames[n], '#', nameParts);
+        if (nameParts.size() == 3)
+        {
+            rVariableNames.push_back(rNames[n]);
+            continue;
+        }
+
+        Port *pPort = getPortWithFullName(pRootSystem, rNames[n]);
+        const vector<NodeDataDescription> *pVariables = pPort ? pPort->getNodeDataDescriptions() : 0;
+        if (!pVariables)
+        {
+            printErrorMessage("Could not find port: "+rNames[n]);
+            return false;
+        }
+        for (size_t v=0; v<pVariables->size(); ++v)
+        {
+            rVariableNames.push_back(rNames[n]+"#"+pVariables->at(v).name.c_str());
+        }
+    }
+    return true;
+}
+
+//! @brief Look up the ports and data ids of full variable names in one model instance
+bool resolveVariables(ComponentSystem *pSystem, const vector<string> &rVariableNames, vector<SweepVariable> &rVariables)
+{
+    rVariables.clear();
+    for (size_t n=0; n<rVariableNames.size(); ++n)
+    {
+        vector<string> nameParts;
+        splitStringOnDelimiter(rVariableNames[n], '#', nameParts);
+        Port *pPort = (nameParts.size() == 3) ? getPortWithFullName(pSystem, rVariableNames[n]) : 0;
+        const int dataId = pPort ? pPort->getNodeDataIdFromName(nameParts[2].c_str()) : -1;
+        if (dataId < 0)
+        {
+            printErrorMessage("Could not find variable: "+rVariableNames[n]);
+            return false;
+        }
+        SweepVariable variable = {pPort, size_t(dataId)};
+        rVariables.push_back(variable);
+    }
+    return true;
+}
+
+//! @brief Only log the time series variables, final values are read from the nodes and do not need to be logged
+void setupSweepLogging(ComponentSystem *pSystem, const vector<SweepVariable> &rTimeSeries)
+{
+    forEachPort(pSystem, [](Port &rPort){rPort.setEnableLogging(false);});
+    if (rTimeSeries.empty())
+    {
+        pSystem->setNumLogSamples(0);
+        return;
+    }
+
+    for (size_t s=0; s<rTimeSeries.size(); ++s)
+    {
+        Port *pPort = rTimeSeries[s].pPort;
+        if (!pPort->isLoggingEnabled())
+        {
+            for (size_t v=0; v<pPort->getNodeDataDescriptions()->size(); ++v)
+            {
+                pPort->setEnableLogVariable(v, false);
+            }
+        }
+        pPort->setEnableLogVariable(rTimeSeries[s].dataId, true);
+        pPort->setEnableLogging(true);
+    }
+}
+
+//! @brief Write one row of sweep results
+//! @param[out] rOutput The stream to write to
+//! @param[in] row The row index in the sweep table
+//! @param[in] rValues The parameter values of the row
+//! @param[in] ok False if the simulation failed, all results are then written as nan
+//! @param[in] rFinalValues The final value variables
+//! @param[in] rTimeSeries The time series variables
+//! @param[in] numSamples The number of log samples to write for each time series variable
+void writeResultsRow(ostream &rOutput, const size_t row, const vector<string> &rValues, const bool ok,
+                     const vector<SweepVariable> &rFinalValues, const vector<SweepVariable> &rTimeSeries, const size_t numSamples)
+{
+    const double nan = numeric_limits<double>::quiet_NaN();
+    rOutput << row << "," << (ok ? "ok" : "failed");
+    for (size_t p=0; p<rValues.size(); ++p)
+    {
+        rOutput << "," << rValues[p];
+    }
+    rOutput << std::scientific;
+    for (size_t f=0; f<rFinalValues.size(); ++f)
+    {
+        rOutput << "," << (ok ? rFinalValues[f].pPort->readNode(rFinalValues[f].dataId) : nan);
+    }
+    for (size_t s=0; s<rTimeSeries.size(); ++s)
+    {
+        const vector<double> *pLogData = ok ? rTimeSeries[s].pPort->getLogDataColumnPtr(rTimeSeries[s].dataId) : 0;
+        for (size_t t=0; t<numSamples; ++t)
+        {
+            rOutput << "," << ((pLogData && t<pLogData->size()) ? (*pLogData)[t] : nan);
+        }
+    }
+    rOutput << defaultfloat << "\n";
+}
+
+//! @brief Create the header line of the sweep results file
+//! @param[in] pTime The log time vector, only used if there are time series variables
+std::string createResultsHeader(const vector<string> &rParameterNames, const vector<string> &rFinalValueNames, const vector<string> &rTimeSeriesNames,
+                                const vector<double> *pTime, const size_t numSamples)
+{
+    ostringstream header;
+    header << "row,status";
+    for (size_t p=0; p<rParameterNames.size(); ++p)
+    {
+        header << "," << rParameterNames[p];
+    }
+    for (size_t f=0; f<rFinalValueNames.size(); ++f)
+    {
+        header << "," << rFinalValueNames[f];
+    }
+    for (size_t s=0; s<rTimeSeriesNames.size(); ++s)
+    {
+        for (size_t t=0; t<numSamples; ++t)
+        {
+            header << "," << rTimeSeriesNames[s] << "@" << pTime->at(t);
+        }
+    }
+    return header.str();
+}
+
+}
+
+//! @brief Simulate an already loaded model once for each row in a parameter table, and write all results to one file
+//! @details The first line in the table contains full parameter names, and each following line a comma separated set of values.
+//! The model is cloned into a number of instances that are simulated in parallel, one table row each. Numerical values of double
+//! parameters are set through parameter handles, other values are set as parameter value text.
+//! Each results line starts with the table row index and ok or failed, followed by the parameter values, the final values and
+//! the logged samples of the time series variables. The file is flushed after each batch of rows. If the results file already
+//! exists, the rows in it are not simulated again, so an interrupted sweep can be resumed by running the same command again.
+//! @param[in] pRootSystem The loaded top-level system, it is used as the first instance
+//! @param[in] rTableFile The parameter table file
+//! @param[in] rResultsFile The results file to write or resume
+//! @param[in] rSettings The simulation settings
+//! @returns True if all rows were simulated successfully
+bool runSweepMode(ComponentSystem *pRootSystem, const string &rTableFile, const string &rResultsFile, const SweepModeSettings &rSettings)
+{
+    vector<string> parameterNames;
+    vector< vector<string> > rows;
+    if (!readSweepTable(rTableFile, parameterNames, rows))
+    {
+        return false;
+    }
+
+    vector<string> finalValueNames, timeSeriesNames;
+    if (!expandVariableNames(pRootSystem, rSettings.finalValueVariables, finalValueNames) ||
+        (!rSettings.timeSeriesVariables.empty() && !expandVariableNames(pRootSystem, rSettings.timeSeriesVariables, timeSeriesNames)))
+    {
+        return false;
+    }
+
+    // Read the rows that are already done from an existing results file, an incomplete last line is dropped
+    string existingHeader, existingContents;
+    set<size_t> finishedRows;
+    ifstream existingFile(rResultsFile.c_str(), ios::binary);
+    string line;
+    while (existingFile.is_open() && getline(existingFile, line) && !existingFile.eof())
+    {
+        if (existingHeader.empty())
+        {
+            existingHeader = line;
+        }
+        else
+        {
+            finishedRows.insert(size_t(strtoul(line.c_str(), 0, 10)));
+        }
+        existingContents += line+"\n";
+    }
+    existingFile.close();
+
+    vector<size_t> pendingRows;
+    for (size_t r=0; r<rows.size(); ++r)
+    {
+        if (finishedRows.count(r) == 0)
+        {
+            pendingRows.push_back(r);
+        }
+    }
+    if (!finishedRows.empty())
+    {
+        stringstream ss;
+        ss << "Resuming sweep, " << rows.size()-pendingRows.size() << " of " << rows.size() << " rows are already done";
+        printMessage(ss.str(), rSettings.silent);
+    }
+    if (pendingRows.empty())
+    {
+        return true;
+    }
+
+    ofstream results(rResultsFile.c_str(), ios::binary | ios::trunc);
+    if (!results.is_open())
+    {
+        printErrorMessage("Could not open: "+rResultsFile+" for writing!");
+        return false;
+    }
+    results << existingContents;
+    results.flush();
+
+    // Create the model instances, the loaded model is the first one
+    size_t numInstances = (rSettings.numInstances > 0) ? rSettings.numInstances : getNumAvailibleCores();
+    numInstances = min(numInstances, pendingRows.size());
+    vector<ComponentSystem*> instances(1, pRootSystem);
+    bool isOk = true;
+    for (size_t i=1; isOk && i<numInstances; ++i)
+    {
+        instances.push_back(pRootSystem->clone());
+        isOk = (instances.back() != 0);
+    }
+    if (!isOk)
+    {
+        printErrorMessage("Could not clone the model for the sweep");
+    }
+
+    // Parameter values that are numbers are set through parameter handles, others by name
+    vector<bool> useHandle(parameterNames.size(), true);
+    for (size_t r=0; r<rows.size(); ++r)
+    {
+        for (size_t p=0; p<parameterNames.size(); ++p)
+        {
+            useHandle[p] = useHandle[p] && isNumber(rows[r][p]);
+        }
+    }
+    vector< vector<ParameterHandle> > handles(instances.size(), vector<ParameterHandle>(parameterNames.size()));
+    vector< vector<SweepVariable> > finalValues(instances.size()), timeSeries(instances.size());
+    for (size_t i=0; isOk && i<instances.size(); ++i)
+    {
+        for (size_t p=0; p<parameterNames.size(); ++p)
+        {
+            if (useHandle[p] && !handles[i][p].resolve(instances[i], parameterNames[p].c_str()))
+            {
+                printWarningMessage("Parameter: "+parameterNames[p]+" will be set by name", rSettings.silent);
+                useHandle[p] = false;
+            }
+        }
+        isOk = resolveVariables(instances[i], finalValueNames, finalValues[i]) && resolveVariables(instances[i], timeSeriesNames, timeSeries[i]);
+        if (isOk)
+        {
+            setupSweepLogging(instances[i], timeSeries[i]);
+            instances[i]->setDesiredTimestep(rSettings.stepTime);
+            isOk = instances[i]->checkModelBeforeSimulation();
+        }
+    }
+    printWaitingMessages(rSettings.printDebug, rSettings.silent);
+
+    // The header is written when the log time of the time series is known, rows that fail before that are kept until then
+    // An existing header must be the same, otherwise the results file belongs to an other sweep
+    size_t numSamples = 0;
+    bool haveHeader = false;
+    vector<size_t> rowsWithoutHeader;
+    auto writeHeader = [&](const vector<double> *pTime)
+    {
+        const string header = createResultsHeader(parameterNames, finalValueNames, timeSeriesNames, pTime, numSamples);
+        haveHeader = true;
+        if (existingHeader.empty())
+        {
+            results << header << "\n";
+        }
+        else if (header != existingHeader)
+        {
+            printErrorMessage("The existing results file: "+rResultsFile+" was written with other parameters or variables, it can not be resumed");
+            return false;
+        }
+        for (size_t r=0; r<rowsWithoutHeader.size(); ++r)
+        {
+            writeResultsRow(results, rowsWithoutHeader[r], rows[rowsWithoutHeader[r]], false, finalValues[0], timeSeries[0], numSamples);
+        }
+        return true;
+    };
+    if (isOk && timeSeriesNames.empty())
+    {
+        isOk = writeHeader(0);
+    }
+
+    size_t numFailed = 0;
+    SimulationHandler simulationHandler;
+    vector<ComponentSystem*> previouslySimulated;
+    TicToc sweepTimer;
+    for (size_t b=0; isOk && b<pendingRows.size(); b+=instances.size())
+    {
+        const size_t batchSize = min(instances.size(), pendingRows.size()-b);
+        vector<bool> rowOk(batchSize, true);
+        vector<ComponentSystem*> initialized;
+        for (size_t i=0; i<batchSize; ++i)
+        {
+            const vector<string> &rValues = rows[pendingRows[b+i]];
+            for (size_t p=0; p<parameterNames.size(); ++p)
+            {
+                if (useHandle[p])
+                {
+                    rowOk[i] = handles[i][p].setValue(atof(rValues[p].c_str())) && rowOk[i];
+                }
+                else
+                {
+                    rowOk[i] = setParameterValueWithFullName(instances[i], parameterNames[p], rValues[p]) && rowOk[i];
+                }
+            }
+            rowOk[i] = rowOk[i] && instances[i]->initialize(rSettings.startTime, rSettings.stopTime);
+            if (rowOk[i])
+            {
+                initialized.push_back(instances[i]);
+            }
+        }
+
+        if (initialized.size() == 1)
+        {
+            initialized.front()->simulate(rSettings.stopTime);
+        }
+        else if (initialized.size() > 1)
+        {
+            // The systems are only distributed over the threads again when the set of systems changes
+            const bool noChanges = (initialized == previouslySimulated);
+            simulationHandler.simulateSystem(rSettings.startTime, rSettings.stopTime, int(initialized.size()), initialized, noChanges);
+            previouslySimulated = initialized;
+        }
+
+        for (size_t i=0; i<batchSize; ++i)
+        {
+            instances[i]->finalize();
+            rowOk[i] = rowOk[i] && !instances[i]->wasSimulationAborted();
+            if (!haveHeader && rowOk[i])
+            {
+                numSamples = instances[i]->getNumActuallyLoggedSamples();
+                isOk = writeHeader(instances[i]->getLogTimeVector());
+            }
+        }
+        if (!isOk)
+        {
+            break;
+        }
+
+        for (size_t i=0; i<batchSize; ++i)
+        {
+            const size_t row = pendingRows[b+i];
+            if (!rowOk[i])
+            {
+                printErrorMessage("Simulation failed for sweep row: "+to_string(row), rSettings.silent);
+                ++numFailed;
+            }
+            if (haveHeader)
+            {
+                writeResultsRow(results, row, rows[row], rowOk[i], finalValues[i], timeSeries[i], numSamples);
+            }
+            else
+            {
+                rowsWithoutHeader.push_back(row);
+            }
+        }
+        results.flush();
+        printWaitingMessages(rSettings.printDebug, rSettings.silent);
+
+        stringstream ss;
+        ss << "Sweep rows done: " << rows.size()-pendingRows.size()+b+batchSize << " of " << rows.size() << ", " << sweepTimer.Toc() << " s";
+        printMessage(ss.str(), rSettings.silent);
+    }
+
+    // If all rows failed, the header is written without time series
+    if (isOk && !haveHeader)
+    {
+        isOk = writeHeader(0);
+    }
+    results.close();
+
+    for (size_t i=1; i<instances.size(); ++i)
+    {
+        delete instances[i];
+    }
+    return isOk && (numFailed == 0);
+}
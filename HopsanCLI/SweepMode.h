@@ -0,0 +1,59 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+
+//!
+//! @file   SweepMode.h
+//! @brief Contains the sweep mode, that simulates a resident model once for each row in a parameter table
+//!
+
+#ifndef SWEEPMODE_H
+#define SWEEPMODE_H
+
+#include <string>
+#include <vector>
+
+namespace hopsan {
+class ComponentSystem;
+}
+
+//! @brief Settings for the sweep mode
+class SweepModeSettings
+{
+public:
+    SweepModeSettings();
+
+    double startTime;
+    double stepTime;
+    double stopTime;
+    size_t numInstances;
+    bool printDebug;
+    bool silent;
+    std::vector<std::string> finalValueVariables;
+    std::vector<std::string> timeSeriesVariables;
+};
+
+bool runSweepMode(hopsan::ComponentSystem *pRootSystem, const std::string &rTableFile, const std::string &rResultsFile, const SweepModeSettings &rSettings);
+
+#endif // SWEEPMODE_H
@@ -0,0 +1,247 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   WarmMode.cpp
+//! @brief Contains the warm mode, that runs simulations of a resident model on commands from an input stream
+//!
+
+#include <sstream>
+#include <cstdlib>
+
+#include "WarmMode.h"
+#include "ModelUtilities.h"
+#include "CliUtilities.h"
+#include "core_cli.h"
+#include "TicToc.hpp"
+
+#include "ComponentSystem.h"
+
+using namespace std;
+using namespace hopsan;
+
+WarmModeSettings::WarmModeSettings()
+{
+    startTime = 0;
+    stepTime = 0.001;
+    stopTime = 1;
+    useParallel = false;
+    numThreads = 0;
+    algorithm = APrioriScheduling;
+    printDebug = false;
+    silent = false;
+}
+
+namespace {
+
+//! @brief Parse a simulation time string, [start,ts,stop] or [ts,stop] or [stop]
+bool parseSimulationTime(const string &rTime, double &rStartTime, double &rStepTime, double &rStopTime)
+{
+    vector<string> simTime;
+    splitStringOnDelimiter(rTime, ',', simTime);
+    if (simTime.size() == 3)
+    {
+        rStartTime = atof(simTime[0].c_str());
+        rStepTime = atof(simTime[1].c_str());
+        rStopTime = atof(simTime[2].c_str());
+    }
+    else if (simTime.size() == 2)
+    {
+        rStepTime = atof(simTime[0].c_str());
+        rStopTime = atof(simTime[1].c_str());
+    }
+    else if (simTime.size() == 1)
+    {
+        rStopTime = atof(simTime[0].c_str());
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool hasEnding(const string &rString, const string &rEnding)
+{
+    return (rString.size() >= rEnding.size()) && (rString.compare(rString.size()-rEnding.size(), rEnding.size(), rEnding) == 0);
+}
+
+}
+
+//! @brief Run simulations of an already loaded model, on commands read line by line from an input stream
+//! @details The libraries and the model stay loaded between the simulations, so that each new run only pays for initialize and simulate.
+//! Each command is answered with a line starting with "OK" or "FAILED" when it has been handled. The commands are:
+//! set FullComponentName#ParameterName value, import parameters.csv, reset, simulate [start,ts,stop], results file.csv|file.h5 [final] and quit.
+//! The reset command restores the parameter values that the model had when the warm mode started.
+//! While the warm mode runs, all other output to std::cout (messages and terminal colors) is redirected to std::cerr,
+//! so that the output stream only contains command replies.
+//! @param[in] pRootSystem The loaded top-level system
+//! @param[in] rSettings The default simulation settings
+//! @param[in] rInput The stream to read commands from
+//! @param[in] rOutput The stream to write command replies to
+//! @returns True if all commands succeeded
+bool runWarmMode(ComponentSystem *pRootSystem, const WarmModeSettings &rSettings, istream &rInput, ostream &rOutput)
+{
+    ostream replyOutput(rOutput.rdbuf());
+    streambuf *pCoutBuffer = cout.rdbuf(cerr.rdbuf());
+
+    vector<pair<string, string> > templateParameters;
+    getParameterValues(pRootSystem, templateParameters);
+
+    bool allSucceeded = true;
+    bool haveSimulated = false;
+    size_t numRuns = 0;
+    string line;
+    while (getline(rInput, line))
+    {
+        // Remove trailing carriage return from input that has been written on Windows
+        if (!line.empty() && (line[line.size()-1] == '\r'))
+        {
+            line.erase(line.size()-1);
+        }
+
+        istringstream lineStream(line);
+        string command;
+        lineStream >> command;
+        if (command.empty() || command[0] == '#')
+        {
+            continue;
+        }
+
+        bool ok = false;
+        string reply;
+        if (command == "quit")
+        {
+            replyOutput << "OK" << endl;
+            break;
+        }
+        else if (command == "set")
+        {
+            string name, value;
+            lineStream >> name;
+            getline(lineStream >> ws, value);
+            ok = !name.empty() && !value.empty() && setParameterValueWithFullName(pRootSystem, name, value);
+            if (!ok)
+            {
+                reply = "Could not set parameter: "+name;
+            }
+        }
+        else if (command == "import")
+        {
+            string filePath;
+            getline(lineStream >> ws, filePath);
+            ok = !filePath.empty() && importParameterValuesFromCSV(filePath, pRootSystem);
+            if (!ok)
+            {
+                reply = "Could not import parameters from: "+filePath;
+            }
+        }
+        else if (command == "reset")
+        {
+            ok = true;
+            for (size_t p=0; p<templateParameters.size(); ++p)
+            {
+                ok = setParameterValueWithFullName(pRootSystem, templateParameters[p].first, templateParameters[p].second) && ok;
+            }
+            if (!ok)
+            {
+                reply = "Could not restore all parameter values";
+            }
+        }
+        else if (command == "simulate")
+        {
+            double startTime = rSettings.startTime;
+            double stepTime = rSettings.stepTime;
+            double stopTime = rSettings.stopTime;
+            string simTime;
+            lineStream >> simTime;
+            if (!simTime.empty() && !parseSimulationTime(simTime, startTime, stepTime, stopTime))
+            {
+                reply = "Could not parse simulation time: "+simTime;
+            }
+            else
+            {
+                TicToc simuTimer;
+                pRootSystem->setDesiredTimestep(stepTime);
+                ok = pRootSystem->checkModelBeforeSimulation() && pRootSystem->initialize(startTime, stopTime);
+                if (ok)
+                {
+                    if (rSettings.useParallel)
+                    {
+                        // Reuse the schedule and threads from the previous run, the model structure does not change between runs
+                        pRootSystem->simulateMultiThreaded(startTime, stopTime, size_t(rSettings.numThreads), haveSimulated, rSettings.algorithm);
+                    }
+                    else
+                    {
+                        pRootSystem->simulate(stopTime);
+                    }
+                    ok = !pRootSystem->wasSimulationAborted();
+                    haveSimulated = true;
+                }
+                pRootSystem->finalize();
+                ++numRuns;
+
+                ostringstream ss;
+                ss << "run " << numRuns << " " << simuTimer.Toc() << " s";
+                reply = ok ? ss.str() : "Simulation failed, "+ss.str();
+            }
+        }
+        else if (command == "results")
+        {
+            string filePath, howMany;
+            lineStream >> filePath >> howMany;
+            const SaveResults saveHowMany = (howMany == "final") ? Final : Full;
+            if (filePath.empty())
+            {
+                reply = "No results file given";
+            }
+            else if (hasEnding(filePath, ".h5") || hasEnding(filePath, ".hdf5"))
+            {
+                saveResultsToHDF5(pRootSystem, filePath, rSettings.logOnlyPortsOrVariables, saveHowMany);
+                ok = true;
+            }
+            else
+            {
+                saveResultsToCSV(pRootSystem, filePath, saveHowMany, rSettings.logOnlyPortsOrVariables);
+                ok = true;
+            }
+        }
+        else
+        {
+            reply = "Unknown command: "+command;
+        }
+
+        printWaitingMessages(rSettings.printDebug, rSettings.silent);
+        replyOutput << (ok ? "OK" : "FAILED");
+        if (!reply.empty())
+        {
+            replyOutput << " " << reply;
+        }
+        replyOutput << endl;
+        allSucceeded = allSucceeded && ok;
+    }
+
+    cout.rdbuf(pCoutBuffer);
+    return allSucceeded;
+}
@@ -0,0 +1,61 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   WarmMode.h
+//! @brief Contains the warm mode, that runs simulations of a resident model on commands from an input stream
+//!
+
+#ifndef WARMMODE_H
+#define WARMMODE_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "CoreUtilities/SimulationHandler.h"
+
+namespace hopsan {
+class ComponentSystem;
+}
+
+//! @brief Settings for the warm mode
+class WarmModeSettings
+{
+public:
+    WarmModeSettings();
+
+    double startTime;
+    double stepTime;
+    double stopTime;
+    bool useParallel;
+    int numThreads;
+    hopsan::ParallelAlgorithmT algorithm;
+    bool printDebug;
+    bool silent;
+    std::vector<std::string> logOnlyPortsOrVariables;
+};
+
+bool runWarmMode(hopsan::ComponentSystem *pRootSystem, const WarmModeSettings &rSettings, std::istream &rInput=std::cin, std::ostream &rOutput=std::cout);
+
+#endif // WARMMODE_H
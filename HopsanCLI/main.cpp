@@ -31,6 +31,8 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <atomic>
+#include <cstdlib>
 
 #include <tclap/CmdLine.h>
 
@@ -44,10 +46,13 @@
 #include "CliUtilities.h"
 #include "ModelValidation.h"
 #include "BuildUtilities.h"
+#include "WarmMode.h"
+#include "SweepMode.h"
 
 #ifdef USEOPS
 #include "OpsWorker.h"
 #include "OpsEvaluator.h"
+#include "OpsExecutor.h"
 #include "OpsMessageHandler.h"
 #include "OpsWorkerNelderMead.h"
 #include "OpsWorkerComplexRF.h"
@@ -133,30 +138,41 @@ public:
         mEvaulationCounter = 0;
         mStartTime = startTime;
         mStopTime = stopTime;
-    }
 
-    //! @todo Make evaluateAll... work in parallel
+        // Resolve the parameters once, so that candidate values can be set without name lookup
+        mParameterHandles.resize(mRootSystemPtrs.size());
+        for(size_t s=0; s<mRootSystemPtrs.size(); ++s)
+        {
+            mParameterHandles[s].resize(mParNames.size());
+            for(size_t i=0; i<mParNames.size(); ++i)
+            {
+                mParameterHandles[s][i].resolve(mRootSystemPtrs[s], HString(mParNames[i].c_str()));
+            }
+        }
+    }
 
-    //void evaluateAllPoints();
+    //! @brief Evaluate one candidate, using the model copy with the same index as the candidate
+    //! @details Different candidates can be evaluated concurrently, since each candidate has its own model
     void evaluateCandidate(size_t idx)
     {
+        ComponentSystem *pSystem = mRootSystemPtrs.at(idx);
         for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
         {
             double par = mpWorker->getCandidateParameter(idx, i);
-            if(!mRootSystemPtrs.at(0)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
+            if(!mParameterHandles.at(idx)[i].setValue(par))
             {
                 cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
             }
         }
 
-        mRootSystemPtrs.at(0)->initialize(mStartTime,mStopTime);
-        mRootSystemPtrs.at(0)->simulate(mStopTime);
+        pSystem->initialize(mStartTime,mStopTime);
+        pSystem->simulate(mStopTime);
 
         double obj = 0.0;
         for(size_t i=0; i<mObjComps.size(); ++i)
         {
             int portId = 0;
-            Component *pComp = mRootSystemPtrs.at(0)->getSubComponent(mObjComps[i].c_str());
+            Component *pComp = pSystem->getSubComponent(mObjComps[i].c_str());
             Port *pPort = pComp->getPort(mObjPorts[i].c_str());
             double data = *pPort->getNodeDataPtr(portId);
             obj += mObjWeights[i]*data;
@@ -166,57 +182,18 @@ public:
         ++mEvaulationCounter;
     }
 
-    void evaluateAllCandidates()
-    {
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
-        {
-            for(size_t i=0; i<mpWorker->getNumberOfParameters(); ++i)
-            {
-                double par = mpWorker->getCandidateParameter(c, i);
-                if(!mRootSystemPtrs.at(c)->setParameterValue(HString(mParNames[i].c_str()), HString(std::to_string(par).c_str())))
-                {
-                    cout << "Error: Parameter " << mParNames[i] << " not found in model." << endl;
-                }
-            }
-        }
-
-        int  threads = mpWorker->getNumberOfCandidates();
-        if(threads == 1)
-        {
-            threads = -1;
-        }
-
-        gHopsanCore.getSimulationHandler()->initializeSystem(mStartTime,mStopTime,mRootSystemPtrs);
-        gHopsanCore.getSimulationHandler()->simulateSystem(mStartTime,mStopTime,threads,mRootSystemPtrs);
-
-        for(size_t c=0; c<mpWorker->getNumberOfCandidates(); ++c)
-        {
-            double obj = 0.0;
-            for(size_t i=0; i<mObjComps.size(); ++i)
-            {
-                int portId = 0;
-                Component *pComp = mRootSystemPtrs.at(c)->getSubComponent(mObjComps[i].c_str());
-                Port *pPort = pComp->getPort(mObjPorts[i].c_str());
-                double data = *pPort->getNodeDataPtr(portId);
-                obj += mObjWeights[i]*data;
-            }
-            mpWorker->setCandidateObjectiveValue(c, obj);
-            ++mEvaulationCounter;
-        }
-    }
-
     size_t getNumberOfEvaluations() { return mEvaulationCounter; }
 
-    //void evaluateAllCandidates();
 private:
     vector<ComponentSystem *> mRootSystemPtrs;
     vector<string> mParNames;
+    vector<vector<ParameterHandle> > mParameterHandles;
     vector<string> mObjComps;
     vector<string> mObjPorts;
     vector<double> mObjWeights;
     vector<double> mParMin;
     vector<double> mParMax;
-    size_t mEvaulationCounter;
+    std::atomic<size_t> mEvaulationCounter;
     double mStartTime;
     double mStopTime;
 };
@@ -235,26 +212,34 @@ int main(int argc, char *argv[])
         TCLAP::SwitchArg printDebugOption("", "printDebug", "Show debug messages in the output", cmd);
         TCLAP::SwitchArg silentOption("", "silent", "Disable all output messages", cmd);
         TCLAP::SwitchArg createHvcTestOption("", "createValidationData","Create a model validation data set based on the variables connected to scopes in the model given by option -m", cmd);
+        TCLAP::SwitchArg warmOption("", "warm", "Keep the libraries and the model loaded and run simulations on commands read from stdin, one per line: set, import, reset, simulate, results and quit. Each command is answered with a line starting with OK or FAILED", cmd);
         TCLAP::SwitchArg prefixRootLevelName("", "prefixRootSystemName", "Prefix the root-level system name to exported results and parameters", cmd);
 
         TCLAP::ValueArg<std::string> coreLogFileOption("", "log.corelogfile", "The simulation core log file destination", false, "", "Filepath", cmd);
         TCLAP::ValueArg<std::string> buildCompLibOption("", "buildComponentLibrary", "Build the specified component library (point to the library xml)", false, "", "string", cmd);
         TCLAP::ValueArg<std::string> destinationOption("d","destination","Destination for resulting files",false,"","Path to directory", cmd);
-        TCLAP::ValueArg<std::string> saveSimulationStateOption("", "saveSimState", "Export the simulation state to this file", false, "Path to file", "string", cmd);
-        TCLAP::ValueArg<std::string> loadSimulationStateOption("", "loadSimState", "Load the simulation state (with time offset) from this file", false, "Path to file", "string", cmd);
+        TCLAP::ValueArg<std::string> saveSimulationStateOption("", "saveSimState", "Export the simulation state, including internal component states, to this file", false, "Path to file", "string", cmd);
+        TCLAP::ValueArg<std::string> loadSimulationStateOption("", "loadSimState", "Load the simulation state (with time offset and internal component states) from this file", false, "Path to file", "string", cmd);
         TCLAP::ValueArg<std::string> loadSimulationSVOption("", "loadSimStartValues", "Load the start values (simulation state without time offset) from this file", false, "Path to file", "string", cmd);
         TCLAP::ValueArg<std::string> resultsCSVSortOption("", "resultsCSVSort", "Export results in columns or in rows: [rows, cols]", false, "rows", "string", cmd);
         TCLAP::ValueArg<std::string> resultsFinalCSVOption("", "resultsFinalCSV", "Export the results (only final values)", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFullCSVOption("", "resultsFullCSV", "Export the results (all logged data) to CSV", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFinalHDF5Option("", "resultsFinalHDF5", "Exeport the results (only final values) to HDF5", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> resultsFullHDF5Option("", "resultsFullHDF5", "Exeport the results (all logged data) to HDF5", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> resultsStreamOption("", "resultsStream", "Stream the results (all logged data) to file during simulation, so that only one chunk of log data is kept in memory. Files ending with .h5 or .hdf5 are written as chunked HDF5, other files in the Hopsan binary log format", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> resultsStreamChunkOption("", "resultsStreamChunk", "The number of log samples per chunk when streaming results", false, "4096", "integer", cmd);
         TCLAP::ValueArg<std::string> parameterExportOption("", "parameterExport", "CSV file with exported parameter values", false, "", "Path to file", cmd);
         TCLAP::ValueArg<std::string> parameterImportOption("", "parameterImport", "CSV file with parameter values to import", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> sweepOption("", "sweep", "CSV table with one set of parameter values per row, the first row contains the full parameter names. The model is simulated once for each row, see --sweepResults", false, "", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> sweepResultsOption("", "sweepResults", "Results file for --sweep, one line per table row with final values of the variables given by --logonly (default all) and the samples of the --sweepTimeSeries variables. An interrupted sweep is resumed if the file exists", false, "sweep_results.csv", "Path to file", cmd);
+        TCLAP::ValueArg<std::string> sweepInstancesOption("", "sweepInstances", "The number of model instances to simulate in parallel during --sweep, 0 means auto-detect number of processors", false, "0", "integer", cmd);
+        TCLAP::ValueArg<std::string> sweepTimeSeriesOption("", "sweepTimeSeries", "Ports or variables to write all logged samples for in the --sweep results. Can be a file (one full port/variable name per line) or coma separated list.", false, "", "string", cmd);
         TCLAP::ValueArg<std::string> hvcTestOption("t","validate","Perform model validation based on HopsanValidationConfiguration",false,"","Path to .hvc file", cmd);
         TCLAP::ValueArg<std::string> nLogSamplesOption("l","numLogSamples","Set the number of log samples to store for the top-level system, (default: Use number in .hmf)",false,"","integer", cmd);
+        TCLAP::ValueArg<std::string> randomSeedOption("","randomSeed","Set the random seed for the top-level system, the random number streams of components are derived from it and their names, (default: Use seed in .hmf or 0)",false,"","integer", cmd);
         TCLAP::ValueArg<std::string> logonlyOption("","logonly","If specified, log only given ports or variables. Can be a file (one full port/variable name per line) or coma separated list.",false,"","string", cmd);
         TCLAP::ValueArg<std::string> simulateOption("s","simulate","Specify simulation time as: [hmf] or [start,ts,stop] or [ts,stop] or [stop]",false,"","Comma separated string", cmd);
-        TCLAP::ValueArg<std::string> parallelOption("p","parallel","Enable parallel simulation with specified number of threads. 0 threads  means auto-detect number of procssors.",false,"0","integer", cmd);
+        TCLAP::ValueArg<std::string> parallelOption("p","parallel","Enable parallel simulation with specified number of threads. 0 threads  means auto-detect number of procssors. Optionally followed by the algorithm: apriori (default), taskpool, taskstealing, forkjoin or clusteredforkjoin",false,"0","integer[,algorithm]", cmd);
         TCLAP::ValueArg<std::string> extLibsFileOption("","externalLibsFile","A text file containing the external libs to load",false,"","Path to file", cmd);
         TCLAP::MultiArg<std::string> extLibPathsOption("e","externalLib","Path to a .dll/.so/.dylib externalComponentLib. Can be given multiple times",false,"Path to file", cmd);
         TCLAP::MultiArg<std::string> optimizationOption("o","optScript","Optimization scripts",false,"Path to files", cmd);
@@ -611,19 +596,28 @@ int main(int argc, char *argv[])
                 std::vector<ComponentSystem*> rootSystemPtrs;
                 for(size_t m=0; m<nModels; ++m)
                 {
-                    rootSystemPtrs.push_back(gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime));
-                    if(rootSystemPtrs.at(m))
+                    // The model file is only loaded once, the other instances are cloned from the first one
+                    if(m == 0)
                     {
-                        if (parameterImportOption.isSet())
+                        rootSystemPtrs.push_back(gHopsanCore.loadHMFModelFile(hmfPathOption.getValue().c_str(), startTime, stopTime));
+                        if (rootSystemPtrs.front() && parameterImportOption.isSet())
                         {
                             cout << "Importing parameter values from file: " << parameterImportOption.getValue() << endl;
-                            importParameterValuesFromCSV(parameterImportOption.getValue(), rootSystemPtrs.at(m));
+                            importParameterValuesFromCSV(parameterImportOption.getValue(), rootSystemPtrs.front());
                         }
+                    }
+                    else
+                    {
+                        rootSystemPtrs.push_back(rootSystemPtrs.front()->clone());
+                    }
+
+                    if(rootSystemPtrs.at(m))
+                    {
                         rootSystemPtrs.at(m)->disableLog();
                     }
                     else
                     {
-                        printErrorMessage("Could not load model file: " + hmfPathOption.getValue());
+                        printErrorMessage((m == 0) ? "Could not load model file: " + hmfPathOption.getValue() : "Could not clone model: " + hmfPathOption.getValue());
                         modelFileOk=false;
                         returnSuccess=false;
                         break;
@@ -765,10 +759,21 @@ int main(int argc, char *argv[])
                         }
                     }
 
+                    // Evaluate candidates concurrently, one thread per model copy
+                    Ops::Executor *pExecutor = nullptr;
+                    if(nModels > 1)
+                    {
+                        pExecutor = new Ops::ThreadPoolExecutor(nModels);
+                        pEvaluator->setExecutor(pExecutor);
+                    }
+
                     //Execute optimization
                     pBaseWorker->initialize();
                     pBaseWorker->run();
 
+                    pEvaluator->setExecutor(nullptr);
+                    delete pExecutor;
+
                     //Print results
                     if(printDebugFile)
                     {
@@ -887,36 +892,53 @@ int main(int argc, char *argv[])
                         pRootSystem->setNumLogSamples(nSamp);
                     }
 
+                    if (randomSeedOption.isSet())
+                    {
+                        uint64_t seed = strtoull(randomSeedOption.getValue().c_str(), 0, 10);
+                        cout << "Setting random seed to: " << seed << endl;
+                        pRootSystem->setRandomSeed(seed);
+                    }
+
                     if (logonlyOption.isSet())
                     {
-                        auto file_or_list = logonlyOption.getValue();
-                        // Check if argument is a file, if so, read from it line-by-line
-                        std::ifstream port_name_file(file_or_list);
-                        if (port_name_file.is_open())
-                        {
-                            std::string line;
-                            while(std::getline(port_name_file, line))
-                            {
-                                if (!line.empty())
-                                {
-                                    logOnlyPortsOrVariables.push_back(line);
-                                }
-                            }
-                            port_name_file.close();
-                        }
-                        // Else read , separated string
-                        else
-                        {
-                            splitStringOnDelimiter(file_or_list,',',logOnlyPortsOrVariables);
-                        }
+                        readPortOrVariableNames(logonlyOption.getValue(), logOnlyPortsOrVariables);
 
                         // Now disable all nodes and then enable the requested ones
+                        // For variable names (Component#Port#Variable) only the requested variables in the port are logged
                         forEachPort(pRootSystem, [](hopsan::Port& port){port.setEnableLogging(false);});
                         for (const auto& port_name : logOnlyPortsOrVariables)
                         {
                             hopsan::Port* pPort = getPortWithFullName(pRootSystem, port_name);
                             if (pPort)
                             {
+                                std::vector<std::string> nameParts;
+                                splitStringOnDelimiter(port_name, '#', nameParts);
+                                const std::vector<hopsan::NodeDataDescription> *pVariables = pPort->getNodeDataDescriptions();
+                                const size_t numVariables = pVariables ? pVariables->size() : 0;
+                                if (nameParts.size() == 3)
+                                {
+                                    const int dataId = pPort->getNodeDataIdFromName(nameParts[2].c_str());
+                                    if (dataId < 0)
+                                    {
+                                        printWarningMessage("Could not find variable: '"+port_name+"' when processing logonly input");
+                                        continue;
+                                    }
+                                    if (!pPort->isLoggingEnabled())
+                                    {
+                                        for (size_t v=0; v<numVariables; ++v)
+                                        {
+                                            pPort->setEnableLogVariable(v, false);
+                                        }
+                                    }
+                                    pPort->setEnableLogVariable(size_t(dataId), true);
+                                }
+                                else
+                                {
+                                    for (size_t v=0; v<numVariables; ++v)
+                                    {
+                                        pPort->setEnableLogVariable(v, true);
+                                    }
+                                }
                                 pPort->setEnableLogging(true);
                             }
                             else
@@ -942,6 +964,89 @@ int main(int argc, char *argv[])
                         pRootSystem->setKeepValuesAsStartValues(true);
                     }
 
+                    if (sweepOption.isSet())
+                    {
+                        SweepModeSettings sweepSettings;
+                        sweepSettings.startTime = startTime;
+                        sweepSettings.stepTime = stepTime;
+                        sweepSettings.stopTime = stopTime;
+                        sweepSettings.printDebug = printDebugOption.getValue();
+                        sweepSettings.silent = silentOption.getValue();
+                        sweepSettings.finalValueVariables = logOnlyPortsOrVariables;
+                        const int numInstances = atoi(sweepInstancesOption.getValue().c_str());
+                        if (numInstances < 0)
+                        {
+                            printErrorMessage("Number of sweep instances cannot be negative.");
+                            return -1;
+                        }
+                        sweepSettings.numInstances = size_t(numInstances);
+                        if (sweepTimeSeriesOption.isSet())
+                        {
+                            readPortOrVariableNames(sweepTimeSeriesOption.getValue(), sweepSettings.timeSeriesVariables);
+                        }
+
+                        cout << "Sweeping parameter table: " << sweepOption.getValue() << ", results in: " << destinationPath+sweepResultsOption.getValue() << endl;
+                        returnSuccess = doSimulate && runSweepMode(pRootSystem, sweepOption.getValue(), destinationPath+sweepResultsOption.getValue(), sweepSettings);
+                        printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                        delete pRootSystem;
+                        return returnSuccess ? 0 : 1;
+                    }
+
+                    if (warmOption.getValue())
+                    {
+                        WarmModeSettings warmSettings;
+                        warmSettings.startTime = startTime;
+                        warmSettings.stepTime = stepTime;
+                        warmSettings.stopTime = stopTime;
+                        warmSettings.printDebug = printDebugOption.getValue();
+                        warmSettings.silent = silentOption.getValue();
+                        warmSettings.logOnlyPortsOrVariables = logOnlyPortsOrVariables;
+                        if(parallelOption.isSet()) {
+                            if(!parseParallelOption(parallelOption.getValue(), warmSettings.numThreads, warmSettings.algorithm)) {
+                                printErrorMessage("Could not parse parallel option: "+parallelOption.getValue());
+                                return -1;
+                            }
+                            if(warmSettings.numThreads < 0) {
+                                printErrorMessage("Number of threads cannot be negative.");
+                                return -1;
+                            }
+                            warmSettings.useParallel = true;
+                        }
+                        // Only command replies are written to stdout in warm mode, so these messages go to stderr
+                        if (resultsStreamOption.isSet() && !silentOption.getValue())
+                        {
+                            cerr << "Warning: Results streaming is not supported in warm mode, use the results command instead" << endl;
+                        }
+
+                        cerr << "Warm mode, waiting for commands" << endl;
+                        returnSuccess = doSimulate && runWarmMode(pRootSystem, warmSettings);
+                        printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
+                        delete pRootSystem;
+                        return returnSuccess ? 0 : 1;
+                    }
+
+                    hopsan::LogDataSink *pResultsStreamSink = nullptr;
+                    if (resultsStreamOption.isSet())
+                    {
+                        const int chunkSize = atoi(resultsStreamChunkOption.getValue().c_str());
+                        if (chunkSize <= 0)
+                        {
+                            printErrorMessage("Results stream chunk size must be positive");
+                            return -1;
+                        }
+                        pResultsStreamSink = createResultsStreamSink(pRootSystem, destinationPath+resultsStreamOption.getValue(), size_t(chunkSize));
+                        if (!pResultsStreamSink)
+                        {
+                            return -1;
+                        }
+                        cout << "Streaming results to file: " << destinationPath+resultsStreamOption.getValue() << endl;
+                        if (resultsFullCSVOption.isSet() || resultsFullHDF5Option.isSet())
+                        {
+                            printWarningMessage("When streaming results, full result exports only contain the last chunk of log data", silentOption.getValue());
+                        }
+                        pRootSystem->setLogDataSink(pResultsStreamSink);
+                    }
+
                     //! @todo maybe use simulation handler object instead
                     TicToc isoktimer("IsOkTime");
                     doSimulate = doSimulate && pRootSystem->checkModelBeforeSimulation();
@@ -951,6 +1056,16 @@ int main(int argc, char *argv[])
                         TicToc initTimer("InitializeTime");
                         doSimulate = doSimulate && pRootSystem->initialize(startTime, stopTime);
                         initTimer.TocPrint();
+
+                        // Initialize resets the internal component states, so they must be restored afterwards
+                        if (doSimulate && loadSimulationStateOption.isSet())
+                        {
+                            if (!restoreSimulationCheckpoint(loadSimulationStateOption.getValue().c_str(), pRootSystem))
+                            {
+                                printErrorMessage("Could not restore the internal component states from: "+loadSimulationStateOption.getValue(), silentOption.getValue());
+                                doSimulate = false;
+                            }
+                        }
                     }
                     else
                     {
@@ -963,12 +1078,17 @@ int main(int argc, char *argv[])
                         cout << "Simulating: " << startTime << " to " << stopTime << " with Ts: " << stepTime << "     Please Wait!" << endl;
                         TicToc simuTimer("SimulationTime");
                         if(parallelOption.isSet()) {
-                            int nThreads = atoi(parallelOption.getValue().c_str());
+                            int nThreads;
+                            hopsan::ParallelAlgorithmT algorithm;
+                            if(!parseParallelOption(parallelOption.getValue(), nThreads, algorithm)) {
+                                printErrorMessage("Could not parse parallel option: "+parallelOption.getValue());
+                                return -1;
+                            }
                             if(nThreads < 0) {
                                 printErrorMessage("Number of threads cannot be negative.");
                                 return -1;
                             }
-                            pRootSystem->simulateMultiThreaded(startTime, stopTime, nThreads);
+                            pRootSystem->simulateMultiThreaded(startTime, stopTime, nThreads, false, algorithm);
                         }
                         else {
                             pRootSystem->simulate(stopTime);
@@ -986,6 +1106,17 @@ int main(int argc, char *argv[])
                     }
 
                     pRootSystem->finalize();
+
+                    if (pResultsStreamSink)
+                    {
+                        if (!pResultsStreamSink->finish())
+                        {
+                            printErrorMessage("Failure when streaming results: "+std::string(pResultsStreamSink->getLastError().c_str()), silentOption.getValue());
+                            returnSuccess = false;
+                        }
+                        pRootSystem->setLogDataSink(nullptr);
+                        delete pResultsStreamSink;
+                    }
                 }
 
                 printWaitingMessages(printDebugOption.getValue(), silentOption.getValue());
@@ -151,6 +151,7 @@ SOURCES += \
     src/CoreUtilities/HopsanCoreMessageHandler.cpp \
     src/CoreUtilities/HmfLoader.cpp \
     src/ComponentUtilities/WhiteGaussianNoise.cpp \
+    src/ComponentUtilities/RandomNumberGenerator.cpp \
     src/ComponentUtilities/SecondOrderTransferFunction.cpp \
     src/ComponentUtilities/matrix.cpp \
     src/ComponentUtilities/ludcmp.cpp \
@@ -167,6 +168,7 @@ SOURCES += \
     src/ComponentUtilities/LookupTable.cpp \
     src/ComponentUtilities/PLOParser.cpp \
     src/ComponentUtilities/TempDirectoryHandle.cpp \
+    src/ComponentUtilities/SharedLookupTable.cpp \
     $${PWD}/dependencies/indexingcsvparser/src/indexingcsvparser.cpp \
     src/Quantities.cpp \
     src/CoreUtilities/NumHopHelper.cpp \
@@ -175,7 +177,9 @@ SOURCES += \
     src/CoreUtilities/SimulationHandler.cpp \
     src/CoreUtilities/MultiThreadingUtilities.cpp \
     src/CoreUtilities/StringUtilities.cpp \
-    src/CoreUtilities/SaveRestoreSimulationPoint.cpp
+    src/CoreUtilities/SaveRestoreSimulationPoint.cpp \
+    src/CoreUtilities/LogDataSink.cpp \
+    src/CoreUtilities/SimulationStateBuffer.cpp
 HEADERS += \
     include/win32dll.h \
     include/Port.h \
@@ -195,6 +199,7 @@ HEADERS += \
     include/CoreUtilities/ClassFactoryStatusCheck.hpp \
     include/CoreUtilities/ClassFactory.hpp \
     include/ComponentUtilities/WhiteGaussianNoise.h \
+    include/ComponentUtilities/RandomNumberGenerator.h \
     include/ComponentUtilities/ValveHysteresis.h \
     include/ComponentUtilities/TurbulentFlowFunction.h \
     include/ComponentUtilities/SecondOrderTransferFunction.h \
@@ -222,6 +227,7 @@ HEADERS += \
     include/HopsanCoreMacros.h \
     include/compiler_info.h \
     include/ComponentUtilities/LookupTable.h \
+    include/ComponentUtilities/SharedLookupTable.h \
     include/ComponentUtilities/PLOParser.h \
     $${PWD}/dependencies/indexingcsvparser/include/indexingcsvparser/indexingcsvparser.h \
     include/Quantities.h \
@@ -232,7 +238,9 @@ HEADERS += \
     include/CoreUtilities/ConnectionAssistant.h \
     include/CoreUtilities/AliasHandler.h \
     include/CoreUtilities/SimulationHandler.h \
-    include/CoreUtilities/SaveRestoreSimulationPoint.h
+    include/CoreUtilities/SaveRestoreSimulationPoint.h \
+    include/CoreUtilities/LogDataSink.h \
+    include/CoreUtilities/SimulationStateBuffer.h
 
 #DO NOT remove the commented line below, it will be autoreplaced by script
 #INTERNALCOMPLIB_FMI4C_DEPENDENCY#
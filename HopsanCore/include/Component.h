@@ -41,6 +41,7 @@
 #include <map>
 #include <list>
 #include <algorithm>
+#include <typeinfo>
 
 namespace hopsan {
 
@@ -58,6 +59,7 @@ class ComponentSystem;
 class HopsanEssentials;
 class HopsanCoreMessageHandler;
 class NumericalIntegrationSolver;
+class SimulationStateBuffer;
 
 enum VariameterTypeEnumT {InputVariable, OutputVariable, OtherVariable};
 
@@ -89,6 +91,10 @@ class HOPSANCORE_DLLAPI Component
 public:
     //! @brief Enum type for all CQS types
     enum CQSEnumT {CType, QType, SType, UndefinedCQSType};
+    //! @brief Enum type for what happens to output variables on the steps where a multi-rate component is not simulated
+    enum RateBoundaryModeT {HoldOutputs, ExtrapolateOutputs};
+    //! @brief Function type used to simulate a batch of components of the same concrete type
+    typedef void (*SimulateBatchFunctionT)(Component* const* ppComponents, const size_t nComponents, const double stopT);
 
     //==========Public functions==========
     // Configuration and simulation functions
@@ -109,6 +115,12 @@ public:
     void setInheritTimestep(const bool inherit=true);
     bool doesInheritTimestep() const;
 
+    // Multi-rate functions
+    void setStepMultiple(const size_t multiple);
+    size_t getStepMultiple() const;
+    void setRateBoundaryMode(const RateBoundaryModeT mode);
+    RateBoundaryModeT getRateBoundaryMode() const;
+
     // Name and type
     void setName(HString name);
     const HString &getName() const;
@@ -125,6 +137,7 @@ public:
     virtual bool isComponentSignal() const;
     virtual bool isExperimental() const;
     virtual bool isObsolete() const;
+    virtual SimulateBatchFunctionT getSimulateBatchFunction() const;
 
     // Constants
     void addConstant(const HString &rName, const HString &rDescription, const HString &rUnit, double &rData);
@@ -235,6 +248,13 @@ public:
     virtual void getResiduals(double * /*y*/, double* /*res*/);
     virtual void getJacobian(double * /*y*/, double* /*f*/, double* /*J*/);
 
+    // Simulation state functions, used by simulation checkpoints
+    virtual void saveState(SimulationStateBuffer &rBuffer) const;
+    virtual bool restoreState(SimulationStateBuffer &rBuffer);
+
+    // Read-only data transfer, used when cloning systems
+    virtual void copyReadOnlyDataFrom(const Component *pSource);
+
 protected:
     //==========Protected member functions==========
     // Constructor - Destructor
@@ -248,6 +268,43 @@ protected:
     virtual void setTimestep(const double timestep);
     virtual size_t calcNumSimSteps(const double startT, const double stopT) const;
 
+    //! @brief Simulates a batch of components of the same concrete type from their current time to stopT
+    //! @details The call to simulateOneTimestep is resolved at compile time, so there is only one indirect call per batch.
+    //! Return a pointer to this function from getSimulateBatchFunction(), using getSimulateBatchFunctionIfExactType(), to enable type-batched simulation of a component type.
+    //! Component types that override simulate() or calcNumSimSteps() must not use it.
+    //! @tparam ComponentT The concrete component type, all components in the batch must be of exactly this type
+    //! @param [in] ppComponents Array of component pointers
+    //! @param [in] nComponents Number of components in the array
+    //! @param [in] stopT Stop time
+    template<typename ComponentT>
+    static void simulateBatch(Component* const* ppComponents, const size_t nComponents, const double stopT)
+    {
+        for (size_t c=0; c<nComponents; ++c)
+        {
+            Component *pComponent = ppComponents[c];
+            const size_t nSteps = pComponent->Component::calcNumSimSteps(pComponent->mTime, stopT);
+            for (size_t i=0; i<nSteps; ++i)
+            {
+                pComponent->mTime += pComponent->mTimestep;
+                static_cast<ComponentT*>(pComponent)->ComponentT::simulateOneTimestep();
+            }
+        }
+    }
+
+    //! @brief Returns &simulateBatch<ComponentT> if this component is exactly of type ComponentT, otherwise 0
+    //! @details Use this in getSimulateBatchFunction(), so that component types derived from a batched type, that inherit
+    //! getSimulateBatchFunction(), are not simulated as the base type but fall back to normal simulation
+    //! @tparam ComponentT The concrete component type that implements getSimulateBatchFunction()
+    template<typename ComponentT>
+    SimulateBatchFunctionT getSimulateBatchFunctionIfExactType() const
+    {
+        if (typeid(*this) == typeid(ComponentT))
+        {
+            return &Component::simulateBatch<ComponentT>;
+        }
+        return 0;
+    }
+
     // Interface variable functions
     Port *addInputVariable(const HString &rName, const HString &rDescription, const HString &rQuantityOrUnit, const double defaultValue, double **ppNodeData=0);
     Port *addOutputVariable(const HString &rName, const HString &rDescription, const HString &rQuantityOrUnit, double **ppNodeData=0);
@@ -277,6 +334,8 @@ protected:
     bool mInheritTimestep;
     double mTimestep, mDesiredTimestep;
     double mTime;
+    size_t mStepMultiple;
+    RateBoundaryModeT mRateBoundaryMode;
     size_t mModelHierarchyDepth; //!< This variable contains the depth of the system in the model hierarchy, (used by connect to figure out where to store nodes)
     std::vector<HString> mSearchPaths;
 
@@ -288,6 +347,8 @@ private:
     void setSystemParent(ComponentSystem *pComponentSystem);
     void setTypeName(const HString &rTypeName);
     double *getNodeDataPtr(Port* pPort, const int dataId);
+    void setupRateBoundaryOutputs();
+    void updateRateBoundaryOutputs(const double stopT, const bool tookStep);
 
     // Parameter registration
     void registerParameter(const HString &rName, const HString &rDescription, const HString &rQuantity, const HString &rUnit, double &rValue);
@@ -310,6 +371,12 @@ private:
     std::vector<VariameterDescription> mVariameters;
     std::map<Port*, double**> mAutoSignalNodeDataPtrPorts;
     bool mIsDisabled;
+
+    // Output extrapolation between the steps of multi-rate components
+    std::vector<double*> mRateBoundaryOutputPtrs;
+    std::vector<double> mRateBoundaryValues;
+    std::vector<double> mRateBoundarySlopes;
+    double mRateBoundaryTime;
 };
 
 
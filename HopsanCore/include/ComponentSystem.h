@@ -38,6 +38,7 @@
 #include <mutex>
 #include <chrono>
 #include <ctime>
+#include <cstdint>
 #endif
 
 #include "Component.h"
@@ -47,6 +48,9 @@
 namespace hopsan {
     class NumHopHelper;
     class ComponentSystemMultiThreadPrivates;
+    class ComponentSystemBatchPrivates;
+    class ComponentSystemLogDataPrivates;
+    class LogDataSink;
 
     class HOPSANCORE_DLLAPI ComponentSystem :public Component
     {
@@ -82,6 +86,9 @@ namespace hopsan {
         HString reserveUniqueName(const HString &rDesiredName, const UniqeNameEnumT type=UniqueReservedNameType);
         void unReserveUniqueName(const HString &rName);
 
+        // Cloning
+        ComponentSystem *clone();
+
         // System Parameter functions
         bool renameParameter(const HString &rOldName, const HString &rNewName);
         virtual std::list<HString> getModelAssets() const;
@@ -131,9 +138,17 @@ namespace hopsan {
         bool initialize(const double startT, const double stopT);
         void simulate(const double stopT);
         bool startRealtimeSimulation(double realTimeFactor=1);
-        virtual void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads = 0, const bool noChanges=false, ParallelAlgorithmT algorithm=APrioriScheduling);
+        virtual void simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads = 0, const bool noChanges=true, ParallelAlgorithmT algorithm=APrioriScheduling);
         void finalize();
 
+        // Type-batched simulation
+        void setUseTypeBatching(const bool useBatching=true);
+        bool doesUseTypeBatching() const;
+
+        // Node data arena
+        void setUseNodeDataArena(const bool useArena=true);
+        bool doesUseNodeDataArena() const;
+
         bool simulateAndMeasureTime(const size_t nSteps);
         double getTotalMeasuredTime();
         void sortComponentVectorsByMeasuredTime();
@@ -141,6 +156,8 @@ namespace hopsan {
         void distributeQcomponents(std::vector< std::vector<Component*> > &rSplitQVector, size_t nThreads);
         void distributeSignalcomponents(std::vector< std::vector<Component*> > &rSplitSignalVector, size_t nThreads);
         void distributeNodePointers(std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
+        void distributeComponentsByConnectivity(std::vector< std::vector<Component*> > &rSplitCVector, std::vector< std::vector<Component*> > &rSplitQVector,
+                                                std::vector< std::vector<Node*> > &rSplitNodeVector, size_t nThreads);
         void reschedule(size_t nThreads);
 
         // Set and get desired timestep
@@ -149,8 +166,15 @@ namespace hopsan {
         bool doesInheritTimestep() const;
         double getDesiredTimeStep() const;
 
+        // Set and get random seed, used by components with random number generators
+        void setRandomSeed(const uint64_t seed);
+        uint64_t getRandomSeed() const;
+        void setInheritRandomSeed(const bool inherit=true);
+        bool doesInheritRandomSeed() const;
+
         // Log functions
         void logTimeAndNodes(const size_t simStep);
+        void relogStartValues();
         void enableLog();
         void disableLog();
         std::vector<double>* getLogTimeVector();
@@ -159,6 +183,13 @@ namespace hopsan {
         void setLogStartTime(const double logStartTime);
         size_t getNumLogSamples() const;
         size_t getNumActuallyLoggedSamples() const;
+        void setLogDecimationMode(const LogDecimationModeT mode);
+        LogDecimationModeT getLogDecimationMode() const;
+        void setLogDataSink(LogDataSink *pSink);
+        LogDataSink *getLogDataSink() const;
+        size_t getNumStreamedLogSamples() const;
+        bool tryLockLogData();
+        void unlockLogData();
 
         // Stop a running initialization or simulation
         void stopSimulation(const HString &rReason);
@@ -206,6 +237,10 @@ namespace hopsan {
 //        void setLogSettingsSkipFactor(double factor, double start, double stop, double sampletime);
         void setupLogSlotsAndTs(const double simStartT, const double simStopT, const double simTs);
         void preAllocateLogSpace();
+        void setupLogDataStream();
+        void streamLogData();
+        void setLogDataStreamPaused(const bool paused);
+        void publishNumLoggedSamples();
 
         // Add and Remove subcomponent ptrs from storage vectors
         void addSubComponentPtrToStorage(Component* pComponent);
@@ -214,7 +249,21 @@ namespace hopsan {
         // Clear all contents of the system (use in destructor)
         void clear();
 
+        // Copy settings, contents and connections into an empty system
+        bool cloneContentsInto(ComponentSystem *pTarget);
+        void cloneParametersInto(ComponentSystem *pTarget);
+
         bool sortComponentVector(std::vector<Component*> &rOldSignalVector);
+        void getSortDependencies(Component *pComponent, const std::vector<Component*> &rComponentVector, std::vector<Component*> &rRequiredComponents);
+
+        // Type-batched simulation
+        void setupTypeBatches();
+
+        // Node data arena
+        void setupNodeDataArena();
+        void releaseNodeDataArena();
+        void setupPartitionNodeData(const size_t threadID);
+        void releasePartitionNodeData();
 
         // UniqueName specific functions
         HString determineUniquePortName(const HString &rPortname);
@@ -258,13 +307,30 @@ namespace hopsan {
 
         bool mKeepValuesAsStartValues;
 
+        uint64_t mRandomSeed;
+        bool mInheritRandomSeed;
+
+        bool mUseTypeBatching;
+        ComponentSystemBatchPrivates *mpBatchPrivates;
+
+        bool mUseNodeDataArena;
+        std::vector<double> mNodeDataArena;
+        std::vector<Node*> mNodeDataArenaNodePtrs;
+
         AliasHandler mAliasHandler;
 
         // Log related variables
         size_t mRequestedNumLogSamples, mnLogSlots, mLogCtr;
         double mRequestedLogStartTime, mLogTimeDt;
         bool mEnableLogData;
+        LogDecimationModeT mLogDecimationMode;
+        std::vector<Node*> mLoggedNodePtrs;
         std::vector<double> mTimeStorage;
+        LogDataSink *mpLogDataSink;
+        std::vector<const std::vector<double>*> mLogStreamColumnPtrs;
+        size_t mLogStreamId, mnStreamedLogSamples;
+        bool mLogDataStreamPaused;
+        ComponentSystemLogDataPrivates *mpLogDataPrivates;
     };
 
 
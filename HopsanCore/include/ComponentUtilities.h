@@ -43,9 +43,11 @@
 #include "ComponentUtilities/PLOParser.h"
 #include "ComponentUtilities/AuxiliarySimulationFunctions.h"
 #include "ComponentUtilities/AuxiliaryMathematicaWrapperFunctions.h"
+#include "ComponentUtilities/RandomNumberGenerator.h"
 #include "ComponentUtilities/WhiteGaussianNoise.h"
 #include "ComponentUtilities/num2string.hpp"
 #include "ComponentUtilities/EquationSystemSolver.h"
 #include "ComponentUtilities/LookupTable.h"
+#include "ComponentUtilities/SharedLookupTable.h"
 #include "ComponentUtilities/TempDirectoryHandle.h"
 #endif // COMPONENTUTILITIES_H_INCLUDED
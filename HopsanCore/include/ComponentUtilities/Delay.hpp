@@ -35,6 +35,7 @@
 #define DELAY_HPP_INCLUDED
 
 #include "stddef.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 namespace hopsan {
 
@@ -48,6 +49,8 @@ public:
     {
         mpArray = 0;
         mSize = 0;
+        mNewest = 0;
+        mOldest = 0;
     }
 
     ~DelayTemplate()
@@ -172,6 +175,52 @@ public:
         return mSize;
     }
 
+    //! @brief Save the buffer contents to a simulation state buffer
+    //! @param [in,out] rBuffer The state buffer to write to
+    void saveState(SimulationStateBuffer &rBuffer) const
+    {
+        rBuffer.write(mSize);
+        rBuffer.write(mNewest);
+        rBuffer.write(mOldest);
+        for (size_t i=0; i<mSize; ++i)
+        {
+            rBuffer.write(mpArray[i]);
+        }
+    }
+
+    //! @brief Restore the buffer contents from a simulation state buffer
+    //! @details The buffer is reallocated if the saved size differs from the current size
+    //! @param [in,out] rBuffer The state buffer to read from
+    //! @returns True if successful
+    bool restoreState(SimulationStateBuffer &rBuffer)
+    {
+        size_t size, newest, oldest;
+        if (!rBuffer.read(size) || !rBuffer.read(newest) || !rBuffer.read(oldest))
+        {
+            return false;
+        }
+        if (size == 0)
+        {
+            clear();
+            return true;
+        }
+        if ((newest >= size) || (oldest >= size))
+        {
+            return false;
+        }
+        if (size != mSize)
+        {
+            initialize(int(size), T());
+        }
+        for (size_t i=0; i<mSize; ++i)
+        {
+            rBuffer.read(mpArray[i]);
+        }
+        mNewest = newest;
+        mOldest = oldest;
+        return !rBuffer.hasFailed();
+    }
+
     //! @brief Clear the delay buffer, deleting all data
     void clear()
     {
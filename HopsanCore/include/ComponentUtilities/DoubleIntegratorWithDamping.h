@@ -38,6 +38,8 @@
 
 namespace hopsan {
 
+    class SimulationStateBuffer;
+
     //! @ingroup ComponentUtilityClasses
     class HOPSANCORE_DLLAPI DoubleIntegratorWithDamping
     {
@@ -50,6 +52,8 @@ namespace hopsan {
         void redoIntegrate(double u);
         double valueFirst();
         double valueSecond();
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     private:
         double mDelayU, mDelayY, mDelaySY;
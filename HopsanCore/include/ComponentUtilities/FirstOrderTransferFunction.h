@@ -57,6 +57,8 @@ namespace hopsan {
         double delayedU() const;
         double delayedY() const;
         bool isSaturated() const;
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     protected:
         double mValue;
@@ -89,6 +91,8 @@ namespace hopsan {
         void recalculateCoefficients();
         double update(double u);
         double value();
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     private:
         double mValue;
@@ -74,6 +74,22 @@ public:
         return mDelayY;
     }
 
+    //! @brief Save the integrator state to a simulation state buffer
+    //! @param[in,out] rBuffer The state buffer to write to
+    void saveState(SimulationStateBuffer &rBuffer) const
+    {
+        rBuffer.write(mDelayU);
+        rBuffer.write(mDelayY);
+    }
+
+    //! @brief Restore the integrator state from a simulation state buffer
+    //! @param[in,out] rBuffer The state buffer to read from
+    //! @returns True if successful
+    bool restoreState(SimulationStateBuffer &rBuffer)
+    {
+        return rBuffer.read(mDelayU) && rBuffer.read(mDelayY);
+    }
+
 protected:
     double mDelayU, mDelayY;
     double mTimeStep;
@@ -129,6 +145,23 @@ public:
         return update(u);
     }
 
+    //! @brief Save the integrator state and backup buffer to a simulation state buffer
+    //! @param[in,out] rBuffer The state buffer to write to
+    void saveState(SimulationStateBuffer &rBuffer) const
+    {
+        Integrator::saveState(rBuffer);
+        mBackupU.saveState(rBuffer);
+        mBackupY.saveState(rBuffer);
+    }
+
+    //! @brief Restore the integrator state and backup buffer from a simulation state buffer
+    //! @param[in,out] rBuffer The state buffer to read from
+    //! @returns True if successful
+    bool restoreState(SimulationStateBuffer &rBuffer)
+    {
+        return Integrator::restoreState(rBuffer) && mBackupU.restoreState(rBuffer) && mBackupY.restoreState(rBuffer);
+    }
+
 protected:
     Delay mBackupU, mBackupY;
 
@@ -48,6 +48,8 @@ namespace hopsan {
         void setMinMax(double min, double max);
         double update(double u);
 	double value();
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     private:
         double mDelayU, mDelayY;
@@ -36,12 +36,37 @@
 
 #include <vector>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 inline double interp1(const double x, const double i1, const double i2, const double v1, const double v2)
 {
     return v1 + (x-i1)*(v2-v1)/(i2-i1);
 }
 
+//! @brief Remembers the intervals found in the previous lookup in a table, the next search starts from there
+//! @details The cursor is owned by the caller, so a table can be shared between components and threads as long as each
+//! of them uses its own cursor. Any cursor can be used with any table, an outdated cursor only makes the search slower.
+class LookupTableCursor
+{
+public:
+    LookupTableCursor()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (size_t d=0; d<MaxNumDims; ++d)
+        {
+            mIndex[d] = 0;
+        }
+    }
+
+    static const size_t MaxNumDims = 3;
+    size_t mIndex[MaxNumDims];
+};
+
 class LookupTableNDBase
 {
 
@@ -61,6 +86,7 @@ public:
         mNumSubDimDataElements.clear(); mNumSubDimDataElements.resize(mNumDims, 0);
         mIndexIncreasingOrDecreasing.clear(); mIndexIncreasingOrDecreasing.resize(mNumDims, Unknown);
         resetFirstLast();
+        resetSearchCache();
     }
 
     bool isEmpty() const
@@ -124,6 +150,12 @@ public:
 
                 isStrictlyInc = isStrictlyInc && (mIndexIncreasingOrDecreasing[d] == StrictlyIncreasing);
             }
+
+            resetSearchCache();
+            if (isStrictlyInc)
+            {
+                calcUniformIndexSteps();
+            }
             return isStrictlyInc;
         }
         else
@@ -322,13 +354,113 @@ public:
         return mIndexData[dim].size();
     }
 
+    //! @brief Check if the index data along a dimension is uniformly spaced
+    //! @note The result is only valid after isDataOK() has been called
+    bool isIndexUniform(const size_t dim) const
+    {
+        return (mUniformInvStep[dim] > 0);
+    }
+
+    //! @brief Find the index of the interval in which x is located along a dimension
+    //! @details For uniformly spaced index data the interval is calculated directly, otherwise bisection is used.
     //! @note Assumes that x is within index range
     size_t findIndexAlongDim(const size_t dim, const double x) const
     {
+        if (mUniformInvStep[dim] > 0)
+        {
+            return findUniformIndexAlongDim(dim, x);
+        }
         return intervalHalfSubDiv(x, 0, mIndexData[dim].size()-1, dim);
     }
 
+    //! @brief Find the index of the interval in which x is located along a dimension, starting from the interval in a cursor
+    //! @details For uniformly spaced index data the interval is calculated directly, otherwise the search starts from
+    //! the interval found in the previous lookup with the same cursor (hunt search), since inputs usually change smoothly
+    //! between time steps. The returned interval is the same as a bisection search would return.
+    //! @note Assumes that x is within index range
+    //! @param [in] dim The dimension, must be less than LookupTableCursor::MaxNumDims
+    //! @param [in] x The value to find the interval for
+    //! @param [in,out] rCursor The interval found in the previous lookup, it is updated with the found interval
+    size_t findIndexAlongDim(const size_t dim, const double x, LookupTableCursor &rCursor) const
+    {
+        if (mUniformInvStep[dim] > 0)
+        {
+            return findUniformIndexAlongDim(dim, x);
+        }
+
+        // Try the previous interval and its closest neighbors before falling back to bisection
+        const size_t lastIdx = mIndexData[dim].size()-2;
+        size_t idx = rCursor.mIndex[dim];
+        if (idx <= lastIdx)
+        {
+            if (isInInterval(dim, idx, x))
+            {
+                return idx;
+            }
+            else if ((idx < lastIdx) && isInInterval(dim, idx+1, x))
+            {
+                rCursor.mIndex[dim] = idx+1;
+                return idx+1;
+            }
+            else if ((idx > 0) && isInInterval(dim, idx-1, x))
+            {
+                rCursor.mIndex[dim] = idx-1;
+                return idx-1;
+            }
+        }
+        idx = intervalHalfSubDiv(x, 0, mIndexData[dim].size()-1, dim);
+        rCursor.mIndex[dim] = idx;
+        return idx;
+    }
+
 protected:
+    //! @brief Calculate the interval directly for uniformly spaced index data, then correct for round-off errors and for x on a breakpoint
+    size_t findUniformIndexAlongDim(const size_t dim, const double x) const
+    {
+        const std::vector<double> &rIndexData = mIndexData[dim];
+        const size_t lastIdx = rIndexData.size()-2;
+        const double t = (x-mIndexFirst[dim])*mUniformInvStep[dim];
+        size_t idx = (t > 0) ? std::min(size_t(t), lastIdx) : 0;
+        while ((idx > 0) && (x <= rIndexData[idx]))
+        {
+            --idx;
+        }
+        while ((idx < lastIdx) && (x > rIndexData[idx+1]))
+        {
+            ++idx;
+        }
+        return idx;
+    }
+
+    //! @brief Check if x is located in interval idx, using the same convention as intervalHalfSubDiv (x on a breakpoint belongs to the lower interval)
+    inline bool isInInterval(const size_t dim, const size_t idx, const double x) const
+    {
+        return ((idx == 0) || (x > mIndexData[dim][idx])) && (x <= mIndexData[dim][idx+1]);
+    }
+
+    void resetSearchCache()
+    {
+        mUniformInvStep.clear(); mUniformInvStep.resize(mNumDims, 0);
+    }
+
+    //! @brief Detect uniformly spaced index data, so that the interval can be calculated instead of searched for
+    void calcUniformIndexSteps()
+    {
+        for (size_t d=0; d<mNumDims; ++d)
+        {
+            const std::vector<double> &rIndexData = mIndexData[d];
+            const size_t n = rIndexData.size();
+            const double step = (rIndexData[n-1]-rIndexData[0])/double(n-1);
+            const double tol = 1e-9*step;
+            bool isUniform = (step > 0);
+            for (size_t i=1; isUniform && (i<n); ++i)
+            {
+                isUniform = (std::fabs(rIndexData[i]-rIndexData[i-1]-step) <= tol);
+            }
+            mUniformInvStep[d] = isUniform ? 1.0/step : 0;
+        }
+    }
+
     size_t intervalHalfSubDiv(const double x, const size_t i1, const size_t iend, const size_t dim) const
     {
         if (iend-i1 <= 1)
@@ -496,6 +628,7 @@ protected:
     std::vector<double> mIndexFirst;
     std::vector<double> mIndexLast;
     std::vector<IncreasingEnumT> mIndexIncreasingOrDecreasing;
+    std::vector<double> mUniformInvStep;
 
     std::vector< std::vector<double> > mIndexData;
     std::vector<double> mValueData;
@@ -529,13 +662,72 @@ public:
             return mValueData[mValueData.size()-1];
         }
         // Handle in range
+        return interpolateInInterval(x, findIndexAlongDim(0, x));
+    }
+
+    //! @brief Interpolate, starting the search from the interval found in the previous lookup with the same cursor
+    //! @details Gives the same result as interpolate(x), but is faster for smoothly changing inputs on non-uniform index data
+    double interpolate(const double x, LookupTableCursor &rCursor) const
+    {
+        if( x<mIndexFirst[0] )
+        {
+            return mValueData[0];
+        }
+        else if( x>=mIndexLast[0] )
         {
-            const std::vector<double> &rIndexData = mIndexData[0];
-            const size_t idx = findIndexAlongDim(0, x);
+            return mValueData[mValueData.size()-1];
+        }
+        return interpolateInInterval(x, findIndexAlongDim(0, x, rCursor));
+    }
 
-            // Note, assumes that index data is strictly increasing (two values can not be the same). That will lead to division by zero here
-            return mValueData[idx] + (x - rIndexData[idx])*(mValueData[idx+1] -  mValueData[idx])/(rIndexData[idx+1] -  rIndexData[idx]);
+    //! @brief Interpolate a batch of values
+    //! @details Gives the same result as calling interpolate(x) for each value. For uniformly spaced index data the loop
+    //! does not search or branch on the data, so that the compiler can vectorize it. Otherwise the hunt search is used,
+    //! which is fast when the values are sorted, such as a time series.
+    //! @param [in] pX Pointer to the values to interpolate at
+    //! @param [out] pOut Pointer to the output array, must have room for n values
+    //! @param [in] n The number of values
+    void interpolate(const double *pX, double *pOut, const size_t n) const
+    {
+        const double *pIndex = &mIndexData[0][0];
+        const double *pValue = &mValueData[0];
+        const double first = mIndexFirst[0];
+        const double last = mIndexLast[0];
+        const double firstValue = pValue[0];
+        const double lastValue = pValue[mValueData.size()-1];
+
+        if (isIndexUniform(0))
+        {
+            const double invStep = mUniformInvStep[0];
+            const size_t lastIdx = mIndexData[0].size()-2;
+            for (size_t i=0; i<n; ++i)
+            {
+                const double x = std::min(std::max(pX[i], first), last);
+                const double t = (x-first)*invStep;
+                size_t idx = (t > 0) ? std::min(size_t(t), lastIdx) : 0;
+                // Correct for round-off errors and for x on a breakpoint, at most one step is needed for uniform data
+                idx -= size_t((idx > 0) && (x <= pIndex[idx]));
+                idx += size_t((idx < lastIdx) && (x > pIndex[idx+1]));
+                const double y = pValue[idx] + (x - pIndex[idx])*(pValue[idx+1] - pValue[idx])/(pIndex[idx+1] - pIndex[idx]);
+                pOut[i] = (pX[i] < first) ? firstValue : ((pX[i] >= last) ? lastValue : y);
+            }
         }
+        else
+        {
+            LookupTableCursor cursor;
+            for (size_t i=0; i<n; ++i)
+            {
+                pOut[i] = interpolate(pX[i], cursor);
+            }
+        }
+    }
+
+private:
+    inline double interpolateInInterval(const double x, const size_t idx) const
+    {
+        const std::vector<double> &rIndexData = mIndexData[0];
+        // Note, assumes that index data is strictly increasing (two values can not be the same). That will lead to division by zero here
+        return mValueData[idx] + (x - rIndexData[idx])*(mValueData[idx+1] -  mValueData[idx])/(rIndexData[idx+1] -  rIndexData[idx]);
     }
 };
 
@@ -556,9 +748,38 @@ public:
         r = limitToRange(0, r);
         c = limitToRange(1, c);
 
-        const size_t tl_r = findIndexAlongDim(0, r);
+        return interpolateInCell(r, c, findIndexAlongDim(0, r), findIndexAlongDim(1, c));
+    }
+
+    //! @brief Interpolate, starting the search from the intervals found in the previous lookup with the same cursor
+    double interpolate(double r, double c, LookupTableCursor &rCursor) const
+    {
+        r = limitToRange(0, r);
+        c = limitToRange(1, c);
+
+        return interpolateInCell(r, c, findIndexAlongDim(0, r, rCursor), findIndexAlongDim(1, c, rCursor));
+    }
+
+    //! @brief Interpolate a batch of points
+    //! @details Gives the same result as calling interpolate(r, c) for each point, the search for each point starts from
+    //! the intervals of the previous point, which is fast when the points change smoothly
+    //! @param [in] pR Pointer to the row index values
+    //! @param [in] pC Pointer to the column index values
+    //! @param [out] pOut Pointer to the output array, must have room for n values
+    //! @param [in] n The number of points
+    void interpolate(const double *pR, const double *pC, double *pOut, const size_t n) const
+    {
+        LookupTableCursor cursor;
+        for (size_t i=0; i<n; ++i)
+        {
+            pOut[i] = interpolate(pR[i], pC[i], cursor);
+        }
+    }
+
+private:
+    double interpolateInCell(const double r, const double c, const size_t tl_r, const size_t tl_c) const
+    {
         const size_t tr_r = tl_r;
-        const size_t tl_c = findIndexAlongDim(1, c);
         const size_t bl_c = tl_c;
 
         const size_t tr_c = tl_c+1;
@@ -597,12 +818,40 @@ public:
         c = limitToRange(1, c);
         p = limitToRange(2, p);
 
-        // Find planes, lower an higher
-        const size_t pl = findIndexAlongDim(2, p);
+        return interpolateInCell(r, c, p, findIndexAlongDim(0, r), findIndexAlongDim(1, c), findIndexAlongDim(2, p));
+    }
 
-        // Now do 2d interpolation in each plane
-        const size_t tl_r = findIndexAlongDim(0, r);
-        const size_t tl_c = findIndexAlongDim(1, c);
+    //! @brief Interpolate, starting the search from the intervals found in the previous lookup with the same cursor
+    double interpolate(double r, double c, double p, LookupTableCursor &rCursor) const
+    {
+        r = limitToRange(0, r);
+        c = limitToRange(1, c);
+        p = limitToRange(2, p);
+
+        return interpolateInCell(r, c, p, findIndexAlongDim(0, r, rCursor), findIndexAlongDim(1, c, rCursor), findIndexAlongDim(2, p, rCursor));
+    }
+
+    //! @brief Interpolate a batch of points
+    //! @details Gives the same result as calling interpolate(r, c, p) for each point, the search for each point starts from
+    //! the intervals of the previous point, which is fast when the points change smoothly
+    //! @param [in] pR Pointer to the row index values
+    //! @param [in] pC Pointer to the column index values
+    //! @param [in] pP Pointer to the plane index values
+    //! @param [out] pOut Pointer to the output array, must have room for n values
+    //! @param [in] n The number of points
+    void interpolate(const double *pR, const double *pC, const double *pP, double *pOut, const size_t n) const
+    {
+        LookupTableCursor cursor;
+        for (size_t i=0; i<n; ++i)
+        {
+            pOut[i] = interpolate(pR[i], pC[i], pP[i], cursor);
+        }
+    }
+
+private:
+    double interpolateInCell(const double r, const double c, const double p, const size_t tl_r, const size_t tl_c, const size_t pl) const
+    {
+        // Do 2d interpolation in the lower and higher planes
         const double vpl = interp2d(tl_r, tl_c, pl, r, c);
         const double vph = interp2d(tl_r, tl_c, pl+1, r, c);
 
@@ -610,7 +859,6 @@ public:
         return interp1(p, mIndexData[2][pl], mIndexData[2][pl+1], vpl, vph);
     }
 
-private:
     double interp2d(const size_t tl_r, const size_t tl_c, const size_t plane, const double r, const double c) const
     {
         const size_t tr_r = tl_r;
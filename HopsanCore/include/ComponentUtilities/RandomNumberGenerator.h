@@ -0,0 +1,87 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   RandomNumberGenerator.h
+//!
+//! @brief Contains a counter-based random number generator for use in components
+//!
+//$Id$
+
+#ifndef RANDOMNUMBERGENERATOR_H_INCLUDED
+#define RANDOMNUMBERGENERATOR_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+
+namespace hopsan {
+
+    class Component;
+    class SimulationStateBuffer;
+
+    //! @ingroup ComponentUtilityClasses
+    //! @brief Counter-based (Philox4x32-10) random number generator
+    //! @details Value number n only depends on the seed and n, so each component can have its own reproducible stream
+    //! that does not depend on the order in which components are simulated. Use the fill functions to generate many values at once.
+    class HOPSANCORE_DLLAPI RandomNumberGenerator
+    {
+    public:
+        RandomNumberGenerator(const uint64_t seed=0);
+
+        void setSeed(const uint64_t seed);
+        void setSeed(const Component *pComponent);
+        uint64_t getSeed() const;
+
+        double uniform();
+        double gaussian();
+        void fillUniform(double *pData, const size_t n);
+        void fillGaussian(double *pData, const size_t n);
+
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
+
+        static uint64_t deriveSeed(const uint64_t seed, const HString &rName);
+        static uint64_t getComponentSeed(const Component *pComponent);
+
+    private:
+        enum {BufferSize=64};
+        enum BufferContentT {EmptyBuffer, UniformBuffer, GaussianBuffer};
+
+        void generateUniform(const uint64_t firstBlock, double *pData, const size_t n) const;
+        void generateGaussian(const uint64_t firstBlock, double *pData, const size_t n) const;
+        void refillBuffer(const BufferContentT content);
+
+        uint64_t mSeed;
+        uint32_t mKey[2];
+        uint64_t mNextBlock;
+        uint64_t mBufferBlock;
+        size_t mBufferPos;
+        BufferContentT mBufferContent;
+        double mBuffer[BufferSize];
+    };
+}
+
+#endif // RANDOMNUMBERGENERATOR_H_INCLUDED
@@ -59,6 +59,8 @@ namespace hopsan {
         double delayedY() const;
         double delayed2Y() const;
         bool isSaturated() const;
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     private:
         double mValue;
@@ -83,6 +85,8 @@ namespace hopsan {
         double update(double u);
         double value();
         void recalculateCoefficients();
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
 
     private:
         double mValue;
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SharedLookupTable.h
+//!
+//! @brief Contains a lookup table holder that lets cloned components share one parsed table
+//!
+//$Id$
+
+#ifndef SHAREDLOOKUPTABLE_H
+#define SHAREDLOOKUPTABLE_H
+
+#include <memory>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+
+namespace hopsan {
+
+//! @brief Identifies what a lookup table was parsed from, the file (with its modification time and size) or text, and the parse settings
+class HOPSANCORE_DLLAPI LookupTableSource
+{
+public:
+    LookupTableSource();
+    static LookupTableSource fromFile(const HString &rFilePath, const HString &rSettings);
+    static LookupTableSource fromText(const HString &rText, const HString &rSettings);
+
+    bool isValid() const;
+    bool operator==(const LookupTableSource &rOther) const;
+
+private:
+    HString mFilePathOrText;
+    HString mSettings;
+    bool mIsFile;
+    long long mModificationTime;
+    long long mFileSize;
+};
+
+//! @brief Holds a parsed lookup table and the source it was parsed from
+//! @details Components share one instance with their clones (through copyReadOnlyDataFrom), so that a table is only parsed once
+//! as long as the source file has not been changed. The table itself is never modified after it has been stored.
+template<typename TableT>
+class SharedLookupTable
+{
+public:
+    //! @brief Returns the most recently stored table, regardless of its source (or null if none)
+    std::shared_ptr<const TableT> get() const
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        std::lock_guard<std::mutex> lock(mMutex);
+#endif
+        return mpTable;
+    }
+
+    //! @brief Returns the stored table if it was parsed from the given source, otherwise null
+    std::shared_ptr<const TableT> find(const LookupTableSource &rSource) const
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        std::lock_guard<std::mutex> lock(mMutex);
+#endif
+        if (mpTable && rSource.isValid() && (mSource == rSource))
+        {
+            return mpTable;
+        }
+        return std::shared_ptr<const TableT>();
+    }
+
+    //! @brief Stores a newly parsed table, replacing the previous one
+    void store(const LookupTableSource &rSource, const std::shared_ptr<const TableT> &rpTable)
+    {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+        std::lock_guard<std::mutex> lock(mMutex);
+#endif
+        mSource = rSource;
+        mpTable = rpTable;
+    }
+
+private:
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mutable std::mutex mMutex;
+#endif
+    LookupTableSource mSource;
+    std::shared_ptr<const TableT> mpTable;
+};
+
+}
+
+#endif // SHAREDLOOKUPTABLE_H
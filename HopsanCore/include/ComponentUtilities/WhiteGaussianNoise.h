@@ -35,14 +35,29 @@
 #define WHITEGAUSSIANNOISE_H_INCLUDED
 
 #include "win32dll.h"
+#include "ComponentUtilities/RandomNumberGenerator.h"
 
 namespace hopsan {
 
     //! @ingroup ComponentUtilityClasses
+    //! @brief White Gaussian noise with mean 0 and standard deviation 1
+    //! @details Use setSeed() in initialize and nextValue() to get a reproducible noise stream for the component.
+    //! The static getValue() uses a shared stream per thread, and the values then depend on simulation order.
     class HOPSANCORE_DLLAPI WhiteGaussianNoise
     {
     public:
         static double getValue();
+
+        void setSeed(const uint64_t seed);
+        void setSeed(const Component *pComponent);
+        double nextValue();
+        void fillValues(double *pData, const size_t n);
+
+        void saveState(SimulationStateBuffer &rBuffer) const;
+        bool restoreState(SimulationStateBuffer &rBuffer);
+
+    private:
+        RandomNumberGenerator mGenerator;
     };
 }
 
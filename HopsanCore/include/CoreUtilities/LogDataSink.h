@@ -0,0 +1,143 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogDataSink.h
+//!
+//! @brief Contains the log data sink classes used to stream log data to file during simulation
+//!
+//$Id$
+
+#ifndef LOGDATASINK_H
+#define LOGDATASINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "win32dll.h"
+#include "HopsanTypes.h"
+
+namespace hopsan {
+
+//! @brief Describes one variable in a log data stream
+class LogSinkVariable
+{
+public:
+    HString componentName;
+    HString portName;
+    HString variableName;
+    HString alias;
+    HString unit;
+    HString quantity;
+};
+
+//! @brief One chunk of log data from a stream
+//! @details The data contains nSamples time values followed by nSamples values for each variable in the stream
+class LogDataChunk
+{
+public:
+    size_t streamId;
+    size_t nSamples;
+    std::vector<double> data;
+};
+
+class LogDataSinkPrivates;
+
+//! @brief Base class for log data sinks, that write log data to file in chunks while the simulation is running
+//! @details Each logging system registers one stream and submits its log data in fixed size chunks. The chunks are written
+//! by a background writer thread (if multi-threading is available), so that memory use is bounded by the chunk size and the
+//! number of queued chunks instead of the length of the simulation. If the writer falls behind, submit blocks until a chunk has been written.
+//! Sub classes implement the actual file format.
+class HOPSANCORE_DLLAPI LogDataSink
+{
+public:
+    LogDataSink();
+    virtual ~LogDataSink();
+
+    void setChunkSize(const size_t nSamples);
+    size_t getChunkSize() const;
+    void setMaxQueuedChunks(const size_t nChunks);
+
+    size_t registerStream(const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables);
+    LogDataChunk *acquireChunk();
+    void submitChunk(LogDataChunk *pChunk);
+    bool finish();
+
+    bool hasFailed() const;
+    HString getLastError() const;
+
+protected:
+    //! @brief Open a new stream in the output file
+    //! @param [in] streamId The id of the stream, streams are numbered from 0 in registration order
+    //! @param [in] rSystemHierarchy The subsystem hierarchy, separated by ".", empty for the top-level system
+    //! @param [in] rVariables The variables in the stream, in the same order as in the chunks
+    //! @returns True if successful
+    virtual bool openStream(const size_t streamId, const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables) = 0;
+
+    //! @brief Write one chunk of log data to the output file
+    //! @param [in] rChunk The chunk to write
+    //! @returns True if successful
+    virtual bool writeChunk(const LogDataChunk &rChunk) = 0;
+
+    //! @brief Close the output file
+    //! @returns True if successful
+    virtual bool close() = 0;
+
+    void setLastError(const HString &rError);
+
+private:
+    void processRequests();
+    LogDataSinkPrivates *mpPrivates;
+};
+
+//! @brief Log data sink that writes an append-only binary file
+//! @details The file starts with the 8 byte identifier "HOPSLOG1", followed by records in native byte order.
+//! A record starts with an uint32 record type. A stream record (type 1) contains the uint64 stream id, the system hierarchy string,
+//! the uint64 number of variables and for each variable the component, port, variable, alias, unit and quantity strings.
+//! Strings are stored as an uint32 length followed by the characters. A chunk record (type 2) contains the uint64 stream id,
+//! the uint64 number of samples, the time values and then the values for each variable in stream order, as doubles.
+class HOPSANCORE_DLLAPI BinaryLogDataSink : public LogDataSink
+{
+public:
+    BinaryLogDataSink(const HString &rFilePath);
+    ~BinaryLogDataSink();
+
+protected:
+    bool openStream(const size_t streamId, const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables);
+    bool writeChunk(const LogDataChunk &rChunk);
+    bool close();
+
+private:
+    bool openFile();
+    bool writeString(const HString &rString);
+    template<typename T> bool writeValue(const T value);
+
+    HString mFilePath;
+    FILE *mpFile;
+    bool mHaveCreatedFile;
+};
+
+}
+
+#endif // LOGDATASINK_H
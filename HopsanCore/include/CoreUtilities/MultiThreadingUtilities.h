@@ -53,6 +53,9 @@ size_t HOPSANCORE_DLLAPI determineActualNumberOfThreads(const size_t nDesiredThr
 
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 
 namespace hopsan {
 
@@ -62,38 +65,66 @@ class ComponentSystem;
 class Node;
 
 //! @brief Class for barrier locks in multi-threaded simulations.
+//! @details The master thread waits until all other threads have arrived, locks the next barrier and then unlocks this one.
+//! Waiting threads first spin for a limited number of iterations and then park (futex on Linux, condition variable elsewhere),
+//! so that no cores are burned when there are more threads than free cores.
 class BarrierLock
 {
 public:
     //! @brief Constructor.
     //! @note Number of threads must be correct! Wrong value will result in either deadlocks or threads or non-synchronized threads.
     //! @param nThreads Number of threads to by synchronized.
-    BarrierLock(size_t nThreads)
+    //! @param nSpins Number of spin iterations before a waiting thread parks
+    BarrierLock(size_t nThreads, size_t nSpins=DefaultSpinCount)
     {
-        mnThreads=nThreads;
+        mnThreads=int(nThreads);
+        mnSpins=nSpins;
         mCounter = 0;
-        mLock = true;
+        mLock = 1;
+        mnParked = 0;
+        mMasterParked = 0;
     }
 
     //! @brief Locks the barrier.
-    inline void lock() { mCounter=0; mLock=true; }
+    inline void lock() { mCounter=0; mLock=1; }
 
-    //! @brief Unlocks the barrier.
-    inline void unlock() { mLock=false; }
+    //! @brief Unlocks the barrier, and wakes any parked threads.
+    void unlock();
 
     //! @brief Returns whether or not the barrier is locked.
-    inline bool isLocked() { return mLock; }
+    inline bool isLocked() { return (mLock != 0); }
 
-    //! @brief Increments barrier counter by one.
-    inline void increment() { ++mCounter; }
+    //! @brief Increments barrier counter by one, and wakes the master thread if it is parked and this was the last thread.
+    void increment();
 
     //! @brief Returns whether or not all threads have incremented the barrier.
     inline bool allArrived() { return (mCounter == (mnThreads-1)); }      //One less due to master thread
 
+    //! @brief Increments the barrier counter and waits until the master thread unlocks the barrier (used by slave threads).
+    void arriveAndWait();
+
+    //! @brief Waits until all other threads have arrived (used by the master thread).
+    //! @param pSystem The system to check for aborted simulation while waiting
+    //! @returns False if the simulation was aborted while waiting, else true
+    bool waitForAllArrived(const ComponentSystem *pSystem);
+
+    //! @brief The default number of spin iterations before a waiting thread parks
+    static const size_t DefaultSpinCount = 4000;
+
 private:
+    void park(std::atomic<int> *pWord, const int value);
+    void wake(std::atomic<int> *pWord);
+
     int mnThreads;
+    size_t mnSpins;
     std::atomic<int> mCounter;
-    std::atomic<bool> mLock;
+    std::atomic<int> mLock;
+    std::atomic<int> mnParked;
+    std::atomic<int> mMasterParked;
+#if !defined(__linux__)
+    std::mutex mParkMutex;
+    std::condition_variable mParkCondition;
+#endif
 };
 
 
@@ -186,143 +217,199 @@ HOPSANCORE_DLLAPI void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ,
 /////////////////////////////
 
 
-class ThreadSafeVector
+//! @brief Lock-free work-stealing deque (Chase-Lev) with a fixed capacity
+//! @details The owner thread pushes and pops components at the bottom, other threads steal from the top.
+//! The capacity is never grown, so it must be large enough for all components pushed in one phase.
+class WorkStealingDeque
 {
 public:
-    ThreadSafeVector(std::vector<Component*> data, size_t maxSize)
+    WorkStealingDeque(const size_t minCapacity)
     {
-        mSize = maxSize;
-        mVector.resize(maxSize);
-        for(size_t i=0; i<data.size(); ++i)
+        size_t capacity = 1;
+        while (capacity < minCapacity)
         {
-            mVector[i] = data[i];
+            capacity *= 2;
         }
-        firstIdx=0;
-        lastIdx=std::max(size_t(1), data.size())-1;
-        mpMutex = new std::mutex();
-    }
-
-
-    Component *tryAndTakeFirst()
-    {
-        Component *ret;
-        mpMutex->lock();
-
-        int idx = (firstIdx%mSize+mSize)%mSize;
-        ret = mVector[idx];
-        mVector[idx] = 0;
-
-        if(firstIdx != lastIdx)
-            ++firstIdx;
-
-        mpMutex->unlock();
-        return ret;
+        mMask = capacity-1;
+        mpBuffer = new std::atomic<Component*>[capacity];
+        for (size_t i=0; i<capacity; ++i)
+        {
+            mpBuffer[i].store(0, std::memory_order_relaxed);
+        }
+        mTop.store(0);
+        mBottom.store(0);
     }
 
-    Component *tryAndTakeLast()
+    ~WorkStealingDeque()
     {
-        Component *ret = 0;
-        if(!mpMutex->try_lock())
-            return 0;
-
-        int idx = (lastIdx%mSize+mSize)%mSize;
-        ret = mVector[idx];
-        mVector[idx] = 0;
-
-        if(lastIdx != firstIdx)
-            --lastIdx;
-
-        mpMutex->unlock();
-        return ret;
+        delete[] mpBuffer;
     }
 
-    //! @note NOT THREAD-SAFE
-    size_t size()
+    //! @brief Pushes a component at the bottom of the deque
+    //! @note May only be called by the owner thread
+    inline void push(Component *pComponent)
     {
-        return mVector.size();
+        const long long b = mBottom.load(std::memory_order_relaxed);
+        mpBuffer[size_t(b) & mMask].store(pComponent, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(b+1, std::memory_order_relaxed);
     }
 
-    void insertFirst(Component* comp)
+    //! @brief Pops a component from the bottom of the deque
+    //! @note May only be called by the owner thread
+    //! @returns The component, or 0 if the deque was empty
+    inline Component *pop()
     {
-        mpMutex->lock();
-        int idx = (firstIdx%mSize+mSize)%mSize;
-        if(firstIdx == lastIdx && mVector[idx] == 0)
+        const long long b = mBottom.load(std::memory_order_relaxed)-1;
+        mBottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        long long t = mTop.load(std::memory_order_relaxed);
+        Component *pComponent = 0;
+        if (t <= b)
         {
-            mVector[idx] = comp;
+            pComponent = mpBuffer[size_t(b) & mMask].load(std::memory_order_relaxed);
+            if (t == b)
+            {
+                // Last component, race against thieves
+                if (!mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    pComponent = 0;
+                }
+                mBottom.store(b+1, std::memory_order_relaxed);
+            }
         }
         else
         {
-            --firstIdx;
-            idx = (firstIdx%mSize+mSize)%mSize;
-            mVector[idx] = comp;
+            mBottom.store(b+1, std::memory_order_relaxed);
         }
-        mpMutex->unlock();
+        return pComponent;
     }
 
-
-    void insertLast(Component* comp)
+    //! @brief Tries to steal a component from the top of the deque
+    //! @returns The component, or 0 if the deque was empty or if an other thread took the component first
+    inline Component *steal()
     {
-        mpMutex->lock();
-        int idx = (firstIdx%mSize+mSize)%mSize;
-        if(firstIdx == lastIdx && mVector[idx] == 0)
+        long long t = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const long long b = mBottom.load(std::memory_order_acquire);
+        if (t < b)
         {
-            mVector[idx] = comp;
+            Component *pComponent = mpBuffer[size_t(t) & mMask].load(std::memory_order_relaxed);
+            if (mTop.compare_exchange_strong(t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return pComponent;
+            }
         }
-        else
-        {
-            ++lastIdx;
-            int idx = (lastIdx%mSize+mSize)%mSize;
-            mVector[idx] = comp;
-        }
-        mpMutex->unlock();
+        return 0;
     }
 
-    //! @note NOT THREAD-SAFE
-    Component* at(size_t idx)
-    {
-        return mVector[idx];
-    }
+private:
+    std::atomic<long long> mTop;
+    char mPadding[64];  // Keep top and bottom on separate cache lines
+    std::atomic<long long> mBottom;
+    std::atomic<Component*> *mpBuffer;
+    size_t mMask;
+};
+
+
+//! @brief One phase (C or Q) in the task-stealing algorithm, with one work-stealing deque per thread
+//! @details Each thread simulates its own components first and then steals from the other threads until all
+//! components in the phase have been simulated. Stolen components are moved to the thief for the next time step,
+//! so that the distribution follows changes in component execution times.
+class HOPSANCORE_DLLAPI TaskStealingPhase
+{
+public:
+    TaskStealingPhase(ComponentSystem *pSystem, const std::vector< std::vector<Component*> > &rSplitVector, const size_t nThreads);
+    ~TaskStealingPhase();
+
+    void reset();
+    void simulate(const size_t threadID, const double time);
 
 private:
-    int mSize;
-    std::vector<Component*> mVector;
-    int firstIdx, lastIdx;
-    std::mutex *mpMutex;
+    ComponentSystem *mpSystem;
+    std::vector<WorkStealingDeque*> mDeques;
+    std::vector< std::vector<Component*> > mOwnComponents;
+    std::vector< std::vector<Component*> > mSimulatedComponents;
+    long long mnComponents;
+    std::atomic<long long> mnRemaining;
 };
 
 
 HOPSANCORE_DLLAPI void simStealingMaster(ComponentSystem *pSystem,
                                          std::vector<Component*> &sVector,
-                                         std::vector<ThreadSafeVector*> *cVectors,
-                                         std::vector<ThreadSafeVector*> *qVectors,
+                                         TaskStealingPhase *pPhaseC,
+                                         TaskStealingPhase *pPhaseQ,
                                          std::vector<double *> &pSimTimes,
                                          double startTime,
                                          double timeStep,
                                          size_t numSimSteps,
-                                         size_t nThreads,
-                                         size_t threadID,
                                          BarrierLock *pBarrier_S,
                                          BarrierLock *pBarrier_C,
                                          BarrierLock *pBarrier_Q,
-                                         BarrierLock *pBarrier_N,
-                                         size_t maxSize);
-
-
+                                         BarrierLock *pBarrier_N);
 
 
 HOPSANCORE_DLLAPI void simStealingSlave(ComponentSystem *pSystem,
-                                        std::vector<ThreadSafeVector*> *cVectors,
-                                        std::vector<ThreadSafeVector*> *qVectors,
+                                        TaskStealingPhase *pPhaseC,
+                                        TaskStealingPhase *pPhaseQ,
                                         double startTime,
                                         double timeStep,
                                         size_t numSimSteps,
-                                        size_t nThreads,
                                         size_t threadID,
                                         BarrierLock *pBarrier_S,
                                         BarrierLock *pBarrier_C,
                                         BarrierLock *pBarrier_Q,
-                                        BarrierLock *pBarrier_N,
-                                        size_t maxSize);
+                                        BarrierLock *pBarrier_N);
+
+
+//! @brief A pool of persistent worker threads, used to run multi-threaded simulations without creating new threads each time
+//! @details The calling thread always acts as thread 0, worker threads are created on demand and then kept parked between runs.
+//! If the pool is already running a task (from another simulation), temporary threads are used instead.
+class HOPSANCORE_DLLAPI SimulationThreadPool
+{
+public:
+    typedef std::function<void(size_t)> TaskFunctionT;
+
+    SimulationThreadPool();
+    ~SimulationThreadPool();
+
+    void run(const size_t nThreads, const TaskFunctionT &rTask);
+    size_t getNumWorkers() const;
+
+private:
+    void workerLoop(const size_t threadID, size_t generation);
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mRunMutex;
+    std::mutex mMutex;
+    std::condition_variable mStartCondition;
+    std::condition_variable mDoneCondition;
+    const TaskFunctionT *mpTask;
+    size_t mnThreads;
+    size_t mnBusy;
+    size_t mGeneration;
+    bool mStop;
+};
+
+
+//! @brief Pins the calling thread to one of the processor cores that it is allowed to run on, the previous affinity is restored when the object is destroyed
+//! @details Create one object per pinned thread and task, so that worker threads in the persistent thread pool do not keep their pinning between runs
+class HOPSANCORE_DLLAPI ThreadCorePin
+{
+public:
+    ThreadCorePin();
+    ~ThreadCorePin();
+
+    bool pin(const size_t core);
+    void unpin();
+
+private:
+    ThreadCorePin(const ThreadCorePin &);
+    ThreadCorePin &operator=(const ThreadCorePin &);
+
+    std::vector<unsigned char> mOriginalAffinity;
+    bool mIsPinned;
+};
 
 
 /////////////////////////////////////////////
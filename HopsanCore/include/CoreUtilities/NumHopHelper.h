@@ -49,6 +49,9 @@ public:
 
     bool evalNumHopScript(const HString &script, double &rValue, bool doPrintOutput, HString &rOutput);
     bool interpretNumHopScript(const HString &script, bool doPrintOutput, HString &rOutput);
+    bool compileNumHopScript(const HString &script, bool doPrintOutput, HString &rOutput);
+    bool isCompiled() const;
+    bool eval(double &rValue);
     bool eval(double &rValue, bool doPrintOutput, HString &rOutput);
 
     HVector<HString> extractVariableNames(const HString &expression) const;
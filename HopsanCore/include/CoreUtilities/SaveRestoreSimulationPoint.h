@@ -29,6 +29,7 @@
 
 #include "win32dll.h"
 #include "HopsanTypes.h"
+#include <string>
 
 namespace hopsan {
 
@@ -36,6 +37,9 @@ class ComponentSystem;
 
 void HOPSANCORE_DLLAPI saveSimulationPoint(HString fileName, ComponentSystem* pRootSystem);
 void HOPSANCORE_DLLAPI restoreSimulationPoint(HString fileName, ComponentSystem* pRootSystem, double &rTimeOffset);
+bool HOPSANCORE_DLLAPI restoreSimulationCheckpoint(HString fileName, ComponentSystem* pRootSystem);
+void HOPSANCORE_DLLAPI saveSimulationCheckpointToMemory(std::string &rData, ComponentSystem* pRootSystem);
+bool HOPSANCORE_DLLAPI restoreSimulationCheckpointFromMemory(const std::string &rData, ComponentSystem* pRootSystem);
 
 }
 
@@ -0,0 +1,84 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   SimulationStateBuffer.h
+//!
+//! @brief Contains the simulation state buffer class, used to save and restore component internal state
+//!
+//$Id$
+
+#ifndef SIMULATIONSTATEBUFFER_H
+#define SIMULATIONSTATEBUFFER_H
+
+#include <cstddef>
+#include <vector>
+#include "win32dll.h"
+
+namespace hopsan {
+
+//! @brief Binary buffer for the internal state of a component, such as delay buffers and transfer function states
+//! @details Values are read back in the same order as they were written. Only use it for plain data types.
+//! If a read goes past the end of the buffer, the read fails and hasFailed() returns true.
+class HOPSANCORE_DLLAPI SimulationStateBuffer
+{
+public:
+    SimulationStateBuffer();
+
+    void clear();
+    bool isEmpty() const;
+    size_t getSize() const;
+    const char *getData() const;
+    void setData(const char *pData, const size_t nBytes);
+
+    void writeBytes(const void *pData, const size_t nBytes);
+    bool readBytes(void *pData, const size_t nBytes);
+    bool hasFailed() const;
+
+    //! @brief Write a value to the end of the buffer
+    //! @param [in] rValue The value to write
+    template<typename T>
+    void write(const T &rValue)
+    {
+        writeBytes(&rValue, sizeof(T));
+    }
+
+    //! @brief Read the next value from the buffer
+    //! @param [out] rValue The value read, unchanged if the read failed
+    //! @returns True if successful
+    template<typename T>
+    bool read(T &rValue)
+    {
+        return readBytes(&rValue, sizeof(T));
+    }
+
+private:
+    std::vector<char> mData;
+    size_t mReadPos;
+    bool mHasFailed;
+};
+
+}
+
+#endif // SIMULATIONSTATEBUFFER_H
@@ -48,6 +48,7 @@ namespace hopsan {
 class LoadExternal;
 class HopsanCoreMessageHandler;
 class QuantityRegister;
+class SimulationThreadPool;
 
 //! @brief This class gives access to HopsanCore for model and externalLib loading as well as component creation and simulation.
 class HOPSANCORE_DLLAPI HopsanEssentials
@@ -58,6 +59,7 @@ private:
     HopsanCoreMessageHandler* mpMessageHandler;
     LoadExternal* mpExternalLoader;
     SimulationHandler mSimulationHandler;
+    SimulationThreadPool* mpSimulationThreadPool;
     QuantityRegister* mpQuantityRegister;
     static size_t mInstanceCounter;
 
@@ -115,6 +117,7 @@ public:
 
     // Running simulation
     SimulationHandler *getSimulationHandler();
+    SimulationThreadPool *getSimulationThreadPool();
 };
 
 
@@ -48,6 +48,14 @@ class HopsanEssentials;
 
 enum NodeDataVariableTypeEnumT {DefaultType, IntensityType, FlowType, TLMType, HiddenType};
 
+//! @brief How the simulation steps between two log samples are reduced into one sample
+//! LogSampled logs the value at the sample step, LogMean, LogMin and LogMax log the mean, min or max value over all steps since the previous sample,
+//! LogEnvelope logs the mean value and also the min and max values in separate columns
+enum LogDecimationModeT {LogSampled, LogMean, LogMin, LogMax, LogEnvelope};
+
+//! @brief The log data columns of a node variable, LogMinColumn and LogMaxColumn only exist in LogEnvelope mode
+enum LogColumnT {LogValueColumn, LogMinColumn, LogMaxColumn};
+
 HOPSANCORE_DLLAPI HString nodeDataVariableTypeAsString(const NodeDataVariableTypeEnumT type);
 
 class NodeDataDescription
@@ -89,14 +97,14 @@ public:
     //! @return The data value
     inline double getDataValue(const size_t dataId) const
     {
-        return mDataValues[dataId];
+        return mpDataValues[dataId];
     }
     //! @brief set data in node
     //! @param [in] dataId Identifier for the type of node data to set, (no bounds check is performed)
     //! @param [in] data The data value
     inline void setDataValue(const size_t dataId, const double data)
     {
-        mDataValues[dataId] = data;
+        mpDataValues[dataId] = data;
     }
 
     const std::vector<NodeDataDescription>* getDataDescriptions() const;
@@ -108,6 +116,9 @@ public:
     virtual bool getSignalQuantityModifyable(const size_t dataId=0) const;
 
     void logData(const size_t logSlot);
+    void accumulateLogData();
+    bool isLogging() const;
+    const std::vector<double> *getLogDataColumnPtr(const size_t dataId, const LogColumnT column=LogValueColumn) const;
 
     int getNumberOfPortsByType(const int type) const;
     size_t getNumConnectedPorts() const;
@@ -127,14 +138,20 @@ protected:
     virtual void copySignalQuantityAndUnitTo(Node *pOtherNode) const;
     virtual void setTLMNodeDataValuesTo(Node *pOtherNode) const;
 
-    void preAllocateLogSpace(const size_t nLogSlots);
+    void preAllocateLogSpace(const size_t nLogSlots, const LogDecimationModeT mode=LogSampled);
+    std::vector<std::vector<double> > *getLogDataRowsPtr();
 
     double *getDataPtr(const size_t data_type);
 
+    void attachDataValues(double *pData);
+    void detachDataValues();
+    bool isDataValuesAttached() const;
+
     // Protected member variables
     HString mNiceName;
     std::vector<NodeDataDescription> mDataDescriptions;
     std::vector<double> mDataValues;
+    double *mpDataValues;
 
 private:
     // Private member functions
@@ -148,9 +165,22 @@ private:
     std::vector<Port*> mConnectedPorts;
     ComponentSystem *mpOwnerSystem;
 
-    // Log specific variables
-    std::vector<std::vector<double> > mDataStorage;
+    void resetLogAccumulators();
+
+    // Log specific variables, one contiguous column per logged variable
+    std::vector<std::vector<double> > mLogColumns;
+    std::vector<std::vector<double> > mLogMinColumns;
+    std::vector<std::vector<double> > mLogMaxColumns;
+    std::vector<size_t> mLoggedDataIds;
+    std::vector<double> mLogMin, mLogMax, mLogSum;
+    size_t mnLogAccumulated;
+    size_t mnLogSlots;
+    LogDecimationModeT mLogMode;
     bool mDoLog;
+
+    // Row-wise copy of the log data, only built on request for backwards compatibility
+    std::vector<std::vector<double> > mDataStorage;
+    bool mDataStorageValid;
 };
 
 typedef ClassFactory<HString, Node> NodeFactory;
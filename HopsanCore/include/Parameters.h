@@ -41,6 +41,7 @@ namespace hopsan {
 
 //Forward declaration
 class Component;
+class ComponentSystem;
 class ParameterEvaluatorHandler;
 
 class HOPSANCORE_DLLAPI ParameterEvaluator
@@ -51,6 +52,7 @@ public:
                        const HString &rType, const bool internal=false, void* pDataPtr=0, ParameterEvaluatorHandler* pParameterEvalHandler=0);
 
     bool setParameterValue(const HString &rValue, ParameterEvaluator **ppNeedEvaluation=0, bool force=false);
+    bool setDoubleValue(const double value);
     bool setParameter(const HString &rValue, const HString &rDescription, const HString &rQuantity, const HString &rUnit,
                       const HString &rType, ParameterEvaluator **pNeedEvaluation=0, bool internal=false, bool force=false);
 
@@ -134,6 +136,31 @@ protected:
     std::vector<ParameterEvaluator*> mParametersNeedEvaluation; //! @todo Use this vector to ensure parameters are valid at simulation time e.g. if a used system parameter is deleted before simulation
 };
 
+
+//! @brief A pre-resolved handle to a double parameter, for fast repeated value updates
+//! @details The parameter is looked up once by its full name, after that the value can be set directly without name lookup or evaluation.
+//! Parameters that reference the handled parameter by name are collected when resolving, and only those are re-evaluated when the value is set.
+//! The handle becomes invalid if parameters are added, removed or renamed, or if components are added to or removed from the model.
+class HOPSANCORE_DLLAPI ParameterHandle
+{
+public:
+    ParameterHandle();
+
+    bool resolve(ComponentSystem *pRootSystem, const HString &rFullName);
+    bool isValid() const;
+    const HString &getFullName() const;
+
+    bool setValue(const double value);
+    double getValue() const;
+
+private:
+    void findDependentParameters(Component *pComponent, const HString &rName, const bool recurse);
+
+    HString mFullName;
+    ParameterEvaluator *mpParameter;
+    std::vector<ParameterEvaluator*> mDependentParameters;
+};
+
 }
 
 #endif // PARAMETERS_H
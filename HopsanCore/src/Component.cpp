@@ -79,6 +79,9 @@ Component::Component()
     mInheritTimestep = true;
     mIsDisabled = false;
     mTimestep = 0.001;
+    mStepMultiple = 1;
+    mRateBoundaryMode = HoldOutputs;
+    mRateBoundaryTime = 0;
 
     mpSystemParent = 0;
     mModelHierarchyDepth = 0;
@@ -95,6 +98,7 @@ bool Component::initialize(const double startT, const double stopT)
     HOPSAN_UNUSED(stopT)
     mTime = startT;
     initialize();
+    setupRateBoundaryOutputs();
 
     return true;        //Always return true, because we cannot know if it was successful or not (yet)
 }
@@ -288,6 +292,11 @@ void Component::simulate(const double stopT)
         simulateOneTimestep();
     }
 
+    if (!mRateBoundaryOutputPtrs.empty())
+    {
+        updateRateBoundaryOutputs(stopT, nSteps > 0);
+    }
+
     //DEBUG
 //    while(mTime < stopT)
 //    {
@@ -335,6 +344,37 @@ void Component::finalize()
     //Default does nothing
 }
 
+//! @brief Optional function that saves internal state that is not stored in nodes, such as delay buffers and transfer function states
+//! @details Override this together with restoreState() in components with internal state, to make them continue exactly from a simulation checkpoint.
+//! The node data of the component ports is saved separately and should not be included.
+//! @param [in,out] rBuffer The state buffer to write to
+void Component::saveState(SimulationStateBuffer &rBuffer) const
+{
+    HOPSAN_UNUSED(rBuffer)
+    //Default does nothing
+}
+
+//! @brief Optional function that restores internal state saved by saveState()
+//! @details This is called after initialize, so the state overwrites the initial values
+//! @param [in,out] rBuffer The state buffer to read from, values must be read in the same order as they were written
+//! @returns True if successful
+bool Component::restoreState(SimulationStateBuffer &rBuffer)
+{
+    HOPSAN_UNUSED(rBuffer)
+    //Default does nothing
+    return true;
+}
+
+//! @brief Optional function that copies data loaded by a component, such as lookup tables, from an identically configured component
+//! @details This is called by ComponentSystem::clone(), after the parameters have been copied, so that clones do not need to reload or parse external data files.
+//! The source component is always of the same type as this one.
+//! @param [in] pSource The component that is being cloned
+void Component::copyReadOnlyDataFrom(const Component *pSource)
+{
+    HOPSAN_UNUSED(pSource)
+    //Default does nothing
+}
+
 
 //! @brief Set the desired component name
 //! @param [in] name The desired component name
@@ -765,6 +805,36 @@ bool Component::doesInheritTimestep() const
     //return true;       //Components always inherit timestep, so let's return true
 }
 
+//! @brief Set how many system time steps the component should take per step of its own
+//! @details The component time step becomes the multiple times the time step it would otherwise get from its system parent.
+//! On the system steps in between, the component is not simulated and its outputs are held or extrapolated, see setRateBoundaryMode().
+//! This also works for subsystems, the components inside then take the longer time step as well.
+//! @param [in] multiple The step multiple, 1 (the default) means that the component is simulated every system step
+void Component::setStepMultiple(const size_t multiple)
+{
+    mStepMultiple = std::max(multiple, size_t(1));
+}
+
+//! @brief Returns the number of system time steps per step of the component
+size_t Component::getStepMultiple() const
+{
+    return mStepMultiple;
+}
+
+//! @brief Set what happens to the outputs of a multi-rate component on the system steps where it is not simulated
+//! @details Outputs are either held at the value from the last component step, or linearly extrapolated from the last two steps.
+//! Only signal output variables are extrapolated, power port variables and subsystem outputs are always held.
+//! @param [in] mode The rate boundary mode
+void Component::setRateBoundaryMode(const RateBoundaryModeT mode)
+{
+    mRateBoundaryMode = mode;
+}
+
+Component::RateBoundaryModeT Component::getRateBoundaryMode() const
+{
+    return mRateBoundaryMode;
+}
+
 
 bool Component::checkModelBeforeSimulation()
 {
@@ -815,6 +885,14 @@ bool Component::isObsolete() const
     return false;
 }
 
+//! @brief Returns the function used to simulate all components of this type in one batch
+//! @details Type-batched simulation is opt-in, component types enable it by returning getSimulateBatchFunctionIfExactType<ComponentType>()
+//! @returns Pointer to batch simulation function or 0 if this type can not be batched
+Component::SimulateBatchFunctionT Component::getSimulateBatchFunction() const
+{
+    return 0;
+}
+
 //! @brief Returns a pointer to the simulation time variable in the component
 //! @returns pointer to time variable
 double *Component::getTimePtr()
@@ -1329,7 +1407,59 @@ void Component::setTimestep(const double timestep)
 size_t Component::calcNumSimSteps(const double startT, const double stopT) const
 {
     // Round to nearest, we may not get exactly the stop time that we want
-    return size_t(std::max(stopT-startT,0.0)/mTimestep+0.5);
+    // For multi-rate components, round to the nearest system step and then down to whole component steps
+    return size_t(std::max(stopT-startT,0.0)/mTimestep+0.5/mStepMultiple);
+}
+
+//! @brief Collect the signal outputs that should be extrapolated between the steps of a multi-rate component
+void Component::setupRateBoundaryOutputs()
+{
+    mRateBoundaryOutputPtrs.clear();
+    mRateBoundaryValues.clear();
+    mRateBoundarySlopes.clear();
+    mRateBoundaryTime = mTime;
+    if ((mStepMultiple > 1) && (mRateBoundaryMode == ExtrapolateOutputs))
+    {
+        for (size_t p=0; p<mPortPtrVector.size(); ++p)
+        {
+            if (mPortPtrVector[p]->getPortType() == WritePortType)
+            {
+                double *pData = mPortPtrVector[p]->getNodeDataPtr(0); // 0 = NodeSignal::Value
+                if (pData)
+                {
+                    mRateBoundaryOutputPtrs.push_back(pData);
+                    mRateBoundaryValues.push_back(*pData);
+                }
+            }
+        }
+        mRateBoundarySlopes.resize(mRateBoundaryValues.size(), 0.0);
+    }
+}
+
+//! @brief Update the extrapolation slopes after a component step, or write extrapolated outputs on a step in between
+//! @param [in] stopT The current system time
+//! @param [in] tookStep True if the component was simulated up to stopT
+void Component::updateRateBoundaryOutputs(const double stopT, const bool tookStep)
+{
+    if (tookStep)
+    {
+        const double dt = mTime-mRateBoundaryTime;
+        for (size_t i=0; i<mRateBoundaryOutputPtrs.size(); ++i)
+        {
+            const double value = *mRateBoundaryOutputPtrs[i];
+            mRateBoundarySlopes[i] = (value-mRateBoundaryValues[i])/dt;
+            mRateBoundaryValues[i] = value;
+        }
+        mRateBoundaryTime = mTime;
+    }
+    else
+    {
+        const double dt = stopT-mRateBoundaryTime;
+        for (size_t i=0; i<mRateBoundaryOutputPtrs.size(); ++i)
+        {
+            *mRateBoundaryOutputPtrs[i] = mRateBoundaryValues[i]+mRateBoundarySlopes[i]*dt;
+        }
+    }
 }
 
 //! @brief Add an inputVariable (Scalar signal ReadPort)
@@ -37,6 +37,7 @@
 #include <iostream>
 #include <algorithm>
 #include <map>
+#include <set>
 #include <time.h>
 
 #include "ComponentSystem.h"
@@ -48,6 +49,8 @@
 #include "CoreUtilities/HmfLoader.h"
 #include "CoreUtilities/NumHopHelper.h"
 #include "CoreUtilities/ConnectionAssistant.h"
+#include "CoreUtilities/LogDataSink.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
 #include "ComponentUtilities/num2string.hpp"
 
 using namespace std;
@@ -105,23 +108,161 @@ bool vectorContains(const std::vector<T> &rVector, const T &rObj)
     }
     return false;
 }
+
+//! @brief Find the port in a cloned system that corresponds to a port in the original system
+//! @param[in] pPort The port in the original system (not a multiport sub port)
+//! @param[in] pOriginal The original system
+//! @param[in] pClone The cloned system
+//! @return Pointer to the corresponding port, or 0 if not found
+hopsan::Port *findClonedPort(hopsan::Port *pPort, const hopsan::ComponentSystem *pOriginal, hopsan::ComponentSystem *pClone)
+{
+    hopsan::Component *pClonedComponent = pClone;
+    if (pPort->getComponent() != pOriginal)
+    {
+        pClonedComponent = pClone->getSubComponent(pPort->getComponent()->getName());
+    }
+    if (pClonedComponent)
+    {
+        return pClonedComponent->getPort(pPort->getName());
+    }
+    return 0;
+}
+
+//! @brief Check if a port is visible inside a system, either as a sub component port or as one of the system ports
+bool isPortVisibleInSystem(const hopsan::Port *pPort, const hopsan::ComponentSystem *pSystem)
+{
+    const hopsan::Component *pComponent = pPort->getComponent();
+    return (pComponent == pSystem) || (pComponent->getSystemParent() == pSystem);
+}
 } // anon namespace
 
 namespace hopsan {
 
 class ComponentSystemMultiThreadPrivates {
 public:
+    ComponentSystemMultiThreadPrivates()
+    {
+        mScheduleValid = false;
+        mScheduleNumThreads = 0;
+        mScheduleAlgorithm = APrioriScheduling;
+    }
+
+    //! @brief Returns a copy of a pointer vector sorted by address, to compare contents regardless of order
+    template<typename T>
+    static std::vector<T*> sortedByAddress(const std::vector<T*> &rVector)
+    {
+        std::vector<T*> sorted = rVector;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+    //! @brief Checks if the cached schedule (the split vectors) was made for the same thread count, algorithm and topology
+    bool isScheduleValid(const size_t nThreads, const ParallelAlgorithmT algorithm, const std::vector<Component*> &rSignalComponents,
+                         const std::vector<Component*> &rCComponents, const std::vector<Component*> &rQComponents, const std::vector<Node*> &rNodes) const
+    {
+        // Signal components must keep their order, C and Q components and nodes only need to be the same
+        return mScheduleValid && (mScheduleNumThreads == nThreads) && (mScheduleAlgorithm == algorithm) &&
+               (mScheduleSignalComponents == rSignalComponents) &&
+               (mScheduleCComponents == sortedByAddress(rCComponents)) &&
+               (mScheduleQComponents == sortedByAddress(rQComponents)) &&
+               (mScheduleNodes == sortedByAddress(rNodes));
+    }
+
+    //! @brief Remembers which thread count, algorithm and topology the split vectors were made for
+    void setScheduleValid(const size_t nThreads, const ParallelAlgorithmT algorithm, const std::vector<Component*> &rSignalComponents,
+                          const std::vector<Component*> &rCComponents, const std::vector<Component*> &rQComponents, const std::vector<Node*> &rNodes)
+    {
+        mScheduleValid = true;
+        mScheduleNumThreads = nThreads;
+        mScheduleAlgorithm = algorithm;
+        mScheduleSignalComponents = rSignalComponents;
+        mScheduleCComponents = sortedByAddress(rCComponents);
+        mScheduleQComponents = sortedByAddress(rQComponents);
+        mScheduleNodes = sortedByAddress(rNodes);
+    }
+
     std::vector<double *> mvTimePtrs;
     std::vector< std::vector<Component*> > mSplitCVector;
     std::vector< std::vector<Component*> > mSplitQVector;
     std::vector< std::vector<Component*> > mSplitSignalVector;
     std::vector< std::vector<Node*> > mSplitNodeVector;
+
+    // Node data owned by each partition in the clustered algorithm, allocated by the thread that simulates the partition
+    std::vector< std::vector<double> > mPartitionNodeData;
+    std::vector< std::vector<Node*> > mPartitionNodeDataNodePtrs;
+
+    // The topology that the split vectors were made for
+    bool mScheduleValid;
+    size_t mScheduleNumThreads;
+    ParallelAlgorithmT mScheduleAlgorithm;
+    std::vector<Component*> mScheduleSignalComponents;
+    std::vector<Component*> mScheduleCComponents;
+    std::vector<Component*> mScheduleQComponents;
+    std::vector<Node*> mScheduleNodes;
 #if defined(HOPSANCORE_USEMULTITHREADING)
     std::mutex mStopMutex;
 #endif
 
 };
 
+//! @brief A run of consecutive components in a batch schedule, simulated by one function call
+class ComponentBatch {
+public:
+    Component::SimulateBatchFunctionT mpSimulateBatch; //!< The batch function, or 0 if the component must be simulated on its own
+    size_t mOffset;
+    size_t mSize;
+};
+
+//! @brief The components of one simulation phase (S, C or Q), grouped by concrete type into batches
+class ComponentBatchSchedule {
+public:
+    void clear()
+    {
+        mComponentPtrs.clear();
+        mBatches.clear();
+    }
+
+    void simulate(const double stopT) const
+    {
+        for (size_t b=0; b<mBatches.size(); ++b)
+        {
+            const ComponentBatch &rBatch = mBatches[b];
+            if (rBatch.mpSimulateBatch)
+            {
+                rBatch.mpSimulateBatch(&mComponentPtrs[rBatch.mOffset], rBatch.mSize, stopT);
+            }
+            else
+            {
+                mComponentPtrs[rBatch.mOffset]->simulate(stopT);
+            }
+        }
+    }
+
+    std::vector<Component*> mComponentPtrs;
+    std::vector<ComponentBatch> mBatches;
+};
+
+class ComponentSystemBatchPrivates {
+public:
+    ComponentBatchSchedule mSignalSchedule;
+    ComponentBatchSchedule mCSchedule;
+    ComponentBatchSchedule mQSchedule;
+};
+
+//! @brief Log data state that is shared with threads that read the log data while the system is simulating
+class ComponentSystemLogDataPrivates {
+public:
+    ComponentSystemLogDataPrivates() : mnPublishedLogSamples(0) {}
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    // Stored (release) after the samples have been written, loaded (acquire) before they are read
+    std::atomic<size_t> mnPublishedLogSamples;
+    // Held while the log data storage is (re)allocated
+    std::mutex mAllocationMutex;
+#else
+    size_t mnPublishedLogSamples;
+#endif
+};
+
 
 //Constructor
 ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
@@ -133,9 +274,20 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
     mDesiredTimestep = 0.001;
     mInheritTimestep = true;
     mKeepValuesAsStartValues = false;
+    mRandomSeed = 0;
+    mInheritRandomSeed = true;
     mRequestedNumLogSamples = 0; //This has to be 0 since we want logging to be disabled by default
     mRequestedLogStartTime = 0;
     mpMultiThreadPrivates = new ComponentSystemMultiThreadPrivates;
+    mUseTypeBatching = false;
+    mpBatchPrivates = new ComponentSystemBatchPrivates;
+    mUseNodeDataArena = false;
+    mLogDecimationMode = LogSampled;
+    mpLogDataSink = 0;
+    mLogStreamId = 0;
+    mnStreamedLogSamples = 0;
+    mLogDataStreamPaused = false;
+    mpLogDataPrivates = new ComponentSystemLogDataPrivates;
     mpNumHopHelper = 0;
 
     // Prevent creation of components, system parameters and system ports named "self"
@@ -156,9 +308,14 @@ ComponentSystem::ComponentSystem() : Component(), mAliasHandler(this)
 
 ComponentSystem::~ComponentSystem()
 {
+    // Give the node data values back to the nodes before they are removed
+    releaseNodeDataArena();
+    releasePartitionNodeData();
     // Clear the contents of the system
     clear();
     delete mpMultiThreadPrivates;
+    delete mpBatchPrivates;
+    delete mpLogDataPrivates;
 }
 
 void ComponentSystem::configure()
@@ -199,11 +356,17 @@ size_t ComponentSystem::getNumLogSamples() const
 }
 
 //! @brief Returns the number of actually logged data samples
+//! @details When a log data sink is used, only the samples that are still held in memory are counted,
+//! see getNumStreamedLogSamples() for the number of samples that have been streamed
 //! @return Number of available logged data samples in storage
 size_t ComponentSystem::getNumActuallyLoggedSamples() const
 {
-    // This assumes that the logCtr has been incremented after each saved log step
-    return mLogCtr;
+    // The published count is updated after each saved log step, it can also be read from other threads while simulating
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    return mpLogDataPrivates->mnPublishedLogSamples.load(std::memory_order_acquire);
+#else
+    return mpLogDataPrivates->mnPublishedLogSamples;
+#endif
 }
 
 
@@ -397,6 +560,228 @@ void ComponentSystem::addComponent(Component *pComponent)
 }
 
 
+//! @brief Create a copy of this system and all its contents
+//! @details The copy is built from the in-memory model, so no model file is parsed. Sub components are created by type name,
+//! and get the parameter values (including start values) of the originals. Subsystems, system ports, system parameters, connections,
+//! aliases, embedded scripts and simulation settings are copied recursively. Components can copy data they have loaded from
+//! external files, see Component::copyReadOnlyDataFrom(). The clone must be initialized before it can be simulated.
+//! @returns A pointer to the new top-level system, or 0 if cloning failed. The caller takes ownership of the clone.
+ComponentSystem *ComponentSystem::clone()
+{
+    if (!mpHopsanEssentials)
+    {
+        addErrorMessage("Can not clone a system that was not created by HopsanEssentials");
+        return 0;
+    }
+
+    ComponentSystem *pClone;
+    if (getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)
+    {
+        pClone = mpHopsanEssentials->createConditionalComponentSystem();
+    }
+    else
+    {
+        pClone = mpHopsanEssentials->createComponentSystem();
+    }
+
+    if (!cloneContentsInto(pClone))
+    {
+        mpHopsanEssentials->removeComponent(pClone);
+        return 0;
+    }
+    return pClone;
+}
+
+
+//! @brief Copy the system parameters of this system into an other system
+void ComponentSystem::cloneParametersInto(ComponentSystem *pTarget)
+{
+    const std::vector<ParameterEvaluator*> *pParameters = getParametersVectorPtr();
+    for (size_t i=0; i<pParameters->size(); ++i)
+    {
+        const ParameterEvaluator *pParameter = (*pParameters)[i];
+        const HString &rUnitOrQuantity = pParameter->getQuantity().empty() ? pParameter->getUnit() : pParameter->getQuantity();
+        // Use force to set parameters that refer to parameters in parent systems, they will be evaluated in initialize
+        pTarget->setOrAddSystemParameter(pParameter->getName(), pParameter->getValue(), pParameter->getType(), pParameter->getDescription(),
+                                         rUnitOrQuantity, pParameter->isInternal(), true);
+    }
+}
+
+
+//! @brief Copy settings, sub components, connections and aliases of this system into an empty system
+//! @param[in] pTarget The system to copy into, it must already be added to its parent system (if any)
+//! @returns True if successful
+bool ComponentSystem::cloneContentsInto(ComponentSystem *pTarget)
+{
+    pTarget->setName(getName());
+    pTarget->setSubTypeName(getSubTypeName());
+    pTarget->setDisabled(isDisabled());
+    pTarget->setDesiredTimestep(mDesiredTimestep);
+    pTarget->setInheritTimestep(mInheritTimestep);
+    pTarget->setStepMultiple(mStepMultiple);
+    pTarget->setRateBoundaryMode(mRateBoundaryMode);
+    pTarget->setRandomSeed(mRandomSeed);
+    pTarget->setInheritRandomSeed(mInheritRandomSeed);
+    pTarget->setLogStartTime(mRequestedLogStartTime);
+    pTarget->setNumLogSamples(mRequestedNumLogSamples);
+    pTarget->setLogDecimationMode(mLogDecimationMode);
+    pTarget->setKeepValuesAsStartValues(mKeepValuesAsStartValues);
+    pTarget->setUseTypeBatching(mUseTypeBatching);
+    pTarget->setUseNodeDataArena(mUseNodeDataArena);
+    pTarget->setExternalModelFilePath(mExternalModelFilePath);
+    for (size_t i=0; i<mSearchPaths.size(); ++i)
+    {
+        pTarget->addSearchPath(mSearchPaths[i]);
+    }
+
+    // System parameters are needed before sub components are added, as they may be used by them
+    cloneParametersInto(pTarget);
+    pTarget->setNumHopScript(mNumHopScript);
+
+    // System ports
+    std::vector<Port*> ports = getPortPtrVector();
+    for (size_t i=0; i<ports.size(); ++i)
+    {
+        const Port::RequireConnectionEnumT reqConnect = ports[i]->isConnectionRequired() ? Port::Required : Port::NotRequired;
+        pTarget->addSystemPort(ports[i]->getName(), ports[i]->getDescription(), reqConnect);
+    }
+
+    // Sub components, added in the order of the storage vectors so that the clone gets the same simulation order
+    std::vector<Component*> subComponents;
+    subComponents.insert(subComponents.end(), mComponentSignalptrs.begin(), mComponentSignalptrs.end());
+    subComponents.insert(subComponents.end(), mComponentCptrs.begin(), mComponentCptrs.end());
+    subComponents.insert(subComponents.end(), mComponentQptrs.begin(), mComponentQptrs.end());
+    subComponents.insert(subComponents.end(), mComponentUndefinedptrs.begin(), mComponentUndefinedptrs.end());
+    subComponents.insert(subComponents.end(), mDisabledSptrs.begin(), mDisabledSptrs.end());
+    subComponents.insert(subComponents.end(), mDisabledCptrs.begin(), mDisabledCptrs.end());
+    subComponents.insert(subComponents.end(), mDisabledQptrs.begin(), mDisabledQptrs.end());
+    for (size_t c=0; c<subComponents.size(); ++c)
+    {
+        Component *pOriginal = subComponents[c];
+        if (pOriginal->isComponentSystem())
+        {
+            ComponentSystem *pOriginalSystem = static_cast<ComponentSystem*>(pOriginal);
+            ComponentSystem *pSubClone;
+            if (pOriginalSystem->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)
+            {
+                pSubClone = mpHopsanEssentials->createConditionalComponentSystem();
+            }
+            else
+            {
+                pSubClone = mpHopsanEssentials->createComponentSystem();
+            }
+            pSubClone->setName(pOriginalSystem->getName());
+            pTarget->addComponent(pSubClone);
+            if (!pOriginalSystem->cloneContentsInto(pSubClone))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            Component *pCloned = mpHopsanEssentials->createComponent(pOriginal->getTypeName());
+            if (!pCloned)
+            {
+                pTarget->addErrorMessage("Could not create component of type: "+pOriginal->getTypeName()+" when cloning: "+pOriginal->getName());
+                return false;
+            }
+            pCloned->setName(pOriginal->getName());
+            pCloned->setSubTypeName(pOriginal->getSubTypeName());
+            pCloned->setDisabled(pOriginal->isDisabled());
+            pCloned->setStepMultiple(pOriginal->getStepMultiple());
+            pCloned->setRateBoundaryMode(pOriginal->getRateBoundaryMode());
+            pTarget->addComponent(pCloned);
+
+            const std::vector<ParameterEvaluator*> *pParameters = pOriginal->getParametersVectorPtr();
+            for (size_t i=0; i<pParameters->size(); ++i)
+            {
+                // Use force to set parameters that refer to system parameters, they will be evaluated in initialize
+                if (!pCloned->setParameterValue((*pParameters)[i]->getName(), (*pParameters)[i]->getValue(), true))
+                {
+                    pCloned->addWarningMessage("Failed to set parameter: "+(*pParameters)[i]->getName()+"="+(*pParameters)[i]->getValue());
+                }
+            }
+
+            std::vector<Port*> originalPorts = pOriginal->getPortPtrVector();
+            for (size_t i=0; i<originalPorts.size(); ++i)
+            {
+                const HString quantity = originalPorts[i]->getSignalNodeQuantity();
+                Port *pClonedPort = pCloned->getPort(originalPorts[i]->getName());
+                if (pClonedPort && !quantity.empty() && originalPorts[i]->getSignalNodeQuantityModifyable())
+                {
+                    pClonedPort->setSignalNodeQuantityOrUnit(quantity);
+                }
+            }
+
+            pCloned->copyReadOnlyDataFrom(pOriginal);
+        }
+    }
+
+    // Connections, each connection is seen from both ports so remember the ones that have already been made
+    // Multiport sub ports are connected first and in order, so that the cloned multiports get the same sub port order
+    std::set< std::pair<Port*, Port*> > connectedPairs;
+    subComponents.push_back(this);
+    for (int pass=0; pass<2; ++pass)
+    {
+        const bool doMultiPorts = (pass == 0);
+        for (size_t c=0; c<subComponents.size(); ++c)
+        {
+            std::vector<Port*> originalPorts = subComponents[c]->getPortPtrVector();
+            for (size_t p=0; p<originalPorts.size(); ++p)
+            {
+                Port *pPort = originalPorts[p];
+                if ((pPort->isMultiPort() != doMultiPorts) || !isPortVisibleInSystem(pPort, this))
+                {
+                    continue;
+                }
+
+                const size_t nSubPorts = doMultiPorts ? pPort->getNumPorts() : 1;
+                for (size_t s=0; s<nSubPorts; ++s)
+                {
+                    std::vector<Port*> connectedPorts = pPort->getConnectedPorts(int(s));
+                    for (size_t o=0; o<connectedPorts.size(); ++o)
+                    {
+                        Port *pOther = connectedPorts[o]->getParentPort() ? connectedPorts[o]->getParentPort() : connectedPorts[o];
+                        if (!isPortVisibleInSystem(pOther, this))
+                        {
+                            continue;
+                        }
+                        std::pair<Port*, Port*> key = (pPort < pOther) ? std::make_pair(pPort, pOther) : std::make_pair(pOther, pPort);
+                        if (!connectedPairs.insert(key).second)
+                        {
+                            continue;
+                        }
+
+                        Port *pClonedPort1 = findClonedPort(pPort, this, pTarget);
+                        Port *pClonedPort2 = findClonedPort(pOther, this, pTarget);
+                        if (!pClonedPort1 || !pClonedPort2 || !pTarget->connect(pClonedPort1, pClonedPort2))
+                        {
+                            pTarget->addErrorMessage("Failed to clone connection: "+pPort->getComponentName()+"::"+pPort->getName()+" - "+
+                                                     pOther->getComponentName()+"::"+pOther->getName());
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Set system parameters again, as connected system ports may have added start value parameters
+    cloneParametersInto(pTarget);
+
+    // Aliases
+    std::vector<HString> aliases = mAliasHandler.getAliases();
+    for (size_t i=0; i<aliases.size(); ++i)
+    {
+        HString compName, portName, varName;
+        mAliasHandler.getVariableFromAlias(aliases[i], compName, portName, varName);
+        pTarget->getAliasHandler().setVariableAlias(aliases[i], compName, portName, varName);
+    }
+
+    return true;
+}
+
+
 //! @brief Rename a sub component and automatically fix unique names
 void ComponentSystem::renameSubComponent(const HString &rOldName, const HString &rNewName)
 {
@@ -714,49 +1099,12 @@ bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVec
             //Ignore components that are already added to the new vector
             if(!vectorContains<Component*>(newComponentVector, pUnsrtComp)) {
                 bool readyToAdd=true;
-                std::vector<Port*> portVector = pUnsrtComp->getPortPtrVector();
-                // Ask each read port for its node, then ask the node for its write port component
-                for(size_t p=0; p<portVector.size(); ++p) {
-                    // Take the port pointer (To make code easier to read)
-                    Port *pPort = portVector[p];
-                    std::vector<Component*> pRequiredComponents;
-
-                    SortHintEnumT sortHint = pPort->getSortHint();
-                    if ((pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
-                        (pUnsrtComp->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)) {
-                        sortHint = pPort->getInternalSortHint();
-                    }
-
-                    if ( (sortHint == Destination) && pPort->isConnected() ) {
-                        std::vector<Port *> sourcePorts;
-                        for(int s=0; s<pPort->getNumPorts(); ++s) {
-                            sourcePorts.push_back(pPort->getNodePtr(s)->getSortOrderSourcePort());
-                        }
-                        for(size_t p=0; p<sourcePorts.size(); ++p) {
-                            if (sourcePorts[p] && sourcePorts[p]->getComponent()) {
-                                pRequiredComponents.push_back(sourcePorts[p]->getComponent());
-                            }
-                        }
-                    }
-                    if(!pRequiredComponents.empty()) {
-                        for(size_t r=0; r<pRequiredComponents.size(); ++r) {
-                            Component *pRequiredComponent = pRequiredComponents[r];
-                            if(pRequiredComponent->mpSystemParent == this) {
-                                if(!vectorContains<Component*>(newComponentVector, pRequiredComponent) &&
-                                        vectorContains<Component*>(rComponentVector,pRequiredComponent)) {
-                                    readyToAdd = false;     //Depending on normal component which has not yet been added
-                                    break;
-                                }
-                            }
-                            else {
-                                if(!vectorContains<Component*>(newComponentVector, pRequiredComponent->mpSystemParent) &&
-                                        (pRequiredComponent->mpSystemParent->getTypeCQS() == pPort->getComponent()->getTypeCQS()) &&
-                                        vectorContains<Component*>(rComponentVector,pRequiredComponent->mpSystemParent)) {
-                                    readyToAdd = false;     //Depending on subsystem component which has not yet been added
-                                    break;
-                                }
-                            }
-                        }
+                std::vector<Component*> requiredComponents;
+                getSortDependencies(pUnsrtComp, rComponentVector, requiredComponents);
+                for(size_t r=0; r<requiredComponents.size(); ++r) {
+                    if(!vectorContains<Component*>(newComponentVector, requiredComponents[r])) {
+                        readyToAdd = false;     //Depending on component which has not yet been added
+                        break;
                     }
                 }
                 // Add the component if all required write port components was already added
@@ -797,6 +1145,50 @@ bool ComponentSystem::sortComponentVector(std::vector<Component*> &rComponentVec
 }
 
 
+//! @brief Find the components in a component vector that a component must be simulated after
+//! @details These are the components writing to the nodes of the (sort hint) destination ports of the component.
+//! If the writing component is inside a subsystem, the subsystem is required instead.
+//! @param[in] pComponent The component to find dependencies for
+//! @param[in] rComponentVector The component vector to look for required components in
+//! @param[out] rRequiredComponents The required components, (components not in the vector are ignored)
+void ComponentSystem::getSortDependencies(Component *pComponent, const std::vector<Component*> &rComponentVector, std::vector<Component*> &rRequiredComponents)
+{
+    std::vector<Port*> portVector = pComponent->getPortPtrVector();
+    // Ask each read port for its node, then ask the node for its write port component
+    for(size_t p=0; p<portVector.size(); ++p) {
+        // Take the port pointer (To make code easier to read)
+        Port *pPort = portVector[p];
+
+        SortHintEnumT sortHint = pPort->getSortHint();
+        if ((pComponent->getTypeName() == HOPSAN_BUILTIN_TYPENAME_SUBSYSTEM) ||
+            (pComponent->getTypeName() == HOPSAN_BUILTIN_TYPENAME_CONDITIONALSUBSYSTEM)) {
+            sortHint = pPort->getInternalSortHint();
+        }
+
+        if ( (sortHint == Destination) && pPort->isConnected() ) {
+            for(size_t s=0; s<pPort->getNumPorts(); ++s) {
+                Port *pSourcePort = pPort->getNodePtr(s)->getSortOrderSourcePort();
+                if (!pSourcePort || !pSourcePort->getComponent()) {
+                    continue;
+                }
+                Component *pRequiredComponent = pSourcePort->getComponent();
+                if(pRequiredComponent->mpSystemParent == this) {
+                    if(vectorContains<Component*>(rComponentVector, pRequiredComponent)) {
+                        rRequiredComponents.push_back(pRequiredComponent);     //Depending on normal component
+                    }
+                }
+                else {
+                    if((pRequiredComponent->mpSystemParent->getTypeCQS() == pComponent->getTypeCQS()) &&
+                            vectorContains<Component*>(rComponentVector, pRequiredComponent->mpSystemParent)) {
+                        rRequiredComponents.push_back(pRequiredComponent->mpSystemParent);     //Depending on subsystem component
+                    }
+                }
+            }
+        }
+    }
+}
+
+
 //! @brief Overloaded function that behaves slightly different when determining unique port names
 //! In systemcomponents we must make sure that systemports and subcomponents have unique names, this simplifies things in the GUI later on
 //! It is VERY important that systemports don't have the same name as a subcomponent
@@ -935,6 +1327,35 @@ void ComponentSystem::removeSubNode(Node* pNode)
             break;
         }
     }
+
+    // If the node data values are kept in the node data arena, move them back into the node
+    for (it=mNodeDataArenaNodePtrs.begin(); it!=mNodeDataArenaNodePtrs.end(); ++it)
+    {
+        if (*it == pNode)
+        {
+            pNode->detachDataValues();
+            mNodeDataArenaNodePtrs.erase(it);
+            break;
+        }
+    }
+    it = std::find(mLoggedNodePtrs.begin(), mLoggedNodePtrs.end(), pNode);
+    if (it != mLoggedNodePtrs.end())
+    {
+        mLoggedNodePtrs.erase(it);
+    }
+    for (size_t t=0; t<mpMultiThreadPrivates->mPartitionNodeDataNodePtrs.size(); ++t)
+    {
+        std::vector<Node*> &rNodes = mpMultiThreadPrivates->mPartitionNodeDataNodePtrs[t];
+        for (it=rNodes.begin(); it!=rNodes.end(); ++it)
+        {
+            if (*it == pNode)
+            {
+                pNode->detachDataValues();
+                rNodes.erase(it);
+                break;
+            }
+        }
+    }
 }
 
 
@@ -945,12 +1366,22 @@ void ComponentSystem::preAllocateLogSpace()
     //    //cout << "stopT = " << stopT << ", startT = " << startT << ", mTimestep = " << mTimestep << endl;
     //    this->setLogSettingsNSamples(nSamples, startT, stopT, mTimestep);
     //! @todo Fix /Peter
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    // Wait for other threads that are reading the log data, see tryLockLogData()
+    std::lock_guard<std::mutex> lock(mpLogDataPrivates->mAllocationMutex);
+#endif
     mLogCtr = 0;
+    publishNumLoggedSamples();
+    mnStreamedLogSamples = 0;
+    mLoggedNodePtrs.clear();
+    mLogStreamColumnPtrs.clear();
     if (mEnableLogData)
     {
+        // When log data is streamed to a sink, only one chunk is kept in memory
+        const size_t nLogSlotsInMemory = mpLogDataSink ? min(mnLogSlots, mpLogDataSink->getChunkSize()) : mnLogSlots;
         try
         {
-            mTimeStorage.resize(mnLogSlots, 0);
+            mTimeStorage.assign(nLogSlotsInMemory, 0);
 
             // Allocate log data memory for subnodes
             //! @todo we should have an other vector with those nodes that should be logged, if we make individual nodes possible to disable logging
@@ -976,7 +1407,11 @@ void ComponentSystem::preAllocateLogSpace()
                     else
                     {
                         (*it)->setDoLogIfEnabled(true);
-                        (*it)->preAllocateLogSpace(mnLogSlots);
+                        (*it)->preAllocateLogSpace(nLogSlotsInMemory, mLogDecimationMode);
+                        if ((*it)->isLogging())
+                        {
+                            mLoggedNodePtrs.push_back(*it);
+                        }
                     }
                     success = true;
                 }
@@ -1002,92 +1437,350 @@ void ComponentSystem::preAllocateLogSpace()
     {
         stopSimulation("Failed to allocate log memory");
     }
+    else if (mEnableLogData && mpLogDataSink)
+    {
+        setupLogDataStream();
+    }
 }
 
 
-void ComponentSystem::logTimeAndNodes(const size_t simStep)
+//! @brief Register the logged variables in this system as a stream in the log data sink
+//! @details Variables are named after the ports of the components in this system that are connected to the logged nodes,
+//! in the same way as in the result export. Nodes in subsystems are streamed by the subsystems themselves.
+void ComponentSystem::setupLogDataStream()
 {
-    if (mEnableLogData)
+    vector<LogSinkVariable> variables;
+    for (size_t n=0; n<mLoggedNodePtrs.size(); ++n)
     {
-        if (mLogTheseTimeSteps[mLogCtr] ==  simStep)
+        Node *pNode = mLoggedNodePtrs[n];
+        for (size_t p=0; p<pNode->mConnectedPorts.size(); ++p)
         {
-            mTimeStorage[mLogCtr] = mTime;   //We log the "real"  simulation time for the sample
-
-            //! @todo we should have an other vector with those nodes that should be logged, if we make individual nodes possible to disable logging
-            vector<Node*>::iterator it;
-            for (it=mSubNodePtrs.begin(); it!=mSubNodePtrs.end(); ++it)
+            const Port *pPort = pNode->mConnectedPorts[p];
+            const Component *pComponent = pPort->getComponent();
+            // Sub ports are named after their multiport, and use its log setting
+            const Port *pNamePort = pPort->getParentPort() ? pPort->getParentPort() : pPort;
+            if ((pComponent->getSystemParent() != this) || !pNamePort->isLoggingEnabled())
             {
-                (*it)->logData(mLogCtr);
+                continue;
             }
-            ++mLogCtr;
-        }
-    }
-}
-
-
-//! @brief Rename a system parameter
-bool ComponentSystem::renameParameter(const HString &rOldName, const HString &rNewName)
-{
-    if (hasReservedUniqueName(rNewName))
-    {
-        addErrorMessage("The desired system parameter name: "+rNewName+" is already used by something else");
-    }
-    else if (mpParameters->renameParameter(rOldName, rNewName))
-    {
-        unReserveUniqueName(rOldName);
-        reserveUniqueName(rNewName);
 
-        // Now try to change the system parameter value in all sub components
-        SubComponentMapT::iterator scmit;
-        for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
-        {
-            Component* pComponent = scmit->second;
-            const std::vector<ParameterEvaluator*> *pParams = pComponent->mpParameters->getParametersVectorPtr();
-            for (size_t p=0; p<pParams->size(); ++p)
+            for (size_t v=0; v<pNode->getNumDataVariables(); ++v)
             {
-                ParameterEvaluator *pParam = pParams->at(p);
-                // If we find a parameter with the old system par name as value then change that value
-                if (pParam->getValue() == rOldName)
+                const vector<double> *pColumn = pPort->getLogDataColumnPtr(v);
+                // As in the result export, only the first sub port of a multiport is included
+                if (pColumn && (pNamePort->getLogDataColumnPtr(v) == pColumn))
                 {
-                    pComponent->setParameterValue(pParam->getName(), rNewName);
+                    const NodeDataDescription *pDesc = pNode->getDataDescription(v);
+                    LogSinkVariable variable;
+                    variable.componentName = pComponent->getName();
+                    variable.portName = pNamePort->getName();
+                    variable.variableName = pDesc->name;
+                    variable.alias = pNamePort->getVariableAlias(v);
+                    variable.unit = pDesc->unit;
+                    variable.quantity = pDesc->quantity;
+                    variables.push_back(variable);
+                    mLogStreamColumnPtrs.push_back(pColumn);
                 }
             }
         }
+    }
 
-        return true;
+    if (!variables.empty())
+    {
+        HString systemHierarchy;
+        for (const ComponentSystem *pSystem=this; pSystem->getSystemParent(); pSystem=pSystem->getSystemParent())
+        {
+            systemHierarchy = systemHierarchy.empty() ? pSystem->getName() : pSystem->getName()+"."+systemHierarchy;
+        }
+        // While paused the system is only re-initialized, and the stream registered in the first initialize is kept
+        if (!mLogDataStreamPaused)
+        {
+            mLogStreamId = mpLogDataSink->registerStream(systemHierarchy, variables);
+        }
     }
-    return false;
 }
 
-std::list<HString> ComponentSystem::getModelAssets() const
+
+//! @brief Submit the samples currently held in memory as one chunk to the log data sink
+void ComponentSystem::streamLogData()
 {
-    // Get any system parameter assets
-    std::list<HString> assets = Component::getModelAssets();
-    // If this is an external system, then also consider the external model as an asset
-    if (isExternalSystem())
+    if (mLogStreamColumnPtrs.empty() || (mLogCtr == 0) || mLogDataStreamPaused)
     {
-        assets.push_back(getExternalModelFilePath());
+        return;
     }
-    // Append assets from sub components
-    SubComponentMapT::const_iterator compIt;
-    for(compIt = mSubComponentMap.begin(); compIt!=mSubComponentMap.end(); ++compIt)
+
+    LogDataChunk *pChunk = mpLogDataSink->acquireChunk();
+    pChunk->streamId = mLogStreamId;
+    pChunk->nSamples = mLogCtr;
+    pChunk->data.resize(mLogCtr*(mLogStreamColumnPtrs.size()+1));
+    double *pData = &pChunk->data[0];
+    std::copy(mTimeStorage.begin(), mTimeStorage.begin()+mLogCtr, pData);
+    for (size_t v=0; v<mLogStreamColumnPtrs.size(); ++v)
     {
-        std::list<HString> sub = compIt->second->getModelAssets();
-        assets.splice(assets.end(), sub);
+        pData += mLogCtr;
+        std::copy(mLogStreamColumnPtrs[v]->begin(), mLogStreamColumnPtrs[v]->begin()+mLogCtr, pData);
     }
-    return assets;
-}
+    mpLogDataSink->submitChunk(pChunk);
 
-//! @brief Adds a transparent SubSystemPort
-Port* ComponentSystem::addSystemPort(HString portName, const HString &rDescription, const Port::RequireConnectionEnumT reqConnect)
-{
-    // Force default port name p, if nothing else specified
-    if (portName.empty())
+    if (mpLogDataSink->hasFailed())
     {
-        portName = "p";
+        mLogStreamColumnPtrs.clear();
+        stopSimulation("Failed to stream log data: "+mpLogDataSink->getLastError());
     }
-
-    return addPort(portName, SystemPortType, "NodeEmpty", rDescription, reqConnect);
+}
+
+
+//! @brief Pause streaming to the log data sink in this system and all subsystems
+//! @details While paused, log samples are discarded instead of being submitted, initialize does not register new streams
+//! and no logged samples are published to other threads (see getNumActuallyLoggedSamples()).
+//! This is used when the system is simulated and re-initialized internally, such as when profiling components before a multi-threaded simulation.
+//! @param [in] paused True to pause, false to resume
+void ComponentSystem::setLogDataStreamPaused(const bool paused)
+{
+    mLogDataStreamPaused = paused;
+    publishNumLoggedSamples();
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->setLogDataStreamPaused(paused);
+        }
+    }
+}
+
+
+//! @brief Publish the number of logged samples, so that other threads may read them while simulating
+//! @details Samples logged while the log data stream is paused will be discarded, so then no samples are published
+void ComponentSystem::publishNumLoggedSamples()
+{
+    const size_t nSamples = mLogDataStreamPaused ? 0 : mLogCtr;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpLogDataPrivates->mnPublishedLogSamples.store(nSamples, std::memory_order_release);
+#else
+    mpLogDataPrivates->mnPublishedLogSamples = nSamples;
+#endif
+}
+
+
+void ComponentSystem::logTimeAndNodes(const size_t simStep)
+{
+    if (mEnableLogData)
+    {
+        if (mLogTheseTimeSteps[mnStreamedLogSamples+mLogCtr] ==  simStep)
+        {
+            // When streaming, the in-memory log is handed over to the sink each time it is full
+            if (mLogCtr == mTimeStorage.size())
+            {
+                streamLogData();
+                mnStreamedLogSamples += mLogCtr;
+                mLogCtr = 0;
+                publishNumLoggedSamples();
+            }
+
+            mTimeStorage[mLogCtr] = mTime;   //We log the "real"  simulation time for the sample
+
+            // Only nodes that are actually logging are visited
+            for (size_t n=0; n<mLoggedNodePtrs.size(); ++n)
+            {
+                mLoggedNodePtrs[n]->logData(mLogCtr);
+            }
+            ++mLogCtr;
+            publishNumLoggedSamples();
+        }
+        else if (mLogDecimationMode != LogSampled)
+        {
+            // Steps between log samples are included in the decimation window of the next sample
+            for (size_t n=0; n<mLoggedNodePtrs.size(); ++n)
+            {
+                mLoggedNodePtrs[n]->accumulateLogData();
+            }
+        }
+    }
+}
+
+
+//! @brief Replace the log sample taken at initialize with the current node values
+//! @details Used when node values have been changed after initialize, for instance when restoring a simulation checkpoint.
+//! It has no effect once the simulation has taken any steps. Subsystems are handled recursively.
+void ComponentSystem::relogStartValues()
+{
+    if (mEnableLogData && (mnStreamedLogSamples == 0) && (mLogCtr == 1) && (mTotalTakenSimulationSteps == 0))
+    {
+        mLogCtr = 0;
+        publishNumLoggedSamples();
+        logTimeAndNodes(mTotalTakenSimulationSteps);
+    }
+
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->relogStartValues();
+        }
+    }
+}
+
+
+//! @brief Set how the simulation steps between two log samples are reduced into one sample
+//! @details The setting is inherited by subsystems, and takes effect at the next initialize
+//! @param [in] mode The decimation mode
+void ComponentSystem::setLogDecimationMode(const LogDecimationModeT mode)
+{
+    mLogDecimationMode = mode;
+}
+
+
+//! @brief Returns how the simulation steps between two log samples are reduced into one sample
+LogDecimationModeT ComponentSystem::getLogDecimationMode() const
+{
+    return mLogDecimationMode;
+}
+
+
+//! @brief Set a sink that log data is streamed to during simulation, instead of keeping all log data in memory
+//! @details Only one chunk of log data (the sink chunk size) is kept in memory, it is submitted to the sink each time it is full,
+//! and the remaining samples are submitted on finalize. The sink is inherited by subsystems, and takes effect at the next initialize.
+//! The caller keeps ownership of the sink and must call LogDataSink::finish() after finalize.
+//! @param [in] pSink The sink, or nullptr to keep all log data in memory
+void ComponentSystem::setLogDataSink(LogDataSink *pSink)
+{
+    mpLogDataSink = pSink;
+}
+
+
+//! @brief Returns the log data sink, or nullptr if log data is kept in memory
+LogDataSink *ComponentSystem::getLogDataSink() const
+{
+    return mpLogDataSink;
+}
+
+
+//! @brief Returns the number of log samples that have been submitted to the log data sink
+size_t ComponentSystem::getNumStreamedLogSamples() const
+{
+    return mnStreamedLogSamples;
+}
+
+
+//! @brief Lock the log data storage of this system and its subsystems, so that it can be read by another thread while simulating
+//! @details The storage is (re)allocated when the system is initialized, also by the simulating thread before a multi-threaded
+//! simulation, and that waits until unlockLogData() is called. Only the samples counted by getNumActuallyLoggedSamples() are valid.
+//! @returns False if the log data is being (re)allocated, then nothing is locked and the log data must not be read
+bool ComponentSystem::tryLockLogData()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    if (!mpLogDataPrivates->mAllocationMutex.try_lock())
+    {
+        return false;
+    }
+#endif
+    std::vector<ComponentSystem*> lockedSubsystems;
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            ComponentSystem *pSubsystem = static_cast<ComponentSystem*>(it->second);
+            if (!pSubsystem->tryLockLogData())
+            {
+                for (size_t s=0; s<lockedSubsystems.size(); ++s)
+                {
+                    lockedSubsystems[s]->unlockLogData();
+                }
+#if defined(HOPSANCORE_USEMULTITHREADING)
+                mpLogDataPrivates->mAllocationMutex.unlock();
+#endif
+                return false;
+            }
+            lockedSubsystems.push_back(pSubsystem);
+        }
+    }
+    return true;
+}
+
+
+//! @brief Unlock the log data storage of this system and its subsystems, after a successful tryLockLogData()
+void ComponentSystem::unlockLogData()
+{
+    SubComponentMapT::iterator it;
+    for (it=mSubComponentMap.begin(); it!=mSubComponentMap.end(); ++it)
+    {
+        if (it->second->isComponentSystem())
+        {
+            static_cast<ComponentSystem*>(it->second)->unlockLogData();
+        }
+    }
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpLogDataPrivates->mAllocationMutex.unlock();
+#endif
+}
+
+
+//! @brief Rename a system parameter
+bool ComponentSystem::renameParameter(const HString &rOldName, const HString &rNewName)
+{
+    if (hasReservedUniqueName(rNewName))
+    {
+        addErrorMessage("The desired system parameter name: "+rNewName+" is already used by something else");
+    }
+    else if (mpParameters->renameParameter(rOldName, rNewName))
+    {
+        unReserveUniqueName(rOldName);
+        reserveUniqueName(rNewName);
+
+        // Now try to change the system parameter value in all sub components
+        SubComponentMapT::iterator scmit;
+        for (scmit=mSubComponentMap.begin(); scmit!=mSubComponentMap.end(); ++scmit)
+        {
+            Component* pComponent = scmit->second;
+            const std::vector<ParameterEvaluator*> *pParams = pComponent->mpParameters->getParametersVectorPtr();
+            for (size_t p=0; p<pParams->size(); ++p)
+            {
+                ParameterEvaluator *pParam = pParams->at(p);
+                // If we find a parameter with the old system par name as value then change that value
+                if (pParam->getValue() == rOldName)
+                {
+                    pComponent->setParameterValue(pParam->getName(), rNewName);
+                }
+            }
+        }
+
+        return true;
+    }
+    return false;
+}
+
+std::list<HString> ComponentSystem::getModelAssets() const
+{
+    // Get any system parameter assets
+    std::list<HString> assets = Component::getModelAssets();
+    // If this is an external system, then also consider the external model as an asset
+    if (isExternalSystem())
+    {
+        assets.push_back(getExternalModelFilePath());
+    }
+    // Append assets from sub components
+    SubComponentMapT::const_iterator compIt;
+    for(compIt = mSubComponentMap.begin(); compIt!=mSubComponentMap.end(); ++compIt)
+    {
+        std::list<HString> sub = compIt->second->getModelAssets();
+        assets.splice(assets.end(), sub);
+    }
+    return assets;
+}
+
+//! @brief Adds a transparent SubSystemPort
+Port* ComponentSystem::addSystemPort(HString portName, const HString &rDescription, const Port::RequireConnectionEnumT reqConnect)
+{
+    // Force default port name p, if nothing else specified
+    if (portName.empty())
+    {
+        portName = "p";
+    }
+
+    return addPort(portName, SystemPortType, "NodeEmpty", rDescription, reqConnect);
 }
 
 
@@ -1584,6 +2277,33 @@ bool ComponentSystem::doesInheritTimestep() const
 }
 
 
+//! @brief Sets the random seed that the random number streams of components in this system are derived from
+//! @details It is only used by sub systems that do not inherit the random seed, and by the top-level system
+//! @param[in] seed The random seed
+void ComponentSystem::setRandomSeed(const uint64_t seed)
+{
+    mRandomSeed = seed;
+}
+
+
+uint64_t ComponentSystem::getRandomSeed() const
+{
+    return mRandomSeed;
+}
+
+
+void ComponentSystem::setInheritRandomSeed(const bool inherit)
+{
+    mInheritRandomSeed = inherit;
+}
+
+
+bool ComponentSystem::doesInheritRandomSeed() const
+{
+    return mInheritRandomSeed;
+}
+
+
 //void ComponentSystem::setTimestep(const double timestep)
 //{
 //    mTimestep = timestep;
@@ -1627,7 +2347,7 @@ void ComponentSystem::setTimestep(const double timestep)
     {
         if (!(mComponentSignalptrs[s]->isComponentSystem())/* && mComponentSignalptrs[s]->doesInheritTimestep()*/)
         {
-            mComponentSignalptrs[s]->setTimestep(timestep);
+            mComponentSignalptrs[s]->setTimestep(timestep*mComponentSignalptrs[s]->getStepMultiple());
         }
     }
 
@@ -1636,7 +2356,7 @@ void ComponentSystem::setTimestep(const double timestep)
     {
         if (!(mComponentCptrs[c]->isComponentSystem())/* && mComponentCptrs[c]->doesInheritTimestep()*/)
         {
-            mComponentCptrs[c]->setTimestep(timestep);
+            mComponentCptrs[c]->setTimestep(timestep*mComponentCptrs[c]->getStepMultiple());
         }
     }
 
@@ -1645,7 +2365,7 @@ void ComponentSystem::setTimestep(const double timestep)
     {
         if (!(mComponentQptrs[q]->isComponentSystem())/* && mComponentQptrs[q]->doesInheritTimestep()*/)
         {
-            mComponentQptrs[q]->setTimestep(timestep);
+            mComponentQptrs[q]->setTimestep(timestep*mComponentQptrs[q]->getStepMultiple());
         }
     }
 }
@@ -1660,7 +2380,7 @@ void ComponentSystem::adjustTimestep(vector<Component*> componentPtrs)
         // Check if component should inherit timestep from its parent system (this system)
         if(componentPtrs[c]->doesInheritTimestep())
         {
-            componentPtrs[c]->setTimestep(mTimestep);
+            componentPtrs[c]->setTimestep(mTimestep*componentPtrs[c]->getStepMultiple());
         }
         // Else use the desired timestep, and adjust it if necessary
         else
@@ -1671,7 +2391,7 @@ void ComponentSystem::adjustTimestep(vector<Component*> componentPtrs)
             {
                 subTs = mTimestep;
             }
-            componentPtrs[c]->setTimestep(subTs);
+            componentPtrs[c]->setTimestep(subTs*componentPtrs[c]->getStepMultiple());
         }
     }
 }
@@ -1778,6 +2498,40 @@ void ComponentSystem::setKeepValuesAsStartValues(bool tf)
     mKeepValuesAsStartValues = tf;
 }
 
+//! @brief Set if components should be simulated in batches grouped by their concrete type
+//! @details In this mode, components of the same type are simulated in one tight loop per S, C and Q phase,
+//! with only one indirect call per batch. Components are only reordered within groups of components that do not depend on each other,
+//! so results are identical to normal simulation. Only component types that provide a batch function are batched.
+//! The setting is propagated to subsystems on initialize.
+//! @param[in] useBatching true to enable type-batched simulation
+void ComponentSystem::setUseTypeBatching(const bool useBatching)
+{
+    mUseTypeBatching = useBatching;
+}
+
+//! @brief Check if components are simulated in batches grouped by their concrete type
+bool ComponentSystem::doesUseTypeBatching() const
+{
+    return mUseTypeBatching;
+}
+
+//! @brief Set if the data values of all sub nodes should be kept in one contiguous memory block during simulation
+//! @details The block is allocated on initialize and the values are copied back into the nodes on finalize.
+//! Nodes are laid out in the order that the sorted C, Q and signal components access them, to improve cache locality.
+//! Node data pointers must be fetched after initialize, (as components do in their initialize function).
+//! The setting is propagated to subsystems on initialize.
+//! @param[in] useArena true to enable the node data arena
+void ComponentSystem::setUseNodeDataArena(const bool useArena)
+{
+    mUseNodeDataArena = useArena;
+}
+
+//! @brief Check if the data values of all sub nodes are kept in one contiguous memory block during simulation
+bool ComponentSystem::doesUseNodeDataArena() const
+{
+    return mUseNodeDataArena;
+}
+
 
 //! @brief Checks that everything is OK before simulation
 //! @returns true if everything is OK, else false (simulation not permitted)
@@ -2161,8 +2915,17 @@ bool ComponentSystem::runNumHopScript(const HString &rScript, bool printOutput,
         mpNumHopHelper = new NumHopHelper();
         mpNumHopHelper->setSystem(this);
     }
+    // The script is only parsed again if it has changed since the previous run
+    if (!mpNumHopHelper->compileNumHopScript(rScript, printOutput, rOutput))
+    {
+        return false;
+    }
+    if (printOutput && !rOutput.empty())
+    {
+        rOutput.append("\n");
+    }
     double dummy;
-    return mpNumHopHelper->evalNumHopScript(rScript, dummy, printOutput, rOutput);
+    return mpNumHopHelper->eval(dummy, printOutput, rOutput);
 }
 
 //! @brief Set the system-level numhop script
@@ -2272,6 +3035,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
     sortComponentVector(mComponentCptrs);
     sortComponentVector(mComponentQptrs);
 
+    // Move node data values into one contiguous block, this must be done before any component fetches node data pointers
+    if (mUseNodeDataArena)
+    {
+        setupNodeDataArena();
+    }
+
     // run top-level system initialization functions
     if (this->isTopLevelSystem())
     {
@@ -2313,6 +3082,10 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples or the subsystems own ?
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setUseTypeBatching(mUseTypeBatching);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setLogDecimationMode(mLogDecimationMode);
+            static_cast<ComponentSystem*>(mComponentSignalptrs[s])->setLogDataSink(mpLogDataSink);
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentSignalptrs[s]->getName());
@@ -2338,6 +3111,10 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentCptrs[c])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->setUseTypeBatching(mUseTypeBatching);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->setLogDecimationMode(mLogDecimationMode);
+            static_cast<ComponentSystem*>(mComponentCptrs[c])->setLogDataSink(mpLogDataSink);
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentCptrs[c]->getName());
@@ -2363,6 +3140,10 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
             //! @todo should we use our own nSamples ore the subsystems own ?
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setNumLogSamples(mRequestedNumLogSamples);
             static_cast<ComponentSystem*>(mComponentQptrs[q])->setLogStartTime(mRequestedLogStartTime);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->setUseTypeBatching(mUseTypeBatching);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->setUseNodeDataArena(mUseNodeDataArena);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->setLogDecimationMode(mLogDecimationMode);
+            static_cast<ComponentSystem*>(mComponentQptrs[q])->setLogDataSink(mpLogDataSink);
         }
 
         addCoreLogMessage("ComponentSystem::initialize() Initializing component: "+mComponentQptrs[q]->getName());
@@ -2378,6 +3159,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
         return false;
     }
 
+    // Group components by type for batched simulation, this must be done after sorting
+    if (mUseTypeBatching)
+    {
+        setupTypeBatches();
+    }
+
     // Log the start values
     logTimeAndNodes(mTotalTakenSimulationSteps);
 
@@ -2387,6 +3174,12 @@ bool ComponentSystem::initialize(const double startT, const double stopT)
 
 
 #if defined(HOPSANCORE_USEMULTITHREADING)
+//! @brief Simulates the system using multiple threads
+//! @param startT Start time of the simulation
+//! @param stopT Stop time of the simulation
+//! @param nDesiredThreads The desired number of threads (0 = one per core)
+//! @param noChanges Reuse the schedule from the previous call if it is still valid, if false components are always re-profiled and redistributed
+//! @param algorithm The parallel algorithm to use
 void ComponentSystem::simulateMultiThreaded(const double startT, const double stopT, const size_t nDesiredThreads, const bool noChanges, const ParallelAlgorithmT algorithm)
 {
     size_t nThreads = determineActualNumberOfThreads(nDesiredThreads);      //Calculate how many threads to actually use
@@ -2395,8 +3188,16 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
     ss << nThreads;
     HString threadStr = ss.str().c_str();
 
-    if(!noChanges)
+    // All threads run on the persistent thread pool if available, the local pool is only used if this system has no HopsanEssentials
+    SimulationThreadPool localThreadPool;
+    SimulationThreadPool *pThreadPool = mpHopsanEssentials ? mpHopsanEssentials->getSimulationThreadPool() : &localThreadPool;
+
+    // The schedule is only rebuilt (and components re-profiled) if requested, or if the thread count, algorithm or topology has changed
+    const bool scheduleValid = mpMultiThreadPrivates->isScheduleValid(nThreads, algorithm, mComponentSignalptrs, mComponentCptrs, mComponentQptrs, mSubNodePtrs);
+    if(!noChanges || !scheduleValid)
     {
+        releasePartitionNodeData();
+
         if(algorithm != TaskStealingAlgorithm)
         {
             mpMultiThreadPrivates->mSplitCVector.clear();
@@ -2404,6 +3205,13 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
             mpMultiThreadPrivates->mSplitSignalVector.clear();
             mpMultiThreadPrivates->mSplitNodeVector.clear();
 
+            // The profiling steps and the re-initialization below must not reach the log data sink
+            setLogDataStreamPaused(true);
+
+            // Keep the initialized state (for example a restored simulation checkpoint), the profiling steps will advance it
+            std::string initialState;
+            saveSimulationCheckpointToMemory(initialState, this);
+
             simulateAndMeasureTime(100);                                //Measure time
             sortComponentVectorsByMeasuredTime();                       //Sort component vectors
 
@@ -2420,15 +3228,45 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
                 addDebugMessage("Time for "+mComponentSignalptrs.at(s)->getName()+": "+to_hstring(mComponentSignalptrs.at(s)->getMeasuredTime()));
             }
 
-            distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);              //Distribute components and nodes
-            distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
-            distributeSignalcomponents(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
-            distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            if(algorithm == ClusteredForkJoinAlgorithm)
+            {
+                // Partition the component graph, all signal components are simulated by the master thread
+                distributeComponentsByConnectivity(mpMultiThreadPrivates->mSplitCVector, mpMultiThreadPrivates->mSplitQVector,
+                                                   mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+                mpMultiThreadPrivates->mSplitSignalVector.resize(nThreads);
+                mpMultiThreadPrivates->mSplitSignalVector[0] = mComponentSignalptrs;
+            }
+            else
+            {
+                distributeCcomponents(mpMultiThreadPrivates->mSplitCVector, nThreads);              //Distribute components and nodes
+                distributeQcomponents(mpMultiThreadPrivates->mSplitQVector, nThreads);
+                distributeSignalcomponents(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
+                distributeNodePointers(mpMultiThreadPrivates->mSplitNodeVector, nThreads);
+            }
 
             // Re-initialize the system to reset values and timers
             //! @note This only work for top level systems where the simulateMultiThreaded will not be called more than once
             this->finalize(); //Always run finalize before initialize
+
+            // Let each pinned thread allocate and touch the data of its own nodes first (before components fetch node data pointers in initialize)
+            if((algorithm == ClusteredForkJoinAlgorithm) && !mUseNodeDataArena)
+            {
+                mpMultiThreadPrivates->mPartitionNodeData.resize(nThreads);
+                mpMultiThreadPrivates->mPartitionNodeDataNodePtrs.resize(nThreads);
+                pThreadPool->run(nThreads, [&](size_t t)
+                {
+                    ThreadCorePin corePin;
+                    if(t != 0)
+                    {
+                        corePin.pin(t);
+                    }
+                    setupPartitionNodeData(t);
+                });
+            }
+
             this->initialize(startT, stopT);
+            restoreSimulationCheckpointFromMemory(initialState, this);
+            setLogDataStreamPaused(false);
         }
         else
         {
@@ -2464,62 +3302,82 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
             distributeSignalcomponents(mpMultiThreadPrivates->mSplitSignalVector, nThreads);
         }
+
+        mpMultiThreadPrivates->setScheduleValid(nThreads, algorithm, mComponentSignalptrs, mComponentCptrs, mComponentQptrs, mSubNodePtrs);
+    }
+    else
+    {
+        // Partition node data is only set up when the schedule is built, since components fetch node data pointers in initialize
+        addDebugMessage("Reusing multi-threaded schedule from previous simulation.");
     }
 
+    mpMultiThreadPrivates->mvTimePtrs.assign(1, &mTime);
 
     size_t nSteps = calcNumSimSteps(startT, stopT);
 
     //Execute simulation
-    if(algorithm == APrioriScheduling)
+    if((algorithm == APrioriScheduling) || (algorithm == ClusteredForkJoinAlgorithm))
     {
-        addInfoMessage("Using a priori scheduling algorithm with "+threadStr+" threads.");
+        if(algorithm == ClusteredForkJoinAlgorithm)
+        {
+            addInfoMessage("Using clustered algorithm with "+threadStr+" threads.");
+        }
+        else
+        {
+            addInfoMessage("Using a priori scheduling algorithm with "+threadStr+" threads.");
+        }
 
-        mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
-        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads);    //Create synchronization barriers
+        //Create synchronization barriers, S and C phases are combined (no S barrier) if there are no signal components
+        BarrierLock *pBarrierLock_S = mComponentSignalptrs.empty() ? 0 : new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_C = new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_N = new BarrierLock(nThreads);
 
-        std::thread *tt = new std::thread[nThreads];
-
-        tt[0] = std::thread(simMaster,
-                            this,
-                            std::ref(mpMultiThreadPrivates->mSplitSignalVector[0]),
-                            std::ref(mpMultiThreadPrivates->mSplitCVector[0]),
-                            std::ref(mpMultiThreadPrivates->mSplitQVector[0]),             //Create master thread
-                            std::ref(mpMultiThreadPrivates->mSplitNodeVector[0]),
-                            std::ref(mpMultiThreadPrivates->mvTimePtrs),
-                            mTime,
-                            mTimestep,
-                            nSteps,
-                            pBarrierLock_S,
-                            pBarrierLock_C,
-                            pBarrierLock_Q,
-                            pBarrierLock_N);
-
-        for (size_t t=1; t<nThreads; ++t)
-        {
-            tt[t] = std::thread(simSlave,
-                                this,
-                                std::ref(mpMultiThreadPrivates->mSplitSignalVector[t]),
-                                std::ref(mpMultiThreadPrivates->mSplitCVector[t]),
-                                std::ref(mpMultiThreadPrivates->mSplitQVector[t]),          //Create slave threads
-                                std::ref(mpMultiThreadPrivates->mSplitNodeVector[t]),
-                                mTime,
-                                mTimestep,
-                                nSteps,
-                                pBarrierLock_S,
-                                pBarrierLock_C,
-                                pBarrierLock_Q,
-                                pBarrierLock_N);
-        }
-
-        for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
-        {
-            tt[i].join();
-        }
-
-        delete[] tt;
+        ComponentSystemMultiThreadPrivates *pPrivates = mpMultiThreadPrivates;
+        const double time = mTime;
+        const double timestep = mTimestep;
+        pThreadPool->run(nThreads, [&](size_t t)
+        {
+            // In the clustered algorithm each partition is pinned to a core during the run (the calling thread is left as it is)
+            ThreadCorePin corePin;
+            if((algorithm == ClusteredForkJoinAlgorithm) && (t != 0))
+            {
+                corePin.pin(t);
+            }
+
+            if(t == 0)
+            {
+                simMaster(this,
+                          pPrivates->mSplitSignalVector[0],
+                          pPrivates->mSplitCVector[0],
+                          pPrivates->mSplitQVector[0],                  //Master thread
+                          pPrivates->mSplitNodeVector[0],
+                          pPrivates->mvTimePtrs,
+                          time,
+                          timestep,
+                          nSteps,
+                          pBarrierLock_S,
+                          pBarrierLock_C,
+                          pBarrierLock_Q,
+                          pBarrierLock_N);
+            }
+            else
+            {
+                simSlave(this,
+                         pPrivates->mSplitSignalVector[t],
+                         pPrivates->mSplitCVector[t],
+                         pPrivates->mSplitQVector[t],                   //Slave threads
+                         pPrivates->mSplitNodeVector[t],
+                         time,
+                         timestep,
+                         nSteps,
+                         pBarrierLock_S,
+                         pBarrierLock_C,
+                         pBarrierLock_Q,
+                         pBarrierLock_N);
+            }
+        });                                                             //Returns when all threads have finished
+
         delete(pBarrierLock_S);
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
@@ -2534,155 +3392,128 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
         TaskPool *pTaskPoolC = new TaskPool(mComponentCptrs);
         TaskPool *pTaskPoolQ = new TaskPool(mComponentQptrs);
 
-        std::thread *tt = new std::thread[nThreads];
-
         std::atomic<double> *pTime = new std::atomic<double>;
         *pTime = mTime;
         std::atomic<bool> *pStop = new std::atomic<bool>;
         *pStop = false;
 
-
-        for (size_t t=0; t<nThreads-1; ++t)
-        {
-            tt[t] = std::thread(simPoolSlave,
-                                pTaskPoolC,
-                                pTaskPoolQ,
-                                pTime,
-                                pStop);
-        }
-
-        Component *pComp;
-        for(size_t i=0; i<nSteps; ++i)
+        pThreadPool->run(nThreads, [&](size_t t)
         {
-            *pTime = *pTime+mTimestep;
-
-            //S-pool
-            pTaskPoolS->open();
-            pComp = pTaskPoolS->getComponent();
-            while(pComp)
+            if(t != 0)
             {
-                pComp->simulate(*pTime);
-                pTaskPoolS->reportDone();
-                pComp = pTaskPoolS->getComponent();
+                simPoolSlave(pTaskPoolC, pTaskPoolQ, pTime, pStop);    //Slave threads
+                return;
             }
-            while(!pTaskPoolS->isReady()) {}
-            pTaskPoolS->close();
 
-            //C-pool
-            pTaskPoolC->open();
-            pComp = pTaskPoolC->getComponent();
-            while(pComp)
+            Component *pComp;
+            for(size_t i=0; i<nSteps; ++i)
             {
-                pComp->simulate(*pTime);
-                pTaskPoolC->reportDone();
+                *pTime = *pTime+mTimestep;
+
+                //S-pool
+                pTaskPoolS->open();
+                pComp = pTaskPoolS->getComponent();
+                while(pComp)
+                {
+                    pComp->simulate(*pTime);
+                    pTaskPoolS->reportDone();
+                    pComp = pTaskPoolS->getComponent();
+                }
+                while(!pTaskPoolS->isReady()) {}
+                pTaskPoolS->close();
+
+                //C-pool
+                pTaskPoolC->open();
                 pComp = pTaskPoolC->getComponent();
-            }
-            while(!pTaskPoolC->isReady()) {}
-            pTaskPoolC->close();
+                while(pComp)
+                {
+                    pComp->simulate(*pTime);
+                    pTaskPoolC->reportDone();
+                    pComp = pTaskPoolC->getComponent();
+                }
+                while(!pTaskPoolC->isReady()) {}
+                pTaskPoolC->close();
 
-            //Q-pool
-            pTaskPoolQ->open();
-            pComp = pTaskPoolQ->getComponent();
-            while(pComp)
-            {
-                pComp->simulate(*pTime);
-                pTaskPoolQ->reportDone();
+                //Q-pool
+                pTaskPoolQ->open();
                 pComp = pTaskPoolQ->getComponent();
-            }
-            while(!pTaskPoolQ->isReady()) {}
-            pTaskPoolQ->close();
-
-            mTime =  *pTime;
-            logTimeAndNodes(i+1);            //Log all nodes
-        }
-        *pStop=true;
-
+                while(pComp)
+                {
+                    pComp->simulate(*pTime);
+                    pTaskPoolQ->reportDone();
+                    pComp = pTaskPoolQ->getComponent();
+                }
+                while(!pTaskPoolQ->isReady()) {}
+                pTaskPoolQ->close();
 
-        for (size_t i = 0; i<nThreads-1; ++i)                 //Wait for all tasks to finish
-        {
-            tt[i].join();
-        }
+                mTime =  *pTime;
+                logTimeAndNodes(i+1);            //Log all nodes
+            }
+            *pStop=true;
+        });                                                             //Returns when all threads have finished
 
-        delete[] tt;
         delete(pTaskPoolS);
         delete(pTaskPoolC);
         delete(pTaskPoolQ);
+        delete(pTime);
         delete(pStop);
     }
     else if(algorithm == TaskStealingAlgorithm)
     {
         addInfoMessage("Using task-stealing algorithm with "+threadStr+" threads.");
 
-        mpMultiThreadPrivates->mvTimePtrs.push_back(&mTime);
-        BarrierLock *pBarrierLock_S = new BarrierLock(nThreads);    //Create synchronization barriers
+        //Create synchronization barriers, S and C phases are combined (no S barrier) if there are no signal components
+        BarrierLock *pBarrierLock_S = mComponentSignalptrs.empty() ? 0 : new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_C = new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_Q = new BarrierLock(nThreads);
         BarrierLock *pBarrierLock_N = new BarrierLock(nThreads);
 
-        size_t maxSize = mComponentCptrs.size()+mComponentQptrs.size()+mComponentSignalptrs.size();
-
-        std::vector<ThreadSafeVector *> *pVectorsC = new std::vector<ThreadSafeVector *>();
-        for(size_t i=0; i<mpMultiThreadPrivates->mSplitCVector.size(); ++i)
-        {
-            pVectorsC->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitCVector[i], maxSize));
-        }
-
-        std::vector<ThreadSafeVector *> *pVectorsQ = new std::vector<ThreadSafeVector *>();
-        for(size_t i=0; i<mpMultiThreadPrivates->mSplitQVector.size(); ++i)
-        {
-            pVectorsQ->push_back(new ThreadSafeVector(mpMultiThreadPrivates->mSplitQVector[i], maxSize));
-        }
-
-        std::thread *tt = new std::thread[nThreads];
-
-        tt[0] = std::thread(simStealingMaster,
-                            this,
-                            std::ref(mComponentSignalptrs),
-                            pVectorsC,
-                            pVectorsQ,             //Create master thread
-                            std::ref(mpMultiThreadPrivates->mvTimePtrs),
-                            mTime,
-                            mTimestep,
-                            nSteps,
-                            nThreads,
-                            0,
-                            pBarrierLock_S,
-                            pBarrierLock_C,
-                            pBarrierLock_Q,
-                            pBarrierLock_N,
-                            maxSize);
-
+        // One lock-free work-stealing deque per thread for each of the C and Q phases
+        TaskStealingPhase *pPhaseC = new TaskStealingPhase(this, mpMultiThreadPrivates->mSplitCVector, nThreads);
+        TaskStealingPhase *pPhaseQ = new TaskStealingPhase(this, mpMultiThreadPrivates->mSplitQVector, nThreads);
 
-        for (size_t t=1; t<nThreads; ++t)
+        std::vector<double *> &rTimePtrs = mpMultiThreadPrivates->mvTimePtrs;
+        const double time = mTime;
+        const double timestep = mTimestep;
+        pThreadPool->run(nThreads, [&](size_t t)
         {
-            tt[t] = std::thread(simStealingSlave,
-                                this,
-                                pVectorsC,
-                                pVectorsQ,
-                                mTime,
-                                mTimestep,
-                                nSteps,
-                                nThreads,
-                                t,
-                                pBarrierLock_S,
-                                pBarrierLock_C,
-                                pBarrierLock_Q,
-                                pBarrierLock_N,
-                                maxSize);
-        }
-
-        for (size_t i = 0; i<nThreads; ++i)                 //Wait for all tasks to finish
-        {
-            tt[i].join();
-        }
+            if(t == 0)
+            {
+                simStealingMaster(this,
+                                  mComponentSignalptrs,
+                                  pPhaseC,
+                                  pPhaseQ,                              //Master thread
+                                  rTimePtrs,
+                                  time,
+                                  timestep,
+                                  nSteps,
+                                  pBarrierLock_S,
+                                  pBarrierLock_C,
+                                  pBarrierLock_Q,
+                                  pBarrierLock_N);
+            }
+            else
+            {
+                simStealingSlave(this,
+                                 pPhaseC,
+                                 pPhaseQ,
+                                 time,
+                                 timestep,
+                                 nSteps,
+                                 t,
+                                 pBarrierLock_S,
+                                 pBarrierLock_C,
+                                 pBarrierLock_Q,
+                                 pBarrierLock_N);
+            }
+        });                                                             //Returns when all threads have finished
 
-        delete[] tt;                                           //Clean up
-        delete(pBarrierLock_S);
+        delete(pBarrierLock_S);                                         //Clean up
         delete(pBarrierLock_C);
         delete(pBarrierLock_Q);
         delete(pBarrierLock_N);
-        delete(pVectorsC);
-        delete(pVectorsQ);
+        delete(pPhaseC);
+        delete(pPhaseQ);
     }
     else if(algorithm == ForkJoinAlgorithm)
     {
@@ -2740,65 +3571,6 @@ void ComponentSystem::simulateMultiThreaded(const double startT, const double st
 
             ++mTotalTakenSimulationSteps;
 
-            logTimeAndNodes(mTotalTakenSimulationSteps);
-        }
-    }
-    else if(algorithm == ClusteredForkJoinAlgorithm)
-    {
-        addInfoMessage("Using clustered fork-join algorithm with unlimited number of threads.");
-
-        // Round to nearest, we may not get exactly the stop time that we want
-        size_t numSimulationSteps = calcNumSimSteps(mTime, stopT); //Here mTime is the last time step since it is not updated yet
-
-        std::thread *tt;
-
-        //Simulate
-        for (size_t i=0; i<numSimulationSteps; ++i)
-        {
-            if (mStopSimulation)
-            {
-                break;
-            }
-
-            mTime += mTimestep; //mTime is updated here before the simulation,
-            //mTime is the current time during the simulateOneTimestep
-
-            //Signal components
-            for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
-            {
-                mComponentSignalptrs[s]->simulate(mTime);
-            }
-
-            //C components
-            tt = new std::thread[mpMultiThreadPrivates->mSplitCVector.size()];
-            for (size_t c=0; c < mpMultiThreadPrivates->mSplitCVector.size(); ++c)
-            {
-                tt[c] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitCVector[c],
-                                    mTime);
-            }
-            for(size_t c=0; c<mpMultiThreadPrivates->mSplitCVector.size(); ++c)
-            {
-                tt[c].join();
-            }
-            delete[] tt;
-
-            //Q components
-            tt = new std::thread[mpMultiThreadPrivates->mSplitQVector.size()];
-            for (size_t q=0; q < mpMultiThreadPrivates->mSplitQVector.size(); ++q)
-            {
-                tt[q] = std::thread(simOneStep,
-                                    &mpMultiThreadPrivates->mSplitQVector[q],
-                                    mTime);
-            }
-            for(size_t q=0; q<mpMultiThreadPrivates->mSplitQVector.size(); ++q)
-            {
-                tt[q].join();
-            }
-            delete[] tt;
-
-            ++mTotalTakenSimulationSteps;
-
             logTimeAndNodes(mTotalTakenSimulationSteps);
         }
     }
@@ -3087,6 +3859,214 @@ void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &rSplitNode
     }
 }
 
+//! @brief Helper function that partitions the C and Q components into one cluster per thread, using the graph of shared nodes
+//! @details Components that share nodes are kept in the same partition as far as possible (few cut nodes), while the measured
+//! C and Q times are balanced separately, since the C and Q phases are synchronized independently. Partitions are grown
+//! greedily from a seed component, then boundary components are moved to neighbouring partitions if that reduces the cut.
+//! Each node is assigned to the partition that owns most of its components.
+//! @param rSplitCVector Reference to vector with vectors of C components (one vector per thread)
+//! @param rSplitQVector Reference to vector with vectors of Q components (one vector per thread)
+//! @param rSplitNodeVector Reference to vector with vectors of nodes (one vector per thread)
+//! @param nThreads Number of simulation threads
+void ComponentSystem::distributeComponentsByConnectivity(vector< vector<Component*> > &rSplitCVector, vector< vector<Component*> > &rSplitQVector,
+                                                         vector< vector<Node*> > &rSplitNodeVector, size_t nThreads)
+{
+    const size_t npos = std::numeric_limits<size_t>::max();
+    const double tolerance = 1.1;      // Allowed imbalance when moving components to reduce the cut
+
+    // The vertices are the C and Q components, with the measured time as weight
+    std::vector<Component*> vertices;
+    vertices.insert(vertices.end(), mComponentCptrs.begin(), mComponentCptrs.end());
+    vertices.insert(vertices.end(), mComponentQptrs.begin(), mComponentQptrs.end());
+    const size_t nVertices = vertices.size();
+    std::map<Component*, size_t> vertexIndex;
+    std::vector<double> weight(nVertices);
+    std::vector<size_t> phase(nVertices);        // 0 = C, 1 = Q
+    double totalWeight[2] = {0, 0};
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        vertexIndex[vertices[v]] = v;
+        weight[v] = vertices[v]->getMeasuredTime();
+        phase[v] = (v < mComponentCptrs.size()) ? 0 : 1;
+        totalWeight[phase[v]] += weight[v];
+    }
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        // Without measurements, balance the number of components instead
+        if(totalWeight[phase[v]] <= 0)
+        {
+            weight[v] = 1;
+        }
+    }
+    totalWeight[0] = totalWeight[1] = 0;
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        totalWeight[phase[v]] += weight[v];
+    }
+    const double target[2] = {totalWeight[0]/double(nThreads), totalWeight[1]/double(nThreads)};
+
+    // The edges connect components that share a node, the edge weight is the number of shared nodes
+    std::vector< std::map<size_t, size_t> > edges(nVertices);
+    std::vector< std::vector<size_t> > nodeVertices(mSubNodePtrs.size());
+    for(size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        const std::vector<Port*> &rPorts = mSubNodePtrs[n]->mConnectedPorts;
+        for(size_t p=0; p<rPorts.size(); ++p)
+        {
+            std::map<Component*, size_t>::iterator it = vertexIndex.find(rPorts[p]->getComponent());
+            if((it != vertexIndex.end()) && !vectorContains(nodeVertices[n], it->second))
+            {
+                nodeVertices[n].push_back(it->second);
+            }
+        }
+        for(size_t a=0; a<nodeVertices[n].size(); ++a)
+        {
+            for(size_t b=0; b<nodeVertices[n].size(); ++b)
+            {
+                if(a != b)
+                {
+                    ++edges[nodeVertices[n][a]][nodeVertices[n][b]];
+                }
+            }
+        }
+    }
+
+    // Grow one partition at a time, always adding the unassigned component with the strongest connection to the partition
+    std::vector<size_t> partition(nVertices, npos);
+    std::vector< std::vector<double> > load(nThreads, std::vector<double>(2, 0.0));
+    size_t nUnassigned = nVertices;
+    for(size_t t=0; t<nThreads && nUnassigned>0; ++t)
+    {
+        std::vector<size_t> connection(nVertices, 0);
+        while(nUnassigned > 0)
+        {
+            size_t best = npos;
+            if(t == nThreads-1)
+            {
+                // The last partition takes everything that is left
+                for(size_t v=0; v<nVertices && best==npos; ++v)
+                {
+                    if(partition[v] == npos)
+                    {
+                        best = v;
+                    }
+                }
+            }
+            else
+            {
+                for(size_t v=0; v<nVertices; ++v)
+                {
+                    if((partition[v] == npos) && (load[t][phase[v]] < target[phase[v]]) &&
+                       ((best == npos) || (connection[v] > connection[best])))
+                    {
+                        best = v;
+                    }
+                }
+            }
+            if(best == npos)
+            {
+                break;  // This partition is full
+            }
+
+            partition[best] = t;
+            load[t][phase[best]] += weight[best];
+            --nUnassigned;
+            for(std::map<size_t, size_t>::iterator it=edges[best].begin(); it!=edges[best].end(); ++it)
+            {
+                connection[it->first] += it->second;
+            }
+        }
+    }
+
+    // Refine by moving boundary components to the partition they are most connected to, as long as the balance is kept
+    size_t nCutEdges = 0;
+    for(size_t pass=0; pass<4; ++pass)
+    {
+        bool moved = false;
+        for(size_t v=0; v<nVertices; ++v)
+        {
+            std::map<size_t, size_t> partitionConnection;
+            for(std::map<size_t, size_t>::iterator it=edges[v].begin(); it!=edges[v].end(); ++it)
+            {
+                partitionConnection[partition[it->first]] += it->second;
+            }
+            const size_t own = partition[v];
+            size_t bestPartition = own;
+            size_t bestConnection = partitionConnection[own];
+            for(std::map<size_t, size_t>::iterator it=partitionConnection.begin(); it!=partitionConnection.end(); ++it)
+            {
+                if((it->second > bestConnection) && (load[it->first][phase[v]]+weight[v] <= tolerance*target[phase[v]]))
+                {
+                    bestPartition = it->first;
+                    bestConnection = it->second;
+                }
+            }
+            if(bestPartition != own)
+            {
+                load[own][phase[v]] -= weight[v];
+                load[bestPartition][phase[v]] += weight[v];
+                partition[v] = bestPartition;
+                moved = true;
+            }
+        }
+        if(!moved)
+        {
+            break;
+        }
+    }
+
+    rSplitCVector.assign(nThreads, std::vector<Component*>());
+    rSplitQVector.assign(nThreads, std::vector<Component*>());
+    rSplitNodeVector.assign(nThreads, std::vector<Node*>());
+    for(size_t v=0; v<nVertices; ++v)
+    {
+        if(phase[v] == 0)
+        {
+            rSplitCVector[partition[v]].push_back(vertices[v]);
+        }
+        else
+        {
+            rSplitQVector[partition[v]].push_back(vertices[v]);
+        }
+        for(std::map<size_t, size_t>::iterator it=edges[v].begin(); it!=edges[v].end(); ++it)
+        {
+            if((it->first > v) && (partition[it->first] != partition[v]))
+            {
+                nCutEdges += it->second;
+            }
+        }
+    }
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        sortComponentVector(rSplitCVector[t]);
+        sortComponentVector(rSplitQVector[t]);
+    }
+
+    // Nodes belong to the partition that owns most of their components, nodes without C or Q components to the master thread
+    for(size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        std::vector<size_t> count(nThreads, 0);
+        size_t owner = 0;
+        for(size_t i=0; i<nodeVertices[n].size(); ++i)
+        {
+            const size_t t = partition[nodeVertices[n][i]];
+            ++count[t];
+            if(count[t] > count[owner])
+            {
+                owner = t;
+            }
+        }
+        rSplitNodeVector[owner].push_back(mSubNodePtrs[n]);
+    }
+
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        addDebugMessage("Partition "+to_hstring(t)+": "+to_hstring(rSplitCVector[t].size())+" C, "+to_hstring(rSplitQVector[t].size())+" Q, "+
+                        to_hstring(rSplitNodeVector[t].size())+" nodes, C time "+to_hstring(load[t][0])+", Q time "+to_hstring(load[t][1]));
+    }
+    addDebugMessage("Number of shared nodes between partitions: "+to_hstring(nCutEdges));
+}
+
 void ComponentSystem::reschedule(size_t nThreads)
 {
     mpMultiThreadPrivates->mSplitCVector.clear();
@@ -3299,6 +4279,13 @@ void ComponentSystem::distributeNodePointers(vector< vector<Node*> > &/*rSplitNo
     addWarningMessage("Called distributeNodePointers(), but multi-threading is not avaialble.");
 }
 
+
+void ComponentSystem::distributeComponentsByConnectivity(vector< vector<Component*> > &/*rSplitCVector*/, vector< vector<Component*> > &/*rSplitQVector*/,
+                                                         vector< vector<Node*> > &/*rSplitNodeVector*/, size_t /*nThreads*/)
+{
+    addWarningMessage("Called distributeComponentsByConnectivity(), but multi-threading is not avaialble.");
+}
+
 #endif
 
 
@@ -3356,31 +4343,254 @@ void ComponentSystem::simulate(const double stopT)
         mTime += mTimestep; //mTime is updated here before the simulation,
         //mTime is the current time during the simulateOneTimestep
 
-        //! @todo maybe use iterators instead
-        //Signal components
-        for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
+        if (mUseTypeBatching)
+        {
+            mpBatchPrivates->mSignalSchedule.simulate(mTime);
+            mpBatchPrivates->mCSchedule.simulate(mTime);
+            mpBatchPrivates->mQSchedule.simulate(mTime);
+        }
+        else
         {
-            mComponentSignalptrs[s]->simulate(mTime);
+            //! @todo maybe use iterators instead
+            //Signal components
+            for (size_t s=0; s < mComponentSignalptrs.size(); ++s)
+            {
+                mComponentSignalptrs[s]->simulate(mTime);
+            }
+
+            //C components
+            for (size_t c=0; c < mComponentCptrs.size(); ++c)
+            {
+                mComponentCptrs[c]->simulate(mTime);
+            }
+
+            //Q components
+            for (size_t q=0; q < mComponentQptrs.size(); ++q)
+            {
+                mComponentQptrs[q]->simulate(mTime);
+            }
         }
 
-        //C components
-        for (size_t c=0; c < mComponentCptrs.size(); ++c)
+        ++mTotalTakenSimulationSteps;
+
+        logTimeAndNodes(mTotalTakenSimulationSteps);
+    }
+}
+
+//! @brief Groups the sorted S, C and Q component vectors into type batches for batched simulation
+//! @details Each component is given a dependency level, one more than the highest level of the components it depends on.
+//! Components on the same level do not depend on each other, so within a level, components of the same type can be simulated together.
+void ComponentSystem::setupTypeBatches()
+{
+    std::vector<Component*> *componentVectors[3] = {&mComponentSignalptrs, &mComponentCptrs, &mComponentQptrs};
+    ComponentBatchSchedule *schedules[3] = {&mpBatchPrivates->mSignalSchedule, &mpBatchPrivates->mCSchedule, &mpBatchPrivates->mQSchedule};
+
+    size_t nBatchedComponents=0, nBatches=0;
+    for (size_t v=0; v<3; ++v)
+    {
+        const std::vector<Component*> &rComponents = *componentVectors[v];
+        ComponentBatchSchedule &rSchedule = *schedules[v];
+        rSchedule.clear();
+
+        // Determine dependency levels, the vector is sorted so required components come first
+        std::map<Component*, size_t> levelMap;
+        size_t maxLevel=0;
+        bool isSorted=true;
+        for (size_t c=0; c<rComponents.size() && isSorted; ++c)
         {
-            mComponentCptrs[c]->simulate(mTime);
+            std::vector<Component*> requiredComponents;
+            getSortDependencies(rComponents[c], rComponents, requiredComponents);
+            size_t level=0;
+            for (size_t r=0; r<requiredComponents.size(); ++r)
+            {
+                std::map<Component*, size_t>::iterator it = levelMap.find(requiredComponents[r]);
+                if (it == levelMap.end())
+                {
+                    // A required component comes later in the vector (it could not be sorted), keep the original order
+                    isSorted = false;
+                    break;
+                }
+                level = std::max(level, it->second+1);
+            }
+            levelMap[rComponents[c]] = level;
+            maxLevel = std::max(maxLevel, level);
+        }
+        if (!isSorted)
+        {
+            addWarningMessage("Could not group components by type, simulating them in sorted order instead");
+            levelMap.clear();
+            for (size_t c=0; c<rComponents.size(); ++c)
+            {
+                levelMap[rComponents[c]] = c;
+            }
+            maxLevel = rComponents.size();
         }
 
-        //Q components
-        for (size_t q=0; q < mComponentQptrs.size(); ++q)
+        std::vector< std::vector<Component*> > levelComponents(maxLevel+1);
+        for (size_t c=0; c<rComponents.size(); ++c)
         {
-            mComponentQptrs[q]->simulate(mTime);
+            levelComponents[levelMap[rComponents[c]]].push_back(rComponents[c]);
         }
 
-        ++mTotalTakenSimulationSteps;
+        // Within each level, group components with the same batch function, in order of first appearance
+        for (size_t level=0; level<levelComponents.size(); ++level)
+        {
+            std::vector<Component::SimulateBatchFunctionT> levelFunctions;
+            std::vector< std::vector<Component*> > levelGroups;
+            for (size_t c=0; c<levelComponents[level].size(); ++c)
+            {
+                Component *pComponent = levelComponents[level][c];
+                // Multi-rate components are simulated on their own, so that their outputs can be extrapolated between their steps
+                Component::SimulateBatchFunctionT pFunction = (pComponent->getStepMultiple() == 1) ? pComponent->getSimulateBatchFunction() : 0;
+                size_t g=levelFunctions.size();
+                if (pFunction)
+                {
+                    g = std::find(levelFunctions.begin(), levelFunctions.end(), pFunction) - levelFunctions.begin();
+                }
+                if (g == levelFunctions.size())
+                {
+                    levelFunctions.push_back(pFunction);
+                    levelGroups.push_back(std::vector<Component*>());
+                }
+                levelGroups[g].push_back(pComponent);
+            }
 
-        logTimeAndNodes(mTotalTakenSimulationSteps);
+            for (size_t g=0; g<levelGroups.size(); ++g)
+            {
+                ComponentBatch batch;
+                batch.mpSimulateBatch = levelFunctions[g];
+                batch.mOffset = rSchedule.mComponentPtrs.size();
+                batch.mSize = levelGroups[g].size();
+                rSchedule.mBatches.push_back(batch);
+                rSchedule.mComponentPtrs.insert(rSchedule.mComponentPtrs.end(), levelGroups[g].begin(), levelGroups[g].end());
+                if (batch.mpSimulateBatch)
+                {
+                    nBatchedComponents += batch.mSize;
+                    ++nBatches;
+                }
+            }
+        }
     }
+
+    addDebugMessage("Type-batched simulation: "+to_hstring(nBatchedComponents)+" components grouped into "+to_hstring(nBatches)+" batches");
 }
 
+//! @brief Move the data values of all sub nodes into one contiguous, cache line aligned, memory block
+//! @details Nodes are placed in the order that the sorted C, Q and signal components access them through their ports.
+//! Nodes that are not reached that way are placed last.
+void ComponentSystem::setupNodeDataArena()
+{
+    releaseNodeDataArena();
+
+    std::vector<Component*> *componentVectors[3] = {&mComponentCptrs, &mComponentQptrs, &mComponentSignalptrs};
+    std::vector<Node*> orderedNodes;
+    std::set<Node*> addedNodes;
+    for (size_t v=0; v<3; ++v)
+    {
+        for (size_t c=0; c<componentVectors[v]->size(); ++c)
+        {
+            std::vector<Port*> ports = componentVectors[v]->at(c)->getPortPtrVector();
+            for (size_t p=0; p<ports.size(); ++p)
+            {
+                const size_t nSubPorts = ports[p]->isMultiPort() ? ports[p]->getNumPorts() : 1;
+                for (size_t sp=0; sp<nSubPorts; ++sp)
+                {
+                    Node *pNode = ports[p]->getNodePtr(sp);
+                    if (pNode && (pNode->getOwnerSystem() == this) && addedNodes.insert(pNode).second)
+                    {
+                        orderedNodes.push_back(pNode);
+                    }
+                }
+            }
+        }
+    }
+    for (size_t n=0; n<mSubNodePtrs.size(); ++n)
+    {
+        if (addedNodes.insert(mSubNodePtrs[n]).second)
+        {
+            orderedNodes.push_back(mSubNodePtrs[n]);
+        }
+    }
+
+    // Allocate one extra cache line so that the first value can be aligned
+    const size_t cacheLineLength = 64/sizeof(double);
+    size_t nValues = 0;
+    for (size_t n=0; n<orderedNodes.size(); ++n)
+    {
+        nValues += orderedNodes[n]->getNumDataVariables();
+    }
+    mNodeDataArena.assign(nValues+cacheLineLength, 0.0);
+    const size_t misalignment = (reinterpret_cast<size_t>(&mNodeDataArena[0]) % 64)/sizeof(double);
+    size_t offset = misalignment ? cacheLineLength-misalignment : 0;
+
+    for (size_t n=0; n<orderedNodes.size(); ++n)
+    {
+        orderedNodes[n]->attachDataValues(&mNodeDataArena[offset]);
+        offset += orderedNodes[n]->getNumDataVariables();
+    }
+    mNodeDataArenaNodePtrs.swap(orderedNodes);
+
+    addDebugMessage("Node data arena: "+to_hstring(mNodeDataArenaNodePtrs.size())+" nodes with "+to_hstring(nValues)+" values");
+}
+
+
+//! @brief Copy the node data values back from the node data arena into the nodes and free the arena
+void ComponentSystem::releaseNodeDataArena()
+{
+    for (size_t n=0; n<mNodeDataArenaNodePtrs.size(); ++n)
+    {
+        mNodeDataArenaNodePtrs[n]->detachDataValues();
+    }
+    mNodeDataArenaNodePtrs.clear();
+    std::vector<double>().swap(mNodeDataArena);
+}
+
+
+//! @brief Move the data values of the nodes owned by one partition (in the clustered algorithm) into memory allocated by the calling thread
+//! @details This is called from the thread that will simulate the partition, so that the memory is first touched (and placed) by that thread
+//! @param threadID The partition (thread) index
+void ComponentSystem::setupPartitionNodeData(const size_t threadID)
+{
+    const std::vector<Node*> &rNodes = mpMultiThreadPrivates->mSplitNodeVector[threadID];
+    size_t nValues = 0;
+    for (size_t n=0; n<rNodes.size(); ++n)
+    {
+        nValues += rNodes[n]->getNumDataVariables();
+    }
+
+    std::vector<double> &rData = mpMultiThreadPrivates->mPartitionNodeData[threadID];
+    rData.assign(nValues, 0.0);
+    size_t offset = 0;
+    for (size_t n=0; n<rNodes.size(); ++n)
+    {
+        rNodes[n]->attachDataValues(&rData[offset]);
+        offset += rNodes[n]->getNumDataVariables();
+    }
+    mpMultiThreadPrivates->mPartitionNodeDataNodePtrs[threadID] = rNodes;
+}
+
+
+//! @brief Copy the node data values back from the partition node data into the nodes and free it
+void ComponentSystem::releasePartitionNodeData()
+{
+    for (size_t t=0; t<mpMultiThreadPrivates->mPartitionNodeDataNodePtrs.size(); ++t)
+    {
+        const std::vector<double> &rData = mpMultiThreadPrivates->mPartitionNodeData[t];
+        const std::vector<Node*> &rNodes = mpMultiThreadPrivates->mPartitionNodeDataNodePtrs[t];
+        for (size_t n=0; n<rNodes.size(); ++n)
+        {
+            // Only detach nodes that still use the partition data (not the node data arena)
+            if (!rData.empty() && (rNodes[n]->mpDataValues >= &rData.front()) && (rNodes[n]->mpDataValues <= &rData.back()))
+            {
+                rNodes[n]->detachDataValues();
+            }
+        }
+    }
+    mpMultiThreadPrivates->mPartitionNodeDataNodePtrs.clear();
+    mpMultiThreadPrivates->mPartitionNodeData.clear();
+}
+
+
 bool ComponentSystem::startRealtimeSimulation(double realTimeFactor)
 {
 #if defined(HOPSANCORE_USEMULTITHREADING)
@@ -3434,6 +4644,18 @@ void ComponentSystem::finalize()
         mComponentSignalptrs.push_back(mDisabledSptrs.at(i));
     }
     mDisabledSptrs.clear();
+
+    // Submit the remaining log samples, they are also kept in memory so that the final values are still available
+    if (mpLogDataSink)
+    {
+        streamLogData();
+        mnStreamedLogSamples += mLogCtr;
+        mLogStreamColumnPtrs.clear();
+    }
+
+    // Give the node data values back to the nodes, so that they can be read after the simulation
+    releaseNodeDataArena();
+    releasePartitionNodeData();
 }
 
 ////! @brief This function will set the number of log data slots for preallocation and logDt based on a skip factor to the sample time
@@ -3498,6 +4720,7 @@ void ComponentSystem::disableLog()
     //mLastLogTime = 0.0; //Initial value should not matter, will be overwritten when selecting log amount
     mnLogSlots = 0;
     mLogCtr = 0;
+    publishNumLoggedSamples();
 }
 
 vector<double> *ComponentSystem::getLogTimeVector()
@@ -34,6 +34,7 @@
 //#include <iostream>
 //#include <cassert>
 #include "ComponentUtilities/DoubleIntegratorWithDamping.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 using namespace hopsan;
 
@@ -104,3 +105,23 @@ double DoubleIntegratorWithDamping::valueSecond()
 {
     return mDelayY;
 }
+
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void DoubleIntegratorWithDamping::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mDelayU);
+    rBuffer.write(mDelayY);
+    rBuffer.write(mDelaySY);
+    rBuffer.write(mDelayUbackup);
+    rBuffer.write(mDelayYbackup);
+    rBuffer.write(mDelaySYbackup);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool DoubleIntegratorWithDamping::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mDelayU) && rBuffer.read(mDelayY) && rBuffer.read(mDelaySY) && rBuffer.read(mDelayUbackup) && rBuffer.read(mDelayYbackup) && rBuffer.read(mDelaySYbackup);
+}
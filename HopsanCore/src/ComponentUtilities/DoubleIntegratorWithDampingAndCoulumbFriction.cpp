@@ -33,6 +33,7 @@
 //$Id$
 
 #include "ComponentUtilities/DoubleIntegratorWithDampingAndCoulumbFriction.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 using namespace hopsan;
 
@@ -171,3 +172,24 @@ double DoubleIntegratorWithDampingAndCoulombFriction::valueSecond()
 {
     return mDelayY;
 }
+
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void DoubleIntegratorWithDampingAndCoulombFriction::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mDelayU);
+    rBuffer.write(mDelayY);
+    rBuffer.write(mDelaySY);
+    rBuffer.write(mDelayUbackup);
+    rBuffer.write(mDelayYbackup);
+    rBuffer.write(mDelaySYbackup);
+    rBuffer.write(movement);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool DoubleIntegratorWithDampingAndCoulombFriction::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mDelayU) && rBuffer.read(mDelayY) && rBuffer.read(mDelaySY) && rBuffer.read(mDelayUbackup) && rBuffer.read(mDelayYbackup) && rBuffer.read(mDelaySYbackup) && rBuffer.read(movement);
+}
@@ -34,6 +34,7 @@
 //#include <iostream>
 #include <algorithm>
 #include "ComponentUtilities/FirstOrderTransferFunction.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 using namespace hopsan;
 
@@ -221,6 +222,26 @@ bool FirstOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void FirstOrderTransferFunction::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mValue);
+    rBuffer.write(mDelayedU);
+    rBuffer.write(mDelayedY);
+    rBuffer.write(mIsSaturated);
+    mBackupU.saveState(rBuffer);
+    mBackupY.saveState(rBuffer);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool FirstOrderTransferFunction::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mValue) && rBuffer.read(mDelayedU) && rBuffer.read(mDelayedY) && rBuffer.read(mIsSaturated) && mBackupU.restoreState(rBuffer) && mBackupY.restoreState(rBuffer);
+}
+
 
 
 
@@ -338,6 +359,23 @@ double FirstOrderTransferFunctionVariable::value()
     return mValue;
 }
 
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void FirstOrderTransferFunctionVariable::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mValue);
+    rBuffer.write(mDelayU);
+    rBuffer.write(mDelayY);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool FirstOrderTransferFunctionVariable::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mValue) && rBuffer.read(mDelayU) && rBuffer.read(mDelayY);
+}
+
 
 //! @class hopsan::FirstOrderLowPassFilter
 //! @ingroup ComponentUtilityClasses
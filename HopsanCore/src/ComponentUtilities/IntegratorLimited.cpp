@@ -36,6 +36,7 @@
 //#include <math.h>
 #include <algorithm>
 #include "ComponentUtilities/IntegratorLimited.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 using namespace hopsan;
 
@@ -126,3 +127,19 @@ double IntegratorLimited::value()
 {
     return mDelayY;
 }
+
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void IntegratorLimited::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mDelayU);
+    rBuffer.write(mDelayY);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool IntegratorLimited::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mDelayU) && rBuffer.read(mDelayY);
+}
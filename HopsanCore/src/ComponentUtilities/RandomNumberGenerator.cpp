@@ -0,0 +1,309 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   RandomNumberGenerator.cpp
+//!
+//! @brief Contains a counter-based random number generator for use in components
+//!
+//$Id$
+
+#include "ComponentUtilities/RandomNumberGenerator.h"
+#include "ComponentSystem.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
+#include <algorithm>
+#include <vector>
+// For MSVC we need this define to get access to M_PI
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+using namespace hopsan;
+
+namespace {
+
+// Philox4x32 constants (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+const uint32_t PhiloxM0 = 0xD2511F53;
+const uint32_t PhiloxM1 = 0xCD9E8D57;
+const uint32_t PhiloxW0 = 0x9E3779B9;
+const uint32_t PhiloxW1 = 0xBB67AE85;
+
+// Number of blocks generated together, the loops over a chunk are written so that they can be vectorized
+const size_t ChunkSize = 8;
+
+//! @brief Generate one chunk of Philox4x32-10 blocks, each block gives four 32-bit values
+void philoxChunk(const uint32_t key[2], const uint64_t firstBlock, uint32_t c0[ChunkSize], uint32_t c1[ChunkSize], uint32_t c2[ChunkSize], uint32_t c3[ChunkSize])
+{
+    for (size_t j=0; j<ChunkSize; ++j)
+    {
+        const uint64_t counter = firstBlock+j;
+        c0[j] = static_cast<uint32_t>(counter);
+        c1[j] = static_cast<uint32_t>(counter >> 32);
+        c2[j] = 0;
+        c3[j] = 0;
+    }
+
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int r=0; r<10; ++r)
+    {
+        for (size_t j=0; j<ChunkSize; ++j)
+        {
+            const uint64_t p0 = static_cast<uint64_t>(PhiloxM0)*c0[j];
+            const uint64_t p1 = static_cast<uint64_t>(PhiloxM1)*c2[j];
+            const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[j] ^ k0;
+            const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[j] ^ k1;
+            c1[j] = static_cast<uint32_t>(p1);
+            c3[j] = static_cast<uint32_t>(p0);
+            c0[j] = n0;
+            c2[j] = n2;
+        }
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+}
+
+//! @brief Convert two 32-bit values to a double with 53 random bits, in the open interval (0,1)
+inline double toOpenUnitInterval(const uint32_t a, const uint32_t b)
+{
+    return ((a >> 5)*67108864.0 + (b >> 6) + 0.5)*(1.0/9007199254740992.0);
+}
+
+//! @brief Mix function from splitmix64, used to spread seeds
+inline uint64_t mixBits(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27))*0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+//! @brief Constructor
+//! @param[in] seed The seed for the random number stream
+RandomNumberGenerator::RandomNumberGenerator(const uint64_t seed)
+{
+    setSeed(seed);
+}
+
+//! @brief Set the seed and restart the random number stream
+//! @param[in] seed The seed
+void RandomNumberGenerator::setSeed(const uint64_t seed)
+{
+    mSeed = seed;
+    mKey[0] = static_cast<uint32_t>(seed);
+    mKey[1] = static_cast<uint32_t>(seed >> 32);
+    mNextBlock = 0;
+    mBufferBlock = 0;
+    mBufferPos = BufferSize;
+    mBufferContent = EmptyBuffer;
+}
+
+//! @brief Set the seed from the random seed of the system and the name path of a component, and restart the random number stream
+//! @param[in] pComponent The component that owns this generator
+void RandomNumberGenerator::setSeed(const Component *pComponent)
+{
+    setSeed(getComponentSeed(pComponent));
+}
+
+uint64_t RandomNumberGenerator::getSeed() const
+{
+    return mSeed;
+}
+
+//! @brief Returns the next uniformly distributed value in the open interval (0,1)
+double RandomNumberGenerator::uniform()
+{
+    if (mBufferContent != UniformBuffer || mBufferPos >= BufferSize)
+    {
+        refillBuffer(UniformBuffer);
+    }
+    return mBuffer[mBufferPos++];
+}
+
+//! @brief Returns the next normally distributed value, with mean 0 and standard deviation 1
+double RandomNumberGenerator::gaussian()
+{
+    if (mBufferContent != GaussianBuffer || mBufferPos >= BufferSize)
+    {
+        refillBuffer(GaussianBuffer);
+    }
+    return mBuffer[mBufferPos++];
+}
+
+//! @brief Fill an array with uniformly distributed values in the open interval (0,1)
+//! @param[out] pData The array to fill
+//! @param[in] n The number of values to generate
+void RandomNumberGenerator::fillUniform(double *pData, const size_t n)
+{
+    generateUniform(mNextBlock, pData, n);
+    mNextBlock += (n+1)/2;
+}
+
+//! @brief Fill an array with normally distributed values, with mean 0 and standard deviation 1
+//! @param[out] pData The array to fill
+//! @param[in] n The number of values to generate
+void RandomNumberGenerator::fillGaussian(double *pData, const size_t n)
+{
+    generateGaussian(mNextBlock, pData, n);
+    mNextBlock += (n+1)/2;
+}
+
+//! @brief Save the position in the random number stream
+void RandomNumberGenerator::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mSeed);
+    rBuffer.write(mNextBlock);
+    rBuffer.write(mBufferBlock);
+    rBuffer.write(mBufferPos);
+    rBuffer.write(static_cast<int>(mBufferContent));
+}
+
+//! @brief Restore a position in the random number stream saved by saveState()
+//! @returns True if successful
+bool RandomNumberGenerator::restoreState(SimulationStateBuffer &rBuffer)
+{
+    uint64_t seed, nextBlock, bufferBlock;
+    size_t bufferPos;
+    int bufferContent;
+    if (!(rBuffer.read(seed) && rBuffer.read(nextBlock) && rBuffer.read(bufferBlock) && rBuffer.read(bufferPos) && rBuffer.read(bufferContent)))
+    {
+        return false;
+    }
+
+    setSeed(seed);
+    mNextBlock = nextBlock;
+    mBufferBlock = bufferBlock;
+    mBufferPos = std::min<size_t>(bufferPos, BufferSize);
+    mBufferContent = static_cast<BufferContentT>(bufferContent);
+    // The buffered values are regenerated instead of being saved
+    if (mBufferContent == UniformBuffer)
+    {
+        generateUniform(mBufferBlock, mBuffer, BufferSize);
+    }
+    else if (mBufferContent == GaussianBuffer)
+    {
+        generateGaussian(mBufferBlock, mBuffer, BufferSize);
+    }
+    else
+    {
+        mBufferContent = EmptyBuffer;
+        mBufferPos = BufferSize;
+    }
+    return true;
+}
+
+//! @brief Derive a new seed from a seed and a name
+//! @param[in] seed The parent seed
+//! @param[in] rName The name
+//! @returns The derived seed
+uint64_t RandomNumberGenerator::deriveSeed(const uint64_t seed, const HString &rName)
+{
+    // FNV-1a hash of the name
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i=0; i<rName.size(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(rName[i]);
+        hash *= 0x100000001B3ULL;
+    }
+    return mixBits(mixBits(seed) ^ hash);
+}
+
+//! @brief Returns the seed for a component, derived from the random seed of its system and the names down to the component
+//! @details Systems that inherit their random seed only contribute with their name, so a component gets the same seed
+//! regardless of how many copies of the model there are or in what order components are simulated.
+//! @param[in] pComponent The component
+//! @returns The seed
+uint64_t RandomNumberGenerator::getComponentSeed(const Component *pComponent)
+{
+    std::vector<const Component*> path;
+    path.push_back(pComponent);
+    ComponentSystem *pSystem = pComponent->getSystemParent();
+    while (pSystem && pSystem->doesInheritRandomSeed() && pSystem->getSystemParent())
+    {
+        path.push_back(pSystem);
+        pSystem = pSystem->getSystemParent();
+    }
+
+    uint64_t seed = pSystem ? pSystem->getRandomSeed() : 0;
+    for (std::vector<const Component*>::reverse_iterator it=path.rbegin(); it!=path.rend(); ++it)
+    {
+        seed = deriveSeed(seed, (*it)->getName());
+    }
+    return seed;
+}
+
+void RandomNumberGenerator::generateUniform(const uint64_t firstBlock, double *pData, const size_t n) const
+{
+    const size_t nBlocks = (n+1)/2;
+    uint32_t c0[ChunkSize], c1[ChunkSize], c2[ChunkSize], c3[ChunkSize];
+    for (size_t b=0; b<nBlocks; b+=ChunkSize)
+    {
+        philoxChunk(mKey, firstBlock+b, c0, c1, c2, c3);
+        const size_t nChunkBlocks = std::min(ChunkSize, nBlocks-b);
+        for (size_t j=0; j<nChunkBlocks; ++j)
+        {
+            const size_t i = 2*(b+j);
+            pData[i] = toOpenUnitInterval(c0[j], c1[j]);
+            if (i+1 < n)
+            {
+                pData[i+1] = toOpenUnitInterval(c2[j], c3[j]);
+            }
+        }
+    }
+}
+
+void RandomNumberGenerator::generateGaussian(const uint64_t firstBlock, double *pData, const size_t n) const
+{
+    // Box-Muller transform, each pair of uniform values gives two normally distributed values
+    const size_t nEven = n - n%2;
+    generateUniform(firstBlock, pData, nEven);
+    for (size_t i=0; i<nEven; i+=2)
+    {
+        const double r = sqrt(-2.0*log(pData[i]));
+        const double a = 2.0*M_PI*pData[i+1];
+        pData[i] = r*cos(a);
+        pData[i+1] = r*sin(a);
+    }
+    if (nEven < n)
+    {
+        double u[2];
+        generateUniform(firstBlock+nEven/2, u, 2);
+        pData[nEven] = sqrt(-2.0*log(u[0]))*cos(2.0*M_PI*u[1]);
+    }
+}
+
+void RandomNumberGenerator::refillBuffer(const BufferContentT content)
+{
+    mBufferBlock = mNextBlock;
+    if (content == UniformBuffer)
+    {
+        fillUniform(mBuffer, BufferSize);
+    }
+    else
+    {
+        fillGaussian(mBuffer, BufferSize);
+    }
+    mBufferContent = content;
+    mBufferPos = 0;
+}
@@ -35,6 +35,7 @@
 //#include <cassert>
 #include <algorithm>
 #include "ComponentUtilities/SecondOrderTransferFunction.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 
 using namespace hopsan;
 
@@ -244,6 +245,28 @@ bool SecondOrderTransferFunction::isSaturated() const
     return mIsSaturated;
 }
 
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void SecondOrderTransferFunction::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mValue);
+    rBuffer.write(mDelayedU);
+    rBuffer.write(mDelayed2U);
+    rBuffer.write(mDelayedY);
+    rBuffer.write(mDelayed2Y);
+    rBuffer.write(mIsSaturated);
+    mBackupU.saveState(rBuffer);
+    mBackupY.saveState(rBuffer);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool SecondOrderTransferFunction::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mValue) && rBuffer.read(mDelayedU) && rBuffer.read(mDelayed2U) && rBuffer.read(mDelayedY) && rBuffer.read(mDelayed2Y) && rBuffer.read(mIsSaturated) && mBackupU.restoreState(rBuffer) && mBackupY.restoreState(rBuffer);
+}
+
 
 
 
@@ -354,6 +377,23 @@ double SecondOrderTransferFunctionVariable::value()
     return mValue;
 }
 
+//! @brief Save the internal state to a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to write to
+void SecondOrderTransferFunctionVariable::saveState(SimulationStateBuffer &rBuffer) const
+{
+    rBuffer.write(mValue);
+    rBuffer.write(mDelayU);
+    rBuffer.write(mDelayY);
+}
+
+//! @brief Restore the internal state from a simulation state buffer
+//! @param [in,out] rBuffer The state buffer to read from
+//! @returns True if successful
+bool SecondOrderTransferFunctionVariable::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return rBuffer.read(mValue) && rBuffer.read(mDelayU) && rBuffer.read(mDelayY);
+}
+
 void SecondOrderTransferFunctionVariable::recalculateCoefficients()
 {
     mCoeffU[0] = mNum[0]*(*mpTimeStep)*(*mpTimeStep) + 2.0*mNum[1]*(*mpTimeStep) + 4.0*mNum[2];
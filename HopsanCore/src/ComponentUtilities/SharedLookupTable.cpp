@@ -0,0 +1,117 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+//!
+//! @file   SharedLookupTable.cpp
+//!
+//! @brief Contains the lookup table source identification used by the shared lookup table
+//!
+//$Id$
+
+#include "ComponentUtilities/SharedLookupTable.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+using namespace hopsan;
+
+namespace {
+
+//! @brief Get the modification time (in nanoseconds where available) and size of a file
+//! @returns false if the file does not exist
+bool getFileTimeAndSize(const HString &rFilePath, long long &rModificationTime, long long &rFileSize)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(rFilePath.c_str(), &st) != 0)
+    {
+        return false;
+    }
+    rModificationTime = static_cast<long long>(st.st_mtime)*1000000000LL;
+#else
+    struct stat st;
+    if (stat(rFilePath.c_str(), &st) != 0)
+    {
+        return false;
+    }
+#ifdef __linux__
+    rModificationTime = static_cast<long long>(st.st_mtim.tv_sec)*1000000000LL + st.st_mtim.tv_nsec;
+#else
+    rModificationTime = static_cast<long long>(st.st_mtime)*1000000000LL;
+#endif
+#endif
+    rFileSize = static_cast<long long>(st.st_size);
+    return true;
+}
+
+}
+
+LookupTableSource::LookupTableSource()
+    : mIsFile(false), mModificationTime(-1), mFileSize(-1)
+{
+}
+
+//! @brief Identify a lookup table parsed from a file
+//! @param[in] rFilePath The absolute path to the file
+//! @param[in] rSettings The parse settings, tables parsed with different settings never match
+LookupTableSource LookupTableSource::fromFile(const HString &rFilePath, const HString &rSettings)
+{
+    LookupTableSource source;
+    source.mIsFile = true;
+    source.mFilePathOrText = rFilePath;
+    source.mSettings = rSettings;
+    if (!getFileTimeAndSize(rFilePath, source.mModificationTime, source.mFileSize))
+    {
+        source.mModificationTime = -1;
+        source.mFileSize = -1;
+    }
+    return source;
+}
+
+//! @brief Identify a lookup table parsed from text
+//! @param[in] rText The text
+//! @param[in] rSettings The parse settings, tables parsed with different settings never match
+LookupTableSource LookupTableSource::fromText(const HString &rText, const HString &rSettings)
+{
+    LookupTableSource source;
+    source.mFilePathOrText = rText;
+    source.mSettings = rSettings;
+    source.mModificationTime = 0;
+    source.mFileSize = 0;
+    return source;
+}
+
+//! @brief Check if the source exists, a file that could not be found never matches any other source
+bool LookupTableSource::isValid() const
+{
+    return (mModificationTime >= 0);
+}
+
+bool LookupTableSource::operator==(const LookupTableSource &rOther) const
+{
+    return (mIsFile == rOther.mIsFile) &&
+           (mModificationTime == rOther.mModificationTime) &&
+           (mFileSize == rOther.mFileSize) &&
+           (mSettings == rOther.mSettings) &&
+           (mFilePathOrText == rOther.mFilePathOrText);
+}
@@ -32,22 +32,47 @@
 //$Id$
 
 #include "ComponentUtilities/WhiteGaussianNoise.h"
-#include <stdlib.h>
-// For MSVC we need this define to get access to M_PI
-#define _USE_MATH_DEFINES
-#include <cmath>
 
 
 using namespace hopsan;
 
+//! @brief Returns a value from a noise stream shared by all users in the same thread
 double WhiteGaussianNoise::getValue()
 {
-    // Calc Gaussian random value
-     double random1 = 0;
-     while(random1 == 0)
-     {
-        random1 = (double)rand() / (double)RAND_MAX;
-     }
-     double random2 = (double)rand() / (double)RAND_MAX;
-     return sqrt((-2.0)*log(random1))*cos(2.0*M_PI*random2);
+    thread_local RandomNumberGenerator generator;
+    return generator.gaussian();
+}
+
+//! @brief Set the seed and restart the noise stream
+void WhiteGaussianNoise::setSeed(const uint64_t seed)
+{
+    mGenerator.setSeed(seed);
+}
+
+//! @brief Set the seed from the random seed of the system and the name path of a component, and restart the noise stream
+void WhiteGaussianNoise::setSeed(const Component *pComponent)
+{
+    mGenerator.setSeed(pComponent);
+}
+
+//! @brief Returns the next value in the noise stream
+double WhiteGaussianNoise::nextValue()
+{
+    return mGenerator.gaussian();
+}
+
+//! @brief Fill an array with the next values in the noise stream
+void WhiteGaussianNoise::fillValues(double *pData, const size_t n)
+{
+    mGenerator.fillGaussian(pData, n);
+}
+
+void WhiteGaussianNoise::saveState(SimulationStateBuffer &rBuffer) const
+{
+    mGenerator.saveState(rBuffer);
+}
+
+bool WhiteGaussianNoise::restoreState(SimulationStateBuffer &rBuffer)
+{
+    return mGenerator.restoreState(rBuffer);
 }
@@ -34,6 +34,8 @@
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include "CoreUtilities/HmfLoader.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/NumHopHelper.h"
@@ -555,6 +557,20 @@ void hopsan::autoPrependSelfToEmbeddedInitScript(ComponentSystem* pSystem) {
 }
 
 
+//! @brief This help function loads the step multiple and rate boundary mode of a component or subsystem
+void loadMultiRateSettings(rapidxml::xml_node<> *pObjectNode, Component* pComponent)
+{
+    pComponent->setStepMultiple(size_t(std::max(readIntAttribute(pObjectNode, "stepmultiple", 1), 1)));
+    if (readStringAttribute(pObjectNode, "rateboundary", "hold") == "extrapolate")
+    {
+        pComponent->setRateBoundaryMode(Component::ExtrapolateOutputs);
+    }
+    else
+    {
+        pComponent->setRateBoundaryMode(Component::HoldOutputs);
+    }
+}
+
 //! @brief This help function loads a component
 void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSystem, HopsanEssentials *pHopsanEssentials)
 {
@@ -570,6 +586,7 @@ void loadComponent(rapidxml::xml_node<> *pComponentNode, ComponentSystem* pSyste
         pComp->setName(displayName);
         pComp->setSubTypeName(subTypeName.c_str());
         pComp->setDisabled(disabled);
+        loadMultiRateSettings(pComponentNode, pComp);
         pSystem->addComponent(pComp);
 
         // Load parameters
@@ -735,6 +752,11 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
     double Ts = readDoubleAttribute(pSimtimeNode, "timestep", 0.001);
     pSystem->setDesiredTimestep(Ts);
     pSystem->setInheritTimestep(readBoolAttribute(pSimtimeNode,"inherit_timestep",true));
+    if (hasAttribute(pSimtimeNode, "randomseed"))
+    {
+        pSystem->setRandomSeed(strtoull(readStringAttribute(pSimtimeNode, "randomseed", "0").c_str(), 0, 10));
+        pSystem->setInheritRandomSeed(readBoolAttribute(pSimtimeNode, "inherit_randomseed", false));
+    }
 
     // Load number of log samples
     rapidxml::xml_node<> *pLogSettingsNode = pSysNode->first_node("simulationlogsettings");
@@ -813,6 +835,10 @@ void loadSystemContents(rapidxml::xml_node<> *pSysNode, ComponentSystem* pSystem
                     // Load system contents
                     loadSystemContents(pObject, pSys, pHopsanEssentials, rootFilePath);
                 }
+                if (pSys != 0)
+                {
+                    loadMultiRateSettings(pObject, pSys);
+                }
             }
             else if (strcmp(pObject->name(), "systemport")==0)
             {
@@ -0,0 +1,420 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   LogDataSink.cpp
+//!
+//! @brief Contains the log data sink classes used to stream log data to file during simulation
+//!
+//$Id$
+
+#include <deque>
+#include <algorithm>
+#include <stdint.h>
+
+#include "CoreUtilities/LogDataSink.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
+
+using namespace hopsan;
+
+namespace hopsan {
+
+//! @brief Private data for the LogDataSink class
+class LogDataSinkPrivates
+{
+public:
+    //! @brief A queued request to the writer, either to open a stream or to write a chunk
+    class Request
+    {
+    public:
+        size_t streamId;
+        HString systemHierarchy;
+        std::vector<LogSinkVariable> variables;
+        LogDataChunk *pChunk;
+    };
+
+    LogDataSinkPrivates() :
+        chunkSize(4096), maxQueuedChunks(4), nStreams(0), nQueuedChunks(0),
+        failed(false), writerRunning(false), stopRequested(false) {}
+
+    void recycleChunk(LogDataChunk *pChunk)
+    {
+        freeChunks.push_back(pChunk);
+    }
+
+    std::deque<Request> requests;
+    std::vector<LogDataChunk*> freeChunks;
+    size_t chunkSize, maxQueuedChunks, nStreams, nQueuedChunks;
+    bool failed, writerRunning, stopRequested;
+    HString lastError;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::mutex mutex;
+    std::condition_variable requestAvailable;
+    std::condition_variable requestDone;
+    std::thread writer;
+#endif
+};
+
+}
+
+LogDataSink::LogDataSink()
+{
+    mpPrivates = new LogDataSinkPrivates();
+}
+
+//! @brief Destructor
+//! @note Sub classes must call finish() in their destructor, as the writer thread calls their virtual functions
+LogDataSink::~LogDataSink()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    if (mpPrivates->writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+            mpPrivates->stopRequested = true;
+        }
+        mpPrivates->requestAvailable.notify_all();
+        mpPrivates->writer.join();
+    }
+#endif
+    for (size_t i=0; i<mpPrivates->freeChunks.size(); ++i)
+    {
+        delete mpPrivates->freeChunks[i];
+    }
+    for (size_t i=0; i<mpPrivates->requests.size(); ++i)
+    {
+        delete mpPrivates->requests[i].pChunk;
+    }
+    delete mpPrivates;
+}
+
+//! @brief Set the number of log samples in each chunk
+//! @details Should be set before any stream is registered, systems use the chunk size as their in-memory log buffer size
+//! @param [in] nSamples The number of samples per chunk
+void LogDataSink::setChunkSize(const size_t nSamples)
+{
+    mpPrivates->chunkSize = std::max(nSamples, size_t(1));
+}
+
+//! @brief Returns the number of log samples in each chunk
+size_t LogDataSink::getChunkSize() const
+{
+    return mpPrivates->chunkSize;
+}
+
+//! @brief Set how many chunks may wait in the write queue before submitChunk blocks
+//! @param [in] nChunks The maximum number of queued chunks
+void LogDataSink::setMaxQueuedChunks(const size_t nChunks)
+{
+    mpPrivates->maxQueuedChunks = std::max(nChunks, size_t(1));
+}
+
+//! @brief Register a new stream of log data, the writer thread is started on the first registration
+//! @param [in] rSystemHierarchy The subsystem hierarchy, separated by ".", empty for the top-level system
+//! @param [in] rVariables The variables in the stream
+//! @returns The id of the new stream, used in the chunks submitted to it
+size_t LogDataSink::registerStream(const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables)
+{
+    LogDataSinkPrivates::Request request;
+    request.systemHierarchy = rSystemHierarchy;
+    request.variables = rVariables;
+    request.pChunk = 0;
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    {
+        std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+        request.streamId = mpPrivates->nStreams++;
+        mpPrivates->requests.push_back(request);
+        if (!mpPrivates->writerRunning)
+        {
+            mpPrivates->stopRequested = false;
+            mpPrivates->writerRunning = true;
+            mpPrivates->writer = std::thread(&LogDataSink::processRequests, this);
+        }
+    }
+    mpPrivates->requestAvailable.notify_one();
+#else
+    request.streamId = mpPrivates->nStreams++;
+    if (!mpPrivates->failed && !openStream(request.streamId, request.systemHierarchy, request.variables))
+    {
+        mpPrivates->failed = true;
+    }
+#endif
+    return request.streamId;
+}
+
+//! @brief Get an empty chunk to fill with log data, chunks that have been written are reused
+//! @returns A chunk, owned by the caller until it is submitted
+LogDataChunk *LogDataSink::acquireChunk()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+#endif
+    if (mpPrivates->freeChunks.empty())
+    {
+        return new LogDataChunk();
+    }
+    LogDataChunk *pChunk = mpPrivates->freeChunks.back();
+    mpPrivates->freeChunks.pop_back();
+    return pChunk;
+}
+
+//! @brief Submit a chunk to be written, blocks if the maximum number of chunks are already queued
+//! @details If the sink has failed, the chunk is discarded
+//! @param [in] pChunk The chunk, ownership is taken by the sink
+void LogDataSink::submitChunk(LogDataChunk *pChunk)
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    {
+        std::unique_lock<std::mutex> lock(mpPrivates->mutex);
+        if (mpPrivates->failed || !mpPrivates->writerRunning)
+        {
+            mpPrivates->recycleChunk(pChunk);
+            return;
+        }
+        LogDataSinkPrivates *pPrivates = mpPrivates;
+        mpPrivates->requestDone.wait(lock, [pPrivates](){return pPrivates->nQueuedChunks < pPrivates->maxQueuedChunks;});
+
+        LogDataSinkPrivates::Request request;
+        request.streamId = pChunk->streamId;
+        request.pChunk = pChunk;
+        mpPrivates->requests.push_back(request);
+        ++mpPrivates->nQueuedChunks;
+    }
+    mpPrivates->requestAvailable.notify_one();
+#else
+    if (!mpPrivates->failed && !writeChunk(*pChunk))
+    {
+        mpPrivates->failed = true;
+    }
+    mpPrivates->recycleChunk(pChunk);
+#endif
+}
+
+//! @brief Write all queued chunks, stop the writer thread and close the output file
+//! @details Registering a new stream after this will reopen the output file in append mode
+//! @returns True if all data was written successfully
+bool LogDataSink::finish()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    if (mpPrivates->writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+            mpPrivates->stopRequested = true;
+        }
+        mpPrivates->requestAvailable.notify_all();
+        mpPrivates->writer.join();
+        std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+        mpPrivates->writerRunning = false;
+    }
+#endif
+    if (!close())
+    {
+        mpPrivates->failed = true;
+    }
+    return !mpPrivates->failed;
+}
+
+//! @brief Check if writing has failed, any further data will be discarded
+bool LogDataSink::hasFailed() const
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+#endif
+    return mpPrivates->failed;
+}
+
+//! @brief Returns the last error message
+HString LogDataSink::getLastError() const
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+#endif
+    return mpPrivates->lastError;
+}
+
+//! @brief Set the error message, for use by sub classes when a write fails
+void LogDataSink::setLastError(const HString &rError)
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    std::lock_guard<std::mutex> lock(mpPrivates->mutex);
+#endif
+    mpPrivates->lastError = rError;
+}
+
+//! @brief The writer thread loop, processes requests in order until stop is requested and the queue is empty
+void LogDataSink::processRequests()
+{
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    LogDataSinkPrivates *pPrivates = mpPrivates;
+    std::unique_lock<std::mutex> lock(pPrivates->mutex);
+    while (true)
+    {
+        pPrivates->requestAvailable.wait(lock, [pPrivates](){return !pPrivates->requests.empty() || pPrivates->stopRequested;});
+        if (pPrivates->requests.empty())
+        {
+            break;
+        }
+
+        LogDataSinkPrivates::Request request = pPrivates->requests.front();
+        pPrivates->requests.pop_front();
+        const bool skip = pPrivates->failed;
+
+        // Write without holding the lock, so that the simulation can fill the next chunk meanwhile
+        lock.unlock();
+        bool success = true;
+        if (!skip)
+        {
+            if (request.pChunk)
+            {
+                success = writeChunk(*request.pChunk);
+            }
+            else
+            {
+                success = openStream(request.streamId, request.systemHierarchy, request.variables);
+            }
+        }
+        lock.lock();
+
+        if (!success)
+        {
+            pPrivates->failed = true;
+        }
+        if (request.pChunk)
+        {
+            pPrivates->recycleChunk(request.pChunk);
+            --pPrivates->nQueuedChunks;
+        }
+        pPrivates->requestDone.notify_all();
+    }
+#endif
+}
+
+
+//! @brief Constructor
+//! @param [in] rFilePath The file to write, it is created (or truncated) when the first stream is registered
+BinaryLogDataSink::BinaryLogDataSink(const HString &rFilePath) :
+    mFilePath(rFilePath), mpFile(0), mHaveCreatedFile(false)
+{
+}
+
+BinaryLogDataSink::~BinaryLogDataSink()
+{
+    finish();
+}
+
+bool BinaryLogDataSink::openStream(const size_t streamId, const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables)
+{
+    if (!openFile())
+    {
+        return false;
+    }
+
+    bool success = writeValue<uint32_t>(1) && writeValue<uint64_t>(streamId) && writeString(rSystemHierarchy) &&
+                   writeValue<uint64_t>(rVariables.size());
+    for (size_t v=0; success && v<rVariables.size(); ++v)
+    {
+        const LogSinkVariable &rVar = rVariables[v];
+        success = writeString(rVar.componentName) && writeString(rVar.portName) && writeString(rVar.variableName) &&
+                  writeString(rVar.alias) && writeString(rVar.unit) && writeString(rVar.quantity);
+    }
+    if (!success)
+    {
+        setLastError("Failed to write stream header to: "+mFilePath);
+    }
+    return success;
+}
+
+bool BinaryLogDataSink::writeChunk(const LogDataChunk &rChunk)
+{
+    if (!mpFile)
+    {
+        setLastError("Log data file is not open: "+mFilePath);
+        return false;
+    }
+
+    bool success = writeValue<uint32_t>(2) && writeValue<uint64_t>(rChunk.streamId) && writeValue<uint64_t>(rChunk.nSamples);
+    if (success && !rChunk.data.empty())
+    {
+        success = (fwrite(&rChunk.data[0], sizeof(double), rChunk.data.size(), mpFile) == rChunk.data.size());
+    }
+    if (!success)
+    {
+        setLastError("Failed to write log data to: "+mFilePath);
+    }
+    return success;
+}
+
+bool BinaryLogDataSink::close()
+{
+    bool success = true;
+    if (mpFile)
+    {
+        success = (fclose(mpFile) == 0);
+        mpFile = 0;
+        if (!success)
+        {
+            setLastError("Failed to close: "+mFilePath);
+        }
+    }
+    return success;
+}
+
+//! @brief Open the output file if it is not already open, the first time it is created, later it is appended
+bool BinaryLogDataSink::openFile()
+{
+    if (mpFile)
+    {
+        return true;
+    }
+
+    mpFile = fopen(mFilePath.c_str(), mHaveCreatedFile ? "ab" : "wb");
+    if (!mpFile)
+    {
+        setLastError("Could not open log data file: "+mFilePath);
+        return false;
+    }
+    if (!mHaveCreatedFile)
+    {
+        mHaveCreatedFile = true;
+        if (fwrite("HOPSLOG1", 1, 8, mpFile) != 8)
+        {
+            setLastError("Failed to write to: "+mFilePath);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BinaryLogDataSink::writeString(const HString &rString)
+{
+    const uint32_t length = uint32_t(rString.size());
+    return writeValue<uint32_t>(length) && (fwrite(rString.c_str(), 1, length, mpFile) == length);
+}
+
+template<typename T>
+bool BinaryLogDataSink::writeValue(const T value)
+{
+    return (fwrite(&value, sizeof(T), 1, mpFile) == 1);
+}
@@ -36,6 +36,16 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
 #if __cplusplus >= 201103L
 #include <mutex>
 #include <chrono>
@@ -86,6 +96,136 @@ size_t determineActualNumberOfThreads(const size_t nDesiredThreads)
 
 #if defined(HOPSANCORE_USEMULTITHREADING)
 
+namespace {
+
+//! @brief Unlocks all barriers, used by the master thread when the simulation is aborted
+void unlockAllBarriers(BarrierLock *pBarrier_S, BarrierLock *pBarrier_C, BarrierLock *pBarrier_Q, BarrierLock *pBarrier_N)
+{
+    if(pBarrier_S)
+    {
+        pBarrier_S->unlock();
+    }
+    pBarrier_C->unlock();
+    pBarrier_Q->unlock();
+    pBarrier_N->unlock();
+}
+
+//! @brief Locks the first barrier in a time step, the S barrier or the C barrier if S and C phases are combined
+void lockFirstBarrier(BarrierLock *pBarrier_S, BarrierLock *pBarrier_C)
+{
+    if(pBarrier_S)
+    {
+        pBarrier_S->lock();
+    }
+    else
+    {
+        pBarrier_C->lock();
+    }
+}
+
+}
+
+void BarrierLock::unlock()
+{
+    mLock = 0;
+    if(mnParked > 0)
+    {
+        wake(&mLock);
+    }
+}
+
+void BarrierLock::increment()
+{
+    const int nArrived = ++mCounter;
+    if((nArrived == mnThreads-1) && mMasterParked)
+    {
+        wake(&mCounter);
+    }
+}
+
+void BarrierLock::arriveAndWait()
+{
+    increment();
+
+    // Spin for a while, in case the other threads are close behind
+    for(size_t i=0; i<mnSpins; ++i)
+    {
+        if(!mLock)
+        {
+            return;
+        }
+    }
+
+    // Park until the master thread unlocks the barrier
+    ++mnParked;
+    while(mLock)
+    {
+        park(&mLock, 1);
+    }
+    --mnParked;
+}
+
+bool BarrierLock::waitForAllArrived(const ComponentSystem *pSystem)
+{
+    // Spin for a while, in case the other threads are close behind
+    for(size_t i=0; i<mnSpins; ++i)
+    {
+        if(allArrived())
+        {
+            return true;
+        }
+        if(pSystem->wasSimulationAborted())
+        {
+            return false;
+        }
+    }
+
+    // Park until the last thread arrives, parking times out regularly so that an aborted simulation is detected
+    mMasterParked = 1;
+    while(!allArrived())
+    {
+        if(pSystem->wasSimulationAborted())
+        {
+            mMasterParked = 0;
+            return false;
+        }
+        park(&mCounter, mCounter);
+    }
+    mMasterParked = 0;
+    return true;
+}
+
+//! @brief Parks the calling thread while pWord has the given value, the wait times out after one millisecond
+void BarrierLock::park(std::atomic<int> *pWord, const int value)
+{
+#if defined(__linux__)
+    struct timespec timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 1000000;
+    syscall(SYS_futex, reinterpret_cast<int*>(pWord), FUTEX_WAIT_PRIVATE, value, &timeout, 0, 0);
+#else
+    std::unique_lock<std::mutex> lock(mParkMutex);
+    if(*pWord == value)
+    {
+        mParkCondition.wait_for(lock, std::chrono::milliseconds(1));
+    }
+#endif
+}
+
+//! @brief Wakes all threads parked on pWord
+void BarrierLock::wake(std::atomic<int> *pWord)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int*>(pWord), FUTEX_WAKE_PRIVATE, std::numeric_limits<int>::max(), 0, 0, 0);
+#else
+    HOPSAN_UNUSED(pWord)
+    {
+        std::lock_guard<std::mutex> lock(mParkMutex);
+    }
+    mParkCondition.notify_all();
+#endif
+}
+
 //! @brief Constructor for slave simulation thread function.
 //! @param pSystem Pointer to top level component system
 //! @param sVector Vector with signal components executed from this thread
@@ -122,9 +262,11 @@ void simSlave(ComponentSystem *pSystem,
 
         //! Signal Components !//
 
-        pBarrier_S->increment();
-        while(pBarrier_S->isLocked()){}                         //Wait at S barrier
-        if(pSystem->wasSimulationAborted()) break;
+        if(pBarrier_S)                                          //No S barrier if S and C phases are combined
+        {
+            pBarrier_S->arriveAndWait();                        //Wait at S barrier
+            if(pSystem->wasSimulationAborted()) break;
+        }
 
         for(size_t i=0; i<sVector.size(); ++i)
         {
@@ -134,8 +276,7 @@ void simSlave(ComponentSystem *pSystem,
 
         //! C Components !//
 
-        pBarrier_C->increment();
-        while(pBarrier_C->isLocked()){}                         //Wait at C barrier
+        pBarrier_C->arriveAndWait();                         //Wait at C barrier
         if(pSystem->wasSimulationAborted()) break;
 
         for(size_t i=0; i<cVector.size(); ++i)
@@ -146,8 +287,7 @@ void simSlave(ComponentSystem *pSystem,
 
         //! Q Components !//
 
-        pBarrier_Q->increment();
-        while(pBarrier_Q->isLocked()){}                         //Wait at Q barrier
+        pBarrier_Q->arriveAndWait();                         //Wait at Q barrier
         if(pSystem->wasSimulationAborted()) break;
 
         for(size_t i=0; i<qVector.size(); ++i)
@@ -157,8 +297,7 @@ void simSlave(ComponentSystem *pSystem,
 
         //! Log Nodes !//
 
-        pBarrier_N->increment();
-        while(pBarrier_N->isLocked()){}                         //Wait at N barrier
+        pBarrier_N->arriveAndWait();                         //Wait at N barrier
         if(pSystem->wasSimulationAborted()) break;
         //! @todo Temporary hack by Peter, after rewriting how node data and time is logged this no longer works, now master thread loags all nodes, need to come up with something smart
         //            for(size_t i=0; i<mVectorN.size(); ++i)
@@ -198,26 +337,16 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         time += timeStep;
 
         //! Signal Components !//
-        bool stop=false;
-        while(!pBarrier_S->allArrived())   //Wait for all other threads to arrive at signal barrier
+        if(pBarrier_S)                         //No S barrier if S and C phases are combined
         {
-            if(pSystem->wasSimulationAborted())
+            if(!pBarrier_S->waitForAllArrived(pSystem))   //Wait for all other threads to arrive at signal barrier
             {
-                stop=true;
+                unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
                 break;
             }
-
+            pBarrier_C->lock();                    //Lock next barrier (must be done before unlocking this one, to prevent deadlocks)
+            pBarrier_S->unlock();                  //Unlock signal barrier
         }
-        if(stop)
-        {
-            pBarrier_S->unlock();
-            pBarrier_C->unlock();
-            pBarrier_Q->unlock();
-            pBarrier_N->unlock();
-            break;
-        }
-        pBarrier_C->lock();                    //Lock next barrier (must be done before unlocking this one, to prevent deadlocks)
-        pBarrier_S->unlock();                  //Unlock signal barrier
 
         for(size_t i=0; i<sVector.size(); ++i)
         {
@@ -225,21 +354,9 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         }
 
         //! C Components !//
-        stop=false;
-        while(!pBarrier_C->allArrived())   //C barrier
-        {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-        }
-        if(stop)
+        if(!pBarrier_C->waitForAllArrived(pSystem))   //C barrier
         {
-            pBarrier_S->unlock();
-            pBarrier_C->unlock();
-            pBarrier_Q->unlock();
-            pBarrier_N->unlock();
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
             break;
         }
         pBarrier_Q->lock();
@@ -251,21 +368,9 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
         }
 
         //! Q Components !//
-        stop=false;
-        while(!pBarrier_Q->allArrived()) //Q barrier
+        if(!pBarrier_Q->waitForAllArrived(pSystem)) //Q barrier
         {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-        }
-        if(stop)
-        {
-            pBarrier_S->unlock();
-            pBarrier_C->unlock();
-            pBarrier_Q->unlock();
-            pBarrier_N->unlock();
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
             break;
         }
         pBarrier_N->lock();
@@ -279,25 +384,12 @@ void simMaster(ComponentSystem *pSystem, std::vector<Component *> &sVector, std:
             *pSimTimes[i] = time;     //Update time in component system, so that progress bar can use it
 
         //! Log Nodes !//
-        stop=false;
-        while(!pBarrier_N->allArrived()) //N barrier
+        if(!pBarrier_N->waitForAllArrived(pSystem)) //N barrier
         {
-            if(pSystem->wasSimulationAborted())
-            {
-                stop=true;
-                break;
-            }
-
-        }
-        if(stop)
-        {
-            pBarrier_S->unlock();
-            pBarrier_C->unlock();
-            pBarrier_Q->unlock();
-            pBarrier_N->unlock();
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
             break;
         }
-        pBarrier_S->lock();
+        lockFirstBarrier(pBarrier_S, pBarrier_C);
         pBarrier_N->unlock();
 
         //! @todo Temporary hack by Peter, after rewriting how node data and time is logged this no longer works, now master thread loags all nodes, need to come up with something smart
@@ -345,257 +437,477 @@ void simPoolSlave(TaskPool *pTaskPoolC, TaskPool *pTaskPoolQ, std::atomic<double
 }
 
 
-//! @brief Function for master simulation thread, that is responsible for synchronizing the simulation
+//! @brief Constructor for one task-stealing phase
+//! @param [in] pSystem Pointer to the top level component system, used to check for aborted simulations
+//! @param [in] rSplitVector The initial distribution of components, one vector per thread (extra vectors are distributed round-robin)
+//! @param [in] nThreads The number of threads taking part in the phase
+TaskStealingPhase::TaskStealingPhase(ComponentSystem *pSystem, const std::vector<std::vector<Component *> > &rSplitVector, const size_t nThreads)
+{
+    mpSystem = pSystem;
+    mOwnComponents.resize(nThreads);
+    mSimulatedComponents.resize(nThreads);
+    mnComponents = 0;
+    for (size_t i=0; i<rSplitVector.size(); ++i)
+    {
+        for (size_t c=0; c<rSplitVector[i].size(); ++c)
+        {
+            mOwnComponents[i%nThreads].push_back(rSplitVector[i][c]);
+            ++mnComponents;
+        }
+    }
+
+    // Each deque must be able to hold all components, since components may migrate between threads
+    for (size_t t=0; t<nThreads; ++t)
+    {
+        mDeques.push_back(new WorkStealingDeque(size_t(mnComponents)));
+        mSimulatedComponents[t].reserve(size_t(mnComponents));
+    }
+    mnRemaining.store(0);
+}
+
+TaskStealingPhase::~TaskStealingPhase()
+{
+    for (size_t t=0; t<mDeques.size(); ++t)
+    {
+        delete mDeques[t];
+    }
+}
+
+//! @brief Prepares the phase for the next time step
+//! @note Must be called by one thread only, when no thread is simulating the phase
+void TaskStealingPhase::reset()
+{
+    mnRemaining.store(mnComponents);
+}
+
+//! @brief Simulates the phase from one thread, returns when all components in the phase have been simulated
+//! @param [in] threadID The id of the calling thread
+//! @param [in] time The time to simulate to
+void TaskStealingPhase::simulate(const size_t threadID, const double time)
+{
+    WorkStealingDeque *pOwnDeque = mDeques[threadID];
+    std::vector<Component*> &rOwnComponents = mOwnComponents[threadID];
+    std::vector<Component*> &rSimulatedComponents = mSimulatedComponents[threadID];
+    rSimulatedComponents.clear();
+
+    // Push in reverse order, so that own components are popped in their sorted order and thieves take from the end
+    for (size_t c=rOwnComponents.size(); c>0; --c)
+    {
+        pOwnDeque->push(rOwnComponents[c-1]);
+    }
+
+    // Simulate own components
+    Component *pComp = pOwnDeque->pop();
+    while (pComp)
+    {
+        pComp->simulate(time);
+        rSimulatedComponents.push_back(pComp);
+        pComp = pOwnDeque->pop();
+    }
+    const long long nOwn = static_cast<long long>(rSimulatedComponents.size());
+    long long nRemaining = mnRemaining.fetch_sub(nOwn)-nOwn;
+
+    // Steal components from the other threads until all components have been simulated
+    // If the simulation is aborted, some threads may never enter the phase, so stop waiting for them
+    const size_t nThreads = mDeques.size();
+    size_t victim = threadID;
+    size_t nFailedSteals = 0;
+    while ((nRemaining > 0) && !mpSystem->wasSimulationAborted())
+    {
+        victim = (victim+1)%nThreads;
+        if (victim != threadID)
+        {
+            pComp = mDeques[victim]->steal();
+            if (pComp)
+            {
+                pComp->simulate(time);
+                rSimulatedComponents.push_back(pComp);
+                mnRemaining.fetch_sub(1);
+                nFailedSteals = 0;
+            }
+            else if (++nFailedSteals >= BarrierLock::DefaultSpinCount)
+            {
+                // Nothing left to steal, the remaining components are being simulated by other threads, give up the core meanwhile
+                std::this_thread::yield();
+            }
+        }
+        nRemaining = mnRemaining.load();
+    }
+
+    // The components simulated by this thread will be its own components in the next time step
+    rOwnComponents.swap(rSimulatedComponents);
+}
+
+
+//! @brief Function for master simulation thread in the task-stealing algorithm, that is responsible for synchronizing the simulation
+//! @param pSystem Pointer to the top level component system
+//! @param sVector Vector with signal components executed from this thread
+//! @param pPhaseC Shared task-stealing phase for C-type components
+//! @param pPhaseQ Shared task-stealing phase for Q-type components
+//! @param *pSimTimes Pointer to the simulation time variables in the component systems
+//! @param startTime Start time of simulation
+//! @param timeStep Step time of simulation
+//! @param numSimSteps Number of steps to simulate
+//! @param *pBarrier_S Pointer to barrier before signal components
+//! @param *pBarrier_C Pointer to barrier before C-type components
+//! @param *pBarrier_Q Pointer to barrier before Q-type components
+//! @param *pBarrier_N Pointer to barrier before node logging
 void simStealingMaster(ComponentSystem *pSystem,
                        std::vector<Component *> &sVector,
-                       std::vector<ThreadSafeVector *> *cVectors,
-                       std::vector<ThreadSafeVector *> *qVectors,
+                       TaskStealingPhase *pPhaseC,
+                       TaskStealingPhase *pPhaseQ,
                        std::vector<double *> &pSimTimes,
                        double startTime,
                        double timeStep,
                        size_t numSimSteps,
-                       size_t nThreads,
-                       size_t threadID,
                        BarrierLock *pBarrier_S,
                        BarrierLock *pBarrier_C,
                        BarrierLock *pBarrier_Q,
-                       BarrierLock *pBarrier_N,
-                       size_t maxSize)
+                       BarrierLock *pBarrier_N)
 {
-    ThreadSafeVector *pTemp;
-    Component *pComp;
-
     double time = startTime;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
 
     for(size_t s=0; s<numSimSteps; ++s)
     {
-        if(pSystem->wasSimulationAborted()) break;
-
         time += timeStep;
 
         //! Signal Components !//
+        if(pBarrier_S)                         //No S barrier if S and C phases are combined
+        {
+            if(!pBarrier_S->waitForAllArrived(pSystem))   //Wait for all other threads to arrive at signal barrier
+            {
+                unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
+                break;
+            }
+            pBarrier_C->lock();
+            pBarrier_S->unlock();
+        }
 
-        while(!pBarrier_S->allArrived()) {}
-        pBarrier_C->lock();
-        pBarrier_S->unlock();
-
-        //Simulate signal components
         for(size_t i=0; i<sVector.size(); ++i)
         {
             sVector[i]->simulate(time);
         }
 
         //! C Components !//
-
-        while(!pBarrier_C->allArrived()) {}    //C barrier
+        if(!pBarrier_C->waitForAllArrived(pSystem))   //C barrier
+        {
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
+            break;
+        }
         pBarrier_Q->lock();
+        pPhaseC->reset();                      //Reset phase before unlocking, so that no thread can enter it too early
         pBarrier_C->unlock();
 
-        //SIMULATE C
-
-        //Switch Q vectors
-        pTemp = pUnFinishedVectorsQ->at(threadID);
-        pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
-        pFinishedVectorQ = pTemp;
-
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        }
+        pPhaseC->simulate(0, time);
 
-        //Steal components
-        //if(int(time/timeStep/5+threadID)%nThreads == 0)
+        //! Q Components !//
+        if(!pBarrier_Q->waitForAllArrived(pSystem))   //Q barrier
         {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
+            break;
         }
-
-        //! Q Components !//
-
-        while(!pBarrier_Q->allArrived()) {}    //Q barrier
         pBarrier_N->lock();
+        pPhaseQ->reset();
         pBarrier_Q->unlock();
 
-        //SIMULATE Q
-
-        //Switch C vectors
-        pTemp = pUnFinishedVectorsC->at(threadID);
-        pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
-        pFinishedVectorC = pTemp;
-
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
-        {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%nThreads == 0)
-        {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
-            }
-        }
+        pPhaseQ->simulate(0, time);
 
         for(size_t i=0; i<pSimTimes.size(); ++i)
-            *pSimTimes[i] = time;
+            *pSimTimes[i] = time;     //Update time in component system, so that progress bar can use it
 
         //! Log Nodes !//
-
-        while(!pBarrier_N->allArrived()) {}    //N barrier
-        pBarrier_S->lock();
+        if(!pBarrier_N->waitForAllArrived(pSystem))   //N barrier
+        {
+            unlockAllBarriers(pBarrier_S, pBarrier_C, pBarrier_Q, pBarrier_N);
+            break;
+        }
+        lockFirstBarrier(pBarrier_S, pBarrier_C);
         pBarrier_N->unlock();
 
         pSystem->logTimeAndNodes(s+1);
     }
 }
 
+
+//! @brief Function for slave simulation threads in the task-stealing algorithm
+//! @param pSystem Pointer to the top level component system
+//! @param pPhaseC Shared task-stealing phase for C-type components
+//! @param pPhaseQ Shared task-stealing phase for Q-type components
+//! @param startTime Start time of simulation
+//! @param timeStep Step time of simulation
+//! @param numSimSteps Number of steps to simulate
+//! @param threadID The id of this thread (the master thread has id 0)
+//! @param *pBarrier_S Pointer to barrier before signal components
+//! @param *pBarrier_C Pointer to barrier before C-type components
+//! @param *pBarrier_Q Pointer to barrier before Q-type components
+//! @param *pBarrier_N Pointer to barrier before node logging
 void simStealingSlave(ComponentSystem *pSystem,
-                      std::vector<ThreadSafeVector *> *cVectors,
-                      std::vector<ThreadSafeVector *> *qVectors,
+                      TaskStealingPhase *pPhaseC,
+                      TaskStealingPhase *pPhaseQ,
                       double startTime,
                       double timeStep,
                       size_t numSimSteps,
-                      size_t nThreads,
                       size_t threadID,
                       BarrierLock *pBarrier_S,
                       BarrierLock *pBarrier_C,
                       BarrierLock *pBarrier_Q,
-                      BarrierLock *pBarrier_N,
-                      size_t maxSize)
-
+                      BarrierLock *pBarrier_N)
 {
-    double time = startTime;;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsC = cVectors;
-    std::vector<ThreadSafeVector*> *pUnFinishedVectorsQ = qVectors;
-    //! @todo memory leak, never deleted, however, dont delete in destructor, that will cause double free corruption since this object is copied when new tasks are created
-    ThreadSafeVector *pFinishedVectorC = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-    ThreadSafeVector *pFinishedVectorQ = new ThreadSafeVector(std::vector<Component*>(), maxSize);
-
-
-    ThreadSafeVector *pTemp;
-    Component *pComp;
+    double time = startTime;
 
     for(size_t i=0; i<numSimSteps; ++i)
     {
-        if(pSystem->wasSimulationAborted()) break;
-
         time += timeStep;
 
         //! Signal Components !//
 
-        pBarrier_S->increment();
-        while(pBarrier_S->isLocked()){}                         //Wait at S barrier
+        if(pBarrier_S)                                          //No S barrier if S and C phases are combined
+        {
+            pBarrier_S->arriveAndWait();                        //Wait at S barrier
+            if(pSystem->wasSimulationAborted()) break;
+        }
 
         //! C Components !//
 
-        pBarrier_C->increment();
-        while(pBarrier_C->isLocked()){}                         //Wait at C barrier
+        pBarrier_C->arriveAndWait();                         //Wait at C barrier
+        if(pSystem->wasSimulationAborted()) break;
+
+        pPhaseC->simulate(threadID, time);
+
+        //! Q Components !//
+
+        pBarrier_Q->arriveAndWait();                         //Wait at Q barrier
+        if(pSystem->wasSimulationAborted()) break;
+
+        pPhaseQ->simulate(threadID, time);
+
+        //! Log Nodes !//
+
+        pBarrier_N->arriveAndWait();                         //Wait at N barrier
+        if(pSystem->wasSimulationAborted()) break;
+    }
+}
+
+//! @brief Constructor, no worker threads are created until they are needed
+SimulationThreadPool::SimulationThreadPool()
+{
+    mpTask = 0;
+    mnThreads = 0;
+    mnBusy = 0;
+    mGeneration = 0;
+    mStop = false;
+}
 
-        //C-COMPONENTS
+//! @brief Destructor, stops and joins all worker threads
+SimulationThreadPool::~SimulationThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mStartCondition.notify_all();
+    for(size_t t=0; t<mWorkers.size(); ++t)
+    {
+        mWorkers[t].join();
+    }
+}
 
-        //Switch Q vectors
-        pTemp = pUnFinishedVectorsQ->at(threadID);
-        pUnFinishedVectorsQ->at(threadID) = pFinishedVectorQ;
-        pFinishedVectorQ = pTemp;
+//! @brief Runs a task on a number of threads and waits until all of them have finished
+//! @param nThreads The number of threads to run the task on, the calling thread is thread 0
+//! @param rTask The task function, called once per thread with the thread id as argument
+void SimulationThreadPool::run(const size_t nThreads, const TaskFunctionT &rTask)
+{
+    if(nThreads <= 1)
+    {
+        rTask(0);
+        return;
+    }
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
-        while(pComp)
+    // If the pool is busy with another simulation, fall back to temporary threads
+    std::unique_lock<std::mutex> runLock(mRunMutex, std::try_to_lock);
+    if(!runLock.owns_lock())
+    {
+        std::vector<std::thread> threads;
+        for(size_t t=1; t<nThreads; ++t)
         {
-            pComp->simulate(time);
-            pFinishedVectorC->insertFirst(pComp);
-            pComp = pUnFinishedVectorsC->at(threadID)->tryAndTakeFirst();
+            threads.push_back(std::thread(rTask, t));
         }
-
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
+        rTask(0);
+        for(size_t t=0; t<threads.size(); ++t)
         {
-            for(size_t i=0; i<nThreads-1; ++i)
-            {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsC->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorC->insertLast(pComp);
-                    break;
-                }
-            }
+            threads[t].join();
         }
+        return;
+    }
 
-        //! Q Components !//
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while(mWorkers.size() < nThreads-1)
+        {
+            mWorkers.push_back(std::thread(&SimulationThreadPool::workerLoop, this, mWorkers.size()+1, mGeneration));
+        }
+        mpTask = &rTask;
+        mnThreads = nThreads;
+        mnBusy = nThreads-1;
+        ++mGeneration;
+    }
+    mStartCondition.notify_all();
 
-        pBarrier_Q->increment();
-        while(pBarrier_Q->isLocked()){}                         //Wait at Q barrier
+    rTask(0);
 
-        //Q-COMPONENTS
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(mnBusy > 0)
+    {
+        mDoneCondition.wait(lock);
+    }
+    mpTask = 0;
+}
 
-        //Switch C vectors
-        pTemp = pUnFinishedVectorsC->at(threadID);
-        pUnFinishedVectorsC->at(threadID) = pFinishedVectorC;
-        pFinishedVectorC = pTemp;
+//! @brief Returns the number of worker threads that have been created (not counting the calling thread)
+size_t SimulationThreadPool::getNumWorkers() const
+{
+    return mWorkers.size();
+}
 
-        //Simulate own components
-        pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
-        while(pComp)
+//! @brief The loop run by each worker thread, waits for a new task generation and runs it if this thread is needed
+//! @param threadID The id of this worker thread (starting at 1)
+//! @param generation The task generation that was current when the thread was created
+void SimulationThreadPool::workerLoop(const size_t threadID, size_t generation)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true)
+    {
+        while(!mStop && (mGeneration == generation))
         {
-            pComp->simulate(time);
-            pFinishedVectorQ->insertFirst(pComp);
-            pComp = pUnFinishedVectorsQ->at(threadID)->tryAndTakeFirst();
+            mStartCondition.wait(lock);
         }
+        if(mStop)
+        {
+            return;
+        }
+        generation = mGeneration;
 
-        //Steal components
-        //if(int(time/timeStep/5+mThreadID)%mnThreads == 0)
+        if(threadID < mnThreads)
         {
-            for(size_t i=0; i<nThreads-1; ++i)
+            const TaskFunctionT *pTask = mpTask;
+            lock.unlock();
+            (*pTask)(threadID);
+            lock.lock();
+            --mnBusy;
+            if(mnBusy == 0)
             {
-                int j = (threadID+1+i)%nThreads;
-                pComp = pUnFinishedVectorsQ->at(j)->tryAndTakeLast();
-                if(pComp)
-                {
-                    pComp->simulate(time);
-                    pFinishedVectorQ->insertLast(pComp);
-                    break;
-                }
+                mDoneCondition.notify_all();
             }
         }
+    }
+}
+
+
+ThreadCorePin::ThreadCorePin()
+{
+    mIsPinned = false;
+}
 
-        //! Log Nodes !//
 
-        pBarrier_N->increment();
-        while(pBarrier_N->isLocked()){}                         //Wait at N barrier
+ThreadCorePin::~ThreadCorePin()
+{
+    unpin();
+}
+
+
+//! @brief Pins the calling thread to one processor core
+//! @details Only the cores in the current affinity mask of the thread (set by taskset, cgroups or the process affinity) are used
+//! @param core The index among the allowed cores, wrapped around if larger than the number of allowed cores
+//! @returns True if the affinity could be set, false if it failed or is not supported on this platform
+bool ThreadCorePin::pin(const size_t core)
+{
+    unpin();
+#if defined(__linux__)
+    cpu_set_t allowedSet;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &allowedSet) != 0)
+    {
+        return false;
+    }
+    const int nAllowed = CPU_COUNT(&allowedSet);
+    if (nAllowed < 1)
+    {
+        return false;
+    }
+    // Find the n:th allowed cpu
+    int n = int(core % size_t(nAllowed));
+    int cpu = 0;
+    for ( ; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &allowedSet) && (n-- == 0))
+        {
+            break;
+        }
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) != 0)
+    {
+        return false;
+    }
+    const unsigned char *pAllowed = reinterpret_cast<const unsigned char*>(&allowedSet);
+    mOriginalAffinity.assign(pAllowed, pAllowed+sizeof(cpu_set_t));
+    mIsPinned = true;
+    return true;
+#elif defined(_WIN32)
+    DWORD_PTR processMask, systemMask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask) || (processMask == 0))
+    {
+        return false;
+    }
+    // Find the n:th allowed cpu
+    size_t nAllowed = 0;
+    for (size_t b=0; b<sizeof(DWORD_PTR)*8; ++b)
+    {
+        nAllowed += (processMask >> b) & 1;
+    }
+    size_t n = core % nAllowed;
+    DWORD_PTR mask = 0;
+    for (size_t b=0; b<sizeof(DWORD_PTR)*8; ++b)
+    {
+        if (((processMask >> b) & 1) && (n-- == 0))
+        {
+            mask = DWORD_PTR(1) << b;
+            break;
+        }
+    }
+    const DWORD_PTR previousMask = SetThreadAffinityMask(GetCurrentThread(), mask);
+    if (previousMask == 0)
+    {
+        return false;
+    }
+    const unsigned char *pPrevious = reinterpret_cast<const unsigned char*>(&previousMask);
+    mOriginalAffinity.assign(pPrevious, pPrevious+sizeof(DWORD_PTR));
+    mIsPinned = true;
+    return true;
+#else
+    HOPSAN_UNUSED(core)
+    return false;
+#endif
+}
+
+
+//! @brief Restores the affinity that the thread had before it was pinned
+void ThreadCorePin::unpin()
+{
+    if (!mIsPinned)
+    {
+        return;
     }
+#if defined(__linux__)
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), reinterpret_cast<const cpu_set_t*>(&mOriginalAffinity[0]));
+#elif defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), *reinterpret_cast<const DWORD_PTR*>(&mOriginalAffinity[0]));
+#endif
+    mIsPinned = false;
 }
 
+
 void simOneComponentOneStep(Component *pComp, double stopTime)
 {
     pComp->simulate(stopTime);
@@ -26,6 +26,11 @@
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <set>
+#include <vector>
 #include "CoreUtilities/NumHopHelper.h"
 #include "ComponentSystem.h"
 #include "CoreUtilities/StringUtilities.h"
@@ -74,6 +79,16 @@ public:
         return -1;
     }
 
+    double *getRegisteredPtr(const HString &name) const
+    {
+        std::map<HString, double*>::const_iterator it = mRegisteredDataPtrs.find(name.c_str());
+        if (it != mRegisteredDataPtrs.end())
+        {
+            return it->second;
+        }
+        return 0;
+    }
+
     void registerDataPointer(const HString &name, double *pData)
     {
         mRegisteredDataPtrs.insert(std::pair<HString,double*>(name, pData));
@@ -309,6 +324,571 @@ private:
     Component *mpComponent;
 };
 
+namespace {
+
+//! @brief A numhop script compiled into a flat list of stack machine instructions
+//! @details Registered data pointers are read and written directly, internal variables live in local slots
+//! and other named values are either looked up by name each evaluation or folded into constants at compile time.
+class NumHopTape
+{
+public:
+    enum OpT {PushConstant, PushPointer, PushInternal, PushNamed, StorePointer, StoreInternal, StoreNamed,
+              Add, Subtract, Multiply, Divide, Power, Negate, EndRow};
+
+    struct Instruction
+    {
+        OpT op;
+        size_t index;
+        double value;
+        double *pData;
+    };
+
+    struct NamedSlot
+    {
+        string name;
+        double value;
+        bool isInternal;
+    };
+
+    NumHopTape() : mIsCompiled(false) {}
+
+    void clear()
+    {
+        mInstructions.clear();
+        mSlots.clear();
+        mRows.clear();
+        mStack.clear();
+        mIsCompiled = false;
+    }
+
+    bool isCompiled() const
+    {
+        return mIsCompiled;
+    }
+
+    //! @brief Forget internal variable values, the same as when the script is interpreted again
+    void resetInternalVariables()
+    {
+        for (size_t i=0; i<mSlots.size(); ++i)
+        {
+            mSlots[i].value = 0;
+            mSlots[i].isInternal = false;
+        }
+    }
+
+    void append(OpT op, double value=0, double *pData=0, size_t index=0)
+    {
+        Instruction instr;
+        instr.op = op;
+        instr.index = index;
+        instr.value = value;
+        instr.pData = pData;
+        mInstructions.push_back(instr);
+    }
+
+    size_t slotIndex(const string &name)
+    {
+        for (size_t i=0; i<mSlots.size(); ++i)
+        {
+            if (mSlots[i].name == name)
+            {
+                return i;
+            }
+        }
+        NamedSlot slot;
+        slot.name = name;
+        slot.value = 0;
+        slot.isInternal = false;
+        mSlots.push_back(slot);
+        return mSlots.size()-1;
+    }
+
+    void endRow(const string &rowText)
+    {
+        append(EndRow, 0, 0, mRows.size());
+        mRows.push_back(rowText);
+    }
+
+    //! @brief Finish compilation by allocating the value stack
+    void finalize()
+    {
+        size_t depth=0, maxDepth=0;
+        for (size_t i=0; i<mInstructions.size(); ++i)
+        {
+            switch (mInstructions[i].op)
+            {
+            case PushConstant:
+            case PushPointer:
+            case PushInternal:
+            case PushNamed:
+                ++depth;
+                maxDepth = std::max(depth, maxDepth);
+                break;
+            case Add:
+            case Subtract:
+            case Multiply:
+            case Divide:
+            case Power:
+            case EndRow:
+                --depth;
+                break;
+            default:
+                break;
+            }
+        }
+        mStack.resize(maxDepth+1);
+        mIsCompiled = !mRows.empty();
+    }
+
+    bool evaluate(numhop::ExternalVariableStorage *pAccess, double &rValue, HString *pOutput)
+    {
+        bool allOK=true, rowOK=true;
+        double value=-1;
+        double *pTop = &mStack[0];
+        for (size_t i=0; i<mInstructions.size(); ++i)
+        {
+            const Instruction &instr = mInstructions[i];
+            switch (instr.op)
+            {
+            case PushConstant:
+                *(++pTop) = instr.value;
+                break;
+            case PushPointer:
+                *(++pTop) = *instr.pData;
+                break;
+            case PushInternal:
+                *(++pTop) = mSlots[instr.index].value;
+                break;
+            case PushNamed:
+            {
+                NamedSlot &slot = mSlots[instr.index];
+                if (slot.isInternal)
+                {
+                    *(++pTop) = slot.value;
+                }
+                else
+                {
+                    bool found;
+                    *(++pTop) = pAccess->externalValue(slot.name, found);
+                    rowOK = rowOK && found;
+                }
+                break;
+            }
+            case StorePointer:
+                *instr.pData = *pTop;
+                break;
+            case StoreInternal:
+                mSlots[instr.index].value = *pTop;
+                break;
+            case StoreNamed:
+            {
+                NamedSlot &slot = mSlots[instr.index];
+                if (!slot.isInternal && pAccess->setExternalValue(slot.name, *pTop))
+                {
+                    break;
+                }
+                // Dotted names can only refer to external values
+                if (slot.name.find('.') == string::npos)
+                {
+                    slot.isInternal = true;
+                    slot.value = *pTop;
+                }
+                else
+                {
+                    rowOK = false;
+                }
+                break;
+            }
+            case Add:
+                --pTop;
+                *pTop += pTop[1];
+                break;
+            case Subtract:
+                --pTop;
+                *pTop -= pTop[1];
+                break;
+            case Multiply:
+                --pTop;
+                *pTop *= pTop[1];
+                break;
+            case Divide:
+                --pTop;
+                *pTop /= pTop[1];
+                break;
+            case Power:
+                --pTop;
+                *pTop = pow(*pTop, pTop[1]);
+                break;
+            case Negate:
+                *pTop = -*pTop;
+                break;
+            case EndRow:
+                value = *(pTop--);
+                if (pOutput)
+                {
+                    pOutput->append("Evaluated ");
+                    pOutput->append(rowOK ? "OK    : " : "FAILED: ");
+                    pOutput->append(mRows[instr.index].c_str());
+                    pOutput->append("     Value: ");
+                    pOutput->append(to_hstring(value).c_str());
+                    pOutput->append("\n");
+                }
+                allOK = allOK && rowOK;
+                rowOK = true;
+                break;
+            }
+        }
+        // Remove the last newline
+        if (pOutput && !pOutput->empty())
+        {
+            pOutput->erase(pOutput->size()-1);
+        }
+        rValue = value;
+        return allOK;
+    }
+
+private:
+    vector<Instruction> mInstructions;
+    vector<NamedSlot> mSlots;
+    vector<string> mRows;
+    vector<double> mStack;
+    bool mIsCompiled;
+};
+
+//! @brief Recursive descent compiler for the subset of numhop expressions that can be put on a NumHopTape
+//! @details Only numbers, names, parentheses, unary minus and the + - * / ^ operators are handled.
+//! Anything else makes compilation fail, and the script is then evaluated by the numhop interpreter instead.
+class NumHopTapeCompiler
+{
+public:
+    NumHopTapeCompiler(NumHopTape &rTape, HopsanParameterAccessBase *pAccess, bool foldExternalValues) :
+        mrTape(rTape), mpAccess(pAccess), mFoldExternalValues(foldExternalValues), mpRow(0), mPos(0) {}
+
+    bool compileScript(const list<string> &rows)
+    {
+        mrTape.clear();
+        // Names assigned in the script, needed to see if a name is read before it has been assigned
+        for (list<string>::const_iterator it=rows.begin(); it!=rows.end(); ++it)
+        {
+            mpRow = &(*it);
+            mPos = 0;
+            string name;
+            if (parseName(name))
+            {
+                skipSpace();
+                if (mPos < mpRow->size() && (*mpRow)[mPos] == '=')
+                {
+                    mScriptAssignedNames.insert(name);
+                }
+            }
+        }
+
+        for (list<string>::const_iterator it=rows.begin(); it!=rows.end(); ++it)
+        {
+            if (!compileRow(*it))
+            {
+                mrTape.clear();
+                return false;
+            }
+        }
+        mrTape.finalize();
+        return mrTape.isCompiled();
+    }
+
+private:
+    bool compileRow(const string &row)
+    {
+        mpRow = &row;
+        mPos = 0;
+
+        // Check for assignment
+        string target;
+        if (parseName(target))
+        {
+            skipSpace();
+            if (mPos < mpRow->size() && (*mpRow)[mPos] == '=')
+            {
+                ++mPos;
+                if (!parseSum() || !atEnd())
+                {
+                    return false;
+                }
+                if (!emitStore(target))
+                {
+                    return false;
+                }
+                mrTape.endRow(row);
+                return true;
+            }
+        }
+
+        // Plain expression
+        mPos = 0;
+        if (!parseSum() || !atEnd())
+        {
+            return false;
+        }
+        mrTape.endRow(row);
+        return true;
+    }
+
+    bool parseSum()
+    {
+        if (!parseProduct())
+        {
+            return false;
+        }
+        while (true)
+        {
+            skipSpace();
+            if (mPos >= mpRow->size())
+            {
+                return true;
+            }
+            const char c = (*mpRow)[mPos];
+            if (c != '+' && c != '-')
+            {
+                return true;
+            }
+            ++mPos;
+            if (!parseProduct())
+            {
+                return false;
+            }
+            mrTape.append((c == '+') ? NumHopTape::Add : NumHopTape::Subtract);
+        }
+    }
+
+    bool parseProduct()
+    {
+        if (!parseUnary())
+        {
+            return false;
+        }
+        while (true)
+        {
+            skipSpace();
+            if (mPos >= mpRow->size())
+            {
+                return true;
+            }
+            const char c = (*mpRow)[mPos];
+            if (c != '*' && c != '/')
+            {
+                return true;
+            }
+            ++mPos;
+            if (!parseUnary())
+            {
+                return false;
+            }
+            mrTape.append((c == '*') ? NumHopTape::Multiply : NumHopTape::Divide);
+        }
+    }
+
+    bool parseUnary()
+    {
+        skipSpace();
+        if (mPos < mpRow->size() && ((*mpRow)[mPos] == '-' || (*mpRow)[mPos] == '+'))
+        {
+            const bool isMinus = ((*mpRow)[mPos] == '-');
+            ++mPos;
+            bool usedPower;
+            if (!parsePower(usedPower))
+            {
+                return false;
+            }
+            // The precedence of a sign in front of a power (-a^b) is left to the interpreter
+            if (usedPower)
+            {
+                return false;
+            }
+            if (isMinus)
+            {
+                mrTape.append(NumHopTape::Negate);
+            }
+            return true;
+        }
+        bool usedPower;
+        return parsePower(usedPower);
+    }
+
+    bool parsePower(bool &rUsedPower)
+    {
+        rUsedPower = false;
+        if (!parsePrimary())
+        {
+            return false;
+        }
+        skipSpace();
+        if (mPos < mpRow->size() && (*mpRow)[mPos] == '^')
+        {
+            ++mPos;
+            skipSpace();
+            if (!parsePrimary())
+            {
+                return false;
+            }
+            mrTape.append(NumHopTape::Power);
+            rUsedPower = true;
+            // The associativity of chained powers (a^b^c) is left to the interpreter
+            skipSpace();
+            if (mPos < mpRow->size() && (*mpRow)[mPos] == '^')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parsePrimary()
+    {
+        skipSpace();
+        if (mPos >= mpRow->size())
+        {
+            return false;
+        }
+        const char c = (*mpRow)[mPos];
+        if (c == '(')
+        {
+            ++mPos;
+            if (!parseSum())
+            {
+                return false;
+            }
+            skipSpace();
+            if (mPos >= mpRow->size() || (*mpRow)[mPos] != ')')
+            {
+                return false;
+            }
+            ++mPos;
+            return true;
+        }
+        if (isdigit(c) || (c == '.' && mPos+1 < mpRow->size() && isdigit((*mpRow)[mPos+1])))
+        {
+            const char *pBegin = mpRow->c_str()+mPos;
+            char *pEnd;
+            const double value = strtod(pBegin, &pEnd);
+            mPos += pEnd-pBegin;
+            // A number directly followed by a name is not valid
+            if (mPos < mpRow->size() && (isalpha((*mpRow)[mPos]) || (*mpRow)[mPos] == '_' || (*mpRow)[mPos] == '.'))
+            {
+                return false;
+            }
+            mrTape.append(NumHopTape::PushConstant, value);
+            return true;
+        }
+        string name;
+        if (parseName(name))
+        {
+            return emitLoad(name);
+        }
+        return false;
+    }
+
+    bool parseName(string &rName)
+    {
+        skipSpace();
+        const size_t begin = mPos;
+        if (mPos >= mpRow->size() || !(isalpha((*mpRow)[mPos]) || (*mpRow)[mPos] == '_'))
+        {
+            return false;
+        }
+        while (mPos < mpRow->size() && (isalnum((*mpRow)[mPos]) || (*mpRow)[mPos] == '_' || (*mpRow)[mPos] == '.'))
+        {
+            ++mPos;
+        }
+        rName = mpRow->substr(begin, mPos-begin);
+        return true;
+    }
+
+    bool emitLoad(const string &name)
+    {
+        if (name == "pi")
+        {
+            mrTape.append(NumHopTape::PushConstant, M_PI);
+            return true;
+        }
+        double *pData = mpAccess->getRegisteredPtr(name.c_str());
+        if (pData)
+        {
+            mrTape.append(NumHopTape::PushPointer, 0, pData);
+            return true;
+        }
+        if (mFoldExternalValues)
+        {
+            if (mAssignedInternalNames.count(name))
+            {
+                mrTape.append(NumHopTape::PushInternal, 0, 0, mrTape.slotIndex(name));
+                return true;
+            }
+            // A name that is read before it is assigned would change meaning between evaluations
+            if (mScriptAssignedNames.count(name))
+            {
+                return false;
+            }
+            bool found;
+            const double value = mpAccess->externalValue(name, found);
+            if (!found)
+            {
+                return false;
+            }
+            mrTape.append(NumHopTape::PushConstant, value);
+            return true;
+        }
+        mrTape.append(NumHopTape::PushNamed, 0, 0, mrTape.slotIndex(name));
+        return true;
+    }
+
+    bool emitStore(const string &name)
+    {
+        if (name == "pi")
+        {
+            return false;
+        }
+        double *pData = mpAccess->getRegisteredPtr(name.c_str());
+        if (pData)
+        {
+            mrTape.append(NumHopTape::StorePointer, 0, pData);
+        }
+        else if (mFoldExternalValues && name.find('.') == string::npos)
+        {
+            // A component can only set registered and self. values, so this becomes an internal variable
+            mrTape.append(NumHopTape::StoreInternal, 0, 0, mrTape.slotIndex(name));
+            mAssignedInternalNames.insert(name);
+        }
+        else
+        {
+            mrTape.append(NumHopTape::StoreNamed, 0, 0, mrTape.slotIndex(name));
+        }
+        return true;
+    }
+
+    void skipSpace()
+    {
+        while (mPos < mpRow->size() && isspace((*mpRow)[mPos]))
+        {
+            ++mPos;
+        }
+    }
+
+    bool atEnd()
+    {
+        skipSpace();
+        return mPos >= mpRow->size();
+    }
+
+    NumHopTape &mrTape;
+    HopsanParameterAccessBase *mpAccess;
+    bool mFoldExternalValues;
+    const string *mpRow;
+    size_t mPos;
+    std::set<string> mScriptAssignedNames;
+    std::set<string> mAssignedInternalNames;
+};
+
+}
+
 namespace hopsan {
 
 class NumHopHelperPrivate
@@ -318,6 +898,8 @@ public:
     numhop::VariableStorage mVarStorage;
     HopsanParameterAccessBase *mpHopsanAccess;
     std::list<numhop::Expression> mExpressions;
+    NumHopTape mTape;
+    HString mTapeScript;
 };
 
 }
@@ -397,6 +979,8 @@ bool NumHopHelper::interpretNumHopScript(const HString &script, bool doPrintOutp
 
     mpPrivate->mVarStorage.clearInternalVariables();
     mpPrivate->mExpressions.clear();
+    mpPrivate->mTape.clear();
+    mpPrivate->mTapeScript.clear();
 
     bool allOK=true;
     for (list<string>::iterator it = expressions.begin(); it!=expressions.end(); ++it)
@@ -421,8 +1005,66 @@ bool NumHopHelper::interpretNumHopScript(const HString &script, bool doPrintOutp
     return allOK;
 }
 
+//! @brief Interpret a numhop script and compile it for fast repeated evaluation
+//! @details If the script only uses operations that can be compiled, eval() will use the compiled form and
+//! registered data pointers will be read and written directly. Otherwise the interpreted expressions are used.
+//! For a component, external values (parameters) are looked up once here, so compile again if they change.
+//! For a system, compiling the same script again reuses the previous compilation.
+//! @param[in] script The script to compile
+//! @param[in] doPrintOutput Toggle whether to print output
+//! @param[out] rOutput The output string to print to, (if printing activated)
+//! @returns true if the script could be interpreted, false otherwise
+bool NumHopHelper::compileNumHopScript(const HString &script, bool doPrintOutput, HString &rOutput)
+{
+    const bool foldExternalValues = (mpComponent != 0);
+    if (!foldExternalValues && mpPrivate->mTape.isCompiled() && (script == mpPrivate->mTapeScript))
+    {
+        mpPrivate->mTape.resetInternalVariables();
+        return true;
+    }
+
+    if (!interpretNumHopScript(script, doPrintOutput, rOutput))
+    {
+        return false;
+    }
+
+    if (mpPrivate->mpHopsanAccess)
+    {
+        list<string> expressions;
+        numhop::extractExpressionRows(script.c_str(), '#', expressions);
+        NumHopTapeCompiler compiler(mpPrivate->mTape, mpPrivate->mpHopsanAccess, foldExternalValues);
+        if (compiler.compileScript(expressions))
+        {
+            mpPrivate->mTapeScript = script;
+        }
+    }
+    return true;
+}
+
+//! @brief Check if the current script has been compiled (and will not be interpreted on eval)
+bool NumHopHelper::isCompiled() const
+{
+    return mpPrivate->mTape.isCompiled();
+}
+
+//! @brief Evaluate the current script without producing any output
+bool NumHopHelper::eval(double &rValue)
+{
+    if (mpPrivate->mTape.isCompiled())
+    {
+        return mpPrivate->mTape.evaluate(mpPrivate->mpHopsanAccess, rValue, 0);
+    }
+    HString dummy;
+    return eval(rValue, false, dummy);
+}
+
 bool NumHopHelper::eval(double &rValue, bool doPrintOutput, HString &rOutput)
 {
+    if (mpPrivate->mTape.isCompiled())
+    {
+        return mpPrivate->mTape.evaluate(mpPrivate->mpHopsanAccess, rValue, doPrintOutput ? &rOutput : 0);
+    }
+
     bool allOK=!mpPrivate->mExpressions.empty();
     double value=-1;
     for (list<numhop::Expression>::iterator it = mpPrivate->mExpressions.begin(); it!=mpPrivate->mExpressions.end(); ++it)
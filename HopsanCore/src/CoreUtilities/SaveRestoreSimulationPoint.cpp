@@ -25,29 +25,73 @@
 //$Id$
 
 #include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "CoreUtilities/SimulationStateBuffer.h"
 #include "ComponentSystem.h"
 #include "Component.h"
 
 #include <vector>
 #include <fstream>
+#include <sstream>
 #include <cstring>
 
 using namespace hopsan;
 
 /*
- * Port head
+ * The file starts with a format version package. Every package has the same head, so that readers can skip packages
+ * that they do not know about, such as packages added in later versions. Files written by older versions of Hopsan
+ * have no format version package and no package length, they are still read.
  *
- * DataIdentifier   FullNameLength  NumDataElements (double)
- * 2-byte           2-byte          2-byte
+ * Package head
  *
+ * DataIdentifier   PackageLength (bytes after the head)
+ * 2-byte           8-byte
  *
+ * Format version package data
+ *
+ * FormatVersion
+ * 2-byte
+ *
+ * Time package data
+ *
+ * Time
+ * 8-byte (double)
+ *
+ * Port package data
+ *
+ * FullNameLength  NumDataElements (double)   FullName   Data
+ * 2-byte          2-byte
+ *
+ * Component state package data
+ *
+ * FullNameLength  NumDataBytes   FullName   Data
+ * 2-byte          8-byte
  *
  * */
 
+#define FORMATVERSIONIDENTIFIER 0x01
 #define TIMEIDENTIFIER 0x02
 #define PORTIDENTIFIER 0x03
+#define COMPONENTSTATEIDENTIFIER 0x04
+
+#define FORMATVERSION 2
 
-void writePortData(Port *pPort, const HString &namePrefix, std::ofstream &rFile)
+void writePackage(size_t identifier, const std::string &rData, std::ostream &rFile)
+{
+    rFile.write(reinterpret_cast<char*>(&identifier), 2);
+    unsigned long long length = rData.size();
+    rFile.write(reinterpret_cast<char*>(&length), 8);
+    rFile.write(rData.data(), std::streamsize(rData.size()));
+}
+
+void writeFormatVersion(std::ostream &rFile)
+{
+    std::ostringstream data(std::ios::binary);
+    size_t version = FORMATVERSION;
+    data.write(reinterpret_cast<char*>(&version), 2);
+    writePackage(FORMATVERSIONIDENTIFIER, data.str(), rFile);
+}
+
+void writePortData(Port *pPort, const HString &namePrefix, std::ostream &rFile)
 {
     // Generate full name
     HString fullName = namePrefix+pPort->getName();
@@ -55,34 +99,66 @@ void writePortData(Port *pPort, const HString &namePrefix, std::ofstream &rFile)
     // OK great, if we have a data vector, lets dump it to file
     if (pDataVector)
     {
-        // Write port identifier
-        size_t identifier = PORTIDENTIFIER;
-        rFile.write(reinterpret_cast<char*>(&identifier), 2);
+        std::ostringstream data(std::ios::binary);
         size_t namelen = fullName.size();
-        rFile.write(reinterpret_cast<char*>(&namelen), 2);
+        data.write(reinterpret_cast<char*>(&namelen), 2);
         size_t datalen = pDataVector->size();
-        rFile.write(reinterpret_cast<char*>(&datalen), 2);
-        rFile.write(fullName.c_str(), namelen);
-        rFile.write(reinterpret_cast<char*>(pDataVector->data()), datalen*sizeof(double));
+        data.write(reinterpret_cast<char*>(&datalen), 2);
+        data.write(fullName.c_str(), namelen);
+        // Read through the node data pointers, the values may live in a node data arena or partition storage
+        for (size_t d=0; d<datalen; ++d)
+        {
+            data.write(reinterpret_cast<char*>(pPort->getNodeDataPtr(d)), sizeof(double));
+        }
+        writePackage(PORTIDENTIFIER, data.str(), rFile);
     }
 }
 
-void writeTimeData(double time, std::ofstream &rFile)
+void writeComponentState(const Component *pComponent, const HString &fullName, std::ostream &rFile)
 {
-    // Write port identifier
-    size_t identifier = TIMEIDENTIFIER;
-    rFile.write(reinterpret_cast<char*>(&identifier), 2);
-    rFile.write(reinterpret_cast<char*>(&time), sizeof(double));
+    SimulationStateBuffer buffer;
+    pComponent->saveState(buffer);
+    // Only components that have internal state write anything
+    if (!buffer.isEmpty())
+    {
+        std::ostringstream data(std::ios::binary);
+        size_t namelen = fullName.size();
+        data.write(reinterpret_cast<char*>(&namelen), 2);
+        unsigned long long datalen = buffer.getSize();
+        data.write(reinterpret_cast<char*>(&datalen), 8);
+        data.write(fullName.c_str(), namelen);
+        data.write(buffer.getData(), std::streamsize(datalen));
+        writePackage(COMPONENTSTATEIDENTIFIER, data.str(), rFile);
+    }
+}
+
+void writeTimeData(double time, std::ostream &rFile)
+{
+    std::ostringstream data(std::ios::binary);
+    data.write(reinterpret_cast<char*>(&time), sizeof(double));
+    writePackage(TIMEIDENTIFIER, data.str(), rFile);
 }
 
-size_t readIdentifier(std::ifstream &rFile)
+//! @brief Read the identifier of the next package
+//! @returns False if there are no more packages
+bool readIdentifier(std::istream &rFile, size_t &rIdentifier)
 {
-    size_t identifier=0;
-    rFile.read(reinterpret_cast<char*>(&identifier), 2);
-    return identifier;
+    rIdentifier = 0;
+    rFile.read(reinterpret_cast<char*>(&rIdentifier), 2);
+    return (rFile.gcount() == 2);
 }
 
-void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
+//! @brief Returns the number of bytes left to read in a stream
+unsigned long long numRemainingBytes(std::istream &rFile)
+{
+    const std::streampos pos = rFile.tellg();
+    rFile.seekg(0, std::ios::end);
+    const std::streampos end = rFile.tellg();
+    rFile.seekg(pos);
+    return static_cast<unsigned long long>(end - pos);
+}
+
+void readPortData(std::istream &rFile, ComponentSystem *pRootSystem)
 {
     // Read rest of header
     size_t namelength=0, datalength=0;
@@ -98,8 +174,11 @@ void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
     delete[] pNameBuffer;
 
     // Read data
-    double *pDataBuffer = new double[datalength];
-    rFile.read(reinterpret_cast<char*>(pDataBuffer), datalength*sizeof(double));
+    std::vector<double> dataBuffer(datalength);
+    if (datalength > 0)
+    {
+        rFile.read(reinterpret_cast<char*>(&dataBuffer[0]), datalength*sizeof(double));
+    }
 
     // Parse fullName and find port to write into
     ComponentSystem *pSystem=pRootSystem;
@@ -116,12 +195,13 @@ void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
             if (pComponent)
             {
                 Port* pPort = pComponent->getPort(pname);
-                if (pPort)
+                if (pPort && pPort->getDataVectorPtr())
                 {
-                    std::vector<double> *pData = pPort->getDataVectorPtr();
-                    for (size_t d=0; d<std::min(datalength, pData->size()); ++d)
+                    // Write through the node data pointers, the values may live in a node data arena or partition storage
+                    const size_t n = std::min(datalength, pPort->getDataVectorPtr()->size());
+                    for (size_t d=0; d<n; ++d)
                     {
-                        pData->at(d) = pDataBuffer[d];
+                        *pPort->getNodeDataPtr(d) = dataBuffer[d];
                     }
                 }
             }
@@ -148,7 +228,71 @@ void readPortData(std::ifstream &rFile, ComponentSystem *pRootSystem)
     //! @todo need lots of error handling in code above
 }
 
-double readTimeData(std::ifstream &rFile)
+//! @brief Find a component from its full name, as written by saveSimulationPointInternal, such as /Subsystem/Component
+Component *findComponentFromFullName(const HString &rFullName, ComponentSystem *pRootSystem)
+{
+    ComponentSystem *pSystem = pRootSystem;
+    Component *pComponent = 0;
+    size_t b = rFullName.find_first_of('/');
+    while (pSystem && (b != HString::npos) && (b+1 < rFullName.size()))
+    {
+        const size_t e = rFullName.find_first_of('/', b+1);
+        const HString name = (e == HString::npos) ? rFullName.substr(b+1) : rFullName.substr(b+1, e-b-1);
+        pComponent = pSystem->getSubComponent(name);
+        if (!pComponent || (e == HString::npos))
+        {
+            break;
+        }
+        pSystem = pComponent->isComponentSystem() ? static_cast<ComponentSystem*>(pComponent) : 0;
+        pComponent = 0;
+        b = e;
+    }
+    return pComponent;
+}
+
+//! @brief Read a component state package, and restore it into the component if doRestore is true
+//! @returns False if the package could not be read or the component could not restore its state
+bool readComponentState(std::istream &rFile, ComponentSystem *pRootSystem, const bool doRestore)
+{
+    size_t namelength=0;
+    unsigned long long datalength=0;
+    rFile.read(reinterpret_cast<char*>(&namelength), 2);
+    rFile.read(reinterpret_cast<char*>(&datalength), 8);
+
+    std::vector<char> nameBuffer(namelength+1, '\0');
+    rFile.read(&nameBuffer[0], namelength);
+    const HString fullName(&nameBuffer[0]);
+
+    std::vector<char> dataBuffer(static_cast<size_t>(datalength));
+    if (datalength > 0)
+    {
+        rFile.read(&dataBuffer[0], std::streamsize(datalength));
+    }
+    if (!rFile.good())
+    {
+        return false;
+    }
+
+    if (doRestore)
+    {
+        Component *pComponent = findComponentFromFullName(fullName, pRootSystem);
+        if (!pComponent)
+        {
+            pRootSystem->addWarningMessage("Could not find component "+fullName+" when restoring simulation state");
+            return true;
+        }
+        SimulationStateBuffer buffer;
+        buffer.setData(dataBuffer.empty() ? 0 : &dataBuffer[0], dataBuffer.size());
+        if (!pComponent->restoreState(buffer) || buffer.hasFailed())
+        {
+            pComponent->addErrorMessage("Could not restore the internal state from the simulation state file");
+            return false;
+        }
+    }
+    return true;
+}
+
+double readTimeData(std::istream &rFile)
 {
     // Read time
     double time=0;
@@ -156,8 +300,101 @@ double readTimeData(std::ifstream &rFile)
     return time;
 }
 
+//! @brief Read all packages in a simulation point stream
+//! @param [in] rStream The stream to read from
+//! @param [in] pRootSystem The top-level system to restore node data into
+//! @param [out] rTime The saved simulation time
+//! @param [in] doRestoreStates If component internal states should be restored, the system must be initialized
+//! @returns False if the stream could not be read or a component state could not be restored
+bool readSimulationPoint(std::istream &rStream, ComponentSystem *pRootSystem, double &rTime, const bool doRestoreStates)
+{
+    size_t id;
+    if (!readIdentifier(rStream, id))
+    {
+        // Empty file
+        return true;
+    }
 
-void saveSimulationPointInternal(ComponentSystem *pRootSystem, const HString &namePrefix, std::ofstream &rFile)
+    // Files from older versions have no format version package, and packages without length that can not be skipped
+    if (id != FORMATVERSIONIDENTIFIER)
+    {
+        bool success = true;
+        do
+        {
+            switch (id)
+            {
+            case TIMEIDENTIFIER:
+                rTime = readTimeData(rStream);
+                break;
+            case PORTIDENTIFIER:
+                readPortData(rStream, pRootSystem);
+                break;
+            case COMPONENTSTATEIDENTIFIER:
+                success = readComponentState(rStream, pRootSystem, doRestoreStates) && success;
+                break;
+            default:
+                pRootSystem->addErrorMessage("Unknown data in simulation state file, the rest of the file is ignored");
+                return false;
+            }
+        } while (readIdentifier(rStream, id));
+        return success;
+    }
+
+    bool success = true;
+    do
+    {
+        unsigned long long length=0;
+        rStream.read(reinterpret_cast<char*>(&length), 8);
+        if ((rStream.gcount() != 8) || (length > numRemainingBytes(rStream)))
+        {
+            pRootSystem->addErrorMessage("The simulation state file is truncated");
+            return false;
+        }
+
+        if ((id == FORMATVERSIONIDENTIFIER) || (id == TIMEIDENTIFIER) || (id == PORTIDENTIFIER) || (id == COMPONENTSTATEIDENTIFIER))
+        {
+            std::string dataBuffer(static_cast<size_t>(length), '\0');
+            if (length > 0)
+            {
+                rStream.read(&dataBuffer[0], std::streamsize(length));
+            }
+            std::istringstream data(dataBuffer, std::ios::binary);
+
+            switch (id)
+            {
+            case FORMATVERSIONIDENTIFIER:
+            {
+                size_t version=0;
+                data.read(reinterpret_cast<char*>(&version), 2);
+                if (version > FORMATVERSION)
+                {
+                    pRootSystem->addErrorMessage("The simulation state file is from a newer version of Hopsan and can not be read");
+                    return false;
+                }
+                break;
+            }
+            case TIMEIDENTIFIER:
+                rTime = readTimeData(data);
+                break;
+            case PORTIDENTIFIER:
+                readPortData(data, pRootSystem);
+                break;
+            case COMPONENTSTATEIDENTIFIER:
+                success = readComponentState(data, pRootSystem, doRestoreStates) && success;
+                break;
+            }
+        }
+        else
+        {
+            // Skip packages from later versions that this version does not know about
+            rStream.ignore(std::streamsize(length));
+        }
+    } while (readIdentifier(rStream, id));
+    return success;
+}
+
+
+void saveSimulationPointInternal(ComponentSystem *pRootSystem, const HString &namePrefix, std::ostream &rFile)
 {
     //! @todo not sure if we should actually save/load the simulation time
     writeTimeData(pRootSystem->getTime(), rFile);
@@ -172,6 +409,8 @@ void saveSimulationPointInternal(ComponentSystem *pRootSystem, const HString &na
             writePortData(ports[p], namePrefix+pComp->getName()+'/', rFile);
         }
 
+        writeComponentState(pComp, namePrefix+pComp->getName(), rFile);
+
         if (pComp->isComponentSystem())
         {
             saveSimulationPointInternal(dynamic_cast<ComponentSystem*>(pComp), namePrefix+pComp->getName()+'/', rFile);
@@ -183,9 +422,10 @@ void saveSimulationPointInternal(ComponentSystem *pRootSystem, const HString &na
 void hopsan::saveSimulationPoint(HString fileName, ComponentSystem *pRootSystem)
 {
     std::ofstream file;
-    file.open(fileName.c_str());
+    file.open(fileName.c_str(), std::ios::binary);
     if (file.is_open())
     {
+        writeFormatVersion(file);
         saveSimulationPointInternal(pRootSystem, "/", file);
     }
     file.close();
@@ -194,25 +434,63 @@ void hopsan::saveSimulationPoint(HString fileName, ComponentSystem *pRootSystem)
 void hopsan::restoreSimulationPoint(HString fileName, ComponentSystem *pRootSystem, double &rTimeOffset)
 {
     std::ifstream file;
-    file.open(fileName.c_str());
+    file.open(fileName.c_str(), std::ios::binary);
     if (file.is_open())
     {
-        while (!file.eof())
-        {
-            // Read identifier from next package
-            size_t id = readIdentifier(file);
-            switch (id)
-            {
-            case TIMEIDENTIFIER:
-                rTimeOffset = readTimeData(file);
-                break;
-            case PORTIDENTIFIER:
-                readPortData(file, pRootSystem);
-                break;
-            default:
-                break;
-            }
-        }
+        // Component internal state can only be restored after initialize, see restoreSimulationCheckpoint()
+        readSimulationPoint(file, pRootSystem, rTimeOffset, false);
     }
     file.close();
 }
+
+//! @brief Restore node data and component internal states from a simulation point stream into an initialized system
+bool restoreSimulationCheckpointInternal(std::istream &rStream, ComponentSystem *pRootSystem)
+{
+    double time=0;
+    const bool success = readSimulationPoint(rStream, pRootSystem, time, true);
+    // The start values were logged at initialize, before they were overwritten
+    pRootSystem->relogStartValues();
+    return success;
+}
+
+//! @brief Restore both node data and component internal state from a simulation point file into an initialized system
+//! @details Call restoreSimulationPoint() and initialize the system with the saved time as start time first, then call
+//! this function to overwrite the initial values, so that the simulation continues exactly from the saved point.
+//! Only components that implement Component::saveState() and Component::restoreState() have their internal state restored.
+//! @param [in] fileName The simulation point file
+//! @param [in] pRootSystem The initialized top-level system
+//! @returns True if the file could be read and all component states were restored
+bool hopsan::restoreSimulationCheckpoint(HString fileName, ComponentSystem *pRootSystem)
+{
+    bool success = false;
+    std::ifstream file;
+    file.open(fileName.c_str(), std::ios::binary);
+    if (file.is_open())
+    {
+        success = restoreSimulationCheckpointInternal(file, pRootSystem);
+    }
+    file.close();
+    return success;
+}
+
+//! @brief Save node data and component internal states of an initialized system to memory
+//! @details Used to carry the current state of a system over a re-initialization, see restoreSimulationCheckpointFromMemory()
+//! @param [out] rData The saved state, in the simulation point file format
+//! @param [in] pRootSystem The initialized top-level system
+void hopsan::saveSimulationCheckpointToMemory(std::string &rData, ComponentSystem *pRootSystem)
+{
+    std::ostringstream stream(std::ios::binary);
+    writeFormatVersion(stream);
+    saveSimulationPointInternal(pRootSystem, "/", stream);
+    rData = stream.str();
+}
+
+//! @brief Restore node data and component internal states saved by saveSimulationCheckpointToMemory() into an initialized system
+//! @param [in] rData The saved state
+//! @param [in] pRootSystem The initialized top-level system
+//! @returns True if all component states were restored
+bool hopsan::restoreSimulationCheckpointFromMemory(const std::string &rData, ComponentSystem *pRootSystem)
+{
+    std::istringstream stream(rData, std::ios::binary);
+    return restoreSimulationCheckpointInternal(stream, pRootSystem);
+}
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   SimulationStateBuffer.cpp
+//!
+//! @brief Contains the simulation state buffer class, used to save and restore component internal state
+//!
+//$Id$
+
+#include "CoreUtilities/SimulationStateBuffer.h"
+#include <cstring>
+
+using namespace hopsan;
+
+SimulationStateBuffer::SimulationStateBuffer()
+{
+    mReadPos = 0;
+    mHasFailed = false;
+}
+
+//! @brief Remove all data from the buffer
+void SimulationStateBuffer::clear()
+{
+    mData.clear();
+    mReadPos = 0;
+    mHasFailed = false;
+}
+
+bool SimulationStateBuffer::isEmpty() const
+{
+    return mData.empty();
+}
+
+//! @brief Returns the number of bytes in the buffer
+size_t SimulationStateBuffer::getSize() const
+{
+    return mData.size();
+}
+
+const char *SimulationStateBuffer::getData() const
+{
+    return mData.empty() ? 0 : &mData[0];
+}
+
+//! @brief Replace the buffer contents, and restart reading from the beginning
+//! @param [in] pData Pointer to the data to copy
+//! @param [in] nBytes The number of bytes to copy
+void SimulationStateBuffer::setData(const char *pData, const size_t nBytes)
+{
+    mData.assign(pData, pData+nBytes);
+    mReadPos = 0;
+    mHasFailed = false;
+}
+
+//! @brief Append raw bytes to the end of the buffer
+//! @param [in] pData Pointer to the data to append
+//! @param [in] nBytes The number of bytes to append
+void SimulationStateBuffer::writeBytes(const void *pData, const size_t nBytes)
+{
+    const char *pBytes = static_cast<const char*>(pData);
+    mData.insert(mData.end(), pBytes, pBytes+nBytes);
+}
+
+//! @brief Read raw bytes from the current read position
+//! @param [out] pData Pointer to where the data should be copied
+//! @param [in] nBytes The number of bytes to read
+//! @returns True if successful, false if there were not enough bytes left in the buffer
+bool SimulationStateBuffer::readBytes(void *pData, const size_t nBytes)
+{
+    if (mHasFailed || (mReadPos+nBytes > mData.size()))
+    {
+        mHasFailed = true;
+        return false;
+    }
+    if (nBytes > 0)
+    {
+        memcpy(pData, &mData[mReadPos], nBytes);
+    }
+    mReadPos += nBytes;
+    return true;
+}
+
+//! @brief Check if any read has gone past the end of the buffer
+bool SimulationStateBuffer::hasFailed() const
+{
+    return mHasFailed;
+}
@@ -37,6 +37,7 @@
 #include "CoreUtilities/HmfLoader.h"
 #include "CoreUtilities/LoadExternal.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
+#include "CoreUtilities/MultiThreadingUtilities.h"
 #include "Quantities.h"
 #include <string.h>
 #include <stdio.h>
@@ -100,6 +101,13 @@ HopsanEssentials::HopsanEssentials()
 
     mpExternalLoader = new LoadExternal(mpComponentFactory, mpNodeFactory, mpMessageHandler);
 
+    // The thread pool is shared by all multi-threaded simulations, worker threads are created when first needed
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    mpSimulationThreadPool = new SimulationThreadPool;
+#else
+    mpSimulationThreadPool = 0;
+#endif
+
     // Make sure that internal Nodes and Components register
     register_default_nodes(mpNodeFactory);
     mpComponentFactory->registerCreatorFunction(HOPSAN_BUILTIN_TYPENAME_DUMMYCOMPONENT, DummyComponent::Creator);
@@ -141,6 +149,10 @@ HopsanEssentials::HopsanEssentials()
 //! @brief HopsanEssentials Destructor
 HopsanEssentials::~HopsanEssentials()
 {
+#if defined(HOPSANCORE_USEMULTITHREADING)
+    delete mpSimulationThreadPool;
+#endif
+
     //Clear the factories
     //! @todo need to make sure that every one has destroyed all components/nodes before we unregister them, it probably cant be done from inside here
     mpNodeFactory->clearFactory();
@@ -356,6 +368,13 @@ SimulationHandler *HopsanEssentials::getSimulationHandler()
     return &mSimulationHandler;
 }
 
+//! @brief Returns the persistent thread pool used by multi-threaded simulations
+//! @returns A pointer to the thread pool, or 0 if HopsanCore was built without multi-threading support
+SimulationThreadPool *HopsanEssentials::getSimulationThreadPool()
+{
+    return mpSimulationThreadPool;
+}
+
 //! @brief Get the message waiting on the message queue
 //! @param [out] rMessage A reference to the message string
 //! @param [out] rType A reference to the message type string
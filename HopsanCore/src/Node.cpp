@@ -37,8 +37,10 @@
 
 #include <fstream>
 #include <cassert>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <limits>
 #include "Node.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "Port.h"
@@ -57,6 +59,18 @@ bool anyPortWantsLogging(std::vector<hopsan::Port*>& ports)
     }
     return false;
 }
+
+bool anyPortWantsLogging(std::vector<hopsan::Port*>& ports, const size_t dataId)
+{
+    for (size_t p=0; p<ports.size(); ++p)
+    {
+        if (ports[p]->isLoggingEnabled() && ports[p]->isLogVariableEnabled(dataId))
+        {
+            return true;
+        }
+    }
+    return false;
+}
 }
 
 using namespace std;
@@ -69,8 +83,13 @@ Node::Node(const size_t datalength)
     // Make sure clear (should not really be needed)
     mDataValues.clear();
     mDataStorage.clear();
+    mDataStorageValid = false;
     mConnectedPorts.clear();
 
+    mnLogAccumulated = 0;
+    mnLogSlots = 0;
+    mLogMode = LogSampled;
+
     // Init pointer
     mpOwnerSystem = 0;
 
@@ -80,6 +99,7 @@ Node::Node(const size_t datalength)
     // Resize
     mDataDescriptions.resize(datalength);
     mDataValues.resize(datalength,0.0);
+    mpDataValues = mDataValues.empty() ? 0 : &mDataValues[0];
 
     // Default disabled logging
     setDoLogIfEnabled(false);
@@ -114,7 +134,7 @@ size_t Node::getNumDataVariables() const
 
 double *Node::getDataPtr(const size_t data_type)
 {
-    return &mDataValues[data_type];
+    return &mpDataValues[data_type];
 }
 
 
@@ -234,7 +254,7 @@ void Node::copyNodeDataValuesTo(Node *pOtherNode) const
         for(size_t i=0; i<pOtherNode->getNumDataVariables(); ++i)
         {
             //! @todo look over if all vector positions should be set or not.
-            pOtherNode->mDataValues[i] = mDataValues[i];
+            pOtherNode->mpDataValues[i] = mpDataValues[i];
         }
         setTLMNodeDataValuesTo(pOtherNode); //Handles Wave, imp variables and similar
     }
@@ -259,24 +279,218 @@ void Node::setTLMNodeDataValuesTo(Node* /*pOtherNode*/) const
 
 
 //! @brief Pre allocate memory for the needed amount of log data
-void Node::preAllocateLogSpace(const size_t nLogSlots)
-{
+//! @details One column is allocated for each variable that any connected port wants to log
+//! @param [in] nLogSlots The number of log samples
+//! @param [in] mode How simulation steps between log samples are reduced into one sample
+void Node::preAllocateLogSpace(const size_t nLogSlots, const LogDecimationModeT mode)
+{
+    mLogColumns.clear();
+    mLogMinColumns.clear();
+    mLogMaxColumns.clear();
+    mLoggedDataIds.clear();
+    mDataStorage.clear();
+    mDataStorageValid = false;
+
     // Don't try to allocate if we are not going to log
     if (mDoLog)
     {
-        mDataStorage.resize(nLogSlots, vector<double>(mDataValues.size()));
+        mnLogSlots = nLogSlots;
+        mLogMode = mode;
+        for (size_t i=0; i<mDataValues.size(); ++i)
+        {
+            if (anyPortWantsLogging(mConnectedPorts, i))
+            {
+                mLoggedDataIds.push_back(i);
+            }
+        }
+
+        mLogColumns.resize(mDataValues.size());
+        if (mLogMode == LogEnvelope)
+        {
+            mLogMinColumns.resize(mDataValues.size());
+            mLogMaxColumns.resize(mDataValues.size());
+        }
+        for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+        {
+            const size_t id = mLoggedDataIds[i];
+            mLogColumns[id].resize(nLogSlots, 0.0);
+            if (mLogMode == LogEnvelope)
+            {
+                mLogMinColumns[id].resize(nLogSlots, 0.0);
+                mLogMaxColumns[id].resize(nLogSlots, 0.0);
+            }
+        }
+
+        mLogMin.resize(mDataValues.size());
+        mLogMax.resize(mDataValues.size());
+        mLogSum.resize(mDataValues.size());
+        resetLogAccumulators();
     }
 }
 
 
-//! @brief Copy current data vector into log storage at given logslot
+//! @brief Copy current data values into log storage at given logslot
+//! @details In the decimating log modes, the current values are included in the window before it is reduced into the log slot
 //! @warning No bounds check is done
 void Node::logData(const size_t logSlot)
 {
     if (mDoLog)
     {
-        mDataStorage[logSlot] = mDataValues;
+        if (mLogMode == LogSampled)
+        {
+            for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+            {
+                const size_t id = mLoggedDataIds[i];
+                mLogColumns[id][logSlot] = mpDataValues[id];
+            }
+        }
+        else
+        {
+            accumulateLogData();
+            const double n = double(mnLogAccumulated);
+            for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+            {
+                const size_t id = mLoggedDataIds[i];
+                switch (mLogMode)
+                {
+                case LogMin:
+                    mLogColumns[id][logSlot] = mLogMin[id];
+                    break;
+                case LogMax:
+                    mLogColumns[id][logSlot] = mLogMax[id];
+                    break;
+                case LogEnvelope:
+                    mLogMinColumns[id][logSlot] = mLogMin[id];
+                    mLogMaxColumns[id][logSlot] = mLogMax[id];
+                    mLogColumns[id][logSlot] = mLogSum[id]/n;
+                    break;
+                default:
+                    mLogColumns[id][logSlot] = mLogSum[id]/n;
+                    break;
+                }
+            }
+            resetLogAccumulators();
+        }
+        mDataStorageValid = false;
+    }
+}
+
+
+//! @brief Include the current data values in the decimation window of the next log sample
+//! @details Called on simulation steps that are not logged, only needed in the decimating log modes
+void Node::accumulateLogData()
+{
+    for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+    {
+        const size_t id = mLoggedDataIds[i];
+        const double value = mpDataValues[id];
+        mLogMin[id] = std::min(mLogMin[id], value);
+        mLogMax[id] = std::max(mLogMax[id], value);
+        mLogSum[id] += value;
     }
+    ++mnLogAccumulated;
+}
+
+
+//! @brief Reset the decimation window
+void Node::resetLogAccumulators()
+{
+    std::fill(mLogMin.begin(), mLogMin.end(), std::numeric_limits<double>::max());
+    std::fill(mLogMax.begin(), mLogMax.end(), -std::numeric_limits<double>::max());
+    std::fill(mLogSum.begin(), mLogSum.end(), 0.0);
+    mnLogAccumulated = 0;
+}
+
+
+//! @brief Check if this node is logging data
+bool Node::isLogging() const
+{
+    return mDoLog && !mLogColumns.empty();
+}
+
+
+//! @brief Returns a pointer to the log data column of one variable
+//! @param [in] dataId The variable id
+//! @param [in] column Which column to get, the min and max columns only exist in LogEnvelope mode
+//! @returns Pointer to the column (one value per log slot) or 0 if the variable is not logged
+const std::vector<double> *Node::getLogDataColumnPtr(const size_t dataId, const LogColumnT column) const
+{
+    const std::vector<std::vector<double> > *pColumns = &mLogColumns;
+    if (column == LogMinColumn)
+    {
+        pColumns = &mLogMinColumns;
+    }
+    else if (column == LogMaxColumn)
+    {
+        pColumns = &mLogMaxColumns;
+    }
+
+    if ((dataId < pColumns->size()) && !(*pColumns)[dataId].empty())
+    {
+        return &(*pColumns)[dataId];
+    }
+    return 0;
+}
+
+
+//! @brief Returns the log data with one row (of all variables) per log slot
+//! @details The rows are copied from the log data columns when needed, variables that are not logged are NaN.
+//! @deprecated This doubles the memory used for log data, use getLogDataColumnPtr() instead
+std::vector<std::vector<double> > *Node::getLogDataRowsPtr()
+{
+    if (!mDataStorageValid)
+    {
+        mDataStorage.clear();
+        if (isLogging())
+        {
+            mDataStorage.resize(mnLogSlots, std::vector<double>(mDataValues.size(), std::numeric_limits<double>::quiet_NaN()));
+            for (size_t i=0; i<mLoggedDataIds.size(); ++i)
+            {
+                const size_t id = mLoggedDataIds[i];
+                for (size_t s=0; s<mnLogSlots; ++s)
+                {
+                    mDataStorage[s][id] = mLogColumns[id][s];
+                }
+            }
+        }
+        mDataStorageValid = true;
+    }
+    return &mDataStorage;
+}
+
+
+//! @brief Move the data values into external storage, such as the node data arena of the owner system
+//! @param [in] pData Pointer to storage for getNumDataVariables() values, current values are copied into it
+//! @details All data pointers handed out before this call will point to the old (now unused) storage
+void Node::attachDataValues(double *pData)
+{
+    if (pData && !mDataValues.empty())
+    {
+        if (isDataValuesAttached())
+        {
+            detachDataValues();
+        }
+        std::copy(mDataValues.begin(), mDataValues.end(), pData);
+        mpDataValues = pData;
+    }
+}
+
+
+//! @brief Copy the data values back from external storage and let the node use its own data vector again
+void Node::detachDataValues()
+{
+    if (isDataValuesAttached())
+    {
+        std::copy(mpDataValues, mpDataValues+mDataValues.size(), mDataValues.begin());
+        mpDataValues = &mDataValues[0];
+    }
+}
+
+
+//! @brief Check if the data values currently live in external storage
+bool Node::isDataValuesAttached() const
+{
+    return !mDataValues.empty() && (mpDataValues != &mDataValues[0]);
 }
 
 
@@ -377,7 +591,12 @@ void Node::setDoLogIfEnabled(bool doLog)
     else
     {
         mDoLog = false;
+        mLogColumns.clear();
+        mLogMinColumns.clear();
+        mLogMaxColumns.clear();
+        mLoggedDataIds.clear();
         mDataStorage.clear();
+        mDataStorageValid = false;
     }
 }
 
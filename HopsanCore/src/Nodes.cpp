@@ -91,9 +91,11 @@ void hopsan::register_default_nodes(NodeFactory* pNodeFactory)
 
 void NodeSignalND::setSignalNumDimensions(size_t numDims)
 {
-    // Resize
+    // Resize, this will also detach the data values from any node data arena
+    detachDataValues();
     mDataDescriptions.resize(numDims);
     mDataValues.resize(numDims,0.0);
+    mpDataValues = mDataValues.empty() ? 0 : &mDataValues[0];
 
     // Set name
     HString nicename = "signal"+to_hstring(numDims)+"d";
@@ -164,6 +164,28 @@ bool ParameterEvaluator::setParameterValue(const HString &rValue, ParameterEvalu
 }
 
 
+//! @brief Set the value of a double parameter directly, without evaluating the value text
+//! @param [in] value The new value for the parameter
+//! @return true if success, false if the parameter is not of type double
+//!
+//! This function is used by ParameterHandle
+bool ParameterEvaluator::setDoubleValue(const double value)
+{
+    if (!mType.compare("double"))
+    {
+        return false;
+    }
+
+    // The value text is kept in sync, since it is evaluated again on initialize and used when saving the model
+    mParameterValue = to_hstring(value);
+    if (mpData)
+    {
+        *static_cast<double*>(mpData) = value;
+    }
+    return true;
+}
+
+
 //! @brief Returns the type of the parameter
 //! @return The type of the parameter
 const HString &ParameterEvaluator::getType() const
@@ -890,3 +912,164 @@ Component *ParameterEvaluatorHandler::getComponent() const
     return mComponent;
 }
 
+
+//! @class hopsan::ParameterHandle
+//! @brief The ParameterHandle class resolves a parameter once, so that its value can be set repeatedly without name lookup
+
+ParameterHandle::ParameterHandle()
+{
+    mpParameter = 0;
+}
+
+//! @brief Resolve a parameter from its full name
+//! @param [in] pRootSystem The system to search from
+//! @param [in] rFullName The full parameter name. Either the name of a system parameter in pRootSystem, or ComponentName#ParameterName,
+//! where the component name may be prefixed by subsystem names separated by $, e.g. Subsystem$Mass#m or Cylinder#A_1#Value.
+//! Use self#ParameterName to refer to system parameters in pRootSystem explicitly.
+//! @return true if the parameter was found and is of type double, otherwise false
+bool ParameterHandle::resolve(ComponentSystem *pRootSystem, const HString &rFullName)
+{
+    mFullName = rFullName;
+    mpParameter = 0;
+    mDependentParameters.clear();
+    if (!pRootSystem)
+    {
+        return false;
+    }
+
+    // Find the component that owns the parameter
+    Component *pComponent = pRootSystem;
+    HString parameterName = rFullName;
+    const size_t hashPos = rFullName.find('#');
+    if (hashPos != HString::npos)
+    {
+        const HString componentName = rFullName.substr(0, hashPos);
+        parameterName = rFullName.substr(hashPos+1);
+        if (componentName != "self")
+        {
+            HVector<HString> nameParts = componentName.split('$');
+            ComponentSystem *pSystem = pRootSystem;
+            for (size_t i=0; pSystem && (i+1<nameParts.size()); ++i)
+            {
+                pSystem = pSystem->getSubComponentSystem(nameParts[i]);
+            }
+            pComponent = pSystem ? pSystem->getSubComponent(nameParts.last()) : 0;
+            if (!pComponent)
+            {
+                pRootSystem->addErrorMessage("Could not find component: "+componentName+" when resolving parameter handle");
+                return false;
+            }
+        }
+    }
+
+    const std::vector<ParameterEvaluator*> *pParameters = pComponent->getParametersVectorPtr();
+    for (size_t i=0; i<pParameters->size(); ++i)
+    {
+        if ((*pParameters)[i]->getName() == parameterName)
+        {
+            mpParameter = (*pParameters)[i];
+            break;
+        }
+    }
+    if (!mpParameter)
+    {
+        pRootSystem->addErrorMessage("Could not find parameter: "+rFullName+" when resolving parameter handle");
+        return false;
+    }
+    if (mpParameter->getType() != "double")
+    {
+        pRootSystem->addErrorMessage("Parameter: "+rFullName+" is not of type double, parameter handles only support double parameters");
+        mpParameter = 0;
+        return false;
+    }
+
+    // System parameters can be referenced from anywhere below the system, component parameters only from within the component
+    findDependentParameters(pComponent, parameterName, pComponent->isComponentSystem());
+    return true;
+}
+
+//! @brief Check if the handle has been resolved successfully
+bool ParameterHandle::isValid() const
+{
+    return (mpParameter != 0);
+}
+
+//! @brief Returns the full parameter name that the handle was resolved from
+const HString &ParameterHandle::getFullName() const
+{
+    return mFullName;
+}
+
+//! @brief Set the parameter value
+//! @details The parameter value is written directly, only parameters that reference this parameter are re-evaluated
+//! @param [in] value The new value
+//! @return true if success, otherwise false
+bool ParameterHandle::setValue(const double value)
+{
+    if (!mpParameter || !mpParameter->setDoubleValue(value))
+    {
+        return false;
+    }
+
+    bool success = true;
+    for (size_t i=0; i<mDependentParameters.size(); ++i)
+    {
+        success = mDependentParameters[i]->evaluate() && success;
+    }
+    return success;
+}
+
+//! @brief Get the current (evaluated) parameter value
+//! @return The value, or 0 if the handle is not valid or the value could not be evaluated
+double ParameterHandle::getValue() const
+{
+    if (mpParameter)
+    {
+        if (mpParameter->getDataPtr())
+        {
+            return *static_cast<double*>(mpParameter->getDataPtr());
+        }
+        HString evaluatedValue;
+        if (mpParameter->evaluate(evaluatedValue))
+        {
+            bool isOK;
+            const double value = evaluatedValue.toDouble(&isOK);
+            if (isOK)
+            {
+                return value;
+            }
+        }
+    }
+    return 0;
+}
+
+//! @brief Collect parameters that reference a parameter name in their value text
+//! @details Dependencies are followed transitively, the matching is conservative, so some unrelated parameters may be included
+//! @param [in] pComponent The component to search in
+//! @param [in] rName The parameter name to look for
+//! @param [in] recurse Whether sub components should be searched as well (if pComponent is a system)
+void ParameterHandle::findDependentParameters(Component *pComponent, const HString &rName, const bool recurse)
+{
+    const std::vector<ParameterEvaluator*> *pParameters = pComponent->getParametersVectorPtr();
+    for (size_t i=0; i<pParameters->size(); ++i)
+    {
+        ParameterEvaluator *pParameter = (*pParameters)[i];
+        const HString &rValue = pParameter->getValue();
+        if ((pParameter != mpParameter) && !rValue.isNummeric() && rValue.containes(rName) &&
+            (find(mDependentParameters.begin(), mDependentParameters.end(), pParameter) == mDependentParameters.end()))
+        {
+            mDependentParameters.push_back(pParameter);
+            // Anything that depends on the dependent parameter must also be re-evaluated
+            findDependentParameters(pComponent, pParameter->getName(), pComponent->isComponentSystem());
+        }
+    }
+
+    if (recurse && pComponent->isComponentSystem())
+    {
+        const std::vector<Component*> subComponents = static_cast<ComponentSystem*>(pComponent)->getSubComponents();
+        for (size_t c=0; c<subComponents.size(); ++c)
+        {
+            findDependentParameters(subComponents[c], rName, true);
+        }
+    }
+}
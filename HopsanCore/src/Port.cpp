@@ -199,7 +199,7 @@ double Port::readNodeSafe(const size_t idx, const size_t subPortIdx) const
 
     if (idx < mpNode->getNumDataVariables())
     {
-        return mpNode->mDataValues[idx];
+        return mpNode->mpDataValues[idx];
     }
     getComponent()->addErrorMessage("data idx out of range in Port::readNodeSafe()");
     return -1;
@@ -217,7 +217,7 @@ void Port::writeNodeSafe(const size_t idx, const double value, const size_t subP
     HOPSAN_UNUSED(subPortIdx)
     if (idx < mpNode->getNumDataVariables())
     {
-        mpNode->mDataValues[idx] = value;
+        mpNode->mpDataValues[idx] = value;
     }
     else
     {
@@ -424,7 +424,7 @@ bool Port::haveLogData(const size_t subPortIdx)
     if (mpNode)
     {
         // Here we assume that timevector DOES exist. If simulation code is correct it should exist
-        return !mpNode->mDataStorage.empty();
+        return mpNode->isLogging();
     }
     return false;
 }
@@ -439,6 +439,25 @@ bool Port::isLoggingEnabled() const
     return mEnableLogging;
 }
 
+//! @brief Enable or disable logging of one variable, variables are logged by default if the port is logged
+//! @param[in] dataId The variable id
+//! @param[in] enableLog Whether to log the variable or not
+void Port::setEnableLogVariable(const size_t dataId, const bool enableLog)
+{
+    if (dataId >= mDisabledLogVariables.size())
+    {
+        mDisabledLogVariables.resize(dataId+1, false);
+    }
+    mDisabledLogVariables[dataId] = !enableLog;
+}
+
+//! @brief Check if a variable should be logged (if logging is enabled for the port)
+//! @param[in] dataId The variable id
+bool Port::isLogVariableEnabled(const size_t dataId) const
+{
+    return (dataId >= mDisabledLogVariables.size()) || !mDisabledLogVariables[dataId];
+}
+
 //! @brief Get all node data descriptions
 //! @param [in] subPortIdx Ignored on non multi ports
 //! @returns A const pointer to the internal node vector with node data descriptions
@@ -569,13 +588,15 @@ vector<double> *Port::getLogTimeVectorPtr(const size_t subPortIdx)
     return 0; //Nothing found return 0
 }
 
+//! @brief Returns the log data with one row (of all variables) per log slot
+//! @details The rows are copied from the node log data columns on request, and the copy is rebuilt after each new log sample
+//! @deprecated Use getLogDataColumnPtr() instead, the row copy doubles the memory used for log data
 //! @param [in] subPortIdx Ignored on non multi ports
 vector<vector<double> > *Port::getLogDataVectorPtr(size_t subPortIdx)
 {
-    // TODO use const cast maybe
     HOPSAN_UNUSED(subPortIdx)
     if (mpNode != 0) {
-        return &(mpNode->mDataStorage);
+        return mpNode->getLogDataRowsPtr();
     }
     else {
         return 0;
@@ -586,19 +607,35 @@ const std::vector<std::vector<double> > *Port::getLogDataVectorPtr(size_t subPor
 {
     HOPSAN_UNUSED(subPortIdx)
     if (mpNode != 0) {
-        return &(mpNode->mDataStorage);
+        return mpNode->getLogDataRowsPtr();
     }
     else {
         return 0;
     }
 }
 
+//! @brief Returns the log data of one variable, with one value per log slot
+//! @param [in] dataId The variable id
+//! @param [in] column Which column to get, the min and max columns only exist when logging with LogEnvelope decimation
+//! @param [in] subPortIdx Ignored on non multi ports
+//! @returns Pointer to the log data column, or 0 if the variable is not logged
+const std::vector<double> *Port::getLogDataColumnPtr(const size_t dataId, const LogColumnT column, const size_t subPortIdx) const
+{
+    HOPSAN_UNUSED(subPortIdx)
+    if (mpNode != 0) {
+        return mpNode->getLogDataColumnPtr(dataId, column);
+    }
+    return 0;
+}
+
 bool Port::isInterfacePort() const
 {
     return getComponent()->isComponentSystem();
 }
 
+//! @brief Returns a pointer to the node data vector
 //! @param [in] subPortIdx Ignored on non multi ports
+//! @note If the node data values are kept in a node data arena, the vector is only up to date outside of a simulation
 vector<double> *Port::getDataVectorPtr(const size_t subPortIdx)
 {
     HOPSAN_UNUSED(subPortIdx)
@@ -1156,6 +1193,14 @@ const std::vector<std::vector<double> > *MultiPort::getLogDataVectorPtr(size_t s
     return 0;
 }
 
+const std::vector<double> *MultiPort::getLogDataColumnPtr(const size_t dataId, const LogColumnT column, const size_t subPortIdx) const
+{
+    if (isConnected()) {
+        return mSubPortsVector[subPortIdx]->getLogDataColumnPtr(dataId, column);
+    }
+    return 0;
+}
+
 void MultiPort::setEnableLogging(const bool enableLog)
 {
     HOPSAN_UNUSED(enableLog);
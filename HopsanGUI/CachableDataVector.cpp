@@ -35,12 +35,168 @@
 
 #include <QDebug>
 
+DataVectorView::DataVectorView()
+{
+    mpData = nullptr;
+    mSize = 0;
+    mIsValid = false;
+}
+
+//! @brief Check if the view could be created, an invalid view has no data
+bool DataVectorView::isValid() const
+{
+    return mIsValid;
+}
+
+int DataVectorView::size() const
+{
+    return mSize;
+}
+
+bool DataVectorView::isEmpty() const
+{
+    return (mSize == 0);
+}
+
+const double *DataVectorView::constData() const
+{
+    return mpData;
+}
+
+const double &DataVectorView::operator[](const int idx) const
+{
+    return mpData[idx];
+}
+
+
+//! @brief Build the min/max pyramid for the given data
+//! @returns The pyramid, empty if there is no data
+QVector<double> MinMaxPyramid::build(const DataVectorView &rData)
+{
+    QVector<double> pyramid;
+    const int numSamples = rData.size();
+    if (numSamples == 0)
+    {
+        return pyramid;
+    }
+
+    // Level 0, find min and max in each bucket of samples
+    int numBuckets = (numSamples+BaseBucketSize-1)/BaseBucketSize;
+    pyramid.reserve(2*numBuckets*ValuesPerBucket);
+    for (int b=0; b<numBuckets; ++b)
+    {
+        const int first = b*BaseBucketSize;
+        const int end = qMin(first+BaseBucketSize, numSamples);
+        int minIdx=first, maxIdx=first;
+        for (int i=first+1; i<end; ++i)
+        {
+            if (rData[i] < rData[minIdx])
+            {
+                minIdx = i;
+            }
+            else if (rData[i] > rData[maxIdx])
+            {
+                maxIdx = i;
+            }
+        }
+        pyramid << minIdx << rData[minIdx] << maxIdx << rData[maxIdx];
+    }
+
+    // Following levels, merge pairs of buckets from the level below
+    int levelOffset = 0;
+    while (numBuckets > 1)
+    {
+        const int numNextBuckets = (numBuckets+1)/2;
+        for (int b=0; b<numNextBuckets; ++b)
+        {
+            const int left = (levelOffset+2*b)*ValuesPerBucket;
+            double minIdx = pyramid[left], minVal = pyramid[left+1];
+            double maxIdx = pyramid[left+2], maxVal = pyramid[left+3];
+            if (2*b+1 < numBuckets)
+            {
+                const int right = left+ValuesPerBucket;
+                if (pyramid[right+1] < minVal)
+                {
+                    minIdx = pyramid[right];
+                    minVal = pyramid[right+1];
+                }
+                if (pyramid[right+3] > maxVal)
+                {
+                    maxIdx = pyramid[right+2];
+                    maxVal = pyramid[right+3];
+                }
+            }
+            pyramid << minIdx << minVal << maxIdx << maxVal;
+        }
+        levelOffset += numBuckets;
+        numBuckets = numNextBuckets;
+    }
+    return pyramid;
+}
+
+MinMaxPyramid::MinMaxPyramid()
+{
+}
+
+//! @brief Constructor
+//! @param[in] rPyramid A view of the pyramid created by build()
+//! @param[in] numSamples The number of samples in the data that the pyramid was built from
+MinMaxPyramid::MinMaxPyramid(const DataVectorView &rPyramid, const int numSamples)
+{
+    // Compute the offset (in buckets) to the first bucket of each level
+    int numBuckets = (numSamples+BaseBucketSize-1)/BaseBucketSize;
+    int offset = 0;
+    while (numBuckets > 0)
+    {
+        mLevelOffsets.append(offset);
+        offset += numBuckets;
+        numBuckets = (numBuckets > 1) ? (numBuckets+1)/2 : 0;
+    }
+
+    // Only use the pyramid if it matches the data
+    if (rPyramid.isValid() && (rPyramid.size() == offset*ValuesPerBucket))
+    {
+        mPyramid = rPyramid;
+    }
+    else
+    {
+        mLevelOffsets.clear();
+    }
+}
+
+bool MinMaxPyramid::isValid() const
+{
+    return !mLevelOffsets.isEmpty();
+}
+
+int MinMaxPyramid::getNumLevels() const
+{
+    return mLevelOffsets.size();
+}
+
+//! @brief Returns the number of samples in each bucket on a level
+int MinMaxPyramid::getBucketSize(const int level) const
+{
+    return BaseBucketSize << level;
+}
+
+//! @brief Get the sample indexes of the min and max value in one bucket, (no bounds check is performed)
+void MinMaxPyramid::getBucketMinMaxIndexes(const int level, const int bucket, int &rMinIdx, int &rMaxIdx) const
+{
+    const int i = (mLevelOffsets[level]+bucket)*ValuesPerBucket;
+    rMinIdx = int(mPyramid[i]);
+    rMaxIdx = int(mPyramid[i+2]);
+}
+
+
 MultiDataVectorCache::MultiDataVectorCache(const QString fileName)
 {
     mIsMultiAppending = false;
     mIsMultiReadWriting = false;
     mIsMultiReading = false;
+    mRemoveWhenUnmapped = false;
     mNumSubscribers = 0;
+    mNumMappings = 0;
     mCacheFile.setFileName(fileName);
 }
 
@@ -182,6 +338,13 @@ void MultiDataVectorCache::smartCloseFile()
 
 void MultiDataVectorCache::removeCacheFile()
 {
+    // The file can not be removed (on all platforms) while parts of it are mapped, wait until the last view is released
+    if (mNumMappings > 0)
+    {
+        mRemoveWhenUnmapped = true;
+        return;
+    }
+    mRemoveWhenUnmapped = false;
     bool rc = mCacheFile.remove();
     qDebug() << "Removing file: " << mCacheFile.fileName() << " : " << rc;
 }
@@ -271,6 +434,61 @@ bool MultiDataVectorCache::returnVector(QVector<double> *&rpData)
     return rc;
 }
 
+//! @brief Maps a part of the cache file into memory, so that the data can be read without copying it
+//! @param[in] startByte The first byte to map
+//! @param[in] nBytes The number of bytes to map, must be > 0
+//! @returns Pointer to the mapped data or nullptr on failure, the mapping must be released with unmapData()
+const double *MultiDataVectorCache::mapData(const quint64 startByte, const quint64 nBytes)
+{
+    // Data appended during a multi append may still be buffered in the open file
+    if (mCacheFile.isOpen())
+    {
+        mCacheFile.flush();
+    }
+
+    // A separate file handle is used for the mappings, since the cache file is opened and closed for each read or write
+    if (!mMapFile.isOpen())
+    {
+        mMapFile.setFileName(mCacheFile.fileName());
+        if (!mMapFile.open(QIODevice::ReadOnly))
+        {
+            mError = mMapFile.errorString();
+            return nullptr;
+        }
+    }
+
+    uchar *pMapped = mMapFile.map(qint64(startByte), qint64(nBytes));
+    if (!pMapped)
+    {
+        mError = mMapFile.errorString();
+        if (mNumMappings == 0)
+        {
+            mMapFile.close();
+        }
+        return nullptr;
+    }
+    ++mNumMappings;
+    return reinterpret_cast<const double*>(pMapped);
+}
+
+//! @brief Releases a mapping created by mapData()
+void MultiDataVectorCache::unmapData(const double *pData)
+{
+    if (mMapFile.unmap(reinterpret_cast<uchar*>(const_cast<double*>(pData))))
+    {
+        --mNumMappings;
+    }
+
+    if (mNumMappings == 0)
+    {
+        mMapFile.close();
+        if (mRemoveWhenUnmapped)
+        {
+            removeCacheFile();
+        }
+    }
+}
+
 bool MultiDataVectorCache::hasError() const
 {
     return !mError.isEmpty();
@@ -328,6 +546,7 @@ qint64 MultiDataVectorCache::getNumSubscribers() const
 
 CachableDataVector::CachableDataVector(const QVector<double> &rDataVector, SharedMultiDataVectorCacheT pMultiCache, const bool cached)
 {
+    mpMinMaxPyramid = nullptr;
     mCacheStartByte = 0;
     mCacheNumBytes = 0;
     // This bool is needed so that we can handled non-cached but empty data.
@@ -361,6 +580,7 @@ CachableDataVector::CachableDataVector(const QVector<double> &rDataVector, Share
 
 CachableDataVector::~CachableDataVector()
 {
+    invalidateMinMaxPyramid();
     if (mpMultiCache)
     {
         mpMultiCache->decrementSubscribers();
@@ -371,6 +591,9 @@ void CachableDataVector::switchCacheFile(SharedMultiDataVectorCacheT pMultiCache
 {
     if (mpMultiCache != pMultiCache)
     {
+        // The pyramid is rebuilt in the new cache file when needed
+        invalidateMinMaxPyramid();
+
         bool wasCached = isCached();
         if (wasCached)
         {
@@ -452,15 +675,18 @@ bool CachableDataVector::streamDataTo(QTextStream &rTextStream, const QString se
 {
     if (isCached())
     {
-        QVector<double> temp;
-        bool isOk = copyDataTo(temp);
+        DataVectorView view = getDataView();
+        if (view.isEmpty())
+        {
+            return view.isValid();
+        }
         int i=0;
-        for (; i<temp.size()-1; ++i)
+        for (; i<view.size()-1; ++i)
         {
-            rTextStream << temp[i] << separator;
+            rTextStream << view[i] << separator;
         }
-        rTextStream << temp[i];
-        return isOk;
+        rTextStream << view[i];
+        return true;
     }
     else
     {
@@ -491,8 +717,57 @@ bool CachableDataVector::copyDataTo(QVector<double> &rData)
     return true;
 }
 
+//! @brief Returns a read-only view of the data, data cached on disk is memory mapped instead of copied
+//! @note Fetch a new view if the data has been replaced, the view will not follow data that is moved in the cache
+DataVectorView CachableDataVector::getDataView()
+{
+    DataVectorView view;
+    if (isCached())
+    {
+        if (mCacheNumBytes > 0)
+        {
+            const double *pData = mpMultiCache->mapData(mCacheStartByte, mCacheNumBytes);
+            if (!pData)
+            {
+                mError = mpMultiCache->getError();
+                return view;
+            }
+            // The view keeps the cache alive until the mapping has been released
+            SharedMultiDataVectorCacheT pMultiCache = mpMultiCache;
+            view.mpMapping = QSharedPointer<const double>(pData, [pMultiCache](const double *pMapped){ pMultiCache->unmapData(pMapped); });
+            view.mpData = pData;
+            view.mSize = int(mCacheNumBytes/sizeof(double));
+        }
+    }
+    else
+    {
+        view.mSharedVector = mDataVector;
+        view.mpData = view.mSharedVector.constData();
+        view.mSize = view.mSharedVector.size();
+    }
+    view.mIsValid = true;
+    return view;
+}
+
+//! @brief Returns a view of the min/max pyramid of the data, it is built and cached together with the data when first requested
+//! @see MinMaxPyramid
+DataVectorView CachableDataVector::getMinMaxPyramidView()
+{
+    if (!mpMinMaxPyramid)
+    {
+        const DataVectorView data = getDataView();
+        if (!data.isValid())
+        {
+            return DataVectorView();
+        }
+        mpMinMaxPyramid = new CachableDataVector(MinMaxPyramid::build(data), mpMultiCache, isCached());
+    }
+    return mpMinMaxPyramid->getDataView();
+}
+
 bool CachableDataVector::replaceData(const QVector<double> &rNewData)
 {
+    invalidateMinMaxPyramid();
     if (isCached())
     {
         // If same length, then replace actual data
@@ -538,6 +813,7 @@ bool CachableDataVector::peek(const int idx, double &rVal)
 
 bool CachableDataVector::poke(const int idx, const double val)
 {
+    invalidateMinMaxPyramid();
     if (isCached())
     {
         if (!mpMultiCache->poke(mCacheStartByte+idx*sizeof(double),val))
@@ -578,6 +854,8 @@ QVector<double> *CachableDataVector::beginFullVectorOperation()
 
 bool CachableDataVector::endFullVectorOperation(QVector<double> *&rpData)
 {
+    // The data may have been modified
+    invalidateMinMaxPyramid();
     bool rc = true;
     if(isCached())
     {
@@ -688,3 +966,11 @@ bool CachableDataVector::copyToMem()
     mError = "No cached data available";
     return false;
 }
+
+//! @brief Remove the min/max pyramid, call this whenever the data is modified
+//! @note The old pyramid data remains as junk in the cache file, just as replaced data does
+void CachableDataVector::invalidateMinMaxPyramid()
+{
+    delete mpMinMaxPyramid;
+    mpMinMaxPyramid = nullptr;
+}
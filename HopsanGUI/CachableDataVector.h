@@ -42,6 +42,53 @@
 #include <QMap>
 #include <QTextStream>
 
+//! @brief A read-only view of the data in a CachableDataVector that does not copy the data
+//! @details If the data is cached on disk, the view points directly into a memory mapping of the cache file.
+//! The mapping is released when the last copy of the view is destroyed. Data in memory is shared implicitly.
+class DataVectorView
+{
+public:
+    DataVectorView();
+
+    bool isValid() const;
+    int size() const;
+    bool isEmpty() const;
+    const double *constData() const;
+    const double &operator[](const int idx) const;
+
+private:
+    friend class CachableDataVector;
+    QSharedPointer<const double> mpMapping;
+    QVector<double> mSharedVector;
+    const double *mpData;
+    int mSize;
+    bool mIsValid;
+};
+
+//! @brief Min/max pyramid of a data vector, used to draw plot curves with about as many points as there are pixels
+//! @details Level 0 holds the index and value of the min and the max sample in each bucket of BaseBucketSize samples,
+//! each following level merges two neighbouring buckets of the level below, until only one bucket remains.
+//! All levels are stored after each other in one vector, so that the pyramid can be cached together with the data.
+class MinMaxPyramid
+{
+public:
+    enum {BaseBucketSize=64, ValuesPerBucket=4};
+
+    static QVector<double> build(const DataVectorView &rData);
+
+    MinMaxPyramid();
+    MinMaxPyramid(const DataVectorView &rPyramid, const int numSamples);
+
+    bool isValid() const;
+    int getNumLevels() const;
+    int getBucketSize(const int level) const;
+    void getBucketMinMaxIndexes(const int level, const int bucket, int &rMinIdx, int &rMaxIdx) const;
+
+private:
+    DataVectorView mPyramid;
+    QVector<int> mLevelOffsets;
+};
+
 //! @todo this could be a template
 class MultiDataVectorCache
 {
@@ -60,6 +107,9 @@ public:
     bool checkoutVector(const quint64 startByte, const quint64 nBytes, QVector<double> *&rpData);
     bool returnVector(QVector<double> *&rpData);
 
+    const double *mapData(const quint64 startByte, const quint64 nBytes);
+    void unmapData(const double *pData);
+
     bool hasError() const;
     QString getError() const;
     QString getAndClearError();
@@ -87,7 +137,10 @@ protected:
 
     QMap<QVector<double> *, CheckoutInfo> mCheckoutMap;
     qint64 mNumSubscribers;
+    qint64 mNumMappings;
     QFile mCacheFile;
+    QFile mMapFile;
+    bool mRemoveWhenUnmapped;
     QString mError;
     bool mIsMultiAppending;
     bool mIsMultiReadWriting;
@@ -111,6 +164,8 @@ public:
 
     bool streamDataTo(QTextStream &rTextStream, const QString separator);
     bool copyDataTo(QVector<double> &rData);
+    DataVectorView getDataView();
+    DataVectorView getMinMaxPyramidView();
     bool replaceData(const QVector<double> &rNewData);
     bool peek(const int idx, double &rVal);
     bool poke(const int idx, const double val);
@@ -129,11 +184,13 @@ public:
 private:
     bool moveToCache();
     bool copyToMem();
+    void invalidateMinMaxPyramid();
 
     QString mWarning;
     QString mError;
     SharedMultiDataVectorCacheT mpMultiCache;
     QVector<double> mDataVector;
+    CachableDataVector *mpMinMaxPyramid;
     quint64 mCacheStartByte;
     quint64 mCacheNumBytes;
     bool mIsCached;
@@ -894,39 +894,53 @@ void CoreSystemAccess::getPlotDataNamesAndUnits(const QString compname, const QS
 
 void CoreSystemAccess::getPlotData(const QString compname, const QString portname, const QString dataname, std::vector<double> *&rpTimeVector, QVector<double> &rData)
 {
-    int dataId = -1;
+    const double *pData = nullptr;
+    size_t nElements = 0;
+    if (getPlotDataView(compname, portname, dataname, rpTimeVector, pData, nElements))
+    {
+        //Ok lets copy all of the data to a Qt vector
+        rData.resize(int(nElements));
+        std::copy(pData, pData+nElements, rData.begin());
+    }
+}
+
+//! @brief Get the logged data of one variable directly from the core log data column, without copying it
+//! @param[out] rpTimeVector The time vector that the data belongs to
+//! @param[out] rpData Pointer to the first logged value
+//! @param[out] rNumSamples The number of logged values
+//! @returns True if the variable was found and has log data
+//! @note The data is only valid until the next simulation
+bool CoreSystemAccess::getPlotDataView(const QString compname, const QString portname, const QString dataname, std::vector<double> *&rpTimeVector, const double *&rpData, size_t &rNumSamples)
+{
+    rpData = nullptr;
+    rNumSamples = 0;
     hopsan::Port* pPort = this->getCorePortPtr(compname, portname);
     if (pPort)
     {
-        dataId = pPort->getNodeDataIdFromName(dataname.toStdString().c_str());
+        const int dataId = pPort->getNodeDataIdFromName(dataname.toStdString().c_str());
         if (dataId > -1)
         {
-            std::vector< std::vector<double> > *pData = pPort->getLogDataVectorPtr();
+            const std::vector<double> *pColumn = pPort->getLogDataColumnPtr(size_t(dataId));
             rpTimeVector = pPort->getLogTimeVectorPtr();
-
-            // Instead of pData.size() lets ask for latest logsample, this way we can avoid coping log slots that have not bee written and contains junk
-            // This is useful when a simulation has been aborted
-            size_t nElements;
-            if (pPort->getNodePtr())
-            {
-                nElements = qMin(pPort->getNodePtr()->getOwnerSystem()->getNumActuallyLoggedSamples(), pData->size());
-            }
-            else
+            if (pColumn)
             {
-                // this should never happen i think
-                nElements = qMin(pData->size(), rpTimeVector->size());
-            }
-            //size_t nElements = min(pPort->getNodegetComponent()->getSystemParent()->getNumActuallyLoggedSamples(), pData->size());
-            //qDebug() << "pData.size(): " << pData->size() << " nElements: " << nElements;
-
-            //Ok lets copy all of the data to a Qt vector
-            rData.resize(nElements); //Allocate memory for data
-            for (size_t i=0; i<nElements; ++i)
-            {
-                rData[i] = pData->at(i).at(dataId);
+                // Instead of the number of log slots lets ask for latest logsample, this way we can avoid coping log slots that have not bee written and contains junk
+                // This is useful when a simulation has been aborted
+                if (pPort->getNodePtr())
+                {
+                    rNumSamples = qMin(pPort->getNodePtr()->getOwnerSystem()->getNumActuallyLoggedSamples(), pColumn->size());
+                }
+                else
+                {
+                    // this should never happen i think
+                    rNumSamples = qMin(pColumn->size(), rpTimeVector->size());
+                }
+                rpData = pColumn->data();
+                return true;
             }
         }
     }
+    return false;
 }
 
 std::vector<double> *CoreSystemAccess::getLogTimeData() const
@@ -286,6 +286,7 @@ public:
     void getPlotDataNamesAndUnits(const QString compname, const QString portname, QVector<QString> &rNames, QVector<QString> &rUnits); //!< @deprecated
     std::vector<double> getTimeVector(QString componentName, QString portName);
     void getPlotData(const QString compname, const QString portname, const QString dataname, std::vector<double> *&rpTimeVector, QVector<double> &rData);
+    bool getPlotDataView(const QString compname, const QString portname, const QString dataname, std::vector<double> *&rpTimeVector, const double *&rpData, size_t &rNumSamples);
     std::vector<double> *getLogTimeData() const;
     bool havePlotData(const QString compname, const QString portname, const QString dataname);
     bool getLastNodeData(const QString compname, const QString portname, const QString dataname, double& rData) const;
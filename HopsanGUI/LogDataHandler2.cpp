@@ -64,6 +64,19 @@
 #include "hopsanhdf5exporter.h"
 #endif
 
+namespace {
+
+//! @brief Copy the logged part of a core log time vector
+QVector<double> copyLoggedTimeVector(const std::vector<double> &rCoreTimeVector, const size_t numLoggedSamples)
+{
+    const size_t n = qMin(rCoreTimeVector.size(), numLoggedSamples);
+    QVector<double> time_vec(int(n));
+    std::copy(rCoreTimeVector.begin(), rCoreTimeVector.begin()+n, time_vec.begin());
+    return time_vec;
+}
+
+}
+
 
 //! @brief Constructor for plot data object
 //! @param pParent Pointer to parent container object
@@ -261,11 +274,12 @@ void LogDataHandler2::exportToPlo(const QString &rFilePath, QList<SharedVectorVa
     }
     fileStream << "\n";
 
-    QVector< double > allData;
-    allData.reserve(nDataRows*nDataCols);
+    // Read the data through views, so that cached data is not copied into memory
+    QVector<DataVectorView> allData;
+    allData.reserve(variables.size());
     for(int var=0; var<variables.size(); ++var)
     {
-        allData << variables[var]->getDataVectorCopy();
+        allData << variables[var]->getDataView();
     }
 
     // Write data lines
@@ -273,7 +287,7 @@ void LogDataHandler2::exportToPlo(const QString &rFilePath, QList<SharedVectorVa
     {
         for(int col=0; col<variables.size(); ++col)
         {
-            const double val = allData[col*nDataRows+row];
+            const double val = allData[col][row];
             if (val < 0)
             {
                 fileStream << " " << val;
@@ -340,7 +354,9 @@ void LogDataHandler2::exportToHDF5(const QString &rFilePath, const QList<SharedV
         QStringList systemHierarchy;
         QString componentName,portName,variableName;
         splitFullVariableName(rVar->getFullVariableName(),systemHierarchy,componentName,portName,variableName);
-        hopsan::HVector<double> dataVector(rVar->getDataVectorCopy().toStdVector());
+        const DataVectorView dataView = rVar->getDataView();
+        hopsan::HVector<double> dataVector;
+        dataVector.assign_from(dataView.constData(), size_t(dataView.size()));
 
         hopsan::HString systemHierarchyStr = systemHierarchy.join(".").toStdString().c_str();
         pExporter->addVariable(systemHierarchyStr,componentName.toStdString().c_str(),portName.toStdString().c_str(),variableName.toStdString().c_str(),rVar->getAliasName().toStdString().c_str(),rVar->getDataUnit().toStdString().c_str(),rVar->getDataQuantity().toStdString().c_str(),dataVector);
@@ -1196,14 +1212,15 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
         // Check so that we have not already stored this time vector in this generation
         if (!rGenTimeVectors.contains(pCoreSysTimeVector))
         {
-            //! @todo here we need to copy (convert) from std vector to qvector, don know if that slows down (probably not much)
-            auto time_vec = QVector<double>::fromStdVector(*pCoreSysTimeVector);
-            time_vec.resize(pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
+            auto time_vec = copyLoggedTimeVector(*pCoreSysTimeVector, pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
             auto pSysTimeVector = insertTimeVectorVariable(time_vec, sharedSystemHierarchy);
             rGenTimeVectors.insert(pCoreSysTimeVector, pSysTimeVector);
         }
     }
 
+    // Buffer for the variable data, if the data is cached to disk the same memory is reused for all variables
+    QVector<double> dataVec;
+
     // Iterate components
     QList<ModelObject*> currentLevelModelObjects = pCurrentSystem->getModelObjects();
     for(ModelObject* pModelObject : currentLevelModelObjects) {
@@ -1228,18 +1245,25 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
                 // Skip hidden variables
                 if ( gpConfig->getBoolSetting(cfg::showhiddennodedatavariables) || (varDesc.mNodeDataVariableType != "Hidden") )
                 {
-                    // Fetch variable data
-                    QVector<double> dataVec;
-                    std::vector<double> *pCoreVarTimeVector=0;
-                    pCurrentSystem->getCoreSystemAccessPtr()->getPlotData(pModelObject->getName(),
-                                                                          pPort->getName(),
-                                                                          varDesc.mName,
-                                                                          pCoreVarTimeVector,
-                                                                          dataVec);
+                    // Fetch variable data, directly from the core log data column
+                    std::vector<double> *pCoreVarTimeVector=nullptr;
+                    const double *pCoreVarData=nullptr;
+                    size_t numSamples=0;
+                    pCurrentSystem->getCoreSystemAccessPtr()->getPlotDataView(pModelObject->getName(),
+                                                                              pPort->getName(),
+                                                                              varDesc.mName,
+                                                                              pCoreVarTimeVector,
+                                                                              pCoreVarData,
+                                                                              numSamples);
 
                     // Prevent adding data if time or data vector was empty
-                    if (!pCoreVarTimeVector->empty() && !dataVec.isEmpty())
+                    if (pCoreVarTimeVector && !pCoreVarTimeVector->empty() && (numSamples > 0))
                     {
+                        // If the previous variable kept the buffer (not cached to disk), clear() releases it instead of detaching a copy
+                        dataVec.clear();
+                        dataVec.resize(int(numSamples));
+                        std::copy(pCoreVarData, pCoreVarData+numSamples, dataVec.begin());
+
                         foundData=true;
                         SharedVariableDescriptionT pVarDesc = SharedVariableDescriptionT(new VariableDescription);
                         pVarDesc->mModelPath = pModelObject->getParentSystemObject()->getModelFilePath();
@@ -1269,8 +1293,7 @@ bool LogDataHandler2::collectLogDataFromSystem(SystemObject *pCurrentSystem, con
                         // Else create a unique variable time vector for this component
                         else
                         {
-                            auto time_vec = QVector<double>::fromStdVector(*pCoreVarTimeVector);
-                            time_vec.resize(pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
+                            auto time_vec = copyLoggedTimeVector(*pCoreVarTimeVector, pCurrentSystem->getCoreSystemAccessPtr()->getCoreSystemPtr()->getNumActuallyLoggedSamples());
                             auto pVarTimeVec = insertTimeVectorVariable(time_vec, SharedSystemHierarchyT());
                             pNewData = insertTimeDomainVariable(pVarTimeVec, dataVec, pVarDesc);
                         }
@@ -466,10 +466,12 @@ const SharedVectorVariableT VectorVariable::getSharedTimeOrFrequencyVector() con
 
 void VectorVariable::addToData(const SharedVectorVariableT pOther)
 {
+    const DataVectorView otherData = pOther->getDataView();
     DataVectorT* pData =  mpCachedDataVector->beginFullVectorOperation();
-    for (int i=0; i<pData->size(); ++i)
+    const int size = qMin(pData->size(), otherData.size());
+    for (int i=0; i<size; ++i)
     {
-       (*pData)[i] += pOther->peekData(i);
+       (*pData)[i] += otherData[i];
     }
     mpCachedDataVector->endFullVectorOperation(pData);
 }
@@ -485,10 +487,12 @@ void VectorVariable::addToData(const double other)
 }
 void VectorVariable::subFromData(const SharedVectorVariableT pOther)
 {
+    const DataVectorView otherData = pOther->getDataView();
     DataVectorT* pData =  mpCachedDataVector->beginFullVectorOperation();
-    for (int i=0; i<pData->size(); ++i)
+    const int size = qMin(pData->size(), otherData.size());
+    for (int i=0; i<size; ++i)
     {
-       (*pData)[i] += -pOther->peekData(i);
+       (*pData)[i] += -otherData[i];
     }
     mpCachedDataVector->endFullVectorOperation(pData);
     emit dataChanged();
@@ -506,10 +510,12 @@ void VectorVariable::subFromData(const double other)
 
 void VectorVariable::multData(const SharedVectorVariableT pOther)
 {
+    const DataVectorView otherData = pOther->getDataView();
     DataVectorT* pData =  mpCachedDataVector->beginFullVectorOperation();
-    for (int i=0; i<pData->size(); ++i)
+    const int size = qMin(pData->size(), otherData.size());
+    for (int i=0; i<size; ++i)
     {
-       (*pData)[i] *= pOther->peekData(i);
+       (*pData)[i] *= otherData[i];
     }
     mpCachedDataVector->endFullVectorOperation(pData);
     emit dataChanged();
@@ -528,10 +534,12 @@ void VectorVariable::multData(const double other)
 
 void VectorVariable::divData(const SharedVectorVariableT pOther)
 {
+    const DataVectorView otherData = pOther->getDataView();
     DataVectorT* pData =  mpCachedDataVector->beginFullVectorOperation();
-    for (int i=0; i<pData->size(); ++i)
+    const int size = qMin(pData->size(), otherData.size());
+    for (int i=0; i<size; ++i)
     {
-       (*pData)[i] /= pOther->peekData(i);
+       (*pData)[i] /= otherData[i];
     }
     mpCachedDataVector->endFullVectorOperation(pData);
     emit dataChanged();
@@ -577,14 +585,13 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
     {
         // Get data vectors
         DataVectorT* pThisData = mpCachedDataVector->beginFullVectorOperation();
-        DataVectorT* pOtherData = pOther->beginFullVectorOperation(); //!< @todo it would be nice to be able to check out read only
+        const DataVectorView otherData = pOther->getDataView();
 
         // Check so that vectors have same size
-        if (pThisData->size() != pOtherData->size())
+        if (pThisData->size() != otherData.size())
         {
             // Abort
-            // Return data vectors
-            pOther->endFullVectorOperation(pOtherData);
+            // Return data vector
             mpCachedDataVector->endFullVectorOperation(pThisData);
             //! @todo error message
             return;
@@ -593,7 +600,7 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
         // Perform diff operation
         for(int i=0; i<pThisData->size()-1; ++i)
         {
-            (*pThisData)[i] = ((*pThisData)[i+1]-(*pThisData)[i])/((*pOtherData)[i+1]-(*pOtherData)[i]);
+            (*pThisData)[i] = ((*pThisData)[i+1]-(*pThisData)[i])/(otherData[i+1]-otherData[i]);
         }
         if (pThisData->size() > 1)
         {
@@ -601,8 +608,7 @@ void VectorVariable::diffBy(SharedVectorVariableT pOther)
         }
 
 
-        // Return data vectors
-        pOther->endFullVectorOperation(pOtherData);
+        // Return data vector
         mpCachedDataVector->endFullVectorOperation(pThisData);
 
         emit dataChanged();
@@ -621,12 +627,13 @@ void VectorVariable::integrateBy(SharedVectorVariableT pOther)
     {
         // Get data pointers
         DataVectorT* pThisData = mpCachedDataVector->beginFullVectorOperation();
-        DataVectorT* pOtherData = pOther->beginFullVectorOperation();
+        const DataVectorView otherData = pOther->getDataView();
 
         // Check so that vectors have same size
-        if (pThisData->size() != pOtherData->size())
+        if (pThisData->size() != otherData.size())
         {
             // Abort
+            mpCachedDataVector->endFullVectorOperation(pThisData);
             //! @todo error message
             return;
         }
@@ -637,12 +644,11 @@ void VectorVariable::integrateBy(SharedVectorVariableT pOther)
         res.append(0);
         for (int i=1; i<pThisData->size(); ++i)
         {
-            res.append( res[i-1] + 0.5*( (*pOtherData)[i] - (*pOtherData)[i-1] )*( (*pThisData)[i-1] + (*pThisData)[i]) );
+            res.append( res[i-1] + 0.5*( otherData[i] - otherData[i-1] )*( (*pThisData)[i-1] + (*pThisData)[i]) );
         }
         *pThisData = res;
 
-        // Return data pointers
-        pOther->endFullVectorOperation(pOtherData);
+        // Return data pointer
         mpCachedDataVector->endFullVectorOperation(pThisData);
 
         emit dataChanged();
@@ -661,12 +667,13 @@ void VectorVariable::lowPassFilter(SharedVectorVariableT pTime, const double w)
     {
         // Get data vector pointers
         DataVectorT* pThisData = mpCachedDataVector->beginFullVectorOperation();
-        DataVectorT* pTimeData = pTime->beginFullVectorOperation();
+        const DataVectorView timeData = pTime->getDataView();
 
         // Check so that vectors have same size
-        if (pThisData->size() != pTimeData->size())
+        if (pThisData->size() != timeData.size())
         {
             // Abort
+            mpCachedDataVector->endFullVectorOperation(pThisData);
             //! @todo error message
             return;
         }
@@ -678,7 +685,7 @@ void VectorVariable::lowPassFilter(SharedVectorVariableT pTime, const double w)
         (*pThisData)[0] = temp;
         for(int i=1; i<pThisData->size(); ++i)
         {
-            double T = (*pTimeData)[i]-(*pTimeData)[i-1];
+            double T = timeData[i]-timeData[i-1];
             double ALF = Al/T;
             double G = 1.0+ALF;
             double A1 = (1.0-ALF)/G;
@@ -688,8 +695,7 @@ void VectorVariable::lowPassFilter(SharedVectorVariableT pTime, const double w)
             (*pThisData)[i] = -A1*(*pThisData)[i-1] + B1*(temp1+temp);
         }
 
-        // Return data ptrs
-        pTime->endFullVectorOperation(pTimeData);
+        // Return data ptr
         mpCachedDataVector->endFullVectorOperation(pThisData);
 
         emit dataChanged();
@@ -1014,13 +1020,12 @@ double VectorVariable::averageOfData() const
 {
     double ret = 0;
     int i=0;
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    for(; i<pVector->size(); ++i)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    for(; i<data.size(); ++i)
     {
-        ret += pVector->at(i);
+        ret += data[i];
     }
     ret /= i;
-    mpCachedDataVector->endFullVectorOperation(pVector);
     return ret;
 }
 
@@ -1028,19 +1033,18 @@ double VectorVariable::minOfData(int &rIdx) const
 {
     rIdx = -1;
     double ret = std::numeric_limits<double>::max();
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if (data.isValid())
     {
-        for(int i=0; i<pVector->size(); ++i)
+        for(int i=0; i<data.size(); ++i)
         {
-            const double &v = (*pVector)[i];
+            const double &v = data[i];
             if(v < ret)
             {
                 ret = v;
                 rIdx=i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
     }
     return ret;
 }
@@ -1054,11 +1058,11 @@ double VectorVariable::minOfData() const
 
 void VectorVariable::elementWiseGt(QVector<double> &rResult, const double threshold) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    rResult.resize(data.size());
+    for(int i=0; i<data.size(); ++i)
     {
-        if ((*pVector)[i] > threshold)
+        if (data[i] > threshold)
         {
             rResult[i] = 1;
         }
@@ -1067,18 +1071,17 @@ void VectorVariable::elementWiseGt(QVector<double> &rResult, const double thresh
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
 }
 
 void VectorVariable::elementWiseGt(QVector<double> &rResult, const SharedVectorVariableT pOther) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const DataVectorView thisData = mpCachedDataVector->getDataView();
+    const DataVectorView otherData = pOther->getDataView();
+    const int size = qMin(thisData.size(), otherData.size());
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if ((*pThisData)[i] > (*pOtherData)[i])
+        if (thisData[i] > otherData[i])
         {
             rResult[i] = 1;
         }
@@ -1087,17 +1090,15 @@ void VectorVariable::elementWiseGt(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
 }
 
 void VectorVariable::elementWiseLt(QVector<double> &rResult, const double threshold) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    rResult.resize(data.size());
+    for(int i=0; i<data.size(); ++i)
     {
-        if ((*pVector)[i] < threshold)
+        if (data[i] < threshold)
         {
             rResult[i] = 1;
         }
@@ -1106,18 +1107,17 @@ void VectorVariable::elementWiseLt(QVector<double> &rResult, const double thresh
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
 }
 
 void VectorVariable::elementWiseLt(QVector<double> &rResult, const SharedVectorVariableT pOther) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const DataVectorView thisData = mpCachedDataVector->getDataView();
+    const DataVectorView otherData = pOther->getDataView();
+    const int size = qMin(thisData.size(), otherData.size());
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if ((*pThisData)[i] < (*pOtherData)[i])
+        if (thisData[i] < otherData[i])
         {
             rResult[i] = 1;
         }
@@ -1126,17 +1126,15 @@ void VectorVariable::elementWiseLt(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
 }
 
 void VectorVariable::elementWiseEq(QVector<double> &rResult, const double value, const double eps) const
 {
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    rResult.resize(pVector->size());
-    for(int i=0; i<pVector->size(); ++i)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    rResult.resize(data.size());
+    for(int i=0; i<data.size(); ++i)
     {
-        if (fuzzyEqual((*pVector)[i], value, eps))
+        if (fuzzyEqual(data[i], value, eps))
         {
             rResult[i] = 1;
         }
@@ -1145,18 +1143,17 @@ void VectorVariable::elementWiseEq(QVector<double> &rResult, const double value,
             rResult[i] = 0;
         }
     }
-    mpCachedDataVector->endFullVectorOperation(pVector);
 }
 
 void VectorVariable::elementWiseEq(QVector<double> &rResult, const SharedVectorVariableT pOther, const double eps) const
 {
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-    const int size = qMin(pThisData->size(), pOtherData->size());
+    const DataVectorView thisData = mpCachedDataVector->getDataView();
+    const DataVectorView otherData = pOther->getDataView();
+    const int size = qMin(thisData.size(), otherData.size());
     rResult.resize(size);
     for(int i=0; i<size; ++i)
     {
-        if (fuzzyEqual((*pThisData)[i], (*pOtherData)[i], eps))
+        if (fuzzyEqual(thisData[i], otherData[i], eps))
         {
             rResult[i] = 1;
         }
@@ -1165,8 +1162,6 @@ void VectorVariable::elementWiseEq(QVector<double> &rResult, const SharedVectorV
             rResult[i] = 0;
         }
     }
-    pOther->endFullVectorOperation(pOtherData);
-    mpCachedDataVector->endFullVectorOperation(pThisData);
 }
 
 bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) const
@@ -1175,22 +1170,20 @@ bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) con
     bool isOK=false;
     if (this->getDataSize() == pOther->getDataSize())
     {
-        QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-        QVector<double> *pOtherData = pOther->beginFullVectorOperation();
-        if (pThisData && pOtherData)
+        const DataVectorView thisData = mpCachedDataVector->getDataView();
+        const DataVectorView otherData = pOther->getDataView();
+        if (thisData.isValid() && otherData.isValid())
         {
             isOK=true;
-            for (int i=0; i<pThisData->size(); ++i)
+            for (int i=0; i<thisData.size(); ++i)
             {
-                if (!fuzzyEqual((*pThisData)[i], (*pOtherData)[i], eps))
+                if (!fuzzyEqual(thisData[i], otherData[i], eps))
                 {
                     isOK = false;
                     break;
                 }
             }
         }
-        pOther->endFullVectorOperation(pOtherData);
-        mpCachedDataVector->endFullVectorOperation(pThisData);
     }
     return isOK;
 }
@@ -1202,17 +1195,17 @@ bool VectorVariable::compare(SharedVectorVariableT pOther, const double eps) con
 int VectorVariable::lower_bound(const double value, const bool assumeSorted) const
 {
     int result = -1;
-    QVector<double> *pThisData = mpCachedDataVector->beginFullVectorOperation();
-    if (pThisData == nullptr) {
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if (!data.isValid()) {
         return result;
     }
 
-    const QVector<double> &data = *pThisData;
-
     if (assumeSorted) {
-        auto lower = std::lower_bound(std::begin(data), std::end(data), value);
-        if (lower != std::end(data)) {
-            result = static_cast<int>(std::distance(std::begin(data), lower));
+        const double *pBegin = data.constData();
+        const double *pEnd = pBegin + data.size();
+        auto lower = std::lower_bound(pBegin, pEnd, value);
+        if (lower != pEnd) {
+            result = static_cast<int>(std::distance(pBegin, lower));
         }
     }
     else {
@@ -1225,10 +1218,22 @@ int VectorVariable::lower_bound(const double value, const bool assumeSorted) con
         }
     }
 
-    mpCachedDataVector->endFullVectorOperation(pThisData);
     return result;
 }
 
+//! @brief Returns a read-only view of the data, data cached on disk is memory mapped instead of copied
+DataVectorView VectorVariable::getDataView() const
+{
+    return mpCachedDataVector->getDataView();
+}
+
+//! @brief Returns a read-only view of the min/max pyramid of the data, used to draw curves with many samples
+//! @see MinMaxPyramid
+DataVectorView VectorVariable::getMinMaxPyramidView() const
+{
+    return mpCachedDataVector->getMinMaxPyramidView();
+}
+
 QVector<double> *VectorVariable::beginFullVectorOperation()
 {
     return mpCachedDataVector->beginFullVectorOperation();
@@ -1276,19 +1281,18 @@ double VectorVariable::maxOfData(int &rIdx) const
 {
     rIdx = -1;
     double ret = -std::numeric_limits<double>::max();
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if (data.isValid())
     {
-        for(int i=0; i<pVector->size(); ++i)
+        for(int i=0; i<data.size(); ++i)
         {
-            const double &v = (*pVector)[i];
+            const double &v = data[i];
             if(v > ret)
             {
                 ret = v;
                 rIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
     }
     return ret;
 }
@@ -1306,12 +1310,12 @@ void VectorVariable::minMaxOfData(double &rMin, double &rMax, int &rMinIdx, int
     rMin = std::numeric_limits<double>::max();
     rMax = -rMin;
 
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if (data.isValid())
     {
-        for(int i=0; i<pVector->size(); ++i)
+        for(int i=0; i<data.size(); ++i)
         {
-            const double &v = (*pVector)[i];
+            const double &v = data[i];
             if(v < rMin)
             {
                 rMin = v;
@@ -1323,7 +1327,6 @@ void VectorVariable::minMaxOfData(double &rMin, double &rMax, int &rMinIdx, int
                 rMaxIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
     }
 }
 
@@ -1334,12 +1337,12 @@ bool VectorVariable::positiveNonZeroMinMaxOfData(double &rMin, double &rMax, int
     rMin = std::numeric_limits<double>::max();
     rMax = std::numeric_limits<double>::epsilon();
 
-    QVector<double> *pVector = mpCachedDataVector->beginFullVectorOperation();
-    if (pVector)
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if (data.isValid())
     {
-        for(int i=0; i<pVector->size(); ++i)
+        for(int i=0; i<data.size(); ++i)
         {
-            const double &v = (*pVector)[i];
+            const double &v = data[i];
             if( (v < rMin) && (v > std::numeric_limits<double>::epsilon()) )
             {
                 rMin = v;
@@ -1351,25 +1354,23 @@ bool VectorVariable::positiveNonZeroMinMaxOfData(double &rMin, double &rMax, int
                 rMaxIdx = i;
             }
         }
-        mpCachedDataVector->endFullVectorOperation(pVector);
     }
     return ((rMinIdx > -1) && (rMaxIdx>-1));
 }
 
 double VectorVariable::rmsOfData() const
 {
-    QVector<double> *pData = mpCachedDataVector->beginFullVectorOperation();
-    if(pData->isEmpty()) {
+    const DataVectorView data = mpCachedDataVector->getDataView();
+    if(data.isEmpty()) {
         return 0;
     }
     double rms = 0;
-    for (int i=0; i<pData->size(); ++i)
+    for (int i=0; i<data.size(); ++i)
     {
-        rms += (*pData)[i]*(*pData)[i];
+        rms += data[i]*data[i];
     }
-    rms /= pData->size();
+    rms /= data.size();
     rms = sqrt(rms);
-    mpCachedDataVector->endFullVectorOperation(pData);
     return rms;
 }
 
@@ -185,6 +185,10 @@ public:
     bool compare(SharedVectorVariableT pOther, const double eps) const;
     int lower_bound(const double value, const bool assumeSorted=false) const;
 
+    // Read-only view of the data without copying it (memory mapped if cached on disk)
+    DataVectorView getDataView() const;
+    DataVectorView getMinMaxPyramidView() const;
+
     // Check out and return pointers to data (move to ram if necessary)
     QVector<double> *beginFullVectorOperation();
     bool endFullVectorOperation(QVector<double> *&rpData);
@@ -237,13 +241,12 @@ public:
     template<typename Function>
     QVector<double> invokeMathFunctionOnData(Function func)
     {
-        QVector<double> *pData = mpCachedDataVector->beginFullVectorOperation();
-        QVector<double> retdata(pData->size());
-        for (int i=0; i<pData->size(); ++i)
+        const DataVectorView data = mpCachedDataVector->getDataView();
+        QVector<double> retdata(data.size());
+        for (int i=0; i<data.size(); ++i)
         {
-            retdata[i] = func((*pData)[i]);
+            retdata[i] = func(data[i]);
         }
-        mpCachedDataVector->endFullVectorOperation(pData);
         return retdata;
     }
 
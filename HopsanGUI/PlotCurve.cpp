@@ -47,6 +47,7 @@
 //Other includes
 #include <limits>
 #include <qwt_plot_zoomer.h>
+#include <qwt_series_data.h>
 #include <QColorDialog>
 #include <QDialog>
 #include <QPushButton>
@@ -114,7 +115,22 @@ UnitConverter lookupUnitConverter(const QString& dataQuantity, const QString& ne
 class DataUnitConverter {
 public:
     DataUnitConverter(const UnitConverter& uc, double dataPlotOffsett, bool invert, double localScale, double localOffset) :
-        mUc(uc), mDataPlotOffsett(dataPlotOffsett), mInvert(invert), mLocalScale(localScale), mLocalOffset(localOffset) { }
+        mUc(uc), mDataPlotOffsett(dataPlotOffsett), mInvert(invert), mLocalScale(localScale), mLocalOffset(localOffset) {
+        if (isLinear()) {
+            const double direction = mInvert ? -1.0 : 1.0;
+            mScaleFromBaseToDesiredUnit = mLocalScale*direction/mUc.scaleToDouble(1.0);
+            mOffsetInBaseUnit = mDataPlotOffsett - mUc.offsetToDouble();
+        }
+    }
+
+    //! @brief Check if the conversion is a scale and offset, then single values can be converted cheaply with convertLinear()
+    bool isLinear() const {
+        return !mUc.isExpression();
+    }
+
+    double convertLinear(const double value) const {
+        return (value+mOffsetInBaseUnit)*mScaleFromBaseToDesiredUnit + mLocalOffset;
+    }
 
     void convertVector(QVector<double> &rDataVector) {
         double direction = mInvert ? -1.0 : 1.0;
@@ -124,10 +140,8 @@ public:
             }
         }
         else {
-            const double scaleFromBaseToDesiredUnit = mLocalScale*direction/mUc.scaleToDouble(1.0);
-            const double offsetInBaseUnit = mDataPlotOffsett - mUc.offsetToDouble();
             for (double& rV : rDataVector) {
-                rV =  (rV+offsetInBaseUnit)*scaleFromBaseToDesiredUnit + mLocalOffset;
+                rV =  convertLinear(rV);
             }
         }
     }
@@ -137,6 +151,198 @@ public:
     bool mInvert;
     double mLocalScale;
     double mLocalOffset;
+    double mScaleFromBaseToDesiredUnit = 1.0;
+    double mOffsetInBaseUnit = 0.0;
+};
+
+//! @brief Curve samples that are read directly from the log data views, data cached on disk is memory mapped instead of copied
+//! @details The unit conversion is applied when each sample is read, so only linear conversions can be used.
+//! If no x-data view is valid, the sample index is used as x-value.
+//! While drawing, beginLevelOfDetail() can reduce the samples to the min and max values for each pixel column.
+//! Outside of drawing all samples are always used (for picking and bounding rect).
+class DataViewCurveData : public QwtSeriesData<QPointF>
+{
+public:
+    //! @brief Only build a min/max pyramid for curves with at least this many samples, shorter curves are reduced directly from the data
+    static constexpr int MinNumSamplesForPyramid = 16*MinMaxPyramid::BaseBucketSize*MinMaxPyramid::BaseBucketSize;
+
+    DataViewCurveData(const DataVectorView &rXData, const DataUnitConverter &rXConverter, const bool xIsSorted,
+                      const DataVectorView &rYData, const DataUnitConverter &rYConverter, const MinMaxPyramid &rYPyramid) :
+        mXData(rXData), mXConverter(rXConverter), mXIsSorted(xIsSorted), mYData(rYData), mYConverter(rYConverter), mYPyramid(rYPyramid),
+        mUseLevelOfDetail(false), mBoundingRect(0.0, 0.0, -1.0, -1.0) { }
+
+    size_t size() const override {
+        if (mUseLevelOfDetail) {
+            return size_t(mLevelOfDetailIndexes.size());
+        }
+        return size_t(numFullSamples());
+    }
+
+    QPointF sample(size_t i) const override {
+        if (mUseLevelOfDetail) {
+            return fullSample(mLevelOfDetailIndexes[int(i)]);
+        }
+        return fullSample(int(i));
+    }
+
+    QRectF boundingRect() const override {
+        // Always computed from all samples, even if this is first called while drawing
+        if (mBoundingRect.width() < 0.0) {
+            const int n = numFullSamples();
+            if (n > 0) {
+                double minX=DoubleMax, maxX=-DoubleMax, minY=DoubleMax, maxY=-DoubleMax;
+                for (int i=0; i<n; ++i) {
+                    // Written so that NaN values are ignored
+                    const QPointF p = fullSample(i);
+                    if (p.x() < minX) {
+                        minX = p.x();
+                    }
+                    if (p.x() > maxX) {
+                        maxX = p.x();
+                    }
+                    if (p.y() < minY) {
+                        minY = p.y();
+                    }
+                    if (p.y() > maxY) {
+                        maxY = p.y();
+                    }
+                }
+                mBoundingRect.setCoords(minX, minY, maxX, maxY);
+            }
+        }
+        return mBoundingRect;
+    }
+
+    //! @brief Reduce the samples in the visible x-range to the min and max sample for each pixel column, until endLevelOfDetail() is called
+    //! @param[in] xMin The lowest visible x-value
+    //! @param[in] xMax The highest visible x-value
+    //! @param[in] pixelWidth The number of pixel columns the x-range is drawn on
+    //! @returns True if the samples were reduced, false if all samples should be drawn
+    bool beginLevelOfDetail(const double xMin, const double xMax, const double pixelWidth) const {
+        const int n = numFullSamples();
+        if (!mXIsSorted || (n == 0) || (pixelWidth < 1.0)) {
+            return false;
+        }
+
+        // Find the visible samples, including one sample outside on each side so that lines to the edges are drawn
+        const int first = qMax(lowerBoundX(xMin)-1, 0);
+        const int last = qMin(lowerBoundX(xMax), n-1);
+        const int bucketSize = int((last-first+1)/pixelWidth);
+        // Reducing less than this does not gain much
+        if (bucketSize < 4) {
+            return false;
+        }
+
+        mLevelOfDetailIndexes.clear();
+        mLevelOfDetailIndexes.reserve(4*int(pixelWidth)+4);
+        mLevelOfDetailIndexes.append(first);
+        if (mYPyramid.isValid() && (bucketSize >= MinMaxPyramid::BaseBucketSize)) {
+            // Use the largest pyramid buckets that are not larger than one pixel column
+            int level = 0;
+            while ((level+1 < mYPyramid.getNumLevels()) && (mYPyramid.getBucketSize(level+1) <= bucketSize)) {
+                ++level;
+            }
+            const int levelBucketSize = mYPyramid.getBucketSize(level);
+            // Buckets that are only partly visible are reduced directly from the data
+            const int firstBucket = (first+levelBucketSize-1)/levelBucketSize;
+            const int endBucket = (last+1)/levelBucketSize;
+            if (firstBucket < endBucket) {
+                appendMinMaxFromData(first, firstBucket*levelBucketSize, levelBucketSize);
+                for (int b=firstBucket; b<endBucket; ++b) {
+                    int minIdx, maxIdx;
+                    mYPyramid.getBucketMinMaxIndexes(level, b, minIdx, maxIdx);
+                    appendMinMaxIndexes(minIdx, maxIdx);
+                }
+                appendMinMaxFromData(endBucket*levelBucketSize, last+1, levelBucketSize);
+            }
+            else {
+                appendMinMaxFromData(first, last+1, bucketSize);
+            }
+        }
+        else {
+            appendMinMaxFromData(first, last+1, bucketSize);
+        }
+        if (mLevelOfDetailIndexes.last() != last) {
+            mLevelOfDetailIndexes.append(last);
+        }
+
+        mUseLevelOfDetail = true;
+        return true;
+    }
+
+    void endLevelOfDetail() const {
+        mUseLevelOfDetail = false;
+    }
+
+private:
+    int numFullSamples() const {
+        if (mXData.isValid()) {
+            return qMin(mXData.size(), mYData.size());
+        }
+        return mYData.size();
+    }
+
+    double fullX(const int idx) const {
+        return mXData.isValid() ? mXConverter.convertLinear(mXData[idx]) : double(idx);
+    }
+
+    QPointF fullSample(const int idx) const {
+        return QPointF(fullX(idx), mYConverter.convertLinear(mYData[idx]));
+    }
+
+    //! @brief Find the first sample with x-value >= value (or the number of samples if there is none)
+    int lowerBoundX(const double value) const {
+        int low=0, high=numFullSamples();
+        while (low < high) {
+            const int mid = low+(high-low)/2;
+            if (fullX(mid) < value) {
+                low = mid+1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    //! @brief Append the min and max sample index in order, skipping duplicates
+    void appendMinMaxIndexes(const int minIdx, const int maxIdx) const {
+        const int lowIdx = qMin(minIdx, maxIdx);
+        const int highIdx = qMax(minIdx, maxIdx);
+        if (mLevelOfDetailIndexes.last() < lowIdx) {
+            mLevelOfDetailIndexes.append(lowIdx);
+        }
+        if (mLevelOfDetailIndexes.last() < highIdx) {
+            mLevelOfDetailIndexes.append(highIdx);
+        }
+    }
+
+    //! @brief Append the min and max sample index of each bucket of samples in the range [begin, end)
+    void appendMinMaxFromData(const int begin, const int end, const int bucketSize) const {
+        for (int b=begin; b<end; b+=bucketSize) {
+            const int bucketEnd = qMin(b+bucketSize, end);
+            int minIdx=b, maxIdx=b;
+            for (int i=b+1; i<bucketEnd; ++i) {
+                if (mYData[i] < mYData[minIdx]) {
+                    minIdx = i;
+                }
+                else if (mYData[i] > mYData[maxIdx]) {
+                    maxIdx = i;
+                }
+            }
+            appendMinMaxIndexes(minIdx, maxIdx);
+        }
+    }
+
+    DataVectorView mXData;
+    DataUnitConverter mXConverter;
+    bool mXIsSorted;
+    DataVectorView mYData;
+    DataUnitConverter mYConverter;
+    MinMaxPyramid mYPyramid;
+    mutable bool mUseLevelOfDetail;
+    mutable QVector<int> mLevelOfDetailIndexes;
+    mutable QRectF mBoundingRect;
 };
 
 }
@@ -1194,46 +1400,69 @@ void PlotCurve::updateCurve()
     }
     else
     {
-        QVector<double> tempX, tempY;
-        // We copy here, it should be faster then peek (at least when data is cached on disc)
-        //! @todo maybe be smart about doing this copy, only copy if a disk cached variable
-        tempY = mData->getDataVectorCopy();
-
         const bool invertYData = mData->isPlotInverted();
         DataUnitConverter yConverter(mCurveDataUnitScale, mData->getGenerationPlotOffsetIfTime(), invertYData, mCurveExtraDataScale, mCurveExtraDataOffset);
-        yConverter.convertVector(tempY);
 
+        // Use special X-data if set, else the time vector if it exist, else we cant draw curve (yet, x-date might be set later) so plot vs samples
+        SharedVectorVariableT pXData;
+        UnitConverter xUnitScale;
+        double xDataOffset = 0.0;
+        bool xInvertData = false;
+        // Time, frequency and sample index are increasing, so the visible samples can be reduced when drawing
+        bool xIsSorted = true;
         if (mCustomXdata && !mShowVsSamples)
         {
-            // Use special X-data, Copy here, it should be faster then peek (at least when data is cached on disc)
-            tempX = mCustomXdata->getDataVectorCopy();
-            const bool xInvertData = mCustomXdata->isPlotInverted();
-            constexpr double localCurveXScale = 1.0;
-            constexpr double localCurveXOffset = 0.0;
-            DataUnitConverter xConverter(mCurveCustomXDataUnitScale, mCustomXdata->getGenerationPlotOffsetIfTime(), xInvertData, localCurveXScale, localCurveXOffset);
-            xConverter.convertVector(tempX);
+            pXData = mCustomXdata;
+            xIsSorted = false;
+            xUnitScale = mCurveCustomXDataUnitScale;
+            xDataOffset = mCustomXdata->getGenerationPlotOffsetIfTime();
+            xInvertData = mCustomXdata->isPlotInverted();
         }
-        // No special X-data use time vector if it exist else we cant draw curve (yet, x-date might be set later)
         else if (mData->getSharedTimeOrFrequencyVector() && !mShowVsSamples)
         {
-            tempX = mData->getSharedTimeOrFrequencyVector()->getDataVectorCopy();
-            const double timeDataOffset = mData->getSharedTimeOrFrequencyVector()->getGenerationPlotOffsetIfTime();
-            constexpr bool notInverted = false;
-            constexpr double localCurveTFScale = 1.0;
-            constexpr double localCurveTFOffset = 0.0;
-            DataUnitConverter xConverter(mCurveTFUnitScale, timeDataOffset, notInverted, localCurveTFScale, localCurveTFOffset);
-            xConverter.convertVector(tempX);
+            pXData = mData->getSharedTimeOrFrequencyVector();
+            xUnitScale = mCurveTFUnitScale;
+            xDataOffset = pXData->getGenerationPlotOffsetIfTime();
         }
-        else
+        constexpr double localCurveXScale = 1.0;
+        constexpr double localCurveXOffset = 0.0;
+        DataUnitConverter xConverter(xUnitScale, xDataOffset, xInvertData, localCurveXScale, localCurveXOffset);
+
+        if (yConverter.isLinear() && xConverter.isLinear())
         {
-            // No time vector or special x-vector, plot vs samples
-            tempX.resize(tempY.size());
-            for (int i=0; i< tempX.size(); ++i) {
-                tempX[i] = i;
+            // Read the samples directly from the data, no copy is needed (even when data is cached on disc)
+            const DataVectorView xData = pXData ? pXData->getDataView() : DataVectorView();
+            const DataVectorView yData = mData->getDataView();
+            MinMaxPyramid yPyramid;
+            if (xIsSorted && (yData.size() >= DataViewCurveData::MinNumSamplesForPyramid))
+            {
+                yPyramid = MinMaxPyramid(mData->getMinMaxPyramidView(), yData.size());
             }
+            setData(new DataViewCurveData(xData, xConverter, xIsSorted, yData, yConverter, yPyramid));
         }
+        else
+        {
+            // Expression unit conversions are to expensive to evaluate on every redraw, convert a copy of the data instead
+            QVector<double> tempX, tempY;
+            tempY = mData->getDataVectorCopy();
+            yConverter.convertVector(tempY);
 
-        setSamples(tempX, tempY);
+            if (pXData)
+            {
+                tempX = pXData->getDataVectorCopy();
+                xConverter.convertVector(tempX);
+            }
+            else
+            {
+                // No time vector or special x-vector, plot vs samples
+                tempX.resize(tempY.size());
+                for (int i=0; i< tempX.size(); ++i) {
+                    tempX[i] = i;
+                }
+            }
+
+            setSamples(tempX, tempY);
+        }
     }
 
     emit curveDataUpdated();
@@ -1616,6 +1845,24 @@ QList<QwtLegendData> PlotCurve::legendData() const
     return list;
 }
 
+//! @brief Draws the curve, with the samples reduced to the min and max values in each pixel column if there are many samples
+//! @details Picking and the bounding rect still use all samples, the reduction is only active while drawing
+void PlotCurve::drawSeries(QPainter *pPainter, const QwtScaleMap &rXMap, const QwtScaleMap &rYMap, const QRectF &rCanvasRect, int from, int to) const
+{
+    const DataViewCurveData *pData = dynamic_cast<const DataViewCurveData*>(data());
+    // Pixel columns are only evenly spaced in x on a linear x-axis
+    const bool linearXAxis = (rXMap.transformation() == nullptr);
+    if (pData && linearXAxis && pData->beginLevelOfDetail(qMin(rXMap.s1(), rXMap.s2()), qMax(rXMap.s1(), rXMap.s2()), qAbs(rXMap.pDist())))
+    {
+        QwtPlotCurve::drawSeries(pPainter, rXMap, rYMap, rCanvasRect, 0, int(pData->size())-1);
+        pData->endLevelOfDetail();
+    }
+    else
+    {
+        QwtPlotCurve::drawSeries(pPainter, rXMap, rYMap, rCanvasRect, from, to);
+    }
+}
+
 //! @brief This function overload is required to avoid auto-scale problems when the data contains inf
 //! @note This is related to issue #1151
 QRectF PlotCurve::boundingRect() const
@@ -185,6 +185,10 @@ public slots:
     void openFrequencyAnalysisDialog();
     void markActive(bool value);
 
+protected:
+    // Qwt overloaded function
+    void drawSeries(QPainter *pPainter, const QwtScaleMap &rXMap, const QwtScaleMap &rYMap, const QRectF &rCanvasRect, int from, int to) const;
+
 private slots:
     void updateCurve();
     void updateCurveName();
@@ -342,7 +342,7 @@ bool RemoteCoreSimulationHandler::getCoreMessages(QVector<QString> &rTypes, QVec
 bool RemoteCoreSimulationHandler::getLogData(QVector<RemoteResultVariable> &rResultVariables)
 {
     std::vector<ResultVariableT> results;
-    bool rc = mpRemoteHopsanClient->requestSimulationResults(results);
+    bool rc = mpRemoteHopsanClient->requestSimulationResultsStreamed(results);
     rResultVariables.clear();
     rResultVariables.reserve(results.size());
     for (ResultVariableT &r : results)
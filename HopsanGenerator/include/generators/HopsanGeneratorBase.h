@@ -70,6 +70,8 @@ public:
     void setMessageHandler(MessageHandlerT messageHandler, void* pMessageObject=nullptr);
 
     void setOutputPath(const QString &path);
+    void setObjectCachePath(const QString &path);
+    QString getObjectCachePath() const;
 
     QString getHopsanRootPath() const;
     QString getHopsanCoreIncludePath() const;
@@ -109,10 +111,14 @@ protected:
     bool copyDir(const QString &fromPath, const QString &toPath, const QList<QRegExp>& excludeRegExps) const;
     void cleanUp(const QString &path, const QStringList &files, const QStringList &subDirs) const;
     bool generateModelFile(const hopsan::ComponentSystem *pSystem, const QString &buildPath, const QMap<QString,QString>& replaceMap) const;
+    QString compilerExecutable() const;
+    QString calcObjectCacheKey(const QString &buildPath, const QStringList &subDirs, const QStringList &buildSettings) const;
+    bool storeInObjectCache(const QString &cacheKey, const QString &filePath) const;
 
     QString mHopsanRootPath;
     QString mTempPath;
     QString mOutputPath;
+    QString mObjectCachePath;
     CompilerSelection mCompilerSelection;
 
 private:
@@ -34,6 +34,7 @@
 #include <QDir>
 #include <QUrl>
 #include <QXmlStreamWriter>
+#include <QThread>
 #include <QDebug>
 
 #include <stddef.h>
@@ -68,6 +69,22 @@ void writeTextToFile(QFile& file, const QString& text)
     ts << text;
 }
 
+//! @brief The compiler flags used for all FMU source files, they are part of the object cache key
+QString fmuCompilerFlags()
+{
+    QString fpicFlag;
+#ifndef _WIN32
+    fpicFlag = "-fPIC ";
+#endif
+    return fpicFlag+"-c -std=c++14 -DHOPSAN_INTERNALDEFAULTCOMPONENTS -DHOPSAN_INTERNAL_EXTRACOMPONENTS -DHOPSANCORE_NOMULTITHREADING";
+}
+
+// The static library with HopsanCore and the default component library, that is kept in the object cache
+constexpr auto fmuCoreArchiveName = "libhopsanfmucore.a";
+
+// The linker version script that limits the exported symbols to the FMI functions
+constexpr auto fmuVersionScriptName = "fmu.map";
+
 bool fromFmiBoolean(fmi2_boolean_t b)
 {
     if (b) {
@@ -224,6 +241,11 @@ bool HopsanFMIGenerator::generateToFmu(QString savePath, ComponentSystem *pSyste
         printErrorMessage("Failed to copy default component library files.");
         return false;
     }
+
+    // HopsanCore and the default library only need to be compiled once for each source version, compiler and flag set
+    const QString cacheKey = calcObjectCacheKey(fmuBuildPath, QStringList() << "HopsanCore" << "componentLibraries/defaultLibrary",
+                                                QStringList() << fmuCompilerFlags() << mHopsanRootPath+"/dependencies/fmi4c/include" << (x64 ? "x64" : "x86"));
+
     if(!copyExternalComponentCodeToDir(fmuBuildPath, externalLibraries, mExtraSourceFiles, mIncludePaths, mLinkPaths, mLinkLibraries)) {
         printErrorMessage("Failed to export required external component library files.");
         return false;
@@ -314,13 +336,14 @@ bool HopsanFMIGenerator::generateToFmu(QString savePath, ComponentSystem *pSyste
     // Replacing namespace
     //------------------------------------------------------------------//
 
-    replaceNameSpace(fmuBuildPath, version);
+    // The namespace must be the same for all exports that share cached objects
+    replaceNameSpace(fmuBuildPath, version, "HopsanFMU"+cacheKey.left(12));
 
     //------------------------------------------------------------------//
     // Compiling and linking
     //------------------------------------------------------------------//
 
-    if(!compileAndLinkFMU(fmuBuildPath, fmuStagePath, modelName, version, x64))
+    if(!compileAndLinkFMU(fmuBuildPath, fmuStagePath, modelName, version, x64, cacheKey))
     {
         return false;
     }
@@ -791,13 +814,10 @@ bool HopsanFMIGenerator::generateModelDescriptionXmlFile(ComponentSystem *pSyste
 }
 
 
-void HopsanFMIGenerator::replaceNameSpace(const QString &savePath, int version) const
+void HopsanFMIGenerator::replaceNameSpace(const QString &savePath, int version, const QString &nameSpace) const
 {
     printMessage("Replacing namespace");
 
-    int random = rand() % 1000000000;
-    QString randomString = QString::number(random);
-    QString nameSpace = "HopsanFMU"+randomString;
     QStringList before = QStringList() << "using namespace hopsan;" << "namespace hopsan " << "\nhopsan::" << "::hopsan::" << " hopsan::" << "*hopsan::" << "namespace hopsan{" << "(hopsan::" << "<hopsan::" << ",hopsan::";
     QStringList after = QStringList() << "using namespace "+nameSpace+";" << "namespace "+nameSpace+" " << "\n"+nameSpace+"::" << "::"+nameSpace+"::" << " "+nameSpace+"::" << "*"+nameSpace+"::" << "namespace "+nameSpace+"{" << "("+nameSpace+"::" << "<"+nameSpace+"::" << ","+nameSpace+"::";
 
@@ -824,7 +844,7 @@ void HopsanFMIGenerator::replaceNameSpace(const QString &savePath, int version)
     }
 }
 
-bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QString &fmuStagePath, const QString &modelName, const int version, bool x64) const
+bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QString &fmuStagePath, const QString &modelName, const int version, bool x64, const QString &cacheKey) const
 {
     const QString vStr = QString::number(version);
     const QString fmiLibDir="\""+mHopsanRootPath+"/dependencies/fmilibrary\"";
@@ -870,40 +890,99 @@ bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QS
         return false;
     }
 
+    // HopsanCore and the default library are built into a static library that is kept in the object cache,
+    // so that only the model specific code needs to be compiled when the same sources have been exported before
+    QStringList coreSrcFiles = listHopsanCoreSourceFiles(fmuBuildPath);
+    QStringList modelSrcFiles;
+    for(const QString& srcFile : listInternalLibrarySourceFiles(fmuBuildPath)) {
+        if(srcFile.startsWith("componentLibraries/defaultLibrary/")) {
+            coreSrcFiles << srcFile;
+        }
+        else {
+            modelSrcFiles << srcFile;
+        }
+    }
+    const QString cachedCoreArchive = QDir(mObjectCachePath+"/"+cacheKey).filePath(fmuCoreArchiveName);
+    const bool useCachedCore = QFile::exists(cachedCoreArchive);
+    if(useCachedCore) {
+        printMessage("Using precompiled HopsanCore from object cache: "+cachedCoreArchive);
+    }
+    else {
+        printMessage("HopsanCore is not in the object cache, it will be compiled");
+    }
+
     //Write the compilation script file
     QTextStream makefileStream(&makefile);
+#ifdef _WIN32
+    // The compile script puts the selected compiler first in PATH
     makefileStream << "CXX = g++\n";
+#else
+    // The same compiler as in the object cache key
+    makefileStream << "CXX = \""+compilerExecutable()+"\"\n";
+#endif
+    makefileStream << "AR = ar\n";
     QString fpicFlag;
 #ifndef _WIN32
     fpicFlag= "-fPIC";
 #endif
-    makefileStream << "CXXFLAGS = "+fpicFlag+" -c -std=c++14 -DHOPSAN_INTERNALDEFAULTCOMPONENTS -DHOPSAN_INTERNAL_EXTRACOMPONENTS -DHOPSANCORE_NOMULTITHREADING\n";
+    makefileStream << "CXXFLAGS = "+fmuCompilerFlags()+"\n";
 #ifdef _WIN32
     makefileStream << "LFLAGS = "+fpicFlag+" -w -shared -static-libgcc -static-libstdc++ -Wl,-Bstatic -lstdc++ -lpthread -Wl,-Bdynamic -Wl,--rpath,'$$ORIGIN/.' -Wl,--rpath,'$$ORIGIN/../../resources'\n";
 #else
-    makefileStream << "LFLAGS = "+fpicFlag+" -w -shared -static-libgcc -Wl,--rpath,'$$ORIGIN/.' -Wl,--rpath,'$$ORIGIN/../../resources'\n";
+    // FMUs built from the same sources share the namespace and all symbol names. Only the FMI functions are exported,
+    // everything else is local to the FMU, also unique symbols (static variables in inline functions and template
+    // static members) that the dynamic linker would otherwise unify between all Hopsan FMUs loaded in the same process
+    makefileStream << "LFLAGS = "+fpicFlag+" -w -shared -static-libgcc -Wl,--version-script="+fmuVersionScriptName+" -Wl,--rpath,'$$ORIGIN/.' -Wl,--rpath,'$$ORIGIN/../../resources'\n";
 #endif
-    makefileStream << "INCLUDES = ";
+    makefileStream << "CORE_INCLUDES =";
     // Add HopsanCore (and necessary dependency) include paths
     for(const QString &includePath : getHopsanCoreIncludePaths()) {
         makefileStream << QString(" -I\"%1\"").arg(includePath);
     }
+    makefileStream << " -I"+fmi4cIncludeDir+"\n";
+    makefileStream << "INCLUDES = $(CORE_INCLUDES)";
     for(const QString &includePath : mIncludePaths) {
         makefileStream << QString(" -I\"%1\"").arg(includePath);
     }
-    makefileStream << " -I"+fmi4cIncludeDir+"\n";
-    makefileStream << "OUTPUT = \""+outputLibraryFile+"\"\n\n";
+    makefileStream << "\n";
+    makefileStream << "OUTPUT = \""+outputLibraryFile+"\"\n";
+    if(useCachedCore) {
+        makefileStream << "CORE_ARCHIVE = \""+cachedCoreArchive+"\"\n\n";
+    }
+    else {
+        makefileStream << "CORE_ARCHIVE = "+QString(fmuCoreArchiveName)+"\n\n";
+    }
     makefileStream << "SRC = fmu"+QString::number(version)+"_model.cpp";
-    QStringList srcFiles = listHopsanCoreSourceFiles(fmuBuildPath) + listInternalLibrarySourceFiles(fmuBuildPath);
-    for(const QString& srcFile : srcFiles) {
+    for(const QString& srcFile : modelSrcFiles) {
         makefileStream << " " << srcFile;
     }
+    makefileStream << "\n";
+    makefileStream << "CORE_SRC =";
+    if(!useCachedCore) {
+        for(const QString& srcFile : coreSrcFiles) {
+            makefileStream << " " << srcFile;
+        }
+    }
     makefileStream << "\n\n";
-    makefileStream << "VPATH := $(sort  $(dir $(SRC)))\n\n";
+    makefileStream << "VPATH := $(sort  $(dir $(SRC) $(CORE_SRC)))\n\n";
     makefileStream << "OBJ := $(patsubst %.cpp, %.o, $(notdir $(SRC)))\n";
-    makefileStream << "OBJ := $(patsubst %.c, %.o, $(notdir $(OBJ)))\n\n";
-    makefileStream << "all: 	$(OBJ)\n";
-    makefileStream << "\t$(CXX) $(OBJ) $(LFLAGS) -o $(OUTPUT)\n\n";
+    makefileStream << "OBJ := $(patsubst %.c, %.o, $(notdir $(OBJ)))\n";
+    makefileStream << "CORE_OBJ := $(patsubst %.cpp, %.o, $(notdir $(CORE_SRC)))\n";
+    makefileStream << "CORE_OBJ := $(patsubst %.c, %.o, $(notdir $(CORE_OBJ)))\n\n";
+    if(useCachedCore) {
+        makefileStream << "all: 	$(OBJ)\n";
+    }
+    else {
+        makefileStream << "all: 	$(OBJ) $(CORE_ARCHIVE)\n";
+    }
+    // All core objects are needed, also those that nothing refers to directly
+    makefileStream << "\t$(CXX) $(OBJ) -Wl,--whole-archive $(CORE_ARCHIVE) -Wl,--no-whole-archive $(LFLAGS) -o $(OUTPUT)\n\n";
+    if(!useCachedCore) {
+        makefileStream << "$(CORE_ARCHIVE): $(CORE_OBJ)\n";
+        makefileStream << "\t$(AR) rcs $@ $(CORE_OBJ)\n\n";
+        // Cached objects must not depend on the include paths of external libraries
+        makefileStream << "$(CORE_OBJ): INCLUDES = $(CORE_INCLUDES)\n\n";
+    }
     makefileStream << "%.o : %.cpp Makefile\n";
     makefileStream << "\t$(CXX) $(CXXFLAGS) $(INCLUDES) -c $< -o $@\n\n";
     makefileStream << "%.o : %.c Makefile\n";
@@ -912,6 +991,19 @@ bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QS
 
     makefile.close();
 
+#ifndef _WIN32
+    QFile versionScript(fmuBuildPath+"/"+fmuVersionScriptName);
+    if(!versionScript.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        printErrorMessage(QString("Failed to open %1 for writing.").arg(fmuVersionScriptName));
+        return false;
+    }
+    // FMI 1.0 functions are prefixed with the model identifier
+    const QString exportedFunctions = (version == 1) ? modelName+"_fmi*" : "fmi"+vStr+"*";
+    QTextStream(&versionScript) << "{\n  global: " << exportedFunctions << ";\n  local: *;\n};\n";
+    versionScript.close();
+#endif
+
     printMessage("Generating compilation script");
 
     QFile compileScriptFile;
@@ -931,9 +1023,9 @@ bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QS
     QTextStream compileScriptStream(&compileScriptFile);
 #ifdef _WIN32
     compileScriptStream << "$env:Path = \""+mCompilerSelection.path+";$env:Path\"\n";
-    compileScriptStream << "mingw32-make -j16 all\n";
+    compileScriptStream << "mingw32-make -j"+QString::number(QThread::idealThreadCount())+" all\n";
 #else
-    compileScriptStream << "make -j16 all\n";
+    compileScriptStream << "make -j"+QString::number(QThread::idealThreadCount())+" all\n";
 #endif
     compileScriptFile.close();
 
@@ -950,6 +1042,10 @@ bool HopsanFMIGenerator::compileAndLinkFMU(const QString &fmuBuildPath, const QS
         return false;
     }
 
+    if(!useCachedCore && storeInObjectCache(cacheKey, fmuBuildPath+"/"+fmuCoreArchiveName)) {
+        printMessage("Stored precompiled HopsanCore in object cache: "+cachedCoreArchive);
+    }
+
     return assertFilesExist("", QStringList() << outputLibraryFile);
 }
 
@@ -36,6 +36,10 @@
 #include <QDomElement>
 #include <QUuid>
 #include <QProcess>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QStandardPaths>
 
 #include <cassert>
 
@@ -103,6 +107,7 @@ HopsanGeneratorBase::HopsanGeneratorBase(const QString &hopsanInstallPath, const
     }
 
     mOutputPath = QDir::currentPath()+"/output";
+    mObjectCachePath = QDir::tempPath()+"/hopsan-object-cache";
 }
 
 HopsanGeneratorBase::~HopsanGeneratorBase()
@@ -1210,6 +1215,20 @@ void HopsanGeneratorBase::setOutputPath(const QString &path)
 }
 
 
+//! @brief Set the directory where precompiled objects are cached between exports
+//! @param[in] path The cache directory, it is created when needed
+void HopsanGeneratorBase::setObjectCachePath(const QString &path)
+{
+    mObjectCachePath = QFileInfo(path).absoluteFilePath();
+}
+
+
+QString HopsanGeneratorBase::getObjectCachePath() const
+{
+    return mObjectCachePath;
+}
+
+
 QString HopsanGeneratorBase::getHopsanCoreIncludePath() const
 {
     return mHopsanRootPath+"/HopsanCore/include";
@@ -1625,6 +1644,94 @@ bool HopsanGeneratorBase::generateModelFile(const ComponentSystem *pSystem, cons
 }
 
 
+//! @brief Returns the g++ executable that the generated build scripts invoke
+//! @details Without a selected compiler path, this is the first g++ in PATH (or just g++ if there is none)
+QString HopsanGeneratorBase::compilerExecutable() const
+{
+    if (mCompilerSelection.path.isEmpty()) {
+        const QString executable = QStandardPaths::findExecutable("g++");
+        return executable.isEmpty() ? QString("g++") : executable;
+    }
+#ifdef _WIN32
+    return mCompilerSelection.path+"/g++.exe";
+#else
+    return mCompilerSelection.path+"g++";
+#endif
+}
+
+
+//! @brief Calculates a key for the object cache from the content of source directories and the build settings
+//! @param[in] buildPath The build directory
+//! @param[in] subDirs Directories in the build directory with the source and header files that the cached objects are built from
+//! @param[in] buildSettings Compiler, flags and anything else that affects the cached objects
+//! @returns The key, a hexadecimal hash string
+QString HopsanGeneratorBase::calcObjectCacheKey(const QString &buildPath, const QStringList &subDirs, const QStringList &buildSettings) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(const QString &setting : buildSettings) {
+        hash.addData(setting.toUtf8());
+        hash.addData("\n", 1);
+    }
+
+    // The compiler itself, it may be updated without changing its path, and g++ is often a link to the actual compiler
+    QFileInfo compilerInfo(compilerExecutable());
+    if (compilerInfo.exists()) {
+        hash.addData(compilerInfo.absoluteFilePath().toUtf8());
+        hash.addData(compilerInfo.canonicalFilePath().toUtf8());
+        hash.addData(QString::number(compilerInfo.size()).toUtf8());
+        hash.addData(compilerInfo.lastModified().toString(Qt::ISODate).toUtf8());
+    }
+
+    // Files are hashed in sorted order, so that the key does not depend on the order they are listed in
+    QDir buildDir(buildPath);
+    for(const QString &subDir : subDirs) {
+        QStringList files;
+        QDirIterator it(buildDir.filePath(subDir), QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            files.append(buildDir.relativeFilePath(it.next()));
+        }
+        files.sort();
+        for(const QString &file : files) {
+            QFile sourceFile(buildDir.filePath(file));
+            if (sourceFile.open(QIODevice::ReadOnly)) {
+                hash.addData(file.toUtf8());
+                hash.addData(&sourceFile);
+            }
+        }
+    }
+    return hash.result().toHex();
+}
+
+
+//! @brief Copies a built file into the object cache
+//! @details The file is first copied to a temporary name and then renamed, so that other exports never see a partially written file
+//! @param[in] cacheKey The cache key, from calcObjectCacheKey()
+//! @param[in] filePath The file to store
+//! @returns True if the file was stored or was already in the cache
+bool HopsanGeneratorBase::storeInObjectCache(const QString &cacheKey, const QString &filePath) const
+{
+    QDir cacheDir(mObjectCachePath+"/"+cacheKey);
+    const QString target = cacheDir.filePath(QFileInfo(filePath).fileName());
+    if (QFile::exists(target)) {
+        return true;
+    }
+    if (!cacheDir.mkpath(".")) {
+        printWarningMessage("Could not create object cache directory: "+cacheDir.path());
+        return false;
+    }
+    const QString tempTarget = target+"."+QUuid::createUuid().toString();
+    if (!QFile::copy(filePath, tempTarget)) {
+        printWarningMessage("Could not copy "+filePath+" to object cache");
+        return false;
+    }
+    if (!QFile::rename(tempTarget, target)) {
+        QFile::remove(tempTarget);
+        return QFile::exists(target);
+    }
+    return true;
+}
+
+
 void HopsanGeneratorBase::copyModelAssetsToDir(const QString &tgtDirPath, hopsan::ComponentSystem *pSystem, QMap<QString, QString> &assetsMap) const
 {
     QDir targetDir(tgtDirPath);
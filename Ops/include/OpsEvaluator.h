@@ -44,6 +44,7 @@
 namespace Ops {
 
 class Worker;
+class Executor;
 
 class OPS_DLLAPI Evaluator
 {
@@ -52,6 +53,8 @@ public:
     ~Evaluator();
 
     void setWorker(Worker *pWorker);
+    Worker *getWorker() const;
+    void setExecutor(Executor *pExecutor);
 
     virtual void evaluateAllPoints();               //Can be re-implemented
     virtual void evaluateCandidate(size_t idx);        //Must be re-implemented
@@ -62,6 +65,7 @@ public:
 
 protected:
     Worker *mpWorker;
+    Executor *mpExecutor = nullptr;
 
 private:
     void updateSurrogateModel();
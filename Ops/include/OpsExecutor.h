@@ -0,0 +1,75 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   OpsExecutor.h
+//!
+//! @brief Contains the executor classes, that run batches of candidate evaluations
+//!
+//$Id$
+
+#ifndef OPSEXECUTOR_H
+#define OPSEXECUTOR_H
+
+#include <stdlib.h>
+#include <vector>
+#include "OpsWin32DLL.h"
+
+namespace Ops {
+
+class Evaluator;
+
+//! @brief Runs batches of candidate evaluations
+//! @details The base class evaluates the candidates one at a time in the calling thread.
+//! Sub classes may evaluate candidates concurrently, in that case the evaluator must be able to evaluate
+//! different candidate indices at the same time, for example by using one model copy per candidate.
+class OPS_DLLAPI Executor
+{
+public:
+    virtual ~Executor();
+
+    virtual size_t getNumberOfWorkers() const;
+    virtual void execute(Evaluator *pEvaluator, const std::vector<size_t> &rCandidateIds);
+};
+
+class ThreadPoolExecutorPrivates;
+
+//! @brief Executor that evaluates candidates concurrently on a pool of threads
+//! @details The threads are created once and are reused for every batch
+class OPS_DLLAPI ThreadPoolExecutor : public Executor
+{
+public:
+    ThreadPoolExecutor(size_t nThreads=0);
+    ~ThreadPoolExecutor();
+
+    size_t getNumberOfWorkers() const;
+    void execute(Evaluator *pEvaluator, const std::vector<size_t> &rCandidateIds);
+
+private:
+    ThreadPoolExecutorPrivates *mpPrivates;
+};
+
+}
+
+#endif // OPSEXECUTOR_H
@@ -37,6 +37,7 @@
 #include <algorithm>
 
 #include "OpsEvaluator.h"
+#include "OpsExecutor.h"
 #include "OpsWorker.h"
 #include "OpsMessageHandler.h"
 #include "ludcmp.h"
@@ -70,6 +71,20 @@ void Evaluator::setWorker(Worker *pWorker)
     mpWorker = pWorker;
 }
 
+Worker *Evaluator::getWorker() const
+{
+    return mpWorker;
+}
+
+//! @brief Set the executor used to evaluate batches of candidates
+//! @details The executor is not owned by the evaluator. If the executor evaluates candidates concurrently,
+//! evaluateCandidate() must be able to evaluate different candidate indices at the same time.
+//! @param [in] pExecutor The executor, or nullptr to evaluate candidates one at a time
+void Evaluator::setExecutor(Executor *pExecutor)
+{
+    mpExecutor = pExecutor;
+}
+
 
 
 void Evaluator::evaluateAllPoints()
@@ -80,6 +95,26 @@ void Evaluator::evaluateAllPoints()
         evaluateAllCandidates();
         mpWorker->mObjectives = mpWorker->mCandidateObjectives;
     }
+    else if(mpExecutor && mpWorker->mNumCandidates > 1)
+    {
+        // Evaluate the points in batches, one point per candidate
+        std::vector<size_t> candidateIds;
+        for(size_t i=0; i<mpWorker->mNumPoints && !mpWorker->aborted(); i+=mpWorker->mNumCandidates)
+        {
+            const size_t nBatch = std::min(mpWorker->mNumCandidates, mpWorker->mNumPoints-i);
+            candidateIds.resize(nBatch);
+            for(size_t c=0; c<nBatch; ++c)
+            {
+                mpWorker->mCandidatePoints[c] = mpWorker->mPoints[i+c];
+                candidateIds[c] = c;
+            }
+            mpExecutor->execute(this, candidateIds);
+            for(size_t c=0; c<nBatch; ++c)
+            {
+                mpWorker->mObjectives[i+c] = mpWorker->mCandidateObjectives[c];
+            }
+        }
+    }
     else
     {
         for(size_t i=0; i<mpWorker->mNumPoints && !mpWorker->aborted(); ++i)
@@ -100,6 +135,10 @@ void Evaluator::evaluateAllPointsWithSurrogateModel()
         evaluateAllCandidatesWithSurrogateModel();
         mpWorker->mObjectives = mpWorker->mCandidateObjectives;
     }
+    else if(mpExecutor && !mpWorker->mUseSurrogateModel)
+    {
+        evaluateAllPoints();
+    }
     else
     {
         for(size_t i=0; i<mpWorker->mNumPoints && !mpWorker->aborted(); ++i)
@@ -121,6 +160,17 @@ void Evaluator::evaluateCandidate(size_t idx)
 
 void Evaluator::evaluateAllCandidates()
 {
+    if(mpExecutor)
+    {
+        std::vector<size_t> candidateIds(mpWorker->mNumCandidates);
+        for(size_t i=0; i<candidateIds.size(); ++i)
+        {
+            candidateIds[i] = i;
+        }
+        mpExecutor->execute(this, candidateIds);
+        return;
+    }
+
     for(size_t i=0; i<mpWorker->mNumCandidates && !mpWorker->aborted(); ++i)
     {
         evaluateCandidate(i);
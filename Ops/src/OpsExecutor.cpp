@@ -0,0 +1,166 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//!
+//! @file   OpsExecutor.cpp
+//!
+//! @brief Contains the executor classes, that run batches of candidate evaluations
+//!
+//$Id$
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "OpsExecutor.h"
+#include "OpsEvaluator.h"
+#include "OpsWorker.h"
+
+using namespace Ops;
+
+Executor::~Executor()
+{
+}
+
+//! @brief Returns the number of candidates that can be evaluated at the same time
+size_t Executor::getNumberOfWorkers() const
+{
+    return 1;
+}
+
+//! @brief Evaluate a batch of candidates, returns when all candidates have been evaluated
+//! @param [in] pEvaluator The evaluator to use
+//! @param [in] rCandidateIds The candidate indices to evaluate
+void Executor::execute(Evaluator *pEvaluator, const std::vector<size_t> &rCandidateIds)
+{
+    for(size_t i=0; i<rCandidateIds.size() && !pEvaluator->getWorker()->aborted(); ++i)
+    {
+        pEvaluator->evaluateCandidate(rCandidateIds[i]);
+    }
+}
+
+
+class Ops::ThreadPoolExecutorPrivates
+{
+public:
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mWorkAvailable;
+    std::condition_variable mBatchFinished;
+    Evaluator *mpEvaluator = nullptr;
+    const std::vector<size_t> *mpCandidateIds = nullptr;
+    size_t mNextCandidate = 0;
+    size_t mNumFinished = 0;
+    bool mQuit = false;
+};
+
+//! @brief The thread pool worker loop, takes one candidate at a time from the current batch
+static void threadPoolLoop(ThreadPoolExecutorPrivates *pPrivates)
+{
+    std::unique_lock<std::mutex> lock(pPrivates->mMutex);
+    while(true)
+    {
+        pPrivates->mWorkAvailable.wait(lock, [pPrivates]() {
+            return pPrivates->mQuit || (pPrivates->mpCandidateIds && pPrivates->mNextCandidate < pPrivates->mpCandidateIds->size());
+        });
+        if(pPrivates->mQuit)
+        {
+            return;
+        }
+
+        const size_t candidateId = (*pPrivates->mpCandidateIds)[pPrivates->mNextCandidate];
+        ++pPrivates->mNextCandidate;
+        Evaluator *pEvaluator = pPrivates->mpEvaluator;
+        lock.unlock();
+
+        if(!pEvaluator->getWorker()->aborted())
+        {
+            pEvaluator->evaluateCandidate(candidateId);
+        }
+
+        lock.lock();
+        ++pPrivates->mNumFinished;
+        if(pPrivates->mNumFinished == pPrivates->mpCandidateIds->size())
+        {
+            pPrivates->mBatchFinished.notify_all();
+        }
+    }
+}
+
+//! @brief Constructor
+//! @param [in] nThreads The number of threads to use, 0 means one thread per hardware thread
+ThreadPoolExecutor::ThreadPoolExecutor(size_t nThreads)
+{
+    mpPrivates = new ThreadPoolExecutorPrivates();
+    if(nThreads == 0)
+    {
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for(size_t t=0; t<nThreads; ++t)
+    {
+        mpPrivates->mThreads.push_back(std::thread(threadPoolLoop, mpPrivates));
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mpPrivates->mMutex);
+        mpPrivates->mQuit = true;
+    }
+    mpPrivates->mWorkAvailable.notify_all();
+    for(size_t t=0; t<mpPrivates->mThreads.size(); ++t)
+    {
+        mpPrivates->mThreads[t].join();
+    }
+    delete mpPrivates;
+}
+
+size_t ThreadPoolExecutor::getNumberOfWorkers() const
+{
+    return mpPrivates->mThreads.size();
+}
+
+//! @brief Evaluate a batch of candidates concurrently, returns when all candidates have been evaluated
+//! @param [in] pEvaluator The evaluator to use, it must be able to evaluate different candidates at the same time
+//! @param [in] rCandidateIds The candidate indices to evaluate
+void ThreadPoolExecutor::execute(Evaluator *pEvaluator, const std::vector<size_t> &rCandidateIds)
+{
+    if(rCandidateIds.empty())
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mpPrivates->mMutex);
+    mpPrivates->mpEvaluator = pEvaluator;
+    mpPrivates->mpCandidateIds = &rCandidateIds;
+    mpPrivates->mNextCandidate = 0;
+    mpPrivates->mNumFinished = 0;
+    mpPrivates->mWorkAvailable.notify_all();
+    mpPrivates->mBatchFinished.wait(lock, [this, &rCandidateIds]() {
+        return mpPrivates->mNumFinished == rCandidateIds.size();
+    });
+    mpPrivates->mpCandidateIds = nullptr;
+    mpPrivates->mpEvaluator = nullptr;
+}
@@ -34,6 +34,7 @@
 #include "GeneratorTypes.h"
 #include <assert.h>
 #include <iostream>
+#include <cmath>
 
 #ifndef DEFAULT_LIBRARY_ROOT
 #define DEFAULT_LIBRARY_ROOT "../componentLibraries/defaultLibrary"
@@ -460,6 +461,75 @@ private slots:
 #endif
     }
 
+    void Generator_FMU_Import_Two_FMUs()
+    {
+#if defined(__APPLE__)
+        QWARN("Generator FMU tests are disbaled on MacOS, until generator code works there");
+#else
+#if defined(HOPSANCOMPILED64BIT)
+        constexpr int architecture = 64;
+        const QString passThroughFmuPath = QDir::currentPath()+"/fmu2 64/unittestmodel_export.fmu";
+#else
+        constexpr int architecture = 32;
+        const QString passThroughFmuPath = QDir::currentPath()+"/fmu2 32/unittestmodel_export.fmu";
+#endif
+        // A second FMU from the same sources, with a gain between in1 and out1 instead of the direct connection
+        double start, stop;
+        ComponentSystem *pGainModel = mHopsanCore.loadHMFModelFile(qPrintable(mTestDataRoot + "/unittestmodel_export.hmf"), start, stop);
+        QVERIFY2(pGainModel, "Could not load the export model");
+        pGainModel->setName("unittestmodel_export_gain");
+        QVERIFY(pGainModel->disconnect("in1", "out", "out1", "in"));
+        Component *pGain = mHopsanCore.createComponent("SignalGain");
+        pGain->setName("Gain");
+        pGainModel->addComponent(pGain);
+        QVERIFY(pGain->setParameterValue("k#Value", "2"));
+        QVERIFY(pGainModel->connect("in1", "out", "Gain", "in"));
+        QVERIFY(pGainModel->connect("Gain", "out", "out1", "in"));
+
+        clearMessages();
+        const QString outpath = QDir::currentPath()+"/fmu2 gain/";
+        removeDir(outpath);
+        QDir().mkpath(outpath);
+        std::vector<char*> externalLibraries;
+        bool exportOK = callFmuExportGenerator(qPrintable(outpath), pGainModel, externalLibraries.data(), 0, mHopsanInstallRoot.c_str(),
+                                               compilerPathForThisArch().c_str(), 2, architecture, &generatorMessageCallback, this);
+        mHopsanCore.removeComponent(pGainModel);
+        if (!exportOK) {
+            printMessages();
+        }
+        QVERIFY2(exportOK, "Failed to export FMU 2.0 with gain");
+
+        // Both FMUs are loaded into this process, each must run its own model
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        Component *pSourceComponent = mHopsanCore.createComponent("SignalSineWave");
+        pSystem->addComponent(pSourceComponent);
+        const QString fmuPaths[2] = {passThroughFmuPath, outpath+"unittestmodel_export_gain.fmu"};
+        Port *pOutPorts[2];
+        for (int i=0; i<2; ++i) {
+            Component *pFmuComponent = mHopsanCore.createComponent("FMIWrapper");
+            pSystem->addComponent(pFmuComponent);
+            pFmuComponent->setParameterValue("path", qPrintable(fmuPaths[i]), true);
+            Port *pInPort = pFmuComponent->getPort("in1_out_y");
+            pOutPorts[i] = pFmuComponent->getPort("out1_in_y");
+            QVERIFY2(pInPort != nullptr && pOutPorts[i] != nullptr, qPrintable("Failed to import FMU: "+fmuPaths[i]));
+            QVERIFY(pSystem->connect(pSourceComponent->getPort("out"), pInPort));
+        }
+        pSystem->setDesiredTimestep(0.001);
+        QVERIFY(pSystem->initialize(0, 1));
+        bool hasNonZeroOutput = false;
+        for (int s=1; s<=10; ++s) {
+            pSystem->simulate(0.1*s);
+            const double passThroughOutput = pOutPorts[0]->readNodeSafe(0);
+            const double gainOutput = pOutPorts[1]->readNodeSafe(0);
+            QVERIFY2(std::abs(gainOutput - 2*passThroughOutput) < 1e-12, "FMUs loaded into the same process affect each other");
+            hasNonZeroOutput = hasNonZeroOutput || (passThroughOutput != 0);
+        }
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+        QVERIFY2(hasNonZeroOutput, "Simulation result from imported FMUs is not correct");
+#endif
+    }
+
     void Generator_Simulink_Export()
     {
         QFETCH(ComponentSystem*, system);
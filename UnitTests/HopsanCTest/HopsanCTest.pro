@@ -0,0 +1,26 @@
+QT       += testlib
+QT       -= gui
+
+#Determine debug extension
+include( ../../Common.prf )
+
+TARGET = tst_hopsanctest$${DEBUG_EXT}
+CONFIG   += console
+CONFIG   -= app_bundle
+DESTDIR = $${PWD}/../../bin
+
+TEMPLATE = app
+
+INCLUDEPATH += $${PWD}/../../hopsanc/include/
+INCLUDEPATH += $${PWD}/../../HopsanCore/include/
+LIBS += -L$${PWD}/../../bin -lhopsanc$${DEBUG_EXT} -lhopsancore$${DEBUG_EXT}
+DEFINES *= HOPSANCORE_DLLIMPORT
+
+unix{
+QMAKE_LFLAGS *= -Wl,-rpath,\'\$$ORIGIN/./\'
+
+}
+
+SOURCES += \
+    tst_hopsanctest.cpp
+DEFINES += SRCDIR=\\\"$$PWD/\\\"
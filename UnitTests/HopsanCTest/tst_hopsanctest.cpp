@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+
+#include "hopsanc.h"
+#include "HopsanCoreMacros.h"
+#include "HopsanCoreVersion.h"
+
+#include <vector>
+
+#ifndef DEFAULT_LIBRARY_ROOT
+#define DEFAULT_LIBRARY_ROOT "../componentLibraries/defaultLibrary"
+#endif
+
+#ifndef TEST_DATA_ROOT
+#define TEST_DATA_ROOT "../UnitTests/HopsanCoreTests/SimulationTest/"
+#endif
+
+#define DEFAULTLIBFILE SHAREDLIB_PREFIX "defaultcomponentlibrary" HOPSAN_DEBUG_POSTFIX "." SHAREDLIB_SUFFIX
+const char* defaultLibraryFilePath = DEFAULT_LIBRARY_ROOT "/" DEFAULTLIBFILE;
+const char* testModelFilePath = TEST_DATA_ROOT "unittestmodel.hmf";
+
+class HopsanCTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    //! @brief Returns the last logged value of a variable
+    double lastLoggedValue(const char *variable)
+    {
+        std::vector<double> data(getNumberOfLogSamples());
+        if (data.empty() || getDataVector(variable, data.data()) != 0)
+        {
+            return -1e300;
+        }
+        return data.back();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+#ifndef HOPSAN_INTERNALDEFAULTCOMPONENTS
+        QVERIFY2(loadLibrary(defaultLibraryFilePath) == 0, "Could not load the default component library");
+#endif
+    }
+
+    void Save_Load_Simulation_State()
+    {
+        const QString stateFile = QDir::temp().filePath("hopsanc_unittest_simulationstate.hss");
+        const char* variable = "TestVolume.P1.Pressure";
+
+        // Continuous simulation
+        QVERIFY(loadModel(testModelFilePath) == 0);
+        QVERIFY(setStartTime(0) == 0);
+        QVERIFY(setStopTime(10) == 0);
+        QVERIFY(simulate() == 0);
+        const double continuousLastValue = lastLoggedValue(variable);
+
+        // Simulate half way and save the state
+        QVERIFY(loadModel(testModelFilePath) == 0);
+        QVERIFY(setStartTime(0) == 0);
+        QVERIFY(setStopTime(5) == 0);
+        QVERIFY(simulate() == 0);
+        QVERIFY2(saveSimulationState(qPrintable(stateFile)) == 0, "Could not save simulation state");
+
+        // Continue from the saved state in a newly loaded model, the start time is taken from the state
+        QVERIFY(loadModel(testModelFilePath) == 0);
+        QVERIFY2(loadSimulationState(qPrintable(stateFile)) == 0, "Could not load simulation state");
+        QVERIFY(setStopTime(10) == 0);
+        QVERIFY(simulate() == 0);
+        QFile::remove(stateFile);
+        QCOMPARE(lastLoggedValue(variable), continuousLastValue);
+
+        QVERIFY2(loadSimulationState(qPrintable(stateFile)) != 0, "Loading a missing simulation state file did not fail");
+    }
+};
+
+QTEST_APPLESS_MAIN(HopsanCTest)
+
+#include "tst_hopsanctest.moc"
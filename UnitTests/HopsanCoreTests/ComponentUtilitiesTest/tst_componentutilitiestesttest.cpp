@@ -539,6 +539,94 @@ private Q_SLOTS:
         QTest::newRow("5") << tempVec << 0.001 << 1.0 << -1000000000.0 << 2.0 << 2.0;
     }
 
+    void Save_Restore_State()
+    {
+        QFETCH(int, nStepsBefore);
+        QFETCH(int, nStepsAfter);
+
+        double num[3] = {1.0, 0.0, 0.0};
+        double den[3] = {1.0, 0.01, 0.0001};
+        SecondOrderTransferFunction tf, restoredTf;
+        Delay delay, restoredDelay;
+        tf.initialize(0.001, num, den, 0.0, 0.0);
+        restoredTf.initialize(0.001, num, den, 0.0, 0.0);
+        delay.initialize(10, 0.0);
+
+        for(int i=0; i<nStepsBefore; ++i)
+        {
+            delay.update(tf.update(std::sin(0.01*i)));
+        }
+
+        SimulationStateBuffer buffer;
+        tf.saveState(buffer);
+        delay.saveState(buffer);
+        QVERIFY(restoredTf.restoreState(buffer));
+        QVERIFY(restoredDelay.restoreState(buffer));
+        QVERIFY(!buffer.hasFailed());
+
+        for(int i=nStepsBefore; i<nStepsBefore+nStepsAfter; ++i)
+        {
+            const double u = std::sin(0.01*i);
+            QCOMPARE(restoredDelay.update(restoredTf.update(u)), delay.update(tf.update(u)));
+        }
+
+        // Reading past the end of the buffer must fail
+        double dummy;
+        QVERIFY(!buffer.read(dummy));
+        QVERIFY(buffer.hasFailed());
+    }
+
+    void Save_Restore_State_data()
+    {
+        QTest::addColumn<int>("nStepsBefore");
+        QTest::addColumn<int>("nStepsAfter");
+        QTest::newRow("0") << 0 << 100;
+        QTest::newRow("1") << 5 << 100;
+        QTest::newRow("2") << 1000 << 1000;
+    }
+
+    void Random_Number_Generator()
+    {
+        QFETCH(quint64, seed);
+        QFETCH(int, nValuesBefore);
+
+        RandomNumberGenerator generator(seed), blockGenerator(seed), restoredGenerator;
+        for(int i=0; i<nValuesBefore; ++i)
+        {
+            generator.gaussian();
+        }
+
+        SimulationStateBuffer buffer;
+        generator.saveState(buffer);
+        QVERIFY(restoredGenerator.restoreState(buffer));
+
+        // Single values and block fill must give the same stream
+        std::vector<double> block(nValuesBefore+257);
+        blockGenerator.fillGaussian(&block[0], block.size());
+        for(size_t i=nValuesBefore; i<block.size(); ++i)
+        {
+            const double value = generator.gaussian();
+            QCOMPARE(value, block[i]);
+            QCOMPARE(restoredGenerator.gaussian(), value);
+        }
+
+        std::vector<double> uniform(1001);
+        generator.fillUniform(&uniform[0], uniform.size());
+        for(size_t i=0; i<uniform.size(); ++i)
+        {
+            QVERIFY(uniform[i] > 0.0 && uniform[i] < 1.0);
+        }
+    }
+
+    void Random_Number_Generator_data()
+    {
+        QTest::addColumn<quint64>("seed");
+        QTest::addColumn<int>("nValuesBefore");
+        QTest::newRow("0") << quint64(0) << 0;
+        QTest::newRow("1") << quint64(1) << 7;
+        QTest::newRow("2") << quint64(0xFFFFFFFFFFFFFFFFULL) << 128;
+    }
+
     void ploParser()
     {
         QFETCH( QString, ploData);
@@ -114,6 +114,10 @@ private Q_SLOTS:
     void lookup2D_data();
     void lookup3D();
     void lookup3D_data();
+    void lookup1DSequence();
+    void lookup1DSequence_data();
+    void lookupNDSequence();
+    void lookupNDSequence_data();
 };
 
 LookupTableTest::LookupTableTest()
@@ -480,6 +484,199 @@ void LookupTableTest::lookup3D_data()
 
 }
 
+void LookupTableTest::lookup1DSequence()
+{
+    QFETCH(QVector<double>, indexData);
+    QFETCH(QVector<double>, valueData);
+    QFETCH(bool, isUniform);
+    QFETCH(QVector<double>, in);
+
+    LookupTable1D lookup1d;
+    lookup1d.getIndexDataRef() = indexData.toStdVector();
+    lookup1d.getValueDataRef() = valueData.toStdVector();
+    QVERIFY2(lookup1d.isDataOK(), "Failed: Data is NOT OK");
+    QVERIFY2(lookup1d.isIndexUniform(0) == isUniform, "Uniform index detection failed");
+
+    // Compare with linear interpolation in an interval found by linear search, for each value in sequence
+    QVector<double> expected(in.size());
+    for (int i=0; i<in.size(); ++i)
+    {
+        const double x = in[i];
+        if (x < indexData.first())
+        {
+            expected[i] = valueData.first();
+        }
+        else if (x >= indexData.last())
+        {
+            expected[i] = valueData.last();
+        }
+        else
+        {
+            int idx=0;
+            while (x > indexData[idx+1])
+            {
+                ++idx;
+            }
+            expected[i] = interp1(x, indexData[idx], indexData[idx+1], valueData[idx], valueData[idx+1]);
+        }
+
+        const double val = lookup1d.interpolate(x);
+        QVERIFY2(fc(val, expected[i]), QString("Interpolate returned the wrong result at %1: %2!=%3").arg(x).arg(val).arg(expected[i]).toLatin1());
+    }
+
+    // Interpolation with cursors should give the same result, also when two cursors are used on the same table at once
+    LookupTableCursor forwardCursor, backwardCursor;
+    for (int i=0; i<in.size(); ++i)
+    {
+        const int j = in.size()-1-i;
+        const double forwardVal = lookup1d.interpolate(in[i], forwardCursor);
+        const double backwardVal = lookup1d.interpolate(in[j], backwardCursor);
+        QVERIFY2(fc(forwardVal, expected[i]), QString("Interpolate with cursor returned the wrong result at %1: %2!=%3").arg(in[i]).arg(forwardVal).arg(expected[i]).toLatin1());
+        QVERIFY2(fc(backwardVal, expected[j]), QString("Interpolate with cursor returned the wrong result at %1: %2!=%3").arg(in[j]).arg(backwardVal).arg(expected[j]).toLatin1());
+    }
+
+    // The batched interpolation should give the same result
+    QVector<double> out(in.size());
+    lookup1d.interpolate(in.constData(), out.data(), size_t(in.size()));
+    for (int i=0; i<in.size(); ++i)
+    {
+        QVERIFY2(fc(out[i], expected[i]), QString("Batched interpolate returned the wrong result at %1: %2!=%3").arg(in[i]).arg(out[i]).arg(expected[i]).toLatin1());
+    }
+}
+
+void LookupTableTest::lookup1DSequence_data()
+{
+    QTest::addColumn< QVector<double> >("indexData");
+    QTest::addColumn< QVector<double> >("valueData");
+    QTest::addColumn< bool >("isUniform");
+    QTest::addColumn< QVector<double> >("in");
+
+    QVector<double> uniformIndexVec, nonUniformIndexVec, valueVec;
+    for (int i=0; i<50; ++i)
+    {
+        uniformIndexVec << -1.0+0.1*i;
+        nonUniformIndexVec << -1.0+0.1*i+0.03*(i%3);
+        valueVec << sin(0.37*i);
+    }
+
+    // Smoothly increasing, then decreasing, passing through all breakpoints and outside the range
+    QVector<double> smoothVec;
+    for (int i=0; i<=700; ++i)
+    {
+        smoothVec << -1.5+0.01*i;
+    }
+    for (int i=700; i>=0; --i)
+    {
+        smoothVec << -1.5+0.01*i;
+    }
+
+    // Random jumps, including exact breakpoints
+    QVector<double> jumpVec;
+    for (int i=0; i<500; ++i)
+    {
+        jumpVec << -1.5+7.0*rand()/RAND_MAX;
+        jumpVec << uniformIndexVec[rand() % uniformIndexVec.size()];
+        jumpVec << nonUniformIndexVec[rand() % nonUniformIndexVec.size()];
+    }
+
+    QTest::newRow("uniform_smooth") << uniformIndexVec << valueVec << true << smoothVec;
+    QTest::newRow("uniform_jumps") << uniformIndexVec << valueVec << true << jumpVec;
+    QTest::newRow("nonuniform_smooth") << nonUniformIndexVec << valueVec << false << smoothVec;
+    QTest::newRow("nonuniform_jumps") << nonUniformIndexVec << valueVec << false << jumpVec;
+}
+
+void LookupTableTest::lookupNDSequence()
+{
+    QFETCH(QVector<double>, indexData);
+    QFETCH(QVector<double>, in);
+
+    // Use the same index data along all dimensions, and values that are not linear in any dimension
+    const int n = indexData.size();
+    LookupTable2D lookup2d;
+    LookupTable3D lookup3d;
+    for (int d=0; d<2; ++d)
+    {
+        lookup2d.getIndexDataRef(d) = indexData.toStdVector();
+    }
+    for (int d=0; d<3; ++d)
+    {
+        lookup3d.getIndexDataRef(d) = indexData.toStdVector();
+    }
+    for (int r=0; r<n; ++r)
+    {
+        for (int c=0; c<n; ++c)
+        {
+            lookup2d.getValueDataRef().push_back(sin(0.37*r)*cos(0.23*c));
+            for (int p=0; p<n; ++p)
+            {
+                lookup3d.getValueDataRef().push_back(sin(0.37*r)*cos(0.23*c)+0.1*p*p);
+            }
+        }
+    }
+    QVERIFY2(lookup2d.isDataOK(), "Failed: 2D data is NOT OK");
+    QVERIFY2(lookup3d.isDataOK(), "Failed: 3D data is NOT OK");
+
+    // Each dimension gets its own shifted version of the input sequence
+    const int m = in.size();
+    QVector<double> rows(m), cols(m), planes(m);
+    for (int i=0; i<m; ++i)
+    {
+        rows[i] = in[i];
+        cols[i] = in[(i+m/3)%m];
+        planes[i] = in[(i+2*m/3)%m];
+    }
+
+    // Interpolation with cursors and batched interpolation should give the same result as interpolation without a cursor
+    QVector<double> out2d(m), out3d(m);
+    lookup2d.interpolate(rows.constData(), cols.constData(), out2d.data(), size_t(m));
+    lookup3d.interpolate(rows.constData(), cols.constData(), planes.constData(), out3d.data(), size_t(m));
+    LookupTableCursor cursor2d, cursor3d;
+    for (int i=0; i<m; ++i)
+    {
+        const double expected2d = lookup2d.interpolate(rows[i], cols[i]);
+        const double expected3d = lookup3d.interpolate(rows[i], cols[i], planes[i]);
+        const double val2d = lookup2d.interpolate(rows[i], cols[i], cursor2d);
+        const double val3d = lookup3d.interpolate(rows[i], cols[i], planes[i], cursor3d);
+        QVERIFY2(fc(val2d, expected2d), QString("2D interpolate with cursor returned the wrong result at %1: %2!=%3").arg(i).arg(val2d).arg(expected2d).toLatin1());
+        QVERIFY2(fc(val3d, expected3d), QString("3D interpolate with cursor returned the wrong result at %1: %2!=%3").arg(i).arg(val3d).arg(expected3d).toLatin1());
+        QVERIFY2(fc(out2d[i], expected2d), QString("Batched 2D interpolate returned the wrong result at %1: %2!=%3").arg(i).arg(out2d[i]).arg(expected2d).toLatin1());
+        QVERIFY2(fc(out3d[i], expected3d), QString("Batched 3D interpolate returned the wrong result at %1: %2!=%3").arg(i).arg(out3d[i]).arg(expected3d).toLatin1());
+    }
+}
+
+void LookupTableTest::lookupNDSequence_data()
+{
+    QTest::addColumn< QVector<double> >("indexData");
+    QTest::addColumn< QVector<double> >("in");
+
+    QVector<double> uniformIndexVec, nonUniformIndexVec;
+    for (int i=0; i<20; ++i)
+    {
+        uniformIndexVec << -1.0+0.1*i;
+        nonUniformIndexVec << -1.0+0.1*i+0.03*(i%3);
+    }
+
+    // Smoothly increasing, passing through all breakpoints and outside the range
+    QVector<double> smoothVec;
+    for (int i=0; i<=400; ++i)
+    {
+        smoothVec << -1.5+0.01*i;
+    }
+
+    // Random jumps, including exact breakpoints
+    QVector<double> jumpVec;
+    for (int i=0; i<200; ++i)
+    {
+        jumpVec << -1.5+4.0*rand()/RAND_MAX;
+        jumpVec << nonUniformIndexVec[rand() % nonUniformIndexVec.size()];
+    }
+
+    QTest::newRow("uniform_smooth") << uniformIndexVec << smoothVec;
+    QTest::newRow("uniform_jumps") << uniformIndexVec << jumpVec;
+    QTest::newRow("nonuniform_smooth") << nonUniformIndexVec << smoothVec;
+    QTest::newRow("nonuniform_jumps") << nonUniformIndexVec << jumpVec;
+}
+
 QTEST_APPLESS_MAIN(LookupTableTest)
 
 #include "tst_lookuptabletest.moc"
@@ -28,6 +28,11 @@
 #include "HopsanCoreVersion.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
 #include "CoreUtilities/HmfLoader.h"
+#include "CoreUtilities/LogDataSink.h"
+#include "CoreUtilities/NumHopHelper.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
+#include "ComponentUtilities/AuxiliarySimulationFunctions.h"
+#include "ComponentUtilities/num2string.hpp"
 
 #include <assert.h>
 #include <algorithm>
@@ -55,6 +60,45 @@ Q_DECLARE_METATYPE(Component*)
 Q_DECLARE_METATYPE(Port*)
 Q_DECLARE_METATYPE(Node*)
 
+//! @brief Log data sink that collects the streamed data in memory, for testing
+class TestLogDataSink : public LogDataSink
+{
+public:
+    ~TestLogDataSink()
+    {
+        finish();
+    }
+
+    std::vector<std::vector<std::vector<double> > > mStreamData;
+    std::vector<std::vector<LogSinkVariable> > mStreamVariables;
+
+protected:
+    bool openStream(const size_t streamId, const HString &rSystemHierarchy, const std::vector<LogSinkVariable> &rVariables)
+    {
+        Q_UNUSED(rSystemHierarchy)
+        mStreamData.resize(streamId+1);
+        mStreamVariables.resize(streamId+1);
+        mStreamData[streamId].resize(rVariables.size()+1);
+        mStreamVariables[streamId] = rVariables;
+        return true;
+    }
+
+    bool writeChunk(const LogDataChunk &rChunk)
+    {
+        std::vector<std::vector<double> > &rData = mStreamData[rChunk.streamId];
+        for (size_t v=0; v<rData.size(); ++v)
+        {
+            rData[v].insert(rData[v].end(), rChunk.data.begin()+v*rChunk.nSamples, rChunk.data.begin()+(v+1)*rChunk.nSamples);
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        return true;
+    }
+};
+
 
 class SimulationTests : public QObject
 {
@@ -102,6 +146,17 @@ private:
         *ppPort = pPort;
     }
 
+    bool writePloTableFile(const QString& filePath, const QString& valueAtOne, const QDateTime& modificationTime) {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        const QString ploData = QString("'VERSION'\n1\n'table.PLO'\n1 2\n'Time', 'Data'\n1.0 1.0\n0 0\n1 %1\ntable.PLO.DAT_-1\nTable.hmf\n").arg(valueAtOne);
+        file.write(ploData.toLatin1());
+        file.flush();
+        return file.setFileTime(modificationTime, QFileDevice::FileModificationTime);
+    }
+
 
     HopsanEssentials mHopsanCore;
 
@@ -343,6 +398,58 @@ private slots:
         QTest::newRow("1") << evalSystem << paramName << paramType << paramValue << expectedEvaluatedParamValue;
     }
 
+    void Parameter_Handle()
+    {
+        QFETCH(HString, fullParamName);
+        QFETCH(double, value);
+        QFETCH(HString, dependentCompName);
+        QFETCH(HString, dependentParamName);
+        QFETCH(double, expectedDependentValue);
+
+        ParameterHandle handle;
+        QVERIFY(handle.resolve(mpSystemFromFile, fullParamName));
+        QVERIFY(handle.isValid());
+        QVERIFY(handle.setValue(value));
+        QCOMPARE(handle.getValue(), value);
+
+        // Parameters referencing the changed parameter must have been re-evaluated, without evaluating the entire model
+        Component* pComp = nullptr;
+        getComponent(dependentCompName, &pComp);
+        double *pDependentValue = static_cast<double*>(pComp->getParameterDataPtr(dependentParamName));
+        QVERIFY(pDependentValue);
+        QCOMPARE(*pDependentValue, expectedDependentValue);
+    }
+
+    void Parameter_Handle_data()
+    {
+        QTest::addColumn<HString>("fullParamName");
+        QTest::addColumn<double>("value");
+        QTest::addColumn<HString>("dependentCompName");
+        QTest::addColumn<HString>("dependentParamName");
+        QTest::addColumn<double>("expectedDependentValue");
+
+        // Component parameter
+        QTest::newRow("0") << HString("TestGain#k#Value") << 3.0 << HString("TestGain") << HString("k#Value") << 3.0;
+        // Dependent parameter in subsystem, through the subsystem parameter sub_a = main_a
+        QTest::newRow("1") << HString("main_a") << 4.0 << HString("Subsystem$Gain") << HString("k#Value") << 6.0;
+        // Dependent parameter in subsystem, referencing the main system parameter directly
+        QTest::newRow("2") << HString("main_a") << 4.0 << HString("Subsystem$Gain_1") << HString("k#Value") << 6.0;
+        // Dependent parameter in subsubsystem, through two levels of system parameters
+        QTest::newRow("3") << HString("self#main_a") << 4.0 << HString("Subsystem$Subsubsystem$Gain") << HString("k#Value") << 6.0;
+        // Subsystem parameter
+        QTest::newRow("4") << HString("Subsystem#sub_b") << 5.0 << HString("Subsystem$Gain") << HString("k#Value") << 6.0;
+    }
+
+    void Parameter_Handle_Invalid()
+    {
+        ParameterHandle handle;
+        QVERIFY(!handle.resolve(mpSystemFromFile, "NoSuchComponent#k#Value"));
+        QVERIFY(!handle.resolve(mpSystemFromFile, "TestGain#NoSuchParameter"));
+        QVERIFY(!handle.resolve(mpSystemFromFile, "main_int_a"));
+        QVERIFY(!handle.isValid());
+        QVERIFY(!handle.setValue(1.0));
+    }
+
     void System_GetAndEval_Parameter()
     {
         QFETCH(HString, subSystemName);
@@ -955,6 +1062,99 @@ private slots:
         QTest::newRow("13") << evalSystem << script << expectEvalOK << expectedValue;
     }
 
+    void NumHop_Tape_Matches_Interpreter()
+    {
+        QFETCH(bool, useComponent);
+        QFETCH(HString, script);
+        QFETCH(bool, expectCompiled);
+
+        // One helper only interprets the script, the other compiles it to a tape when possible
+        NumHopHelper interpreter, compiled;
+        double interpreterRegistered = 5, compiledRegistered = 5;
+        auto setupHelper = [this, useComponent](NumHopHelper &rHelper, double *pRegistered)
+        {
+            if (useComponent)
+            {
+                rHelper.setComponent(mpSystemFromFile->getSubComponent("TestGain"));
+                rHelper.registerDataPtr("reg", pRegistered);
+            }
+            else
+            {
+                // The interpreter does not look up registered data pointers for systems, so none are registered
+                rHelper.setSystem(mpSystemFromFile);
+            }
+        };
+        setupHelper(interpreter, &interpreterRegistered);
+        setupHelper(compiled, &compiledRegistered);
+
+        HString interpreterOutput, compiledOutput;
+        const bool interpretOK = interpreter.interpretNumHopScript(script, false, interpreterOutput);
+        const bool compileOK = compiled.compileNumHopScript(script, false, compiledOutput);
+        QVERIFY2(compileOK == interpretOK, script.c_str());
+        QVERIFY(!interpreter.isCompiled());
+        QVERIFY2(compiled.isCompiled() == expectCompiled, script.c_str());
+
+        // Evaluate twice, internal variables assigned in the first evaluation are kept in the second
+        for (int i=0; i<2; ++i)
+        {
+            double interpreterValue=-1, compiledValue=-1;
+            const bool interpreterEvalOK = interpreter.eval(interpreterValue);
+            const bool compiledEvalOK = compiled.eval(compiledValue);
+            QVERIFY2(compiledEvalOK == interpreterEvalOK, script.c_str());
+            if (interpreterEvalOK)
+            {
+                QVERIFY2(compiledValue == interpreterValue, (script+": "+to_hstring(compiledValue)+" != "+to_hstring(interpreterValue)).c_str());
+            }
+            QVERIFY2(compiledRegistered == interpreterRegistered, (script+": "+to_hstring(compiledRegistered)+" != "+to_hstring(interpreterRegistered)).c_str());
+        }
+    }
+
+    void NumHop_Tape_Matches_Interpreter_data()
+    {
+        QTest::addColumn<bool>("useComponent");
+        QTest::addColumn<HString>("script");
+        QTest::addColumn<bool>("expectCompiled");
+
+        // Precedence and unary minus
+        QTest::newRow("0") << false << HString("2+3*4") << true;
+        QTest::newRow("1") << false << HString("(2+3)*4") << true;
+        QTest::newRow("2") << false << HString("2*3^2+1") << true;
+        QTest::newRow("3") << false << HString("-2*3") << true;
+        QTest::newRow("4") << false << HString("-(2+3)*4") << true;
+        QTest::newRow("5") << false << HString("2*-3") << true;
+        QTest::newRow("6") << false << HString("1-(-2)") << true;
+        QTest::newRow("7") << false << HString("2*pi") << true;
+
+        // Left associativity
+        QTest::newRow("8") << false << HString("a=8; b=4; c=2; a-b-c") << true;
+        QTest::newRow("9") << false << HString("a=8; b=4; c=2; a/b/c") << true;
+        QTest::newRow("10") << false << HString("a=8; b=4; c=2; a-b+c") << true;
+        QTest::newRow("11") << false << HString("a=8; b=4; c=2; a/b*c") << true;
+        QTest::newRow("12") << true << HString("a=8; b=4; c=2; a-b-c-a/b/c") << true;
+
+        // Variable writes between statements, both internal and registered variables
+        QTest::newRow("13") << false << HString("a=1; a=a+1; a=a*3; a") << true;
+        QTest::newRow("14") << true << HString("reg=reg*2; a=reg+1; reg=a*a; reg-a") << true;
+        QTest::newRow("15") << true << HString("a=self.k*7; reg=a-reg; a/reg") << true;
+        QTest::newRow("16") << false << HString("a=TestGain.k+self.apa; b=a^2; b-a") << true;
+
+        // Comparison and boolean operators are evaluated by the interpreter
+        QTest::newRow("17") << false << HString("a=2; b=3; a<b") << false;
+        QTest::newRow("18") << false << HString("a=2; b=3; a>b") << false;
+        QTest::newRow("19") << false << HString("a=2; b=3; (a<b)&(b>a)") << false;
+        QTest::newRow("20") << false << HString("a=2; b=3; (a>b)|(b<a)") << false;
+        QTest::newRow("21") << true << HString("reg=reg>1; reg") << false;
+
+        // Other cases that fall back to the interpreter
+        QTest::newRow("22") << false << HString("a=2; -a^2") << false;
+        QTest::newRow("23") << false << HString("a=2; a^3^2") << false;
+        QTest::newRow("24") << false << HString("cos(pi/4)") << false;
+        QTest::newRow("25") << false << HString("pi=3; pi") << false;
+        QTest::newRow("26") << true << HString("y=x+1; x=2; y") << false;
+        QTest::newRow("27") << true << HString("nosuchname+1") << false;
+        QTest::newRow("28") << false << HString("# only a comment") << false;
+    }
+
     void System_Add_And_Remove_Component()
     {
         Component *pComp = mHopsanCore.createComponent("SignalSink");
@@ -985,6 +1185,72 @@ private slots:
         QTest::newRow("0") << HString("TestStep") << HString("NewName");
     }
 
+    void System_Clone()
+    {
+        ComponentSystem *pClone = mpSystemFromFile->clone();
+        QVERIFY2(pClone, "Failed to clone system.");
+        QVERIFY2(pClone->getSubComponentNames() == mpSystemFromFile->getSubComponentNames(), "Clone does not have the same sub components.");
+        QVERIFY2(pClone->getSubComponent("TestStep")->getPort("out")->isConnectedTo(pClone->getSubComponent("TestGain")->getPort("in")),
+                 "Failed to clone connection.");
+
+        HString originalValue, clonedValue;
+        mpSystemFromFile->getSubComponent("TestStep")->getParameterValue("y_A#Value", originalValue);
+        pClone->getSubComponent("TestStep")->getParameterValue("y_A#Value", clonedValue);
+        QVERIFY2(originalValue == clonedValue, "Failed to clone parameter value.");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY(pClone->initialize(0, 10.0));
+        pClone->simulate(10.0);
+        pClone->finalize();
+        std::vector< std::vector<double> > originalResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        std::vector< std::vector<double> > clonedResults = *pClone->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        QVERIFY2(originalResults == clonedResults, "Original and cloned system gave different results!");
+
+        mHopsanCore.removeComponent(pClone);
+    }
+
+    void Component_Lookup_Table_Shared_With_Clone()
+    {
+        // The file is rewritten with the same size and modification time, so only a re-read can see the new values
+        const QString tableFile = QDir::temp().filePath("hopsan_unittest_lookuptable.plo");
+        const QDateTime modificationTime = QDateTime::fromSecsSinceEpoch(1600000000);
+        QVERIFY(writePloTableFile(tableFile, "10", modificationTime));
+
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        Component *pTable = mHopsanCore.createComponent("Signal1DPLOLookupTable");
+        pTable->setName("Table");
+        pSystem->addComponent(pTable);
+        QVERIFY(pTable->setParameterValue("filename", qPrintable(tableFile)));
+        QVERIFY(pTable->setParameterValue("in#Value", "0.5"));
+        pSystem->setDesiredTimestep(0.001);
+
+        // Clone before the table has been read, the table read first is shared
+        ComponentSystem *pClone = pSystem->clone();
+        QVERIFY2(pClone, "Failed to clone system.");
+        Component *pClonedTable = pClone->getSubComponent("Table");
+
+        QVERIFY(pSystem->initialize(0, 0.01));
+        QVERIFY(fuzzyEqual(pTable->getPort("out")->readNodeSafe(0), 5.0));
+        pSystem->finalize();
+
+        QVERIFY(writePloTableFile(tableFile, "20", modificationTime));
+        QVERIFY(pClone->initialize(0, 0.01));
+        QVERIFY2(fuzzyEqual(pClonedTable->getPort("out")->readNodeSafe(0), 5.0), "The clone read the table file again!");
+        pClone->finalize();
+
+        // A new modification time means the file has changed, so it must be read again
+        QVERIFY(writePloTableFile(tableFile, "20", modificationTime.addSecs(10)));
+        QVERIFY(pClone->initialize(0, 0.01));
+        QVERIFY2(fuzzyEqual(pClonedTable->getPort("out")->readNodeSafe(0), 10.0), "The changed table file was not read again!");
+        pClone->finalize();
+
+        mHopsanCore.removeComponent(pClone);
+        mHopsanCore.removeComponent(pSystem);
+        QFile::remove(tableFile);
+    }
+
     void System_Disconnect_Connect()
     {
         QFETCH(QString, fullPortName1);
@@ -1090,6 +1356,367 @@ private slots:
         QVERIFY2(multiResults3 == singleResults3, "Single-threaded and multi-threaded simulation gave different results!");
     }
 
+    void System_Simulate_Multicore_TaskStealing()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, false, TaskStealingAlgorithm);
+        mpSystemFromFile->finalize();
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        std::vector< std::vector<double> > multiResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        QVERIFY2(multiResults == singleResults, "Single-threaded and task-stealing simulation gave different results!");
+    }
+
+    void System_Simulate_Multicore_Clustered()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        std::vector<double> singleLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, false, ClusteredForkJoinAlgorithm);
+        mpSystemFromFile->finalize();
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        std::vector< std::vector<double> > multiResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        QVERIFY2(multiResults == singleResults, "Single-threaded and clustered simulation gave different results!");
+        std::vector<double> multiLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+        QVERIFY2(multiLastValues == singleLastValues, "Node data values were not copied back from the partitions!");
+    }
+
+    void System_Simulate_Multicore_Repeated()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > singleResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+
+        // The second and third simulations reuse the thread pool and the cached schedule
+        for (int i=0; i<3; ++i)
+        {
+            QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+            mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, true, APrioriScheduling);
+            mpSystemFromFile->finalize();
+            QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+            std::vector< std::vector<double> > multiResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+            QVERIFY2(multiResults == singleResults, "Single-threaded and repeated multi-threaded simulation gave different results!");
+        }
+    }
+
+    void System_Simulate_TypeBatched()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > normalGainResults = *mpSystemFromFile->getSubComponent("TestGain")->getPort("out")->getLogDataVectorPtr();
+        std::vector< std::vector<double> > normalVolumeResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+
+        mpSystemFromFile->setUseTypeBatching(true);
+        QVERIFY(mpSystemFromFile->doesUseTypeBatching());
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() == 2048, "Failed to simulate system!");
+        std::vector< std::vector<double> > batchedGainResults = *mpSystemFromFile->getSubComponent("TestGain")->getPort("out")->getLogDataVectorPtr();
+        std::vector< std::vector<double> > batchedVolumeResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        QVERIFY2(normalGainResults == batchedGainResults, "Type-batched simulation gave different results!");
+        QVERIFY2(normalVolumeResults == batchedVolumeResults, "Type-batched simulation gave different results!");
+    }
+
+    void Component_Derived_Type_Is_Not_Batched()
+    {
+        Component *pBase = mHopsanCore.createComponent("HydraulicCylinderC");
+        Component *pDerived = mHopsanCore.createComponent("HydraulicSymmetricCylinderC");
+        QVERIFY2(pBase && pDerived, "Failed to create components!");
+        QVERIFY2(pBase->getSimulateBatchFunction() != 0, "Batched component type has no batch function!");
+        QVERIFY2(pDerived->getSimulateBatchFunction() == 0, "Derived component type was batched as its base type!");
+        mHopsanCore.removeComponent(pBase);
+        mHopsanCore.removeComponent(pDerived);
+    }
+
+    void System_Log_Columns_And_Decimation()
+    {
+        Port* pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const size_t nSamples = mpSystemFromFile->getNumActuallyLoggedSamples();
+        const std::vector<double> *pColumn = pPort->getLogDataColumnPtr(0);
+        QVERIFY2(pColumn && (pColumn->size() >= nSamples), "Log data column is missing!");
+        for (size_t s=0; s<nSamples; ++s)
+        {
+            QVERIFY2((*pColumn)[s] == pPort->getLogDataVectorPtr()->at(s).at(0), "Log data rows and columns differ!");
+        }
+
+        mpSystemFromFile->setLogDecimationMode(LogEnvelope);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        mpSystemFromFile->setLogDecimationMode(LogSampled);
+        const std::vector<double> *pMean = pPort->getLogDataColumnPtr(0);
+        const std::vector<double> *pMin = pPort->getLogDataColumnPtr(0, LogMinColumn);
+        const std::vector<double> *pMax = pPort->getLogDataColumnPtr(0, LogMaxColumn);
+        QVERIFY2(pMean && pMin && pMax, "Envelope log data columns are missing!");
+        for (size_t s=0; s<nSamples; ++s)
+        {
+            QVERIFY2(((*pMin)[s] <= (*pMean)[s]+1e-9) && ((*pMean)[s] <= (*pMax)[s]+1e-9), "Envelope log data is not ordered min <= mean <= max!");
+        }
+
+        pPort->setEnableLogVariable(0, false);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        pPort->setEnableLogVariable(0, true);
+        QVERIFY2(pPort->getLogDataColumnPtr(0) == 0, "Disabled log variable was logged!");
+        QVERIFY2(pPort->getLogDataColumnPtr(1) != 0, "Enabled log variable was not logged!");
+    }
+
+    void System_Log_Stream_To_Sink()
+    {
+        Port* pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        const size_t nSamples = mpSystemFromFile->getNumActuallyLoggedSamples();
+        const std::vector<double> time(mpSystemFromFile->getLogTimeVector()->begin(), mpSystemFromFile->getLogTimeVector()->begin()+nSamples);
+        const std::vector<double> *pColumn = pPort->getLogDataColumnPtr(0);
+        QVERIFY(pColumn);
+        const std::vector<double> values(pColumn->begin(), pColumn->begin()+nSamples);
+
+        // Use a chunk size that does not divide the number of samples
+        TestLogDataSink sink;
+        sink.setChunkSize(7);
+        sink.setMaxQueuedChunks(2);
+        mpSystemFromFile->setLogDataSink(&sink);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        mpSystemFromFile->setLogDataSink(nullptr);
+        QVERIFY(sink.finish());
+
+        QVERIFY2(mpSystemFromFile->getNumStreamedLogSamples() == nSamples, "Wrong number of streamed log samples!");
+        QVERIFY2(mpSystemFromFile->getNumActuallyLoggedSamples() <= 7, "More than one chunk of log data kept in memory!");
+        QVERIFY(!sink.mStreamData.empty());
+        QVERIFY2(sink.mStreamData[0][0] == time, "Streamed time differs from in-memory log!");
+        bool found = false;
+        for (size_t v=0; v<sink.mStreamVariables[0].size(); ++v)
+        {
+            const LogSinkVariable &rVar = sink.mStreamVariables[0][v];
+            if (rVar.componentName == "TestVolume" && rVar.portName == "P1" && rVar.variableName == pPort->getNodeDataDescription(0)->name)
+            {
+                found = true;
+                QVERIFY2(sink.mStreamData[0][v+1] == values, "Streamed log data differs from in-memory log!");
+            }
+        }
+        QVERIFY2(found, "Variable was not streamed!");
+    }
+
+    void System_Log_Stream_To_Sink_Multicore()
+    {
+        TestLogDataSink singleSink;
+        singleSink.setChunkSize(7);
+        mpSystemFromFile->setLogDataSink(&singleSink);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY(singleSink.finish());
+
+        // The profiling pass and re-initialization in the multi-threaded simulation must not register new streams or submit samples
+        TestLogDataSink multiSink;
+        multiSink.setChunkSize(7);
+        mpSystemFromFile->setLogDataSink(&multiSink);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulateMultiThreaded(0, 10.0, 0, false, APrioriScheduling);
+        mpSystemFromFile->finalize();
+        mpSystemFromFile->setLogDataSink(nullptr);
+        QVERIFY(multiSink.finish());
+
+        QVERIFY2(multiSink.mStreamVariables.size() == singleSink.mStreamVariables.size(), "Multi-threaded simulation registered a different number of streams!");
+        QVERIFY2(multiSink.mStreamData == singleSink.mStreamData, "Multi-threaded simulation streamed different log data!");
+    }
+
+    void System_Simulate_NodeDataArena()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector< std::vector<double> > normalVolumeResults = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getLogDataVectorPtr();
+        std::vector<double> normalLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+
+        mpSystemFromFile->setUseNodeDataArena(true);
+        QVERIFY(mpSystemFromFile->doesUseNodeDataArena());
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        Port* pPort = mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1");
+        QVERIFY2(pPort->getNodeDataPtr(0) != &pPort->getDataVectorPtr()->at(0), "Node data was not moved into the arena!");
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        QVERIFY2(pPort->getNodeDataPtr(0) == &pPort->getDataVectorPtr()->at(0), "Node data was not moved back from the arena!");
+        std::vector< std::vector<double> > arenaVolumeResults = *pPort->getLogDataVectorPtr();
+        std::vector<double> arenaLastValues = *pPort->getDataVectorPtr();
+        QVERIFY2(normalVolumeResults == arenaVolumeResults, "Simulation with node data arena gave different results!");
+        QVERIFY2(normalLastValues == arenaLastValues, "Node data values were not copied back from the arena!");
+    }
+
+    void System_Save_Restore_Simulation_Point()
+    {
+        QFETCH(bool, useNodeDataArena);
+        QFETCH(bool, multiThreaded);
+        const QString stateFile = QDir::temp().filePath("hopsan_unittest_simulationpoint.hss");
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> continuousLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+
+        // Simulate half way and save the state, the node data lives in the arena while simulating if it is enabled
+        mpSystemFromFile->setUseNodeDataArena(useNodeDataArena);
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(5.0);
+        saveSimulationPoint(qPrintable(stateFile), mpSystemFromFile);
+        mpSystemFromFile->finalize();
+
+        // Resume from the saved state, the multi-threaded simulation re-initializes the system after profiling
+        double timeOffset = 0;
+        restoreSimulationPoint(qPrintable(stateFile), mpSystemFromFile, timeOffset);
+        QVERIFY2(fuzzyEqual(timeOffset, 5.0), "Simulation time was not restored!");
+        QVERIFY(mpSystemFromFile->initialize(timeOffset, 10.0));
+        QVERIFY(restoreSimulationCheckpoint(qPrintable(stateFile), mpSystemFromFile));
+        if (multiThreaded)
+        {
+            mpSystemFromFile->simulateMultiThreaded(timeOffset, 10.0, 2, false, APrioriScheduling);
+        }
+        else
+        {
+            mpSystemFromFile->simulate(10.0);
+        }
+        mpSystemFromFile->finalize();
+        QFile::remove(stateFile);
+
+        std::vector<double> resumedLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+        QVERIFY2(resumedLastValues == continuousLastValues, "Resumed simulation gave different results than a continuous simulation!");
+    }
+
+    void System_Save_Restore_Simulation_Point_data()
+    {
+        QTest::addColumn<bool>("useNodeDataArena");
+        QTest::addColumn<bool>("multiThreaded");
+        QTest::newRow("0") << false << false;
+        QTest::newRow("1") << true << false;
+        QTest::newRow("2") << false << true;
+        QTest::newRow("3") << true << true;
+    }
+
+    void System_Restore_Simulation_Point_Unknown_Package()
+    {
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> continuousLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+
+        QVERIFY(mpSystemFromFile->initialize(0, 10.0));
+        mpSystemFromFile->simulate(5.0);
+        std::string state;
+        saveSimulationCheckpointToMemory(state, mpSystemFromFile);
+        mpSystemFromFile->finalize();
+
+        // Add packages that this version does not know about, as a later version could write them, after the 12 byte
+        // format version package and at the end. A package head is a 2-byte identifier and an 8-byte data length.
+        const char unknownPackageData[] = {0x7f, 0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 'a', 'b', 'c', 'd', 'e'};
+        const std::string unknownPackage(unknownPackageData, sizeof(unknownPackageData));
+        const std::string extendedState = state.substr(0, 12) + unknownPackage + state.substr(12) + unknownPackage;
+
+        QVERIFY(mpSystemFromFile->initialize(5.0, 10.0));
+        QVERIFY2(restoreSimulationCheckpointFromMemory(extendedState, mpSystemFromFile), "Failed to restore state with unknown packages!");
+        mpSystemFromFile->simulate(10.0);
+        mpSystemFromFile->finalize();
+        std::vector<double> resumedLastValues = *mpSystemFromFile->getSubComponent("TestVolume")->getPort("P1")->getDataVectorPtr();
+        QVERIFY2(resumedLastValues == continuousLastValues, "Unknown packages changed the restored state!");
+
+        // Unknown packages can not be skipped in files without a format version, and truncated files are rejected
+        QVERIFY(mpSystemFromFile->initialize(5.0, 10.0));
+        QVERIFY2(!restoreSimulationCheckpointFromMemory(unknownPackage+state.substr(12), mpSystemFromFile), "Unknown package without format version was not rejected!");
+        QVERIFY2(!restoreSimulationCheckpointFromMemory(state.substr(0, state.size()-3), mpSystemFromFile), "Truncated state was not rejected!");
+        mpSystemFromFile->finalize();
+    }
+
+    void Component_Restore_Noise_State()
+    {
+        QFETCH(QString, method);
+
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        Component *pIdentifier = mHopsanCore.createComponent("SignalSteadyStateIdentifier");
+        pIdentifier->setName("Identifier");
+        pSystem->addComponent(pIdentifier);
+        QVERIFY(pIdentifier->setParameterValue("method", qPrintable(method)));
+        QVERIFY(pIdentifier->setParameterValue("tol#Value", "0.5"));
+        pSystem->setDesiredTimestep(0.001);
+
+        QVERIFY(pSystem->initialize(0, 1.0));
+        pSystem->simulate(0.5);
+        std::string state;
+        saveSimulationCheckpointToMemory(state, pSystem);
+        std::vector<double> expectedOutput;
+        for (size_t s=1; s<=200; ++s)
+        {
+            pSystem->simulate(0.5+0.001*s);
+            expectedOutput.push_back(pIdentifier->getPort("out")->readNodeSafe(0));
+        }
+        pSystem->finalize();
+
+        // The noise stream and the sliding window must continue where they were saved
+        QVERIFY(pSystem->initialize(0.5, 1.0));
+        QVERIFY2(restoreSimulationCheckpointFromMemory(state, pSystem), "Failed to restore state!");
+        for (size_t s=1; s<=200; ++s)
+        {
+            pSystem->simulate(0.5+0.001*s);
+            QVERIFY2(pIdentifier->getPort("out")->readNodeSafe(0) == expectedOutput[s-1], "Restored simulation gave different results!");
+        }
+        pSystem->finalize();
+        mHopsanCore.removeComponent(pSystem);
+    }
+
+    void Component_Restore_Noise_State_data()
+    {
+        QTest::addColumn<QString>("method");
+        QTest::newRow("Variance ratio") << "1";
+        QTest::newRow("Moving average") << "2";
+    }
+
+    void System_Simulate_MultiRate()
+    {
+        ComponentSystem *pSystem = mHopsanCore.createComponentSystem();
+        Component *pHold = mHopsanCore.createComponent("SignalTime");
+        pHold->setName("Hold");
+        pHold->setStepMultiple(4);
+        pSystem->addComponent(pHold);
+        Component *pExtrapolate = mHopsanCore.createComponent("SignalTime");
+        pExtrapolate->setName("Extrapolate");
+        pExtrapolate->setStepMultiple(4);
+        pExtrapolate->setRateBoundaryMode(Component::ExtrapolateOutputs);
+        pSystem->addComponent(pExtrapolate);
+        pSystem->setDesiredTimestep(0.001);
+        pSystem->setNumLogSamples(11);
+
+        QVERIFY(pSystem->initialize(0, 0.01));
+        QVERIFY2(fuzzyEqual(pHold->getTimestep(), 0.004), "Step multiple was not applied to the time step!");
+        pSystem->simulate(0.01);
+        pSystem->finalize();
+        QVERIFY2(pSystem->getNumActuallyLoggedSamples() == 11, "Failed to simulate system!");
+        for (size_t s=0; s<11; ++s)
+        {
+            const double time = pSystem->getLogTimeVector()->at(s);
+            const double heldTime = 0.004*size_t(s/4);
+            QVERIFY2(fuzzyEqual(pHold->getPort("out")->getLogDataVectorPtr()->at(s).at(0), heldTime), "Output was not held between component steps!");
+            QVERIFY2(fuzzyEqual(pExtrapolate->getPort("out")->getLogDataVectorPtr()->at(s).at(0), (time < 0.004) ? 0 : time), "Output was not extrapolated between component steps!");
+        }
+        mHopsanCore.removeComponent(pSystem);
+    }
+
     void Component_Set_Parameter()
     {
         QFETCH(QString, compName);
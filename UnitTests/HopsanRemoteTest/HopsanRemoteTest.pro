@@ -0,0 +1,21 @@
+QT       += testlib
+QT       -= gui
+
+#Determine debug extension
+include( ../../Common.prf )
+
+TARGET = tst_hopsanremotetest$${DEBUG_EXT}
+CONFIG   += console
+CONFIG   -= app_bundle
+DESTDIR = $${PWD}/../../bin
+
+
+TEMPLATE = app
+
+INCLUDEPATH += $${PWD}/../../hopsanremote/libhopsanremotecommon/include/
+
+QMAKE_CXXFLAGS += -std=c++14
+
+SOURCES += \
+    tst_hopsanremotetest.cpp \
+    $${PWD}/../../hopsanremote/libhopsanremotecommon/src/DataCompression.cpp
@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+#include <QtTest>
+
+#include "hopsanremotecommon/DataCompression.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+Q_DECLARE_METATYPE(std::vector<double>)
+
+namespace {
+
+//! @brief Compare the bit patterns of two arrays of doubles, so that NaN and the sign of zero are also compared
+bool isBitwiseEqual(const std::vector<double> &rA, const std::vector<double> &rB)
+{
+    if (rA.size() != rB.size())
+    {
+        return false;
+    }
+    for (size_t i=0; i<rA.size(); ++i)
+    {
+        uint64_t a, b;
+        memcpy(&a, &rA[i], sizeof(double));
+        memcpy(&b, &rB[i], sizeof(double));
+        if (a != b)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Doubles with random bit patterns, they compress into long literal runs
+std::vector<double> randomBitPatterns(const size_t n)
+{
+    std::mt19937_64 generator(1234);
+    std::vector<double> values(n);
+    for (size_t i=0; i<n; ++i)
+    {
+        const uint64_t bits = generator();
+        memcpy(&values[i], &bits, sizeof(double));
+    }
+    return values;
+}
+
+}
+
+class HopsanRemoteTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void Compress_Doubles_Round_Trip()
+    {
+        QFETCH(std::vector<double>, values);
+
+        const std::string compressed = compressDoubles(values.data(), values.size());
+        std::vector<double> decompressed(values.size(), -1.0);
+        QVERIFY2(decompressDoubles(compressed, values.size(), decompressed.data()), "Could not decompress data");
+        QVERIFY2(isBitwiseEqual(values, decompressed), "Decompressed data differs from the original data");
+    }
+
+    void Compress_Doubles_Round_Trip_data()
+    {
+        QTest::addColumn<std::vector<double> >("values");
+
+        const double inf = std::numeric_limits<double>::infinity();
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        std::vector<double> smooth(2000);
+        for (size_t i=0; i<smooth.size(); ++i)
+        {
+            smooth[i] = std::sin(0.01*double(i));
+        }
+
+        QTest::newRow("empty") << std::vector<double>();
+        QTest::newRow("one value") << std::vector<double>(1, 3.5);
+        QTest::newRow("all zeros") << std::vector<double>(1000, 0.0);
+        QTest::newRow("constant") << std::vector<double>(1000, -2.25);
+        QTest::newRow("nan and inf") << std::vector<double>({nan, inf, -inf, -0.0, 0.0, 1.0, nan, -nan,
+                                                             std::numeric_limits<double>::denorm_min(), (std::numeric_limits<double>::max)()});
+        QTest::newRow("smooth") << smooth;
+        QTest::newRow("long literal runs") << randomBitPatterns(1000);
+    }
+
+    void Decompress_Doubles_Invalid()
+    {
+        const std::vector<double> values = randomBitPatterns(100);
+        const std::string compressed = compressDoubles(values.data(), values.size());
+        std::vector<double> decompressed(values.size()+1);
+
+        // Truncated data
+        for (size_t length=0; length<compressed.size(); ++length)
+        {
+            QVERIFY2(!decompressDoubles(compressed.substr(0, length), values.size(), decompressed.data()), "Truncated data was decompressed");
+        }
+        // Trailing data
+        QVERIFY2(!decompressDoubles(compressed+'\0', values.size(), decompressed.data()), "Data with trailing bytes was decompressed");
+        // Wrong number of values
+        QVERIFY2(!decompressDoubles(compressed, values.size()-1, decompressed.data()), "Data was decompressed into too few values");
+        QVERIFY2(!decompressDoubles(compressed, values.size()+1, decompressed.data()), "Data was decompressed into too many values");
+        // Non-empty data for no values
+        QVERIFY2(!decompressDoubles(compressed, 0, decompressed.data()), "Data was decompressed into no values");
+    }
+};
+
+QTEST_APPLESS_MAIN(HopsanRemoteTest)
+
+#include "tst_hopsanremotetest.moc"
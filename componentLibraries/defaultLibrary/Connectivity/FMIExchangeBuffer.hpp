@@ -0,0 +1,99 @@
+#ifndef FMIEXCHANGEBUFFER_HPP
+#define FMIEXCHANGEBUFFER_HPP
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include "fmi4c.h"
+
+//!
+//! @file FMIExchangeBuffer.hpp
+//! @brief Contiguous value references and values for exchanging variables with functional mockup units
+//!
+
+namespace hopsan {
+
+//! @brief The value references and values of all input or output variables of one type, so that they can be exchanged with a single FMI call
+//! @tparam ValueT The FMI value type
+//! @tparam IsBoolean Set to true for booleans stored as integers (FMI 1.0 and 2.0)
+template<typename ValueT, bool IsBoolean=std::is_same<ValueT, bool>::value>
+class FMIExchangeBuffer
+{
+public:
+    //! @brief Collect value references and variable pointers from a map, call this once when initializing
+    //! @param[in] rVariables Map (or multimap) from value reference to Hopsan variable pointer
+    template<typename MapT>
+    void setup(const MapT &rVariables)
+    {
+        mValueRefs.clear();
+        mpVariables.clear();
+        for(auto it = rVariables.begin(); it != rVariables.end(); ++it) {
+            if(it->second) {
+                mValueRefs.push_back(it->first);
+                mpVariables.push_back(it->second);
+            }
+        }
+        mpValues.reset(new ValueT[mValueRefs.size()]());
+    }
+
+    bool empty() const
+    {
+        return mValueRefs.empty();
+    }
+
+    size_t size() const
+    {
+        return mValueRefs.size();
+    }
+
+    const fmi3ValueReference *valueRefs() const
+    {
+        return mValueRefs.data();
+    }
+
+    ValueT *values()
+    {
+        return mpValues.get();
+    }
+
+    //! @brief Copy the Hopsan variables to the values, before setting inputs
+    void readVariables()
+    {
+        for(size_t i=0; i<mpVariables.size(); ++i) {
+            mpValues[i] = toValue(*mpVariables[i]);
+        }
+    }
+
+    //! @brief Copy the values to the Hopsan variables, after getting outputs
+    void writeVariables()
+    {
+        for(size_t i=0; i<mpVariables.size(); ++i) {
+            (*mpVariables[i]) = double(mpValues[i]);
+        }
+    }
+
+private:
+    static ValueT toValue(const double value)
+    {
+        if(std::is_same<ValueT, bool>::value) {
+            return ValueT(value > 0.5);
+        }
+        else if(IsBoolean) {
+            // FMI 1.0 and 2.0 booleans keep the plain cast (truncation towards zero) that they have always been set with
+            return ValueT(value);
+        }
+        else if(std::is_integral<ValueT>::value) {
+            return ValueT(lround(value));
+        }
+        return ValueT(value);
+    }
+
+    std::vector<fmi3ValueReference> mValueRefs;
+    std::vector<double*> mpVariables;
+    std::unique_ptr<ValueT[]> mpValues;
+};
+
+}
+
+#endif // FMIEXCHANGEBUFFER_HPP
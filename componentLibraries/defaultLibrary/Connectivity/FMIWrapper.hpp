@@ -16,6 +16,7 @@
 
 #ifdef USEFMI4C
 #include "fmi4c.h"
+#include "FMIExchangeBuffer.hpp"
 #include <cstdarg>
 #endif
 
@@ -220,6 +221,23 @@ private:
     std::map<fmi3ValueReference,int> mUInt16Parameters;
     std::map<fmi3ValueReference,int> mUInt8Parameters;
 
+    // Contiguous value references and values, so that each type of input and output is exchanged with one call per time step
+    FMIExchangeBuffer<fmi2Real> mRealInputBuffer, mRealOutputBuffer;
+    FMIExchangeBuffer<fmi2Integer> mIntInputBuffer, mIntOutputBuffer;
+    FMIExchangeBuffer<fmi1Boolean, true> mFmi1BoolInputBuffer, mFmi1BoolOutputBuffer;
+    FMIExchangeBuffer<fmi2Boolean, true> mFmi2BoolInputBuffer, mFmi2BoolOutputBuffer;
+    FMIExchangeBuffer<fmi3Float64> mFloat64InputBuffer, mFloat64OutputBuffer;
+    FMIExchangeBuffer<fmi3Float32> mFloat32InputBuffer, mFloat32OutputBuffer;
+    FMIExchangeBuffer<fmi3Int64> mInt64InputBuffer, mInt64OutputBuffer;
+    FMIExchangeBuffer<fmi3Int32> mInt32InputBuffer, mInt32OutputBuffer;
+    FMIExchangeBuffer<fmi3Int16> mInt16InputBuffer, mInt16OutputBuffer;
+    FMIExchangeBuffer<fmi3Int8> mInt8InputBuffer, mInt8OutputBuffer;
+    FMIExchangeBuffer<fmi3UInt64> mUInt64InputBuffer, mUInt64OutputBuffer;
+    FMIExchangeBuffer<fmi3UInt32> mUInt32InputBuffer, mUInt32OutputBuffer;
+    FMIExchangeBuffer<fmi3UInt16> mUInt16InputBuffer, mUInt16OutputBuffer;
+    FMIExchangeBuffer<fmi3UInt8> mUInt8InputBuffer, mUInt8OutputBuffer;
+    FMIExchangeBuffer<fmi3Boolean> mFmi3BoolInputBuffer, mFmi3BoolOutputBuffer;
+
     std::vector<Port*> mPorts;
 
     fmiVersion_t mFmiVersion;
@@ -1146,6 +1164,49 @@ public:
                 return;
             }
         }
+
+        setupExchangeBuffers();
+    }
+
+    //! @brief Collects the value references and variable pointers of all inputs and outputs into one contiguous array per type
+    void setupExchangeBuffers()
+    {
+        mRealInputBuffer.setup(mRealInputs);
+        mRealOutputBuffer.setup(mRealOutputs);
+        mIntInputBuffer.setup(mIntInputs);
+        mIntOutputBuffer.setup(mIntOutputs);
+        if(mFmiVersion == fmiVersion1) {
+            mFmi1BoolInputBuffer.setup(mBoolInputs);
+            mFmi1BoolOutputBuffer.setup(mBoolOutputs);
+        }
+        else if(mFmiVersion == fmiVersion2) {
+            mFmi2BoolInputBuffer.setup(mBoolInputs);
+            mFmi2BoolOutputBuffer.setup(mBoolOutputs);
+        }
+        else {
+            mFloat64InputBuffer.setup(mFloat64Inputs);
+            mFloat64OutputBuffer.setup(mFloat64Outputs);
+            mFloat32InputBuffer.setup(mFloat32Inputs);
+            mFloat32OutputBuffer.setup(mFloat32Outputs);
+            mInt64InputBuffer.setup(mInt64Inputs);
+            mInt64OutputBuffer.setup(mInt64Outputs);
+            mInt32InputBuffer.setup(mInt32Inputs);
+            mInt32OutputBuffer.setup(mInt32Outputs);
+            mInt16InputBuffer.setup(mInt16Inputs);
+            mInt16OutputBuffer.setup(mInt16Outputs);
+            mInt8InputBuffer.setup(mInt8Inputs);
+            mInt8OutputBuffer.setup(mInt8Outputs);
+            mUInt64InputBuffer.setup(mUInt64Inputs);
+            mUInt64OutputBuffer.setup(mUInt64Outputs);
+            mUInt32InputBuffer.setup(mUInt32Inputs);
+            mUInt32OutputBuffer.setup(mUInt32Outputs);
+            mUInt16InputBuffer.setup(mUInt16Inputs);
+            mUInt16OutputBuffer.setup(mUInt16Outputs);
+            mUInt8InputBuffer.setup(mUInt8Inputs);
+            mUInt8OutputBuffer.setup(mUInt8Outputs);
+            mFmi3BoolInputBuffer.setup(mBoolInputs);
+            mFmi3BoolOutputBuffer.setup(mBoolOutputs);
+        }
     }
 
     void simulateOneTimestep()
@@ -1154,211 +1215,193 @@ public:
             if(NULL == fmu) {
                 return;
             }
-            
+
             fmi1Status status;
-            
-           //Forward inputs
-            std::map<fmi1ValueReference,double*>::iterator it;
-            for(it = mRealInputs.begin(); it != mRealInputs.end(); it++) {
-                status = fmi1_setReal(fmu, &it->first, 1, it->second);
+
+            //Forward inputs
+            if(!mRealInputBuffer.empty()) {
+                mRealInputBuffer.readVariables();
+                status = fmi1_setReal(fmu, mRealInputBuffer.valueRefs(), mRealInputBuffer.size(), mRealInputBuffer.values());
             }
-            for(it = mIntInputs.begin(); it != mIntInputs.end(); it++) {
-                int value = (int)lround(*it->second);
-                status = fmi1_setInteger(fmu, &it->first, 1, &value);
+            if(!mIntInputBuffer.empty()) {
+                mIntInputBuffer.readVariables();
+                status = fmi1_setInteger(fmu, mIntInputBuffer.valueRefs(), mIntInputBuffer.size(), mIntInputBuffer.values());
             }
-            for(it = mBoolInputs.begin(); it != mBoolInputs.end(); it++) {
-                fmi1Boolean value = fmi1Boolean(*it->second);
-                status = fmi1_setBoolean(fmu, &it->first, 1, &value);
+            if(!mFmi1BoolInputBuffer.empty()) {
+                mFmi1BoolInputBuffer.readVariables();
+                status = fmi1_setBoolean(fmu, mFmi1BoolInputBuffer.valueRefs(), mFmi1BoolInputBuffer.size(), mFmi1BoolInputBuffer.values());
+            }
+
+            //Take step
+            status = fmi1_doStep(fmu, mTime-mTimestep, mTimestep, fmi1True);
+            if (status != fmi1OK) {
+                stopSimulation("fmi1DoStep() failed, status = "+to_hstring(status));
+                return;
+            }
+
+            //Forward outputs
+            if(!mRealOutputBuffer.empty()) {
+                status = fmi1_getReal(fmu, mRealOutputBuffer.valueRefs(), mRealOutputBuffer.size(), mRealOutputBuffer.values());
+                mRealOutputBuffer.writeVariables();
+            }
+            if(!mIntOutputBuffer.empty()) {
+                status = fmi1_getInteger(fmu, mIntOutputBuffer.valueRefs(), mIntOutputBuffer.size(), mIntOutputBuffer.values());
+                mIntOutputBuffer.writeVariables();
+            }
+            if(!mFmi1BoolOutputBuffer.empty()) {
+                status = fmi1_getBoolean(fmu, mFmi1BoolOutputBuffer.valueRefs(), mFmi1BoolOutputBuffer.size(), mFmi1BoolOutputBuffer.values());
+                mFmi1BoolOutputBuffer.writeVariables();
             }
-     
-             //Take step
-             status = fmi1_doStep(fmu, mTime-mTimestep, mTimestep, fmi1True);
-             if (status != fmi1OK) {
-                 stopSimulation("fmi1DoStep() failed, status = "+to_hstring(status));
-                 return;
-             }
-     
-             //Forward outputs
-             for(it = mRealOutputs.begin(); it != mRealOutputs.end(); it++) {
-                 status = fmi1_getReal(fmu, &it->first, 1, it->second);
-             }
-             for(it = mIntOutputs.begin(); it != mIntOutputs.end(); it++) {
-                 int temp;
-                 status = fmi1_getInteger(fmu, &it->first, 1, &temp);
-                 (*it->second) = temp;
-             }
-             for(it = mBoolOutputs.begin(); it != mBoolOutputs.end(); it++) {
-                 fmi1Boolean temp;
-                 status = fmi1_getBoolean(fmu, &it->first, 1, &temp);
-                 (*it->second) = temp;
-             }
         }
         else if(mFmiVersion == fmiVersion2) {
             if(NULL == fmu) {
                 return;
             }
-            
+
             fmi2Status status;
-            
+
             //Forward inputs
-            std::map<fmi2ValueReference,double*>::iterator it;
-            for(it = mRealInputs.begin(); it != mRealInputs.end(); it++) {
-                status = fmi2_setReal(fmu, &it->first, 1, it->second);
-            }
-            for(it = mIntInputs.begin(); it != mIntInputs.end(); it++) {
-                int value = (int)lround(*it->second);
-                status = fmi2_setInteger(fmu, &it->first, 1, &value);
-            }
-            for(it = mBoolInputs.begin(); it != mBoolInputs.end(); it++) {
-                int value = int(*it->second);
-                status = fmi2_setBoolean(fmu, &it->first, 1, &value);
-            }
-     
-             //Take step
-             status = fmi2_doStep(fmu, mTime-mTimestep, mTimestep, fmi3True);
-             if (status != fmi2OK) {
-                 stopSimulation("fmi2DoStep() failed, status = "+to_hstring(status));
-                 return;
-             }
-     
-             //Forward outputs
-             for(it = mRealOutputs.begin(); it != mRealOutputs.end(); it++) {
-                 status = fmi2_getReal(fmu, &it->first, 1, it->second);
-             }
-             for(it = mIntOutputs.begin(); it != mIntOutputs.end(); it++) {
-                 int temp;
-                 status = fmi2_getInteger(fmu, &it->first, 1, &temp);
-                 (*it->second) = temp;
-             }
-             for(it = mBoolOutputs.begin(); it != mBoolOutputs.end(); it++) {
-                 int temp;
-                 status = fmi2_getBoolean(fmu, &it->first, 1, &temp);
-                 (*it->second) = temp;
-             }
+            if(!mRealInputBuffer.empty()) {
+                mRealInputBuffer.readVariables();
+                status = fmi2_setReal(fmu, mRealInputBuffer.valueRefs(), mRealInputBuffer.size(), mRealInputBuffer.values());
+            }
+            if(!mIntInputBuffer.empty()) {
+                mIntInputBuffer.readVariables();
+                status = fmi2_setInteger(fmu, mIntInputBuffer.valueRefs(), mIntInputBuffer.size(), mIntInputBuffer.values());
+            }
+            if(!mFmi2BoolInputBuffer.empty()) {
+                mFmi2BoolInputBuffer.readVariables();
+                status = fmi2_setBoolean(fmu, mFmi2BoolInputBuffer.valueRefs(), mFmi2BoolInputBuffer.size(), mFmi2BoolInputBuffer.values());
+            }
+
+            //Take step
+            status = fmi2_doStep(fmu, mTime-mTimestep, mTimestep, fmi3True);
+            if (status != fmi2OK) {
+                stopSimulation("fmi2DoStep() failed, status = "+to_hstring(status));
+                return;
+            }
+
+            //Forward outputs
+            if(!mRealOutputBuffer.empty()) {
+                status = fmi2_getReal(fmu, mRealOutputBuffer.valueRefs(), mRealOutputBuffer.size(), mRealOutputBuffer.values());
+                mRealOutputBuffer.writeVariables();
+            }
+            if(!mIntOutputBuffer.empty()) {
+                status = fmi2_getInteger(fmu, mIntOutputBuffer.valueRefs(), mIntOutputBuffer.size(), mIntOutputBuffer.values());
+                mIntOutputBuffer.writeVariables();
+            }
+            if(!mFmi2BoolOutputBuffer.empty()) {
+                status = fmi2_getBoolean(fmu, mFmi2BoolOutputBuffer.valueRefs(), mFmi2BoolOutputBuffer.size(), mFmi2BoolOutputBuffer.values());
+                mFmi2BoolOutputBuffer.writeVariables();
+            }
         }
         else { //FMI 3
             if(NULL == fmu) {
                 return;
             }
             fmi3Status status;
-            
+
             //Forward inputs
-            std::map<fmi3ValueReference,double*>::iterator itr;
-            for(itr = mFloat64Inputs.begin(); itr != mFloat64Inputs.end(); itr++) {
-                fmi3Float64 value = (fmi3Float64)(*itr->second);
-                status = fmi3_setFloat64(fmu, &itr->first, 1, &value, 1);
-            }
-            for(itr = mFloat32Inputs.begin(); itr != mFloat32Inputs.end(); itr++) {
-                fmi3Float32 value = (fmi3Float32)(*itr->second);
-                status = fmi3_setFloat32(fmu, &itr->first, 1, &value, 1);
-            }
-            std::map<fmi3ValueReference,double*>::iterator itb;
-            for(itb = mBoolInputs.begin(); itb != mBoolInputs.end(); ++itb) {
-                bool value = ((*itb->second) > 0.5);
-                status = fmi3_setBoolean(fmu, &itb->first, 1, &value, 1);
-            }
-            std::map<fmi3ValueReference,double*>::iterator iti;
-            for(iti = mInt64Inputs.begin(); iti != mInt64Inputs.end(); ++iti) {
-                fmi3Int64 value = (fmi3Int64)lround(*iti->second);
-                status = fmi3_setInt64(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mInt32Inputs.begin(); iti != mInt32Inputs.end(); ++iti) {
-                fmi3Int32 value = (fmi3Int32)lround(*iti->second);
-                status = fmi3_setInt32(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mInt16Inputs.begin(); iti != mInt16Inputs.end(); ++iti) {
-                fmi3Int16 value = (fmi3Int16)lround(*iti->second);
-                status = fmi3_setInt16(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mInt8Inputs.begin(); iti != mInt8Inputs.end(); ++iti) {
-                fmi3Int8 value = (fmi3Int8)lround(*iti->second);
-                status = fmi3_setInt8(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mUInt64Inputs.begin(); iti != mUInt64Inputs.end(); ++iti) {
-                fmi3UInt64 value = (fmi3UInt64)lround(*iti->second);
-                status = fmi3_setUInt64(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mUInt32Inputs.begin(); iti != mUInt32Inputs.end(); ++iti) {
-                fmi3UInt32 value = (fmi3UInt32)lround(*iti->second);
-                status = fmi3_setUInt32(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mUInt16Inputs.begin(); iti != mUInt16Inputs.end(); ++iti) {
-                fmi3UInt16 value = (fmi3UInt16)lround(*iti->second);
-                status = fmi3_setUInt16(fmu, &iti->first, 1, &value, 1);
-            }
-            for(iti = mUInt8Inputs.begin(); iti != mUInt8Inputs.end(); ++iti) {
-                fmi3UInt8 value = (fmi3UInt8)lround(*iti->second);
-                status = fmi3_setUInt8(fmu, &iti->first, 1, &value, 1);
-            }
-
-     
-             //Take step
-             bool eventEncountered, terminateSimulation, earlyReturn;
-             double lastT;
-             status = fmi3_doStep(fmu, mTime, mTimestep, fmi3True, &eventEncountered, &terminateSimulation, &earlyReturn, &lastT);
-             if (status != fmi3OK) {
-                 stopSimulation("fmi3DoStep() failed, status = "+to_hstring(status));
-                 return;
-             }
-     
-             //Forward outputs
-             std::map<fmi3ValueReference,double*>::iterator it;
-             for(it = mFloat64Outputs.begin(); it != mFloat64Outputs.end(); it++) {
-                 fmi3Float64 value;
-                 status = fmi3_getFloat64(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mFloat32Outputs.begin(); it != mFloat32Outputs.end(); it++) {
-                 fmi3Float32 value;
-                 status = fmi3_getFloat32(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mInt64Outputs.begin(); it != mInt64Outputs.end(); it++) {
-                 fmi3Int64 value;
-                 status = fmi3_getInt64(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mInt32Outputs.begin(); it != mInt32Outputs.end(); it++) {
-                 fmi3Int32 value;
-                 status = fmi3_getInt32(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mInt16Outputs.begin(); it != mInt16Outputs.end(); it++) {
-                 fmi3Int16 value;
-                 status = fmi3_getInt16(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mInt8Outputs.begin(); it != mInt8Outputs.end(); it++) {
-                 fmi3Int8 value;
-                 status = fmi3_getInt8(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mUInt64Outputs.begin(); it != mUInt64Outputs.end(); it++) {
-                 fmi3UInt64 value;
-                 status = fmi3_getUInt64(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mUInt32Outputs.begin(); it != mUInt32Outputs.end(); it++) {
-                 fmi3UInt32 value;
-                 status = fmi3_getUInt32(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mUInt16Outputs.begin(); it != mUInt16Outputs.end(); it++) {
-                 fmi3UInt16 value;
-                 status = fmi3_getUInt16(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mUInt8Outputs.begin(); it != mUInt8Outputs.end(); it++) {
-                 fmi3UInt8 value;
-                 status = fmi3_getUInt8(fmu, &it->first, 1, &value, 1);
-                 (*it->second) = (double)value;
-             }
-             for(it = mBoolOutputs.begin(); it != mBoolOutputs.end(); it++) {
-                 bool temp;
-                 status = fmi3_getBoolean(fmu, &it->first, 1, &temp, 1);
-                 (*it->second) = temp;
-             }
-         }
+            if(!mFloat64InputBuffer.empty()) {
+                mFloat64InputBuffer.readVariables();
+                status = fmi3_setFloat64(fmu, mFloat64InputBuffer.valueRefs(), mFloat64InputBuffer.size(), mFloat64InputBuffer.values(), mFloat64InputBuffer.size());
+            }
+            if(!mFloat32InputBuffer.empty()) {
+                mFloat32InputBuffer.readVariables();
+                status = fmi3_setFloat32(fmu, mFloat32InputBuffer.valueRefs(), mFloat32InputBuffer.size(), mFloat32InputBuffer.values(), mFloat32InputBuffer.size());
+            }
+            if(!mInt64InputBuffer.empty()) {
+                mInt64InputBuffer.readVariables();
+                status = fmi3_setInt64(fmu, mInt64InputBuffer.valueRefs(), mInt64InputBuffer.size(), mInt64InputBuffer.values(), mInt64InputBuffer.size());
+            }
+            if(!mInt32InputBuffer.empty()) {
+                mInt32InputBuffer.readVariables();
+                status = fmi3_setInt32(fmu, mInt32InputBuffer.valueRefs(), mInt32InputBuffer.size(), mInt32InputBuffer.values(), mInt32InputBuffer.size());
+            }
+            if(!mInt16InputBuffer.empty()) {
+                mInt16InputBuffer.readVariables();
+                status = fmi3_setInt16(fmu, mInt16InputBuffer.valueRefs(), mInt16InputBuffer.size(), mInt16InputBuffer.values(), mInt16InputBuffer.size());
+            }
+            if(!mInt8InputBuffer.empty()) {
+                mInt8InputBuffer.readVariables();
+                status = fmi3_setInt8(fmu, mInt8InputBuffer.valueRefs(), mInt8InputBuffer.size(), mInt8InputBuffer.values(), mInt8InputBuffer.size());
+            }
+            if(!mUInt64InputBuffer.empty()) {
+                mUInt64InputBuffer.readVariables();
+                status = fmi3_setUInt64(fmu, mUInt64InputBuffer.valueRefs(), mUInt64InputBuffer.size(), mUInt64InputBuffer.values(), mUInt64InputBuffer.size());
+            }
+            if(!mUInt32InputBuffer.empty()) {
+                mUInt32InputBuffer.readVariables();
+                status = fmi3_setUInt32(fmu, mUInt32InputBuffer.valueRefs(), mUInt32InputBuffer.size(), mUInt32InputBuffer.values(), mUInt32InputBuffer.size());
+            }
+            if(!mUInt16InputBuffer.empty()) {
+                mUInt16InputBuffer.readVariables();
+                status = fmi3_setUInt16(fmu, mUInt16InputBuffer.valueRefs(), mUInt16InputBuffer.size(), mUInt16InputBuffer.values(), mUInt16InputBuffer.size());
+            }
+            if(!mUInt8InputBuffer.empty()) {
+                mUInt8InputBuffer.readVariables();
+                status = fmi3_setUInt8(fmu, mUInt8InputBuffer.valueRefs(), mUInt8InputBuffer.size(), mUInt8InputBuffer.values(), mUInt8InputBuffer.size());
+            }
+            if(!mFmi3BoolInputBuffer.empty()) {
+                mFmi3BoolInputBuffer.readVariables();
+                status = fmi3_setBoolean(fmu, mFmi3BoolInputBuffer.valueRefs(), mFmi3BoolInputBuffer.size(), mFmi3BoolInputBuffer.values(), mFmi3BoolInputBuffer.size());
+            }
+
+            //Take step
+            bool eventEncountered, terminateSimulation, earlyReturn;
+            double lastT;
+            status = fmi3_doStep(fmu, mTime, mTimestep, fmi3True, &eventEncountered, &terminateSimulation, &earlyReturn, &lastT);
+            if (status != fmi3OK) {
+                stopSimulation("fmi3DoStep() failed, status = "+to_hstring(status));
+                return;
+            }
+
+            //Forward outputs
+            if(!mFloat64OutputBuffer.empty()) {
+                status = fmi3_getFloat64(fmu, mFloat64OutputBuffer.valueRefs(), mFloat64OutputBuffer.size(), mFloat64OutputBuffer.values(), mFloat64OutputBuffer.size());
+                mFloat64OutputBuffer.writeVariables();
+            }
+            if(!mFloat32OutputBuffer.empty()) {
+                status = fmi3_getFloat32(fmu, mFloat32OutputBuffer.valueRefs(), mFloat32OutputBuffer.size(), mFloat32OutputBuffer.values(), mFloat32OutputBuffer.size());
+                mFloat32OutputBuffer.writeVariables();
+            }
+            if(!mInt64OutputBuffer.empty()) {
+                status = fmi3_getInt64(fmu, mInt64OutputBuffer.valueRefs(), mInt64OutputBuffer.size(), mInt64OutputBuffer.values(), mInt64OutputBuffer.size());
+                mInt64OutputBuffer.writeVariables();
+            }
+            if(!mInt32OutputBuffer.empty()) {
+                status = fmi3_getInt32(fmu, mInt32OutputBuffer.valueRefs(), mInt32OutputBuffer.size(), mInt32OutputBuffer.values(), mInt32OutputBuffer.size());
+                mInt32OutputBuffer.writeVariables();
+            }
+            if(!mInt16OutputBuffer.empty()) {
+                status = fmi3_getInt16(fmu, mInt16OutputBuffer.valueRefs(), mInt16OutputBuffer.size(), mInt16OutputBuffer.values(), mInt16OutputBuffer.size());
+                mInt16OutputBuffer.writeVariables();
+            }
+            if(!mInt8OutputBuffer.empty()) {
+                status = fmi3_getInt8(fmu, mInt8OutputBuffer.valueRefs(), mInt8OutputBuffer.size(), mInt8OutputBuffer.values(), mInt8OutputBuffer.size());
+                mInt8OutputBuffer.writeVariables();
+            }
+            if(!mUInt64OutputBuffer.empty()) {
+                status = fmi3_getUInt64(fmu, mUInt64OutputBuffer.valueRefs(), mUInt64OutputBuffer.size(), mUInt64OutputBuffer.values(), mUInt64OutputBuffer.size());
+                mUInt64OutputBuffer.writeVariables();
+            }
+            if(!mUInt32OutputBuffer.empty()) {
+                status = fmi3_getUInt32(fmu, mUInt32OutputBuffer.valueRefs(), mUInt32OutputBuffer.size(), mUInt32OutputBuffer.values(), mUInt32OutputBuffer.size());
+                mUInt32OutputBuffer.writeVariables();
+            }
+            if(!mUInt16OutputBuffer.empty()) {
+                status = fmi3_getUInt16(fmu, mUInt16OutputBuffer.valueRefs(), mUInt16OutputBuffer.size(), mUInt16OutputBuffer.values(), mUInt16OutputBuffer.size());
+                mUInt16OutputBuffer.writeVariables();
+            }
+            if(!mUInt8OutputBuffer.empty()) {
+                status = fmi3_getUInt8(fmu, mUInt8OutputBuffer.valueRefs(), mUInt8OutputBuffer.size(), mUInt8OutputBuffer.values(), mUInt8OutputBuffer.size());
+                mUInt8OutputBuffer.writeVariables();
+            }
+            if(!mFmi3BoolOutputBuffer.empty()) {
+                status = fmi3_getBoolean(fmu, mFmi3BoolOutputBuffer.valueRefs(), mFmi3BoolOutputBuffer.size(), mFmi3BoolOutputBuffer.values(), mFmi3BoolOutputBuffer.size());
+                mFmi3BoolOutputBuffer.writeVariables();
+            }
+        }
     }
 
     void finalize()
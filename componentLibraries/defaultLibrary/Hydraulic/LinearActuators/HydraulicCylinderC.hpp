@@ -80,6 +80,11 @@ class HydraulicCylinderC : public ComponentC
             return new HydraulicCylinderC();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<HydraulicCylinderC>();
+        }
+
         void configure()
         {
             // Set member variables
@@ -390,6 +395,19 @@ class HydraulicCylinderC : public ComponentC
             // Filtering of the characteristics
             CxLim = alfa * CxLim + (1.0 - alfa) * NewCxLim;
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            rBuffer.write(ci1);
+            rBuffer.write(cl1);
+            rBuffer.write(ci2);
+            rBuffer.write(cl2);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return rBuffer.read(ci1) && rBuffer.read(cl1) && rBuffer.read(ci2) && rBuffer.read(cl2);
+        }
     };
 }
 
@@ -48,6 +48,11 @@ namespace hopsan {
             return new HydraulicLaminarOrifice();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<HydraulicLaminarOrifice>();
+        }
+
         void configure()
         {
             mpP1 = addPowerPort("P1", "NodeHydraulic");
@@ -56,6 +56,11 @@ namespace hopsan {
             return new HydraulicTankC();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<HydraulicTankC>();
+        }
+
         void configure()
         {
             mpP1 = addPowerPort("P1", "NodeHydraulic");
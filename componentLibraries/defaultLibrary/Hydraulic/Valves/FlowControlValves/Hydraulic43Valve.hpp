@@ -68,6 +68,11 @@ namespace hopsan {
             return new Hydraulic43Valve();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<Hydraulic43Valve>();
+        }
+
         void configure()
         {
             mpPP = addPowerPort("PP", "NodeHydraulic", "Supply port");
@@ -248,6 +253,16 @@ namespace hopsan {
             (*mpPB_q) = qb;
             (*mpXv) = xv;
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mSpoolPosTF.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mSpoolPosTF.restoreState(rBuffer);
+        }
     };
 }
 
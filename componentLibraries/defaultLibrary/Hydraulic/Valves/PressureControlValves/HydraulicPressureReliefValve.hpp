@@ -240,6 +240,17 @@ namespace hopsan {
             (*mpP2_q) = q2;
             (*mpXv) = x0;
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mFilterLP.saveState(rBuffer);
+            rBuffer.write(mPrevX0);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mFilterLP.restoreState(rBuffer) && rBuffer.read(mPrevX0);
+        }
     };
 }
 
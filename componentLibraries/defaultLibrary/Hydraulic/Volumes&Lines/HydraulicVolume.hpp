@@ -62,6 +62,11 @@ namespace hopsan {
             return new HydraulicVolume();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<HydraulicVolume>();
+        }
+
         void configure()
         {
             mpP1 = addPowerPort("P1", "NodeHydraulic");
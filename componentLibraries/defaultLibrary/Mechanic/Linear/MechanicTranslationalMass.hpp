@@ -67,6 +67,11 @@ namespace hopsan {
             return new MechanicTranslationalMass();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<MechanicTranslationalMass>();
+        }
+
         void configure()
         {
             //Add ports to the component
@@ -189,6 +194,17 @@ namespace hopsan {
             (*mpP1_me) = mMass;
             (*mpP2_me) = mMass;
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mFilterX.saveState(rBuffer);
+            mFilterV.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mFilterX.restoreState(rBuffer) && mFilterV.restoreState(rBuffer);
+        }
     };
 }
 
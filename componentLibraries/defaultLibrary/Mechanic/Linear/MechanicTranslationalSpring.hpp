@@ -50,6 +50,11 @@ namespace hopsan {
             return new MechanicTranslationalSpring();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<MechanicTranslationalSpring>();
+        }
+
         void configure()
         {
             // Add power ports to the component
@@ -57,6 +57,7 @@ namespace hopsan {
         HString mSeparatorChar;
         CSVParserNG mDataFile;
         LookupTable1D mLookupTable;
+        LookupTableCursor mLookupCursor;
 
     public:
         static Component *Creator()
@@ -160,7 +161,7 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-            (*mpOut) = mLookupTable.interpolate(*mpIn);
+            (*mpOut) = mLookupTable.interpolate(*mpIn, mLookupCursor);
         }
 
         bool isObsolete() const
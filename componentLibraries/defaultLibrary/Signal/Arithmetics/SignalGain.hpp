@@ -56,6 +56,11 @@ namespace hopsan {
             return new SignalGain();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<SignalGain>();
+        }
+
         void configure()
         {
             addInputVariable("in","","",0, &mpND_in);
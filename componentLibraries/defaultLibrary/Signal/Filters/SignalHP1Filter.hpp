@@ -88,6 +88,16 @@ namespace hopsan {
         {
             (*mpOut) = mTF.update((*mpIn));
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mTF.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mTF.restoreState(rBuffer);
+        }
     };
 }
 
@@ -91,6 +91,16 @@ namespace hopsan {
         {
             (*mpOut) = mTF2.update((*mpIn));
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mTF2.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mTF2.restoreState(rBuffer);
+        }
     };
 }
 
@@ -76,6 +76,16 @@ namespace hopsan {
             //Filter equation
            (*mpOut) = mIntegrator.update((*mpIn));
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mIntegrator.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mIntegrator.restoreState(rBuffer);
+        }
     };
 }
 
@@ -92,6 +92,16 @@ namespace hopsan {
             //Write new values to nodes
             (*mpOut) = mTF2.update((*mpIn));
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mTF2.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mTF2.restoreState(rBuffer);
+        }
     };
 }
 
@@ -51,6 +51,8 @@ namespace hopsan {
         double *mpIn, *mpOut, *mpTol, *mpWl, *mpSd, *mpL1, *mpL2, *mpL3;
         int mMethod;
         std::vector<double> mWindow;
+        std::vector<double> mNoiseWindow;
+        WhiteGaussianNoise mNoise;
         size_t mWindowId;
         double mDelayedX;
         double mDelayedXf;
@@ -87,6 +89,8 @@ namespace hopsan {
         {
             mWindowId = 0;
             mWindow.resize(*mpWl/mTimestep, 0);
+            mNoiseWindow.resize(mWindow.size());
+            mNoise.setSeed(this);
 
             mDelayedX = (*mpIn);
             mDelayedXf = (*mpIn);
@@ -137,8 +141,9 @@ namespace hopsan {
 
                 //Randomize window
                 std::vector<double> randWindow = mWindow;
+                mNoise.fillValues(mNoiseWindow.data(), mNoiseWindow.size());
                 for(size_t i=0; i<randWindow.size(); ++i) {
-                    randWindow[i] = randWindow[i] + (*mpSd)*WhiteGaussianNoise::getValue();
+                    randWindow[i] = randWindow[i] + (*mpSd)*mNoiseWindow[i];
                 }
 
                 //Compute average of window
@@ -188,7 +193,7 @@ namespace hopsan {
                 double sd = (*mpSd);
                 double dfold = mDelayedDf;
 
-                x = x+sd*WhiteGaussianNoise::getValue();
+                x = x+sd*mNoise.nextValue();
 
                 double vf = l2*(x-xf)*(x-xf);
                 double s1 = (2.0-l1)/2.0*vf;
@@ -212,6 +217,48 @@ namespace hopsan {
                 mDelayedDf = df;
             }
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mNoise.saveState(rBuffer);
+            rBuffer.write(mWindowId);
+            rBuffer.write(mDelayedX);
+            rBuffer.write(mDelayedXf);
+            rBuffer.write(mDelayedDf);
+            rBuffer.write(mWindow.size());
+            for (size_t i=0; i<mWindow.size(); ++i)
+            {
+                rBuffer.write(mWindow[i]);
+            }
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            size_t windowId, windowSize;
+            double delayedX, delayedXf, delayedDf;
+            if (!mNoise.restoreState(rBuffer) || !rBuffer.read(windowId) || !rBuffer.read(delayedX) ||
+                !rBuffer.read(delayedXf) || !rBuffer.read(delayedDf) || !rBuffer.read(windowSize))
+            {
+                return false;
+            }
+            // The window length is given by the parameters and time step, a window of another length can not be restored
+            if ((windowSize != mWindow.size()) || (windowId >= windowSize))
+            {
+                return false;
+            }
+            for (size_t i=0; i<windowSize; ++i)
+            {
+                if (!rBuffer.read(mWindow[i]))
+                {
+                    return false;
+                }
+            }
+            mWindowId = windowId;
+            mDelayedX = delayedX;
+            mDelayedXf = delayedXf;
+            mDelayedDf = delayedDf;
+            return true;
+        }
     };
 }
 
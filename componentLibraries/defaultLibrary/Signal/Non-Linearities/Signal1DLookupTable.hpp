@@ -59,7 +59,9 @@ namespace hopsan {
         HString mSeparatorChar;
         HString mCommentChar;
         CSVParserNG mCSVParser;
-        LookupTable1D mLookupTable;
+        std::shared_ptr<SharedLookupTable<LookupTable1D> > mpSharedTable;
+        std::shared_ptr<const LookupTable1D> mpLookupTable;
+        LookupTableCursor mLookupCursor;
 
     public:
         static Component *Creator()
@@ -69,6 +71,8 @@ namespace hopsan {
 
         void configure()
         {
+            mpSharedTable = std::make_shared<SharedLookupTable<LookupTable1D> >();
+
             mUseTextInput = false;
 
             addInputVariable("in", "", "", 0.0, &mpIn);
@@ -85,14 +89,30 @@ namespace hopsan {
         }
 
 
+        void copyReadOnlyDataFrom(const Component *pSource)
+        {
+            // Clones share the parsed table, it is only parsed again if the file (or text) or the settings change
+            const Signal1DLookupTable *pSourceTable = static_cast<const Signal1DLookupTable*>(pSource);
+            mpSharedTable = pSourceTable->mpSharedTable;
+            mpLookupTable = pSourceTable->mpLookupTable;
+        }
+
+
         void initialize()
         {
             mUseTextInput = !mTextInput.empty();
 
-            if ( mLookupTable.isEmpty() || mReloadCSV )
+            const HString settings = mSeparatorChar+" "+to_hstring(mInDataId)+" "+to_hstring(mOutDataId)+" "+to_hstring(mNumLinesToSkip)+" "+mCommentChar;
+            const LookupTableSource source = mUseTextInput ? LookupTableSource::fromText(mTextInput, settings) :
+                                                             LookupTableSource::fromFile(findFilePath(mFileName), settings);
+
+            // Without reload, keep any table already parsed by this component or its clones
+            mpLookupTable = mReloadCSV ? mpSharedTable->find(source) : mpSharedTable->get();
+            if ( !mpLookupTable )
             {
+                std::shared_ptr<LookupTable1D> pLookupTable = std::make_shared<LookupTable1D>();
+                LookupTable1D &rLookupTable = *pLookupTable;
                 bool isOK=false;
-                mLookupTable.clear();
 
                 if (mUseTextInput) {
                     isOK = mCSVParser.openText(mTextInput);
@@ -151,8 +171,8 @@ namespace hopsan {
                         return;
                     }
 
-                    isOK = mCSVParser.copyColumn(mInDataId, mLookupTable.getIndexDataRef());
-                    isOK = isOK && mCSVParser.copyColumn(mOutDataId, mLookupTable.getValueDataRef());
+                    isOK = mCSVParser.copyColumn(mInDataId, rLookupTable.getIndexDataRef());
+                    isOK = isOK && mCSVParser.copyColumn(mOutDataId, rLookupTable.getValueDataRef());
                     // Now the data is in the lookuptable and we can close the csv file and clear the index
                     mCSVParser.closeFile();
 
@@ -164,10 +184,10 @@ namespace hopsan {
                     }
 
                     // Make sure strictly increasing (no sorting will be done if that is already the case)
-                    mLookupTable.sortIncreasing();
+                    rLookupTable.sortIncreasing();
 
                     // Check if data is OK before we continue
-                    isOK = mLookupTable.isDataOK();
+                    isOK = rLookupTable.isDataOK();
                     if(!isOK)
                     {
                         HString msg = "The LookupTable data is not OK";
@@ -175,16 +195,20 @@ namespace hopsan {
                             msg.append(" after reading from file: "+mFileName);
                         }
                         addErrorMessage(msg);
-                        if (!mLookupTable.isDataSizeOK())
+                        if (!rLookupTable.isDataSizeOK())
                         {
                             addErrorMessage("Something is wrong with the size of the index or data vectors");
                         }
-                        if (!mLookupTable.allIndexStrictlyIncreasing())
+                        if (!rLookupTable.allIndexStrictlyIncreasing())
                         {
                             addErrorMessage("Even after sorting, the index column is still not strictly increasing");
                         }
                         stopSimulation();
+                        return;
                     }
+
+                    mpSharedTable->store(source, pLookupTable);
+                    mpLookupTable = pLookupTable;
                 }
             }
             simulateOneTimestep();
@@ -193,7 +217,7 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-            (*mpOut) = mLookupTable.interpolate(*mpIn);
+            (*mpOut) = mpLookupTable->interpolate(*mpIn, mLookupCursor);
         }
     };
 }
@@ -57,7 +57,9 @@ namespace hopsan {
         HFilePath mPloFileName;
         HTextBlock mTextInput;
         PLOParser mPLOParser;
-        LookupTable1D mLookupTable;
+        std::shared_ptr<SharedLookupTable<LookupTable1D> > mpSharedTable;
+        std::shared_ptr<const LookupTable1D> mpLookupTable;
+        LookupTableCursor mLookupCursor;
 
     public:
         static Component *Creator()
@@ -67,6 +69,8 @@ namespace hopsan {
 
         void configure()
         {
+            mpSharedTable = std::make_shared<SharedLookupTable<LookupTable1D> >();
+
             addInputVariable("in", "", "", 0.0, &mpIn);
             addOutputVariable("out", "", "", &mpOut);
 
@@ -78,14 +82,30 @@ namespace hopsan {
         }
 
 
+        void copyReadOnlyDataFrom(const Component *pSource)
+        {
+            // Clones share the parsed table, it is only parsed again if the file (or text) or the settings change
+            const Signal1DPLOLookupTable *pSourceTable = static_cast<const Signal1DPLOLookupTable*>(pSource);
+            mpSharedTable = pSourceTable->mpSharedTable;
+            mpLookupTable = pSourceTable->mpLookupTable;
+        }
+
+
         void initialize()
         {
             mUseTextInput = !mTextInput.empty();
 
-            if ( mLookupTable.isEmpty() || mReloadPLO )
+            const HString settings = mInDataName+" "+mOutDataName;
+            const LookupTableSource source = mUseTextInput ? LookupTableSource::fromText(mTextInput, settings) :
+                                                             LookupTableSource::fromFile(findFilePath(mPloFileName), settings);
+
+            // Without reload, keep any table already parsed by this component or its clones
+            mpLookupTable = mReloadPLO ? mpSharedTable->find(source) : mpSharedTable->get();
+            if ( !mpLookupTable )
             {
+                std::shared_ptr<LookupTable1D> pLookupTable = std::make_shared<LookupTable1D>();
+                LookupTable1D &rLookupTable = *pLookupTable;
                 bool isOK=false;
-                mLookupTable.clear();
 
                 if (mUseTextInput) {
                     isOK = mPLOParser.readText(mTextInput);
@@ -118,16 +138,16 @@ namespace hopsan {
                         return;
                     }
 
-                    mPLOParser.copyColumn(inId, mLookupTable.getIndexDataRef());
-                    mPLOParser.copyColumn(outId, mLookupTable.getValueDataRef());
+                    mPLOParser.copyColumn(inId, rLookupTable.getIndexDataRef());
+                    mPLOParser.copyColumn(outId, rLookupTable.getValueDataRef());
                     // Now the data is in the lookuptable and we can throw away the plo data to conserve memory
                     mPLOParser.clearData();
 
                     // Make sure strictly increasing (no sorting will be done if that is already the case)
-                    mLookupTable.sortIncreasing();
+                    rLookupTable.sortIncreasing();
 
                     // Check if data is OK before we continue
-                    isOK = mLookupTable.isDataOK();
+                    isOK = rLookupTable.isDataOK();
                     if(!isOK)
                     {
                         HString msg = "The LookupTable data is not OK";
@@ -135,16 +155,20 @@ namespace hopsan {
                             msg.append(" after reading from file: "+mPloFileName);
                         }
                         addErrorMessage(msg);
-                        if (!mLookupTable.isDataSizeOK())
+                        if (!rLookupTable.isDataSizeOK())
                         {
                             addErrorMessage("Something is wrong with the size of the index or data vectors");
                         }
-                        if (!mLookupTable.allIndexStrictlyIncreasing())
+                        if (!rLookupTable.allIndexStrictlyIncreasing())
                         {
                             addErrorMessage("Even after sorting, the index column is still not strictly increasing");
                         }
                         stopSimulation();
+                        return;
                     }
+
+                    mpSharedTable->store(source, pLookupTable);
+                    mpLookupTable = pLookupTable;
                 }
             }
             simulateOneTimestep();
@@ -153,7 +177,7 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-            (*mpOut) = mLookupTable.interpolate(*mpIn);
+            (*mpOut) = mpLookupTable->interpolate(*mpIn, mLookupCursor);
         }
     };
 }
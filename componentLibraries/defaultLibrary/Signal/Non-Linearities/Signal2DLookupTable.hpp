@@ -58,7 +58,9 @@ namespace hopsan {
         HString mCommentChar;
         HTextBlock mTextInput;
         CSVParserNG mCSVParser;
-        LookupTable2D mLookupTable;
+        std::shared_ptr<SharedLookupTable<LookupTable2D> > mpSharedTable;
+        std::shared_ptr<const LookupTable2D> mpLookupTable;
+        LookupTableCursor mLookupCursor;
 
     public:
         static Component *Creator()
@@ -68,6 +70,8 @@ namespace hopsan {
 
         void configure()
         {
+            mpSharedTable = std::make_shared<SharedLookupTable<LookupTable2D> >();
+
             addInputVariable("row", "", "", 0.0, &mpInRow);
             addInputVariable("col", "", "", 0.0, &mpInCol);
             addOutputVariable("out", "", "", &mpOut);
@@ -80,14 +84,30 @@ namespace hopsan {
         }
 
 
+        void copyReadOnlyDataFrom(const Component *pSource)
+        {
+            // Clones share the parsed table, it is only parsed again if the file (or text) or the settings change
+            const Signal2DLookupTable *pSourceTable = static_cast<const Signal2DLookupTable*>(pSource);
+            mpSharedTable = pSourceTable->mpSharedTable;
+            mpLookupTable = pSourceTable->mpLookupTable;
+        }
+
+
         void initialize()
         {
             mUseTextInput = !mTextInput.empty();
 
-            if ( mLookupTable.isEmpty() || mReloadCSV )
+            const HString settings = to_hstring(mNumLinesToSkip)+" "+mCommentChar;
+            const LookupTableSource source = mUseTextInput ? LookupTableSource::fromText(mTextInput, settings) :
+                                                             LookupTableSource::fromFile(findFilePath(mFileName), settings);
+
+            // Without reload, keep any table already parsed by this component or its clones
+            mpLookupTable = mReloadCSV ? mpSharedTable->find(source) : mpSharedTable->get();
+            if ( !mpLookupTable )
             {
+                std::shared_ptr<LookupTable2D> pLookupTable = std::make_shared<LookupTable2D>();
+                LookupTable2D &rLookupTable = *pLookupTable;
                 bool isOK=false;
-                mLookupTable.clear();
 
                 if (mUseTextInput) {
                     isOK = mCSVParser.openText(mTextInput);
@@ -150,8 +170,8 @@ namespace hopsan {
                     size_t nCols = rowscols[1];
 
                     // Copy row and column index vectors (ignoring the final row with nRows and nCols)
-                    isOK = mCSVParser.copyEveryNthFromColumn(0, nCols, mLookupTable.getIndexDataRef(0));
-                    isOK = isOK && mCSVParser.copyRangeFromColumn(1, 0, nCols, mLookupTable.getIndexDataRef(1));
+                    isOK = mCSVParser.copyEveryNthFromColumn(0, nCols, rLookupTable.getIndexDataRef(0));
+                    isOK = isOK && mCSVParser.copyRangeFromColumn(1, 0, nCols, rLookupTable.getIndexDataRef(1));
 
                     if (!isOK)
                     {
@@ -162,13 +182,13 @@ namespace hopsan {
                     }
 
                     // Remove "extra element (num rows)" from row index column, cols not needed since we did not even fetch all values
-                    if (mLookupTable.getDimSize(0) == nRows+1)
+                    if (rLookupTable.getDimSize(0) == nRows+1)
                     {
-                        mLookupTable.getIndexDataRef(0).pop_back();
+                        rLookupTable.getIndexDataRef(0).pop_back();
                     }
 
                     // Copy values
-                    isOK = mCSVParser.copyRangeFromColumn(2, 0, mCSVParser.getNumDataRows()-1, mLookupTable.getValueDataRef());
+                    isOK = mCSVParser.copyRangeFromColumn(2, 0, mCSVParser.getNumDataRows()-1, rLookupTable.getValueDataRef());
                     if (!isOK)
                     {
                         addErrorMessage("Could not parse the csv value column");
@@ -181,10 +201,10 @@ namespace hopsan {
                     mCSVParser.closeFile();
 
                     // Make sure the correct number of rows and columns are available
-                    if ( (nRows != mLookupTable.getDimSize(0)) || (nCols != mLookupTable.getDimSize(1)) )
+                    if ( (nRows != rLookupTable.getDimSize(0)) || (nCols != rLookupTable.getDimSize(1)) )
                     {
-                        addErrorMessage(HString("The actual number of extracted rows: "+to_hstring(mLookupTable.getDimSize(0))+
-                                                " and cols: "+to_hstring(mLookupTable.getDimSize(1))+
+                        addErrorMessage(HString("The actual number of extracted rows: "+to_hstring(rLookupTable.getDimSize(0))+
+                                                " and cols: "+to_hstring(rLookupTable.getDimSize(1))+
                                                 ", Does not match the specification (last line): "+to_hstring(nRows)+
                                                 " "+to_hstring(nCols)));
                         stopSimulation();
@@ -192,10 +212,10 @@ namespace hopsan {
                     }
 
                     // Make sure strictly increasing (no sorting will be done if that is already the case)
-                    mLookupTable.sortIncreasing();
+                    rLookupTable.sortIncreasing();
 
                     // Check if data is OK before we continue
-                    isOK = mLookupTable.isDataOK();
+                    isOK = rLookupTable.isDataOK();
                     if(!isOK)
                     {
                         HString msg = "The LookupTable data is not OK";
@@ -203,16 +223,20 @@ namespace hopsan {
                             msg.append(" after reading from file: "+mFileName);
                         }
                         addErrorMessage(msg);
-                        if (!mLookupTable.isDataSizeOK())
+                        if (!rLookupTable.isDataSizeOK())
                         {
                             addErrorMessage("Something is wrong with the size of the index or data vectors");
                         }
-                        if (!mLookupTable.allIndexStrictlyIncreasing())
+                        if (!rLookupTable.allIndexStrictlyIncreasing())
                         {
                             addErrorMessage("Even after sorting, one or more index columns are still not strictly increasing");
                         }
                         stopSimulation();
+                        return;
                     }
+
+                    mpSharedTable->store(source, pLookupTable);
+                    mpLookupTable = pLookupTable;
                 }
             }
             simulateOneTimestep();
@@ -221,7 +245,7 @@ namespace hopsan {
 
         void simulateOneTimestep()
         {
-            (*mpOut) = mLookupTable.interpolate(*mpInRow, *mpInCol);
+            (*mpOut) = mpLookupTable->interpolate(*mpInRow, *mpInCol, mLookupCursor);
         }
     };
 }
@@ -68,13 +68,24 @@ namespace hopsan {
 
         void initialize()
         {
+            noise.setSeed(this);
             simulateOneTimestep();
         }
 
 
         void simulateOneTimestep()
         {
-             (*mpND_out) = (*mpND_in) + (*mpND_stdDev)*noise.getValue();
+             (*mpND_out) = (*mpND_in) + (*mpND_stdDev)*noise.nextValue();
+        }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            noise.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return noise.restoreState(rBuffer);
         }
     };
 }
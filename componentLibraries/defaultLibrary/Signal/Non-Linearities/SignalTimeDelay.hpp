@@ -78,6 +78,16 @@ namespace hopsan {
         {
             (*mpND_out) =  mDelay.update(*mpND_in);
         }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            mDelay.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return mDelay.restoreState(rBuffer);
+        }
     };
 }
 
@@ -65,13 +65,24 @@ namespace hopsan {
 
         void initialize()
         {
+            noise.setSeed(this);
             simulateOneTimestep();
         }
 
 
         void simulateOneTimestep()
         {
-             (*mpOut) = (*mpStdDev)*noise.getValue();
+             (*mpOut) = (*mpStdDev)*noise.nextValue();
+        }
+
+        void saveState(SimulationStateBuffer &rBuffer) const
+        {
+            noise.saveState(rBuffer);
+        }
+
+        bool restoreState(SimulationStateBuffer &rBuffer)
+        {
+            return noise.restoreState(rBuffer);
         }
     };
 }
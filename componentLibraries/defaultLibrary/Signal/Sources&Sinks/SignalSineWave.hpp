@@ -73,6 +73,11 @@ namespace hopsan {
             return new SignalSineWave();
         }
 
+        SimulateBatchFunctionT getSimulateBatchFunction() const
+        {
+            return getSimulateBatchFunctionIfExactType<SignalSineWave>();
+        }
+
         void configure()
         {
             addInputVariable("f", "Frequencty", "Hz", 1.0, &mpFrequency);
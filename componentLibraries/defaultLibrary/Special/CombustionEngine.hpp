@@ -41,6 +41,7 @@ private:
     HString Characteristics;
     CSVParserNG mDataFile;
     LookupTable1D mLookupTable;
+    LookupTableCursor mLookupCursor;
     double *mpND_w1, *mpND_T1, *mpND_a1, *mpND_c1, *mpND_Zc1, *mpND_in;
     Port *mpin, *mpP1;
 
@@ -111,7 +112,7 @@ public:
         in = (*mpND_in);
         w1 = (*mpND_w1);
 
-        double T_max = mLookupTable.interpolate(w1);
+        double T_max = mLookupTable.interpolate(w1, mLookupCursor);
         c1=limit(-in*P_max/w1,0,T_max);
 
         (*mpND_c1) = c1;
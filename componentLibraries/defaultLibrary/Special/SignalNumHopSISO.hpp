@@ -85,7 +85,7 @@ public:
         mpNumHop->registerDataPtr("out",mpOut);
 
         HString output;
-        bool initOK = mpNumHop->interpretNumHopScript(script.c_str(), true, output);
+        bool initOK = mpNumHop->compileNumHopScript(script.c_str(), true, output);
         if (!initOK)
         {
             addErrorMessage("Error interpreting numhop script: "+output);
@@ -100,9 +100,8 @@ public:
     {
         // Note! Read and Write to nodes is handled internally in NumHopHelper (due to registered pointers)
 
-        HString dummy;
-        double dummy2;
-        bool evalOK = mpNumHop->eval(dummy2, false, dummy);
+        double dummy;
+        bool evalOK = mpNumHop->eval(dummy);
         if (!evalOK)
         {
             stopSimulation("NumHop evaluation failed");
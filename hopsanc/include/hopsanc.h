@@ -29,6 +29,9 @@ extern "C" {
     HOPSANC_DLLAPI int setTimeStep(double value);
     HOPSANC_DLLAPI int setStopTime(double value);
     HOPSANC_DLLAPI int setNumberOfLogSamples(size_t value);
+    HOPSANC_DLLAPI int setResultsStreamFile(const char *path, size_t chunkSize);
+    HOPSANC_DLLAPI int saveSimulationState(const char *path);
+    HOPSANC_DLLAPI int loadSimulationState(const char *path);
     HOPSANC_DLLAPI int simulate();
     HOPSANC_DLLAPI int getTimeVector(double *data);
     HOPSANC_DLLAPI int getDataVector(const char *variable, double *data);
@@ -1,4 +1,7 @@
 #include "hopsanc.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <string.h>
 #include <vector>
@@ -6,6 +9,8 @@
 #include "HopsanCore.h"
 #include "HopsanEssentials.h"
 #include "ComponentSystem.h"
+#include "CoreUtilities/LogDataSink.h"
+#include "CoreUtilities/SaveRestoreSimulationPoint.h"
 #include "ComponentUtilities/num2string.hpp"
 
 static hopsan::ComponentSystem *spCoreComponentSystem = nullptr;
@@ -13,6 +18,11 @@ static hopsan::HopsanEssentials gHopsanCore;
 
 static double startTime, stopTime;
 
+static std::string resultsStreamPath;
+static size_t resultsStreamChunkSize = 4096;
+
+static std::string loadedSimulationStatePath;
+
 std::vector<hopsan::HString> msgVec;
 
 //! @brief Puts specified message in message queue and prints it to cout
@@ -70,6 +80,7 @@ int loadModel(const char* path) {
     if(spCoreComponentSystem) {
         delete spCoreComponentSystem;
     }
+    loadedSimulationStatePath.clear();
     spCoreComponentSystem = gHopsanCore.loadHMFModelFile(path, startTime, stopTime);
     if(!spCoreComponentSystem) {
         printMessage("Failed to instantiate model!");
@@ -118,10 +129,12 @@ int getDataVector(const char* variable, double *data)
         pSystem->getAliasHandler().getVariableFromAlias(splitVar[0], compName, portName, varId);
         hopsan::Component *pComp = pSystem->getSubComponent(compName);
         hopsan::Port *pPort = pComp->getPort(portName);
-        std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-        for (size_t t=0; t<pSystem->getNumActuallyLoggedSamples(); ++t) {
-            data[t] = (*pLogData)[t][size_t(varId)];
+        const std::vector<double> *pLogData = pPort->getLogDataColumnPtr(size_t(varId));
+        if(!pLogData) {
+            printMessage("Error: Variable is not logged: "+splitVar[0]);
+            return -1;
         }
+        std::copy(pLogData->begin(), pLogData->begin()+pSystem->getNumActuallyLoggedSamples(), data);
         return 0;   //Found alias variable!
     }
     else if(splitVar.size() < 3) {
@@ -161,10 +174,12 @@ int getDataVector(const char* variable, double *data)
         return -1;
     }
 
-    std::vector< std::vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-    for (size_t t=0; t<spCoreComponentSystem->getNumActuallyLoggedSamples(); ++t) {
-        data[t] = (*pLogData)[t][size_t(varId)];
+    const std::vector<double> *pLogData = pPort->getLogDataColumnPtr(size_t(varId));
+    if(!pLogData) {
+        printMessage("Error: Variable is not logged: "+splitVar[2]);
+        return -1;
     }
+    std::copy(pLogData->begin(), pLogData->begin()+spCoreComponentSystem->getNumActuallyLoggedSamples(), data);
     return 0;
 }
 
@@ -235,27 +250,57 @@ int simulate()
         return -1;
     }
 
+    hopsan::BinaryLogDataSink *pResultsStreamSink = nullptr;
+    if(!resultsStreamPath.empty()) {
+        pResultsStreamSink = new hopsan::BinaryLogDataSink(resultsStreamPath.c_str());
+        pResultsStreamSink->setChunkSize(resultsStreamChunkSize);
+        spCoreComponentSystem->setLogDataSink(pResultsStreamSink);
+    }
+
+    int status = 0;
     printMessage("Initializing... ");
     if(spCoreComponentSystem->initialize(startTime, stopTime)) {
         printMessage("Success!");
         printWaitingMessages(gHopsanCore, false, false);
+
+        // Initialize resets the internal component states, so they must be restored afterwards
+        if(!loadedSimulationStatePath.empty() &&
+           !hopsan::restoreSimulationCheckpoint(loadedSimulationStatePath.c_str(), spCoreComponentSystem)) {
+            printMessage("Error: Could not restore the internal component states from: "+hopsan::HString(loadedSimulationStatePath.c_str()));
+            status = -1;
+        }
+        else {
+            printMessage("Simulating... ");
+            spCoreComponentSystem->simulate(stopTime);
+            printMessage("Finished!");
+        }
     }
     else {
         printMessage("Failed!");
-        printWaitingMessages(gHopsanCore, false, false);
-        return -1;
+        status = -1;
     }
 
-    printMessage("Simulating... ");
-    spCoreComponentSystem->simulate(stopTime);
-    printMessage("Finished!");
+    // A loaded simulation state is only used by the next simulation
+    if(!loadedSimulationStatePath.empty()) {
+        loadedSimulationStatePath.clear();
+        spCoreComponentSystem->setKeepValuesAsStartValues(false);
+    }
 
     printMessage("Finalizing... ");
     spCoreComponentSystem->finalize();
     printMessage("Finished!");
 
+    if(pResultsStreamSink) {
+        if(!pResultsStreamSink->finish()) {
+            printMessage("Error: Failed to stream results: "+pResultsStreamSink->getLastError());
+            status = -1;
+        }
+        spCoreComponentSystem->setLogDataSink(nullptr);
+        delete pResultsStreamSink;
+    }
+
     printWaitingMessages(gHopsanCore, false, false);
-    return 0;
+    return status;
 }
 
 
@@ -363,6 +408,67 @@ int setNumberOfLogSamples(size_t value)
 }
 
 
+//! @brief Stream the log data to a binary log file during simulation, instead of keeping it all in memory
+//! @details Only the last chunk of log data is then available from getTimeVector() and getDataVector()
+//! @param [in] path Path to the binary log file, or empty to keep all log data in memory
+//! @param [in] chunkSize Number of log samples per chunk
+//! @returns Status (0 = success)
+int setResultsStreamFile(const char *path, size_t chunkSize)
+{
+    if(chunkSize == 0) {
+        printMessage("Error: Chunk size must be positive.");
+        return -1;
+    }
+    resultsStreamPath = path ? path : "";
+    resultsStreamChunkSize = chunkSize;
+    return 0;
+}
+
+
+//! @brief Saves the simulation state at the end of the last simulation, including internal component states
+//! @param [in] path Path to the simulation state file
+//! @returns Status (0 = success)
+int saveSimulationState(const char *path)
+{
+    if(!spCoreComponentSystem) {
+        printMessage("Error: No model is loaded.");
+        return -1;
+    }
+    std::remove(path);
+    hopsan::saveSimulationPoint(path, spCoreComponentSystem);
+    if(!std::ifstream(path).good()) {
+        printMessage("Error: Could not write simulation state file: "+hopsan::HString(path));
+        return -1;
+    }
+    return 0;
+}
+
+
+//! @brief Loads a simulation state, saved by saveSimulationState(), that the next simulation continues from
+//! @details The start time is set to the time of the saved state, so the stop time must be set after it.
+//! The internal component states are restored when the next simulation has been initialized.
+//! @param [in] path Path to the simulation state file
+//! @returns Status (0 = success)
+int loadSimulationState(const char *path)
+{
+    if(!spCoreComponentSystem) {
+        printMessage("Error: No model is loaded.");
+        return -1;
+    }
+    if(!std::ifstream(path).good()) {
+        printMessage("Error: Could not open simulation state file: "+hopsan::HString(path));
+        return -1;
+    }
+    double savedTime = startTime;
+    hopsan::restoreSimulationPoint(path, spCoreComponentSystem, savedTime);
+    startTime = savedTime;
+    spCoreComponentSystem->setKeepValuesAsStartValues(true);
+    loadedSimulationStatePath = path;
+    printWaitingMessages(gHopsanCore, false, false);
+    return 0;
+}
+
+
 //! @brief Returns number of logged samples from last simulation
 //! @returns Number of samples
 size_t getNumberOfLogSamples()
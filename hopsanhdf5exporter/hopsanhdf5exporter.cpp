@@ -180,3 +180,160 @@ const hopsan::HString &HopsanHDF5Exporter::getLastError()
 }
 
 
+
+
+//! @brief Private data for the HopsanHDF5StreamSink class
+class HopsanHDF5StreamSinkPrivates
+{
+public:
+    H5::H5File file;
+    bool isOpen = false;
+    bool haveCreatedFile = false;
+    // One vector of datasets (time first) and the number of written samples for each stream
+    std::vector<std::vector<H5::DataSet> > streamDataSets;
+    std::vector<hsize_t> streamLengths;
+};
+
+//! @brief Help function to create all groups in a path that do not already exist
+void createMissingH5Groups(H5::H5File &rFile, const HString &rGroupPath)
+{
+    HString path;
+    auto parts = rGroupPath.split('/');
+    for (size_t i=0; i<parts.size(); ++i) {
+        if (parts[i].empty()) {
+            continue;
+        }
+        path.append("/").append(parts[i]);
+        if (H5Lexists(rFile.getId(), path.c_str(), H5P_DEFAULT) <= 0) {
+            rFile.createGroup(path.c_str());
+        }
+    }
+}
+
+HopsanHDF5StreamSink::HopsanHDF5StreamSink(const hopsan::HString &rFilePath, const hopsan::HString &rModelFileName, const hopsan::HString &rToolName) :
+    mFilePath(rFilePath),
+    mModelFileName(rModelFileName),
+    mToolName(rToolName)
+{
+    mpPrivates = new HopsanHDF5StreamSinkPrivates();
+}
+
+HopsanHDF5StreamSink::~HopsanHDF5StreamSink()
+{
+    finish();
+    delete mpPrivates;
+}
+
+bool HopsanHDF5StreamSink::openStream(const size_t streamId, const hopsan::HString &rSystemHierarchy, const std::vector<hopsan::LogSinkVariable> &rVariables)
+{
+    try {
+        H5::Exception::dontPrint();
+
+        if (!mpPrivates->isOpen) {
+            if (mpPrivates->haveCreatedFile) {
+                mpPrivates->file.openFile(mFilePath.c_str(), H5F_ACC_RDWR);
+            }
+            else {
+                mpPrivates->file = H5::H5File(mFilePath.c_str(), H5F_ACC_TRUNC);
+                mpPrivates->haveCreatedFile = true;
+
+                time_t rawtime;
+                char timestr[100];
+                time(&rawtime);
+                std::strftime(timestr, sizeof(timestr), "%a %b %d %H:%M:%S %Y", localtime(&rawtime));
+
+                H5::Group root = mpPrivates->file.openGroup("/");
+                appendH5Attribute(root, "date", timestr);
+                appendH5Attribute(root, "model", mModelFileName.c_str());
+                appendH5Attribute(root, "tool", mToolName.c_str());
+            }
+            mpPrivates->isOpen = true;
+        }
+
+        HString systemPath = "/results/";
+        if (!rSystemHierarchy.empty()) {
+            HString systemNames = rSystemHierarchy;
+            systemNames.replace('.', '/');
+            systemPath.append(systemNames).append('/');
+        }
+
+        // Datasets start empty and are extended by one chunk at a time
+        hsize_t dims[1] = {0};
+        hsize_t maxDims[1] = {H5S_UNLIMITED};
+        hsize_t chunkDims[1] = {getChunkSize()};
+        H5::DataSpace dataspace(1, dims, maxDims);
+        H5::DSetCreatPropList properties;
+        properties.setChunk(1, chunkDims);
+
+        auto createDataSet = [&](const HString &rGroupPath, const HString &rName, const HString &rUnit, const HString &rQuantity) {
+            createMissingH5Groups(mpPrivates->file, rGroupPath);
+            H5::DataSet dataset = mpPrivates->file.createDataSet((rGroupPath+rName).c_str(), H5::PredType::NATIVE_DOUBLE, dataspace, properties);
+            appendH5Attribute(dataset, "Unit", rUnit.c_str());
+            appendH5Attribute(dataset, "Quantity", rQuantity.c_str());
+            return dataset;
+        };
+
+        std::vector<H5::DataSet> datasets;
+        datasets.push_back(createDataSet(systemPath, "Time", "s", "Time"));
+        for (const auto &rVar : rVariables) {
+            HString groupPath = systemPath + rVar.componentName + "/" + rVar.portName + "/";
+            datasets.push_back(createDataSet(groupPath, rVar.variableName, rVar.unit, rVar.quantity));
+            if (!rVar.alias.empty()) {
+                H5Lcreate_hard(mpPrivates->file.getId(), (groupPath+rVar.variableName).c_str(), mpPrivates->file.getId(),
+                               (systemPath+rVar.alias).c_str(), H5P_DEFAULT, H5P_DEFAULT);
+            }
+        }
+
+        if (mpPrivates->streamDataSets.size() <= streamId) {
+            mpPrivates->streamDataSets.resize(streamId+1);
+            mpPrivates->streamLengths.resize(streamId+1, 0);
+        }
+        mpPrivates->streamDataSets[streamId] = datasets;
+        mpPrivates->streamLengths[streamId] = 0;
+    }
+    catch(H5::Exception &e) {
+        setLastError(HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName()));
+        return false;
+    }
+    return true;
+}
+
+bool HopsanHDF5StreamSink::writeChunk(const hopsan::LogDataChunk &rChunk)
+{
+    try {
+        std::vector<H5::DataSet> &rDataSets = mpPrivates->streamDataSets.at(rChunk.streamId);
+        hsize_t offset[1] = {mpPrivates->streamLengths[rChunk.streamId]};
+        hsize_t count[1] = {rChunk.nSamples};
+        hsize_t newSize[1] = {offset[0]+count[0]};
+        H5::DataSpace memspace(1, count);
+        for (size_t i=0; i<rDataSets.size(); ++i) {
+            rDataSets[i].extend(newSize);
+            H5::DataSpace filespace = rDataSets[i].getSpace();
+            filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+            rDataSets[i].write(&rChunk.data[i*rChunk.nSamples], H5::PredType::NATIVE_DOUBLE, memspace, filespace);
+        }
+        mpPrivates->streamLengths[rChunk.streamId] = newSize[0];
+    }
+    catch(H5::Exception &e) {
+        setLastError(HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName()));
+        return false;
+    }
+    return true;
+}
+
+bool HopsanHDF5StreamSink::close()
+{
+    if (mpPrivates->isOpen) {
+        try {
+            mpPrivates->streamDataSets.clear();
+            mpPrivates->streamLengths.clear();
+            mpPrivates->file.close();
+            mpPrivates->isOpen = false;
+        }
+        catch(H5::Exception &e) {
+            setLastError(HString(e.getCDetailMsg())+" in "+HString(e.getCFuncName()));
+            return false;
+        }
+    }
+    return true;
+}
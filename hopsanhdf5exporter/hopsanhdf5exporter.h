@@ -2,6 +2,7 @@
 #define HOPSANHDF5EXPORTER_H
 
 #include "HopsanEssentials.h"
+#include "CoreUtilities/LogDataSink.h"
 
 class HopsanHDF5Exporter
 {
@@ -19,4 +20,25 @@ private:
     hopsan::HVector<hopsan::HVector<double> > mDataVectors;
 };
 
+class HopsanHDF5StreamSinkPrivates;
+
+//! @brief Log data sink that streams results to an HDF5 file during simulation
+//! @details The file layout is the same as for HopsanHDF5Exporter, but the datasets are chunked and extended for each written chunk.
+//! Variable aliases are added as hard links to the variable datasets.
+class HopsanHDF5StreamSink : public hopsan::LogDataSink
+{
+public:
+    HopsanHDF5StreamSink(const hopsan::HString &rFilePath, const hopsan::HString &rModelFileName, const hopsan::HString &rToolName);
+    ~HopsanHDF5StreamSink();
+
+protected:
+    bool openStream(const size_t streamId, const hopsan::HString &rSystemHierarchy, const std::vector<hopsan::LogSinkVariable> &rVariables);
+    bool writeChunk(const hopsan::LogDataChunk &rChunk);
+    bool close();
+
+private:
+    hopsan::HString mFilePath, mModelFileName, mToolName;
+    HopsanHDF5StreamSinkPrivates *mpPrivates;
+};
+
 #endif // HOPSANHDF5EXPORTER_H
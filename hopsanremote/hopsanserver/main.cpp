@@ -31,10 +31,18 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <deque>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <functional>
 
 #include "hopsanremotecommon/Messages.h"
 #include "hopsanremotecommon/MessageUtilities.h"
+#include "hopsanremotecommon/DataCompression.h"
 
 #include <tclap/CmdLine.h>
 #include "zmq.hpp"
@@ -92,6 +100,8 @@ public:
     string mExternalIP;
     string mAddressServerIPandPort;
     double mAddressReportAge = 60*10;
+    double mJobWorkerIdleTime = 120;  //!< Job workers that have been idle this long (in seconds) are stopped to release their slot
+    double mFinishedJobAge = 60*60;   //!< Results for finished jobs that have not been requested within this time (in seconds) are removed
 };
 
 ServerConfig gServerConfig;
@@ -275,6 +285,599 @@ static void s_catch_signals(void)
 #endif
 
 map<int, WorkerInfo> workerMap;
+map<int, WorkerInfo> retiringWorkerMap; //!< Workers that have been told to quit, but have not yet said goodbye
+
+bool isWorkerPortTaken(size_t port)
+{
+    for (auto &rWorker : workerMap)
+    {
+        if (rWorker.second.mWorkerPort == port)
+        {
+            return true;
+        }
+    }
+    for (auto &rWorker : retiringWorkerMap)
+    {
+        if (rWorker.second.mWorkerPort == port)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! @brief Launch a worker process and reserve slots for it
+//! @param[in] numThreads The number of slots (threads) for the worker
+//! @param[in] rUserid The user of the worker
+//! @param[out] rWorkerPort The control port of the worker
+//! @param[out] rUid The unique id of the worker
+//! @returns True if the worker process was launched
+bool launchWorkerProcess(int numThreads, const string &rUserid, size_t &rWorkerPort, int &rUid)
+{
+    // Use the first port after the control port that is not used by any other worker
+    size_t workerPort = gServerConfig.mControlPort+1;
+    while (isWorkerPortTaken(workerPort))
+    {
+        ++workerPort;
+    }
+
+    // Generate unique worker Id
+    int uid = rand();
+    while (workerMap.count(uid) != 0 || retiringWorkerMap.count(uid) != 0)
+    {
+        uid = rand();
+    }
+
+#ifdef _WIN32
+    PROCESS_INFORMATION processInformation;
+    STARTUPINFO startupInfo;
+    memset(&processInformation, 0, sizeof(processInformation));
+    memset(&startupInfo, 0, sizeof(startupInfo));
+    startupInfo.cb = sizeof(startupInfo);
+
+    string scport = to_string(gServerConfig.mControlPort);
+    string swport = to_string(workerPort);
+    string nthreads = to_string(numThreads);
+    string uidstr = to_string(uid);
+
+    std::string appName("hopsanserverworker.exe");
+    std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads);
+    TCHAR* pTCharCmdLineBuff = new TCHAR[cmdLine.size()+1];
+    strcpy_s(pTCharCmdLineBuff, cmdLine.size()+1, cmdLine.c_str());
+
+    BOOL result = CreateProcess(appName.c_str(), pTCharCmdLineBuff, NULL, NULL, FALSE, NORMAL_PRIORITY_CLASS, NULL, NULL, &startupInfo, &processInformation);
+    delete[] pTCharCmdLineBuff;
+    if (result == 0)
+    {
+        std::cout << PRINTSERVER << nowDateTime() << " Error: Failed to launch worker process!"<<endl;
+        return false;
+    }
+    std::cout << PRINTSERVER << nowDateTime() << " Launched Worker Process, pid: "<< processInformation.dwProcessId << " port: " << workerPort << " uid: " << uid << " nThreads: " << numThreads  << endl;
+    workerMap.insert({uid, WorkerInfo(numThreads, workerPort, rUserid, processInformation)});
+#else
+    char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64];
+    // Write name
+    sprintf(name_buff, "%s", "hopsanserverworker");
+    // Write port as char in buffer
+    sprintf(sport_buff, "%d", gServerConfig.mControlPort);
+    sprintf(wport_buff, "%d", int(workerPort));
+    // Write num threads as char in buffer
+    sprintf(thread_buff, "%d", numThreads);
+    // Write id as char in buffer
+    sprintf(uid_buff, "%d", uid);
+
+    char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, nullptr};
+
+    pid_t pid;
+    int status = posix_spawn(&pid,"./hopsanserverworker",nullptr,nullptr,argv,environ);
+    if(status != 0)
+    {
+        std::cout << PRINTSERVER << nowDateTime() << " Error: Failed to launch worker process!"<<endl;
+        return false;
+    }
+    std::cout << PRINTSERVER << nowDateTime() << " Launched Worker Process, pid: "<< pid << " port: " << workerPort << " uid: " << uid << " nThreads: " << numThreads << endl;
+    workerMap.insert({uid, WorkerInfo(numThreads, workerPort, rUserid, pid)});
+#endif
+
+    gNumTakenSlots += numThreads;
+    std::cout << PRINTSERVER << nowDateTime() << " Remaining slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
+    rWorkerPort = workerPort;
+    rUid = uid;
+    return true;
+}
+
+
+// ---------- Job queue ----------
+// Clients can submit many small jobs (simulate a model with a set of parameter values) that are queued here.
+// The jobs are run on job workers, worker processes with one slot each that are kept running with their model
+// loaded between jobs, so that only the parameters need to be changed for the next job with the same model.
+
+//! @brief A model used by queued jobs, shared by all jobs with the same hmf
+class JobModel
+{
+public:
+    string mHmf;
+};
+
+//! @brief The jobs from one submission, sharing model, parameter names and result names
+class JobBatch
+{
+public:
+    shared_ptr<const JobModel> mpModel;
+    vector<string> mParameterNames;
+    vector<string> mResultNames;
+};
+
+class JobInfo
+{
+public:
+    shared_ptr<const JobBatch> mpBatch;
+    vector<string> mParameterValues;
+    JobStateEnumT mState = JobQueued;
+    int mNumLostWorkers = 0;    //!< How many job workers that have been lost while running this job
+    steady_clock::time_point mFinishedTime;
+    ReplymsgJobResult mResult;
+};
+
+//! @brief A worker process that is kept running to simulate queued jobs
+class JobWorkerInfo
+{
+public:
+    int mUid;
+    size_t mWorkerPort;
+    bool mIsBusy = false;
+    bool mIsLost = false;
+    steady_clock::time_point mLastUsed;
+    // The members below are only used by the job thread, while the worker is busy
+    shared_ptr<const JobModel> mpLoadedModel;
+    map<string, string> mDefaultParameters; //!< Original values of the parameters changed by jobs, restored before the next job
+};
+
+// The job queue is handled by the main thread, job threads only change the job state and results and the busy worker
+// The mutex must be locked when accessing jobs and job workers
+std::mutex gJobMutex;
+map<int, JobInfo> gJobs;
+deque<int> gJobQueue;
+map<int, shared_ptr<JobWorkerInfo>> gJobWorkers;
+map<size_t, weak_ptr<const JobModel>> gJobModels;
+int gNextJobId = 1;
+int gNumRunningJobs = 0;
+std::atomic_bool gStopJobs(false);
+const long gJobWorkerTimeout = 120000;
+const int gMaxNumLostWorkersPerJob = 2;     //!< A job is failed if it loses more job workers than this, in case the job itself kills them
+const double gMaxJobWorkerIdleTime = 4*60;  //!< Idle job workers must be stopped before they quit on their own after 5 minutes without messages
+
+//! @brief Returns the shared model for a hmf, so that workers can see that they already have the model loaded
+shared_ptr<const JobModel> getJobModel(const string &rHmf)
+{
+    const size_t key = std::hash<string>()(rHmf);
+    auto it = gJobModels.find(key);
+    if (it != gJobModels.end())
+    {
+        shared_ptr<const JobModel> pModel = it->second.lock();
+        if (pModel && pModel->mHmf == rHmf)
+        {
+            return pModel;
+        }
+    }
+    shared_ptr<JobModel> pModel = make_shared<JobModel>();
+    pModel->mHmf = rHmf;
+    gJobModels[key] = pModel;
+    return pModel;
+}
+
+//! @brief A request/reply connection to a job worker, used by the job threads
+class JobWorkerConnection
+{
+public:
+    JobWorkerConnection(size_t port) : mSocket(gContext, ZMQ_REQ)
+    {
+        int linger_ms = 1000;
+        mSocket.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int));
+        mSocket.connect(makeZMQAddress("127.0.0.1", port).c_str());
+    }
+
+    template<typename T>
+    bool request(MessageIdsEnumT id, const T &rMessage, MessageIdsEnumT replyId, zmq::message_t &rResponse, size_t &rOffset)
+    {
+        sendMessage(mSocket, id, rMessage);
+        return receiveReply(replyId, rResponse, rOffset);
+    }
+
+    bool request(MessageIdsEnumT id, MessageIdsEnumT replyId, zmq::message_t &rResponse, size_t &rOffset)
+    {
+        sendShortMessage(mSocket, id);
+        return receiveReply(replyId, rResponse, rOffset);
+    }
+
+    string mError;
+    bool mIsLost = false;
+
+private:
+    bool receiveReply(MessageIdsEnumT replyId, zmq::message_t &rResponse, size_t &rOffset)
+    {
+        rOffset = 0;
+        if (!receiveWithTimeout(mSocket, gJobWorkerTimeout, rResponse))
+        {
+            // The REQ socket can not be used after a missing reply, so the worker is given up
+            mError = "Job worker is not responding";
+            mIsLost = true;
+            return false;
+        }
+        bool parseOK;
+        size_t id = getMessageId(rResponse, rOffset, parseOK);
+        if (parseOK && id == size_t(replyId))
+        {
+            return true;
+        }
+        else if (id == NotAck)
+        {
+            mError = unpackMessage<std::string>(rResponse, rOffset, parseOK);
+        }
+        else
+        {
+            mError = "Got wrong reply from job worker";
+        }
+        return false;
+    }
+
+    zmq::socket_t mSocket;
+};
+
+//! @brief Run one job on a job worker, the model is only loaded if the worker does not already have it
+bool simulateJob(JobWorkerConnection &rConnection, JobWorkerInfo &rWorker, const JobBatch &rBatch, const vector<string> &rValues, ReplymsgJobResult &rResult)
+{
+    zmq::message_t response;
+    size_t offset;
+    bool parseOK;
+
+    if (rWorker.mpLoadedModel != rBatch.mpModel)
+    {
+        rWorker.mpLoadedModel.reset();
+        rWorker.mDefaultParameters.clear();
+        if (!rConnection.request(SetModel, rBatch.mpModel->mHmf, Ack, response, offset))
+        {
+            return false;
+        }
+        rWorker.mpLoadedModel = rBatch.mpModel;
+    }
+
+    // Restore the parameters changed by previous jobs that are not set by this job
+    for (auto it=rWorker.mDefaultParameters.begin(); it!=rWorker.mDefaultParameters.end();)
+    {
+        if (std::find(rBatch.mParameterNames.begin(), rBatch.mParameterNames.end(), it->first) != rBatch.mParameterNames.end())
+        {
+            ++it;
+            continue;
+        }
+        CmdmsgSetParameter msg {it->first, it->second};
+        if (!rConnection.request(SetParameter, msg, Ack, response, offset))
+        {
+            // The model is in an unknown state, make sure it is reloaded for the next job
+            rWorker.mpLoadedModel.reset();
+            return false;
+        }
+        it = rWorker.mDefaultParameters.erase(it);
+    }
+
+    // Set the parameters for this job, the original values are remembered the first time a parameter is changed
+    for (size_t i=0; i<rBatch.mParameterNames.size(); ++i)
+    {
+        const string &rName = rBatch.mParameterNames[i];
+        if (rWorker.mDefaultParameters.count(rName) == 0)
+        {
+            if (!rConnection.request(RequestParameter, rName, ReplyParameter, response, offset))
+            {
+                return false;
+            }
+            rWorker.mDefaultParameters[rName] = unpackMessage<std::string>(response, offset, parseOK);
+        }
+        CmdmsgSetParameter msg {rName, rValues[i]};
+        if (!rConnection.request(SetParameter, msg, Ack, response, offset))
+        {
+            return false;
+        }
+    }
+
+    // Simulate, with the simulation time from the model
+    if (!rConnection.request(Simulate, CmdmsgSimulate(), Ack, response, offset))
+    {
+        return false;
+    }
+    chrono::milliseconds pollInterval(10);
+    while (true)
+    {
+        if (gStopJobs)
+        {
+            rConnection.mError = "Server is closing";
+            return false;
+        }
+        if (!rConnection.request(RequestWorkerStatus, ReplyWorkerStatus, response, offset))
+        {
+            return false;
+        }
+        ReplymsgReplyWorkerStatus status = unpackMessage<ReplymsgReplyWorkerStatus>(response, offset, parseOK);
+        if (parseOK && status.simulation_finished && !status.simulation_inprogress)
+        {
+            if (!status.simualtion_success)
+            {
+                rConnection.mError = "Simulation failed";
+                return false;
+            }
+            break;
+        }
+        std::this_thread::sleep_for(pollInterval);
+        pollInterval = std::min(pollInterval*2, chrono::milliseconds(500));
+    }
+
+    // Collect raw results chunk by chunk until the last one, they are compressed as one series when all have arrived
+    vector<ReplymsgResultsChunkVariable> variables;
+    int numSamples = 0;
+    bool isLastChunk = false;
+    while (!isLastChunk)
+    {
+        ReqmsgRequestResultsChunk resultsRequest {rBatch.mResultNames, numSamples, 0, false};
+        if (!rConnection.request(RequestResultsChunk, resultsRequest, ReplyResultsChunk, response, offset))
+        {
+            return false;
+        }
+        ReplymsgReplyResultsChunk results = unpackMessage<ReplymsgReplyResultsChunk>(response, offset, parseOK);
+        if (!parseOK)
+        {
+            rConnection.mError = "Could not parse results from job worker";
+            return false;
+        }
+        // The simulation has finished, so every chunk must continue where the previous one ended
+        if (results.numsamples <= 0 || results.startsample != numSamples || results.iscompressed ||
+            (!variables.empty() && results.variables.size() != variables.size()))
+        {
+            rConnection.mError = "Got an empty or unexpected results chunk from job worker";
+            return false;
+        }
+        if (variables.empty())
+        {
+            variables.swap(results.variables);
+        }
+        else
+        {
+            for (size_t v=0; v<variables.size(); ++v)
+            {
+                if (results.variables[v].name != variables[v].name)
+                {
+                    rConnection.mError = "Got an empty or unexpected results chunk from job worker";
+                    return false;
+                }
+                variables[v].data.append(results.variables[v].data);
+            }
+        }
+        numSamples += results.numsamples;
+        isLastChunk = results.islastchunk;
+    }
+
+    vector<double> values(numSamples);
+    for (ReplymsgResultsChunkVariable &rVar : variables)
+    {
+        if (rVar.data.size() != values.size()*sizeof(double))
+        {
+            rConnection.mError = "Got results with the wrong size from job worker";
+            return false;
+        }
+        std::copy(rVar.data.begin(), rVar.data.end(), reinterpret_cast<char*>(values.data()));
+        rVar.data = compressDoubles(values.data(), values.size());
+    }
+    rResult.numsamples = numSamples;
+    rResult.iscompressed = true;
+    rResult.variables.swap(variables);
+    return true;
+}
+
+void jobThread(shared_ptr<JobWorkerInfo> pWorker, int jobId, shared_ptr<const JobBatch> pBatch, vector<string> values)
+{
+    ReplymsgJobResult result;
+    result.jobid = jobId;
+    result.state = JobFailed;
+    result.numsamples = 0;
+    result.iscompressed = false;
+    bool isLost = false;
+    try
+    {
+        JobWorkerConnection connection(pWorker->mWorkerPort);
+        if (simulateJob(connection, *pWorker, *pBatch, values, result))
+        {
+            result.state = JobFinished;
+        }
+        else
+        {
+            result.error = connection.mError;
+            isLost = connection.mIsLost;
+        }
+    }
+    catch(zmq::error_t e)
+    {
+        result.error = e.what();
+        isLost = true;
+    }
+
+    std::lock_guard<std::mutex> lock(gJobMutex);
+    auto it = gJobs.find(jobId);
+    if (it != gJobs.end() && isLost && !gStopJobs && it->second.mNumLostWorkers < gMaxNumLostWorkersPerJob)
+    {
+        // The job did not fail by itself, so it is put back first in the queue to be run on another job worker
+        ++it->second.mNumLostWorkers;
+        it->second.mState = JobQueued;
+        gJobQueue.push_front(jobId);
+        cout << PRINTSERVER << nowDateTime() << " Job " << jobId << " lost its job worker: " << result.error << ", queued again" << endl;
+    }
+    else
+    {
+        cout << PRINTSERVER << nowDateTime() << " Job " << jobId << ((result.state == JobFinished) ? " finished" : " failed: "+result.error) << endl;
+        if (it != gJobs.end())
+        {
+            it->second.mState = JobStateEnumT(result.state);
+            it->second.mFinishedTime = steady_clock::now();
+            it->second.mResult = std::move(result);
+        }
+    }
+    pWorker->mIsBusy = false;
+    pWorker->mIsLost = isLost;
+    pWorker->mLastUsed = steady_clock::now();
+    --gNumRunningJobs;
+}
+
+//! @brief Stop using a job worker and release its slot, the worker is told to quit by closeRetiredJobWorkers()
+//! @param[in] uid The job worker uid
+//! @param[out] rRetiredWorkerPorts The port of the retired worker is added here
+//! @note gJobMutex must be locked
+void retireJobWorker(int uid, vector<size_t> &rRetiredWorkerPorts)
+{
+    gJobWorkers.erase(uid);
+    auto it = workerMap.find(uid);
+    if (it != workerMap.end())
+    {
+        rRetiredWorkerPorts.push_back(it->second.mWorkerPort);
+        gNumTakenSlots -= it->second.mNumSlots;
+        retiringWorkerMap.insert(*it);
+        workerMap.erase(it);
+        cout << PRINTSERVER << nowDateTime() << " Stopped job worker: " << uid << " Open slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
+    }
+}
+
+//! @brief Tell retired job workers to quit, the worker processes are reaped when they say goodbye
+//! @note gJobMutex must not be locked, job threads should not have to wait for the replies
+void closeRetiredJobWorkers(const vector<size_t> &rRetiredWorkerPorts)
+{
+    for (const size_t workerPort : rRetiredWorkerPorts)
+    {
+        try
+        {
+            zmq::socket_t workerSocket (gContext, ZMQ_REQ);
+            int linger_ms = 1000;
+            workerSocket.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(int));
+            workerSocket.connect(makeZMQAddress("127.0.0.1", workerPort).c_str());
+            sendShortMessage(workerSocket, ClientClosing);
+            zmq::message_t response;
+            receiveWithTimeout(workerSocket, 1000, response); // Wait for but ignore reply
+        }
+        catch(zmq::error_t e)
+        {
+            cout << PRINTSERVER << nowDateTime() << " Error: Contacting job worker: " << e.what() << endl;
+        }
+    }
+}
+
+//! @brief Stop idle job workers until the requested number of slots are free
+//! @param[in] numSlots The number of slots that should be free
+//! @param[out] rRetiredWorkerPorts The ports of the retired workers, to be closed with closeRetiredJobWorkers()
+//! @note gJobMutex must be locked
+void releaseJobWorkerSlots(int numSlots, vector<size_t> &rRetiredWorkerPorts)
+{
+    for (auto it=gJobWorkers.begin(); it!=gJobWorkers.end() && gServerConfig.mMaxNumSlots-gNumTakenSlots < numSlots;)
+    {
+        const int uid = it->first;
+        const bool isIdle = !it->second->mIsBusy;
+        ++it;
+        if (isIdle)
+        {
+            retireJobWorker(uid, rRetiredWorkerPorts);
+        }
+    }
+}
+
+//! @brief Start queued jobs on idle job workers, and launch new job workers if there are free slots
+void scheduleJobs()
+{
+    std::unique_lock<std::mutex> lock(gJobMutex);
+    vector<size_t> retiredWorkerPorts;
+
+    // Stop lost and long idle job workers
+    for (auto it=gJobWorkers.begin(); it!=gJobWorkers.end();)
+    {
+        const int uid = it->first;
+        const JobWorkerInfo &rWorker = *it->second;
+        const double idleTime = duration_cast<duration<double>>(steady_clock::now() - rWorker.mLastUsed).count();
+        const bool shouldRetire = !rWorker.mIsBusy && (rWorker.mIsLost || (gJobQueue.empty() && idleTime > gServerConfig.mJobWorkerIdleTime));
+        ++it;
+        if (shouldRetire)
+        {
+            retireJobWorker(uid, retiredWorkerPorts);
+        }
+    }
+
+    // Remove finished jobs that no one has asked for
+    for (auto it=gJobs.begin(); it!=gJobs.end();)
+    {
+        if ((it->second.mState == JobFinished || it->second.mState == JobFailed) &&
+            duration_cast<duration<double>>(steady_clock::now() - it->second.mFinishedTime).count() > gServerConfig.mFinishedJobAge)
+        {
+            it = gJobs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    while (!gJobQueue.empty())
+    {
+        const int jobId = gJobQueue.front();
+        auto jit = gJobs.find(jobId);
+        if (jit == gJobs.end())
+        {
+            gJobQueue.pop_front();
+            continue;
+        }
+        JobInfo &rJob = jit->second;
+
+        // Prefer an idle worker that already has the model loaded, then a new worker, and last an idle worker with another model
+        shared_ptr<JobWorkerInfo> pWorker;
+        shared_ptr<JobWorkerInfo> pOtherModelWorker;
+        for (auto &rJobWorker : gJobWorkers)
+        {
+            if (!rJobWorker.second->mIsBusy)
+            {
+                if (rJobWorker.second->mpLoadedModel == rJob.mpBatch->mpModel)
+                {
+                    pWorker = rJobWorker.second;
+                    break;
+                }
+                else if (!pOtherModelWorker || rJobWorker.second->mLastUsed < pOtherModelWorker->mLastUsed)
+                {
+                    pOtherModelWorker = rJobWorker.second;
+                }
+            }
+        }
+        if (!pWorker && gNumTakenSlots < gServerConfig.mMaxNumSlots)
+        {
+            size_t workerPort;
+            int uid;
+            if (launchWorkerProcess(1, "jobqueue", workerPort, uid))
+            {
+                pWorker = make_shared<JobWorkerInfo>();
+                pWorker->mUid = uid;
+                pWorker->mWorkerPort = workerPort;
+                gJobWorkers.insert({uid, pWorker});
+            }
+        }
+        if (!pWorker)
+        {
+            pWorker = pOtherModelWorker;
+        }
+        if (!pWorker)
+        {
+            // All slots are busy
+            break;
+        }
+
+        gJobQueue.pop_front();
+        rJob.mState = JobRunning;
+        pWorker->mIsBusy = true;
+        ++gNumRunningJobs;
+        std::thread(jobThread, pWorker, jobId, rJob.mpBatch, rJob.mParameterValues).detach();
+    }
+
+    lock.unlock();
+    closeRetiredJobWorkers(retiredWorkerPorts);
+}
 
 int main(int argc, char* argv[])
 {
@@ -288,6 +891,7 @@ int main(int argc, char* argv[])
 
     TCLAP::ValueArg<std::string> argDescription("", "description", "Label for this server", false, "", "", cmd);
     TCLAP::ValueArg<std::string> argAddressServerIP("", "addresserver", "IP:port to address server", false, "", "", cmd);
+    TCLAP::ValueArg<double> argJobWorkerIdleTime("", "jobworkeridletime", "Stop job workers that have been idle for this time (at most 4 minutes)", false, 2, "minutes", cmd);
 
     // Parse the argv array.
     cmd.parse( argc, argv );
@@ -299,6 +903,12 @@ int main(int argc, char* argv[])
     gServerConfig.mExternalIP = argExternalIP.getValue();
     gServerConfig.mAddressServerIPandPort = argAddressServerIP.getValue();
     gServerConfig.mAddressReportAge = argAddressReportAge.getValue()*60;
+    gServerConfig.mJobWorkerIdleTime = argJobWorkerIdleTime.getValue()*60;
+    if (gServerConfig.mJobWorkerIdleTime > gMaxJobWorkerIdleTime)
+    {
+        cout << PRINTSERVER << nowDateTime() << " Warning: Job worker idle time is limited to " << gMaxJobWorkerIdleTime/60 << " minutes" << endl;
+        gServerConfig.mJobWorkerIdleTime = gMaxJobWorkerIdleTime;
+    }
 
     steady_clock::time_point lastStatusRequestTime;
 
@@ -325,9 +935,11 @@ int main(int argc, char* argv[])
 #endif
         while (true)
         {
-            // Wait for next request from client
+            // Wait for next request from client, but not for long if there are queued jobs waiting for a free worker
+            // (the queue is only changed by this thread)
+            const long receiveTimeout = gJobQueue.empty() ? 30000 : 100;
             zmq::message_t request;
-            if(receiveWithTimeout(socket, 30000, request))
+            if(receiveWithTimeout(socket, receiveTimeout, request))
             {
                 size_t offset=0;
                 bool idParseOK;
@@ -346,83 +958,30 @@ int main(int argc, char* argv[])
                     }
 
                     cout << PRINTSERVER << nowDateTime() << " Client (" << requestuserid << ") is requesting: " << requestNumThreads << " slots... " << endl;
-                    if (gNumTakenSlots+requestNumThreads <= gServerConfig.mMaxNumSlots)
+                    // Idle job workers give way to clients requesting slots
+                    if (gNumTakenSlots+requestNumThreads > gServerConfig.mMaxNumSlots)
                     {
-                        size_t workerPort = gServerConfig.mControlPort+gNumTakenSlots+1;
-
-                        // Generate unique worker Id
-                        int uid = rand();
-                        while (workerMap.count(uid) != 0)
+                        vector<size_t> retiredWorkerPorts;
                         {
-                            uid = rand();
+                            std::lock_guard<std::mutex> lock(gJobMutex);
+                            releaseJobWorkerSlots(requestNumThreads, retiredWorkerPorts);
                         }
+                        closeRetiredJobWorkers(retiredWorkerPorts);
+                    }
 
-#ifdef _WIN32
-                        PROCESS_INFORMATION processInformation;
-                        STARTUPINFO startupInfo;
-                        memset(&processInformation, 0, sizeof(processInformation));
-                        memset(&startupInfo, 0, sizeof(startupInfo));
-                        startupInfo.cb = sizeof(startupInfo);
-
-                        string scport = to_string(gServerConfig.mControlPort);
-                        string swport = to_string(workerPort);
-                        string nthreads = to_string(requestNumThreads);
-                        string uidstr = to_string(uid);
-
-                        std::string appName("hopsanserverworker.exe");
-                        std::string cmdLine("hopsanserverworker "+uidstr+" "+scport+" "+swport+" "+nthreads);
-                        TCHAR* pTCharCmdLineBuff = new TCHAR[cmdLine.size()+1];
-                        strcpy_s(pTCharCmdLineBuff, cmdLine.size()+1, cmdLine.c_str());
-
-                        BOOL result = CreateProcess(appName.c_str(), pTCharCmdLineBuff, NULL, NULL, FALSE, NORMAL_PRIORITY_CLASS, NULL, NULL, &startupInfo, &processInformation);
-                        if (result == 0)
-                        {
-                            std::cout << PRINTSERVER << "Error: Failed to launch worker process!"<<endl;
-                            sendMessage(socket, NotAck, "Failed to launch worker process!");
-                        }
-                        else
-                        {
-                            std::cout << PRINTSERVER << "Launched Worker Process, pid: "<< processInformation.dwProcessId << " port: " << workerPort << " uid: " << uid << " nThreads: " << requestNumThreads  << endl;
-                            workerMap.insert({uid, WorkerInfo(requestNumThreads, workerPort, requestuserid, processInformation)});
-
-                            ReplymsgReplyServerSlots msg = {workerPort};
-                            sendMessage<ReplymsgReplyServerSlots>(socket, ReplyServerSlots, msg);
-                            gNumTakenSlots++;
-                        }
-                        delete pTCharCmdLineBuff;
-
-#else
-                        char name_buff[64], sport_buff[64], wport_buff[64], thread_buff[64], uid_buff[64];
-                        // Write name
-                        sprintf(name_buff, "%s", "hopsanserverworker");
-                        // Write port as char in buffer
-                        sprintf(sport_buff, "%d", gServerConfig.mControlPort);
-                        sprintf(wport_buff, "%d", int(workerPort));
-                        // Write num threads as char in buffer
-                        sprintf(thread_buff, "%d", requestNumThreads);
-                        // Write id as char in buffer
-                        sprintf(uid_buff, "%d", uid);
-
-                        char *argv[] = {name_buff, uid_buff, sport_buff, wport_buff, thread_buff, nullptr};
-
-                        pid_t pid;
-                        int status = posix_spawn(&pid,"./hopsanserverworker",nullptr,nullptr,argv,environ);
-                        if(status == 0)
+                    if (gNumTakenSlots+requestNumThreads <= gServerConfig.mMaxNumSlots)
+                    {
+                        size_t workerPort;
+                        int uid;
+                        if (launchWorkerProcess(requestNumThreads, requestuserid, workerPort, uid))
                         {
-                            std::cout << PRINTSERVER << nowDateTime() << " Launched Worker Process, pid: "<< pid << " port: " << workerPort << " uid: " << uid << " nThreads: " << requestNumThreads << endl;
-                            workerMap.insert({uid, WorkerInfo(requestNumThreads, workerPort, requestuserid, pid)});
-
                             ReplymsgReplyServerSlots msg = {int(workerPort)};
                             sendMessage(socket, ReplyServerSlots, msg);
-                            gNumTakenSlots+=requestNumThreads;
-                            std::cout << PRINTSERVER << nowDateTime() << " Remaining slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
                         }
                         else
                         {
-                            std::cout << PRINTSERVER << nowDateTime() << " Error: Failed to launch worker process!"<<endl;
                             sendMessage(socket, NotAck, "Failed to launch worker process!");
                         }
-#endif
                     }
                     else if (gNumTakenSlots == gServerConfig.mMaxNumSlots)
                     {
@@ -466,6 +1025,17 @@ int main(int argc, char* argv[])
                             workerMap.erase(it);
                             gNumTakenSlots -= nslots;
                             std::cout << PRINTSERVER << nowDateTime() << " Open slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
+
+                            // If it was a job worker that quit by itself, stop using it
+                            std::lock_guard<std::mutex> lock(gJobMutex);
+                            gJobWorkers.erase(id);
+                        }
+                        else if (retiringWorkerMap.count(id) != 0)
+                        {
+                            // A stopped job worker, its slot has already been released
+                            sendShortMessage(socket, Ack);
+                            waitForWorkerProcess(retiringWorkerMap.at(id));
+                            retiringWorkerMap.erase(id);
                         }
                         else
                         {
@@ -501,6 +1071,81 @@ int main(int argc, char* argv[])
                         cout << PRINTSERVER << nowDateTime() << " Error: Could not parse server id string" << endl;
                     }
                 }
+                else if (msg_id == SubmitJobs)
+                {
+                    bool parseOK;
+                    CmdmsgSubmitJobs msg = unpackMessage<CmdmsgSubmitJobs>(request, offset, parseOK);
+                    if (!parseOK)
+                    {
+                        sendMessage(socket, NotAck, "Could not parse job submission");
+                    }
+                    else if (msg.model.empty())
+                    {
+                        sendMessage(socket, NotAck, "Server can not run jobs with an empty model");
+                    }
+                    else if (std::any_of(msg.parametervalues.begin(), msg.parametervalues.end(),
+                                         [&msg](const vector<string> &rRow){return rRow.size() != msg.parameternames.size();}))
+                    {
+                        sendMessage(socket, NotAck, "The number of parameter values does not match the number of parameter names");
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock(gJobMutex);
+                        shared_ptr<JobBatch> pBatch = make_shared<JobBatch>();
+                        pBatch->mpModel = getJobModel(msg.model);
+                        pBatch->mParameterNames.swap(msg.parameternames);
+                        pBatch->mResultNames.swap(msg.resultnames);
+
+                        ReplymsgReplySubmitJobs reply;
+                        reply.jobids.reserve(msg.parametervalues.size());
+                        for (vector<string> &rValues : msg.parametervalues)
+                        {
+                            const int jobId = gNextJobId++;
+                            JobInfo &rJob = gJobs[jobId];
+                            rJob.mpBatch = pBatch;
+                            rJob.mParameterValues.swap(rValues);
+                            gJobQueue.push_back(jobId);
+                            reply.jobids.push_back(jobId);
+                        }
+                        cout << PRINTSERVER << nowDateTime() << " Client (" << (msg.userid.empty() ? "anonymous" : msg.userid) << ") submitted " << reply.jobids.size()
+                             << " jobs, Queued jobs: " << gJobQueue.size() << endl;
+                        sendMessage(socket, ReplySubmitJobs, reply);
+                    }
+                }
+                else if (msg_id == RequestJobResults)
+                {
+                    bool parseOK;
+                    ReqmsgRequestJobResults msg = unpackMessage<ReqmsgRequestJobResults>(request, offset, parseOK);
+                    if (parseOK)
+                    {
+                        std::lock_guard<std::mutex> lock(gJobMutex);
+                        ReplymsgReplyJobResults reply;
+                        reply.jobs.reserve(msg.jobids.size());
+                        for (int jobId : msg.jobids)
+                        {
+                            auto it = gJobs.find(jobId);
+                            if (it == gJobs.end())
+                            {
+                                reply.jobs.push_back(ReplymsgJobResult {jobId, JobUnknown, "Unknown job", 0, false, {}});
+                            }
+                            else if (it->second.mState == JobFinished || it->second.mState == JobFailed)
+                            {
+                                // Results are only delivered once
+                                reply.jobs.push_back(std::move(it->second.mResult));
+                                gJobs.erase(it);
+                            }
+                            else
+                            {
+                                reply.jobs.push_back(ReplymsgJobResult {jobId, it->second.mState, "", 0, false, {}});
+                            }
+                        }
+                        sendMessage(socket, ReplyJobResults, reply);
+                    }
+                    else
+                    {
+                        sendMessage(socket, NotAck, "Could not parse job results request");
+                    }
+                }
                 else if (msg_id == RequestServerStatus)
                 {
                     cout << PRINTSERVER << nowDateTime() << " Client is requesting status" << endl;
@@ -560,7 +1205,7 @@ int main(int argc, char* argv[])
 
             // Go through all running workers and check if we should try to request status from them, to see if they are still alive
             //! @todo since we are not using the status data here, maybe we should use ping/pong messages instead
-            for (auto it = workerMap.begin(); it!=workerMap.end(); ++it)
+            for (auto it = workerMap.begin(); it!=workerMap.end();)
             {
                 WorkerInfo &wi = it->second;
                 if (duration_cast<duration<double>>(steady_clock::now() - wi.mLastAliveReport).count() > 10*60)
@@ -572,13 +1217,22 @@ int main(int argc, char* argv[])
                         std::cout << PRINTSERVER << nowDateTime() << "Burying dead worker: " << it->first << endl;
                         waitForWorkerProcess(wi);
                         int nslots = wi.mNumSlots;
-                        workerMap.erase(it);
+                        {
+                            std::lock_guard<std::mutex> lock(gJobMutex);
+                            gJobWorkers.erase(it->first);
+                        }
+                        it = workerMap.erase(it);
                         gNumTakenSlots -= nslots ;
                         std::cout << PRINTSERVER << nowDateTime() << "Open slots: " << gServerConfig.mMaxNumSlots-gNumTakenSlots << endl;
+                        continue;
                     }
                 }
+                ++it;
             }
 
+            // Start queued jobs on free job workers
+            scheduleJobs();
+
             if (s_interrupted)
             {
                 cout << PRINTSERVER << nowDateTime() << " Interrupt signal received, killing server" << std::endl;
@@ -586,6 +1240,29 @@ int main(int argc, char* argv[])
             }
         }
 
+        // Stop the running jobs and the job workers
+        gStopJobs = true;
+        for (int i=0; i<100; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock(gJobMutex);
+                if (gNumRunningJobs == 0)
+                {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        vector<size_t> retiredWorkerPorts;
+        {
+            std::lock_guard<std::mutex> lock(gJobMutex);
+            while (!gJobWorkers.empty())
+            {
+                retireJobWorker(gJobWorkers.begin()->first, retiredWorkerPorts);
+            }
+        }
+        closeRetiredJobWorkers(retiredWorkerPorts);
+
         // Tell master server we are closing
         if (argAddressServerIP.isSet())
         {
@@ -34,6 +34,8 @@
 #include <thread>
 #include <atomic>
 #include <array>
+#include <algorithm>
+#include <unordered_set>
 
 #include "zmq.hpp"
 
@@ -41,6 +43,7 @@
 #include "hopsanremotecommon/MessageUtilities.h"
 #include "hopsanremotecommon/FileAccess.h"
 #include "hopsanremotecommon/FileReceiver.hpp"
+#include "hopsanremotecommon/DataCompression.h"
 
 #include "HopsanEssentials.h"
 #include "CoreUtilities/HopsanCoreMessageHandler.h"
@@ -68,10 +71,8 @@ bool gHaveLoadedComponentLibraries=false;
 typedef struct
 {
     string fullName;
-    vector< vector<double> > *pData = 0;
-    vector< double > *pTimeData = 0;
+    const vector<double> *pData = 0; //!< Log data column or time vector
     size_t dataLength = 0;
-    size_t dataId = 0;
     string unit;
     string quantity;
     string alias;
@@ -101,8 +102,8 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
     ModelVariableInfo_t tmvi;
     tmvi.fullName = (systemHierarchy+"Time").c_str();
     tmvi.quantity = "Time";
-    tmvi.pTimeData = pTime;
-    tmvi.dataLength = pSys->getNumActuallyLoggedSamples();
+    tmvi.pData = pTime;
+    tmvi.dataLength = pTime ? std::min(pSys->getNumActuallyLoggedSamples(), pTime->size()) : 0;
     rvMVI.push_back(tmvi);
 
     vector<Component *> subComps = pSys->getSubComponents();
@@ -127,28 +128,24 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
                     continue;
                 }
 
-                //! @todo what about time vector
-                vector< vector<double> > *pLogData = pPort->getLogDataVectorPtr();
-
                 const vector<NodeDataDescription> *pVars = pPort->getNodeDataDescriptions();
                 if (pVars)
                 {
                     for (size_t v=0; v<pVars->size(); ++v)
                     {
                         // Only write something if data has been logged (skip ports that are not logged)
-                        // We assume that the data vector has been cleared
-                        //! @todo check if log on
-                        if (pLogData->size() > 0)
+                        // The log data columns are allocated during initialize, so they can also be read while simulating
+                        const NodeDataDescription *pVarDesc = &(*pVars)[v];
+                        const vector<double> *pLogData = pPort->getLogDataColumnPtr(pVarDesc->id);
+                        if (pLogData && !pLogData->empty())
                         {
-                            const NodeDataDescription *pVarDesc = &(*pVars)[v];
                             ModelVariableInfo_t mvi;
                             mvi.fullName = (systemHierarchy+pComp->getName()+"#"+pPort->getName()+"#"+pVarDesc->name).c_str();
                             mvi.alias = pPort->getVariableAlias(pVarDesc->id).c_str();
                             mvi.quantity = pVarDesc->quantity.c_str();
                             mvi.unit = pVarDesc->unit.c_str();
                             mvi.pData = pLogData;
-                            mvi.dataId = pVarDesc->id;
-                            mvi.dataLength = pSys->getNumActuallyLoggedSamples();
+                            mvi.dataLength = std::min(pSys->getNumActuallyLoggedSamples(), pLogData->size());
                             rvMVI.push_back(mvi);
                         }
                     }
@@ -158,6 +155,66 @@ void collectAllModelVariables(ComponentSystem *pSys, vector<ModelVariableInfo_t>
     }
 }
 
+//! @brief Copy a time chunk of logged results into a reply message
+//! @param[in] rRequest The request, with variable selection and sample range
+//! @param[in] rvMVI The model variables
+//! @param[in] nLoggedSamples The number of samples logged so far
+//! @param[in] simulationFinished Whether the simulation has finished (no more samples will be logged)
+//! @param[out] rReply The reply to fill
+void makeResultsChunk(const ReqmsgRequestResultsChunk &rRequest, const vector<ModelVariableInfo_t> &rvMVI, const size_t nLoggedSamples,
+                      const bool simulationFinished, ReplymsgReplyResultsChunk &rReply)
+{
+    // The logged sample count starts over when the system is re-initialized, then there may not be any samples from the start sample yet
+    const size_t startSample = size_t(std::max(rRequest.startsample, 0));
+    size_t numSamples = (nLoggedSamples > startSample) ? nLoggedSamples-startSample : 0;
+    if (rRequest.maxsamples > 0)
+    {
+        numSamples = std::min(numSamples, size_t(rRequest.maxsamples));
+    }
+
+    rReply.startsample = int(startSample);
+    rReply.numsamples = int(numSamples);
+    rReply.iscompressed = rRequest.compress;
+    rReply.islastchunk = simulationFinished && (startSample+numSamples >= nLoggedSamples);
+
+    unordered_set<string> selectedNames(rRequest.names.begin(), rRequest.names.end());
+    for (const ModelVariableInfo_t &rMvi : rvMVI)
+    {
+        if (!rMvi.pData || (!selectedNames.empty() && selectedNames.count(rMvi.fullName) == 0))
+        {
+            continue;
+        }
+
+        rReply.variables.push_back(ReplymsgResultsChunkVariable());
+        ReplymsgResultsChunkVariable &rVar = rReply.variables.back();
+        rVar.name = rMvi.fullName;
+        if (startSample == 0)
+        {
+            rVar.alias = rMvi.alias;
+            rVar.quantity = rMvi.quantity;
+            rVar.unit = rMvi.unit;
+        }
+        const size_t numAvailable = (rMvi.pData->size() > startSample) ? rMvi.pData->size()-startSample : 0;
+        const double *pSamples = (numAvailable > 0) ? rMvi.pData->data()+startSample : nullptr;
+        // Samples that have not been logged in this (sub)system are sent as zeros
+        vector<double> padded;
+        if (numAvailable < numSamples)
+        {
+            padded.resize(numSamples, 0.0);
+            std::copy(pSamples, pSamples+numAvailable, padded.begin());
+            pSamples = padded.data();
+        }
+        if (rRequest.compress)
+        {
+            rVar.data = compressDoubles(pSamples, numSamples);
+        }
+        else
+        {
+            rVar.data.assign(reinterpret_cast<const char*>(pSamples), numSamples*sizeof(double));
+        }
+    }
+}
+
 void splitStringOnDelimiter(const std::string &rString, const char delim, std::vector<std::string> &rSplitVector)
 {
     rSplitVector.clear();
@@ -906,28 +963,54 @@ int main(int argc, char* argv[])
                             vars.back().alias = rMvi.alias;
                             vars.back().quantity = rMvi.quantity;
                             vars.back().unit = rMvi.unit.c_str();
-                            vars.back().data.reserve(rMvi.dataLength);
-                            // Copy if a data variable
                             if (rMvi.pData)
                             {
-                                for (size_t t=0; t<rMvi.dataLength; ++t)
-                                {
-                                    vars.back().data.push_back((*rMvi.pData)[t][rMvi.dataId]);
-                                }
-                            }
-                            // Copy if a time data variable
-                            else if (rMvi.pTimeData)
-                            {
-                                for (size_t t=0; t<vMVI[mvi].dataLength; ++t)
-                                {
-                                    vars.back().data.push_back((*rMvi.pTimeData)[t]);
-                                }
+                                vars.back().data.assign(rMvi.pData->begin(), rMvi.pData->begin()+rMvi.dataLength);
                             }
                         }
 
                         sendMessage(socket,ReplyResults,vars);
                     }
                 }
+                else if (msg_id == RequestResultsChunk)
+                {
+                    bool parseOK;
+                    ReqmsgRequestResultsChunk msg = unpackMessage<ReqmsgRequestResultsChunk>(request, offset, parseOK);
+                    if (!parseOK)
+                    {
+                        sendMessage(socket, NotAck, "Could not parse results chunk request");
+                    }
+                    else if (!gpRootSystem)
+                    {
+                        sendMessage(socket, NotAck, "No model loaded");
+                    }
+                    else
+                    {
+                        ReplymsgReplyResultsChunk reply;
+                        // The log data is reallocated when the system is (re)initialized, also by the simulation thread before
+                        // a multi-threaded simulation, then reply with an empty chunk so that the client asks again later
+                        if (gpRootSystem->tryLockLogData())
+                        {
+                            // Check if finished before counting samples, the count is then final
+                            const bool simulationFinished = !gIsSimulating;
+                            const size_t nLoggedSamples = gpRootSystem->getNumActuallyLoggedSamples();
+                            vector<ModelVariableInfo_t> vMVI;
+                            collectAllModelVariables(gpRootSystem, vMVI, "");
+                            makeResultsChunk(msg, vMVI, nLoggedSamples, simulationFinished, reply);
+                            gpRootSystem->unlockLogData();
+                        }
+                        else
+                        {
+                            reply.startsample = std::max(msg.startsample, 0);
+                            reply.numsamples = 0;
+                            reply.iscompressed = msg.compress;
+                            reply.islastchunk = false;
+                        }
+                        cout << PRINTWORKER << nowDateTime() << " Client requests results chunk from sample: " << reply.startsample << " Sending: " << reply.numsamples
+                             << " samples of " << reply.variables.size() << " variables" << endl;
+                        sendMessage(socket, ReplyResultsChunk, reply);
+                    }
+                }
                 else if (msg_id == RequestMessages)
                 {
                     HopsanCoreMessageHandler *pHandler = gHopsanCore.getCoreMessageHandler();
@@ -61,6 +61,9 @@ public:
     bool connectToServer(std::string address);
     bool serverConnected() const;
     bool requestSlot(int numThreads, int &rControlPort, const std::string userid="");
+    bool submitJobs(const std::string &rModel, const std::vector<std::string> &rParameterNames, const std::vector<std::vector<std::string> > &rParameterValues,
+                    const std::vector<std::string> &rResultNames, std::vector<int> &rJobIds, const std::string userid="");
+    bool requestJobResults(const std::vector<int> &rJobIds, std::vector<JobResultT> &rJobResults);
 
     bool connectToWorker(int ctrlPort);
     bool workerConnected() const;
@@ -93,6 +96,9 @@ public:
     bool requestWorkerStatus(WorkerStatusT &rWorkerStatus);
     bool requestServerStatus(ServerStatusT &rServerStatus);
     bool requestSimulationResults(std::vector<ResultVariableT> &rResultVariables);
+    bool requestSimulationResultsChunk(std::vector<ResultVariableT> &rResultVariables, size_t &rNextSample, bool &rIsLastChunk,
+                                       const std::vector<std::string> &rNames=std::vector<std::string>(), const int maxSamples=0, const bool compress=true);
+    bool requestSimulationResultsStreamed(std::vector<ResultVariableT> &rResultVariables, const std::vector<std::string> &rNames=std::vector<std::string>(), const int chunkSize=100000);
     bool requestMessages();
     bool requestMessages(std::vector<char> &rTypes, std::vector<std::string> &rTags, std::vector<std::string> &rMessages);
     bool requestShellOutput(std::string &rOutput);
@@ -28,6 +28,7 @@
 #include "hopsanremotecommon/Messages.h"
 #include "hopsanremotecommon/MessageUtilities.h"
 #include "hopsanremotecommon/FileReceiver.hpp"
+#include "hopsanremotecommon/DataCompression.h"
 
 #include "zmq.hpp"
 #include "msgpack.hpp"
@@ -551,6 +552,130 @@ bool RemoteHopsanClient::requestSimulationResults(std::vector<ResultVariableT> &
     return false;
 }
 
+//! @brief Request the next chunk of simulation results, can be used while the simulation is running
+//! @details The samples are appended to the result variables, new variables are added on the first chunk
+//! @param[in,out] rResultVariables The result variables to append to
+//! @param[in,out] rNextSample The first sample to request, it is advanced by the number of received samples
+//! @param[out] rIsLastChunk Set to true if the simulation has finished and all samples have been received
+//! @param[in] rNames Full names of the variables to request, all variables if empty
+//! @param[in] maxSamples The maximum number of samples in the chunk, no limit if <= 0
+//! @param[in] compress Request compressed data
+//! @returns True if the chunk was received
+bool RemoteHopsanClient::requestSimulationResultsChunk(std::vector<ResultVariableT> &rResultVariables, size_t &rNextSample, bool &rIsLastChunk,
+                                                       const std::vector<std::string> &rNames, const int maxSamples, const bool compress)
+{
+    std::lock_guard<std::mutex> lock(mWorkerMutex);
+
+    rIsLastChunk = false;
+    ReqmsgRequestResultsChunk msg {rNames, int(rNextSample), maxSamples, compress};
+    sendClientMessage<ReqmsgRequestResultsChunk>(mpWorkerSocket, RequestResultsChunk, msg);
+
+    zmq::message_t response;
+    if (receiveWithTimeout(*mpWorkerSocket, response, mLongReceiveTimeout))
+    {
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplyResultsChunk)
+        {
+            ReplymsgReplyResultsChunk reply = unpackMessage<ReplymsgReplyResultsChunk>(response, offset, parseOK);
+            if (!parseOK || reply.startsample != int(rNextSample))
+            {
+                setLastError("Could not parse results chunk");
+                return false;
+            }
+
+            if (rNextSample == 0)
+            {
+                rResultVariables.clear();
+                rResultVariables.reserve(reply.variables.size());
+            }
+            for (size_t v=0; v<reply.variables.size(); ++v)
+            {
+                ReplymsgResultsChunkVariable &rVar = reply.variables[v];
+                // Variables are sent in the same order in every chunk, so only search if they do not match
+                size_t r = v;
+                if (r >= rResultVariables.size() || rResultVariables[r].name != rVar.name)
+                {
+                    r = 0;
+                    while (r < rResultVariables.size() && rResultVariables[r].name != rVar.name)
+                    {
+                        ++r;
+                    }
+                    if (r == rResultVariables.size())
+                    {
+                        rResultVariables.push_back(ResultVariableT());
+                        rResultVariables.back().name = rVar.name;
+                        rResultVariables.back().alias = rVar.alias;
+                        rResultVariables.back().quantity = rVar.quantity;
+                        rResultVariables.back().unit = rVar.unit;
+                    }
+                }
+
+                std::vector<double> &rData = rResultVariables[r].data;
+                const size_t oldSize = rData.size();
+                rData.resize(oldSize+reply.numsamples);
+                bool dataOK;
+                if (reply.iscompressed)
+                {
+                    dataOK = decompressDoubles(rVar.data, reply.numsamples, rData.data()+oldSize);
+                }
+                else
+                {
+                    dataOK = (rVar.data.size() == reply.numsamples*sizeof(double));
+                    if (dataOK)
+                    {
+                        std::copy(rVar.data.begin(), rVar.data.end(), reinterpret_cast<char*>(rData.data()+oldSize));
+                    }
+                }
+                if (!dataOK)
+                {
+                    rData.resize(oldSize);
+                    setLastError("Could not decode results chunk data");
+                    return false;
+                }
+            }
+            rNextSample += reply.numsamples;
+            rIsLastChunk = reply.islastchunk;
+            return true;
+        }
+        else if (id == NotAck)
+        {
+            setLastError(unpackMessage<std::string>(response, offset, parseOK));
+        }
+        else
+        {
+            setLastError("Got wrong reply");
+        }
+    }
+    return false;
+}
+
+//! @brief Request all simulation results in compressed chunks, waits for the simulation to finish if it is running
+//! @param[out] rResultVariables The result variables
+//! @param[in] rNames Full names of the variables to request, all variables if empty
+//! @param[in] chunkSize The maximum number of samples per chunk
+//! @returns True if all results were received
+bool RemoteHopsanClient::requestSimulationResultsStreamed(std::vector<ResultVariableT> &rResultVariables, const std::vector<std::string> &rNames, const int chunkSize)
+{
+    size_t nextSample = 0;
+    bool isLastChunk = false;
+    while (!isLastChunk)
+    {
+        const size_t prevNextSample = nextSample;
+        if (!requestSimulationResultsChunk(rResultVariables, nextSample, isLastChunk, rNames, chunkSize, true))
+        {
+            return false;
+        }
+        // Wait a while for new samples if the simulation is still running
+        if (!isLastChunk && nextSample == prevNextSample)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    return true;
+}
+
 bool RemoteHopsanClient::requestSlot(int numThreads, int &rControlPort, const std::string userid)
 {
     ReqmsgReqServerSlots msg {numThreads, userid};
@@ -588,6 +713,131 @@ bool RemoteHopsanClient::requestSlot(int numThreads, int &rControlPort, const st
     return false;
 }
 
+//! @brief Submit simulation jobs to the job queue of the server, no worker slot is needed
+//! @details The jobs are run on workers that keep the model loaded between jobs, use requestJobResults() to get the results
+//! @param[in] rModel The model (hmf) to simulate
+//! @param[in] rParameterNames Full names of the parameters to set for each job
+//! @param[in] rParameterValues One row of parameter values per job
+//! @param[in] rResultNames Full names of the variables to return, all variables if empty
+//! @param[out] rJobIds The id of each submitted job
+//! @param[in] userid The user submitting the jobs
+//! @returns True if the jobs were queued
+bool RemoteHopsanClient::submitJobs(const std::string &rModel, const std::vector<std::string> &rParameterNames, const std::vector<std::vector<std::string> > &rParameterValues,
+                                    const std::vector<std::string> &rResultNames, std::vector<int> &rJobIds, const std::string userid)
+{
+    CmdmsgSubmitJobs msg {userid, rModel, rParameterNames, rParameterValues, rResultNames};
+    sendClientMessage<CmdmsgSubmitJobs>(mpServerSocket, SubmitJobs, msg);
+
+    zmq::message_t response;
+    if (receiveWithTimeout(*mpServerSocket, response, mLongReceiveTimeout))
+    {
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplySubmitJobs)
+        {
+            ReplymsgReplySubmitJobs reply = unpackMessage<ReplymsgReplySubmitJobs>(response, offset, parseOK);
+            if (parseOK)
+            {
+                rJobIds.swap(reply.jobids);
+                return true;
+            }
+            else
+            {
+                setLastError("Could not parse job submission reply");
+            }
+        }
+        else if (id == NotAck)
+        {
+            setLastError(unpackMessage<string>(response, offset, parseOK));
+        }
+        else
+        {
+            setLastError("Got wrong reply type from server");
+        }
+    }
+    return false;
+}
+
+//! @brief Request the state and results of submitted jobs, the results of a finished job are only sent once
+//! @param[in] rJobIds The jobs to ask for
+//! @param[out] rJobResults The state of each job, with results for the jobs that have finished
+//! @returns True if the request was answered
+bool RemoteHopsanClient::requestJobResults(const std::vector<int> &rJobIds, std::vector<JobResultT> &rJobResults)
+{
+    ReqmsgRequestJobResults msg {rJobIds};
+    sendClientMessage<ReqmsgRequestJobResults>(mpServerSocket, RequestJobResults, msg);
+
+    zmq::message_t response;
+    if (receiveWithTimeout(*mpServerSocket, response, mLongReceiveTimeout))
+    {
+        size_t offset=0;
+        bool parseOK;
+        size_t id = getMessageId(response, offset, parseOK);
+        if (id == ReplyJobResults)
+        {
+            ReplymsgReplyJobResults reply = unpackMessage<ReplymsgReplyJobResults>(response, offset, parseOK);
+            if (!parseOK)
+            {
+                setLastError("Could not parse job results reply");
+                return false;
+            }
+
+            rJobResults.clear();
+            rJobResults.reserve(reply.jobs.size());
+            for (ReplymsgJobResult &rJob : reply.jobs)
+            {
+                rJobResults.push_back(JobResultT());
+                JobResultT &rResult = rJobResults.back();
+                rResult.jobid = rJob.jobid;
+                rResult.state = JobStateEnumT(rJob.state);
+                rResult.error = rJob.error;
+                rResult.variables.resize(rJob.variables.size());
+                for (size_t v=0; v<rJob.variables.size(); ++v)
+                {
+                    ReplymsgResultsChunkVariable &rVar = rJob.variables[v];
+                    ResultVariableT &rResultVar = rResult.variables[v];
+                    rResultVar.name = rVar.name;
+                    rResultVar.alias = rVar.alias;
+                    rResultVar.quantity = rVar.quantity;
+                    rResultVar.unit = rVar.unit;
+                    rResultVar.data.resize(rJob.numsamples);
+                    bool dataOK;
+                    if (rJob.iscompressed)
+                    {
+                        dataOK = decompressDoubles(rVar.data, rJob.numsamples, rResultVar.data.data());
+                    }
+                    else
+                    {
+                        dataOK = (rVar.data.size() == rJob.numsamples*sizeof(double));
+                        if (dataOK)
+                        {
+                            std::copy(rVar.data.begin(), rVar.data.end(), reinterpret_cast<char*>(rResultVar.data.data()));
+                        }
+                    }
+                    if (!dataOK)
+                    {
+                        rResult.state = JobFailed;
+                        rResult.error = "Could not decode job results";
+                        rResult.variables.clear();
+                        break;
+                    }
+                }
+            }
+            return true;
+        }
+        else if (id == NotAck)
+        {
+            setLastError(unpackMessage<string>(response, offset, parseOK));
+        }
+        else
+        {
+            setLastError("Got wrong reply type from server");
+        }
+    }
+    return false;
+}
+
 bool RemoteHopsanClient::connectToWorker(int workerPort)
 {
     if (workerConnected())
@@ -0,0 +1,40 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#ifndef DATACOMPRESSION_H
+#define DATACOMPRESSION_H
+
+#include <cstddef>
+#include <string>
+
+// Lossless compression of double arrays, for result data transfer
+// Each value is XOR:ed with the previous value, the bytes are shuffled so that byte n of all values are stored together,
+// and runs of zero bytes (common in the high bytes of slowly changing signals) are run-length encoded
+
+std::string compressDoubles(const double *pData, const size_t n);
+bool decompressDoubles(const std::string &rCompressed, const size_t n, double *pData);
+
+#endif // DATACOMPRESSION_H
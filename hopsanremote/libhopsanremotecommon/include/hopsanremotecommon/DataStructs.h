@@ -37,4 +37,14 @@ typedef struct
     std::vector<double> data;
 }ResultVariableT;
 
+enum JobStateEnumT {JobQueued, JobRunning, JobFinished, JobFailed, JobUnknown};
+
+typedef struct
+{
+    int jobid;
+    JobStateEnumT state;
+    std::string error;
+    std::vector<ResultVariableT> variables;
+}JobResultT;
+
 #endif // DATASTRUCTS_H
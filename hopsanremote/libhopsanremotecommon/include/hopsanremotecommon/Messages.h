@@ -28,6 +28,7 @@
 #define MESSAGES_H
 
 #include <string>
+#include <vector>
 #include "StatusInfoStructs.h"
 #include "DataStructs.h"
 #include "msgpack.hpp"
@@ -79,6 +80,12 @@ enum MessageIdsEnumT {
 
     /* Work in progress (last to avoid breaking compatibility */
     WorkerAlive,
+    RequestResultsChunk,
+    ReplyResultsChunk,
+    SubmitJobs,
+    ReplySubmitJobs,
+    RequestJobResults,
+    ReplyJobResults,
 
 };
 
@@ -169,6 +176,37 @@ public:
     MSGPACK_DEFINE(filename, offset)
 };
 
+class ReqmsgRequestResultsChunk
+{
+public:
+    std::vector<std::string> names; //!< Full names of the variables to send, all variables if empty
+    int startsample;
+    int maxsamples;
+    bool compress;
+
+    MSGPACK_DEFINE(names, startsample, maxsamples, compress)
+};
+
+class CmdmsgSubmitJobs
+{
+public:
+    std::string userid;
+    std::string model;                                     //!< The model (hmf) shared by all jobs
+    std::vector<std::string> parameternames;               //!< Full names of the parameters set by the jobs
+    std::vector<std::vector<std::string> > parametervalues; //!< One row of parameter values per job
+    std::vector<std::string> resultnames;                  //!< Full names of the variables to return, all variables if empty
+
+    MSGPACK_DEFINE(userid, model, parameternames, parametervalues, resultnames)
+};
+
+class ReqmsgRequestJobResults
+{
+public:
+    std::vector<int> jobids;
+
+    MSGPACK_DEFINE(jobids)
+};
+
 class CmdmsgIdentifyUser
 {
 public:
@@ -207,6 +245,14 @@ public:
     MSGPACK_DEFINE(services, users, numFreeSlots, numTotalSlots, startTime, stopTime, isReady)
 };
 
+class ReplymsgReplySubmitJobs
+{
+public:
+    std::vector<int> jobids;
+
+    MSGPACK_DEFINE(jobids)
+};
+
 class ReplymsgReplyBenchmarkResults
 {
 public:
@@ -236,6 +282,51 @@ public:
     MSGPACK_DEFINE(name,alias,quantity,unit,data)
 };
 
+class ReplymsgResultsChunkVariable
+{
+public:
+    std::string name;
+    std::string alias;    //!< Only sent with the first chunk
+    std::string quantity; //!< Only sent with the first chunk
+    std::string unit;     //!< Only sent with the first chunk
+    std::string data;     //!< Raw or compressed (see DataCompression.h) double values
+
+    MSGPACK_DEFINE(name,alias,quantity,unit,data)
+};
+
+class ReplymsgReplyResultsChunk
+{
+public:
+    int startsample;
+    int numsamples;
+    bool iscompressed;
+    bool islastchunk; //!< True if the simulation has finished and there are no more samples after this chunk
+    std::vector<ReplymsgResultsChunkVariable> variables;
+
+    MSGPACK_DEFINE(startsample,numsamples,iscompressed,islastchunk,variables)
+};
+
+class ReplymsgJobResult
+{
+public:
+    int jobid;
+    int state;          //!< A JobStateEnumT value, results are only sent for finished jobs
+    std::string error;
+    int numsamples;
+    bool iscompressed;
+    std::vector<ReplymsgResultsChunkVariable> variables;
+
+    MSGPACK_DEFINE(jobid,state,error,numsamples,iscompressed,variables)
+};
+
+class ReplymsgReplyJobResults
+{
+public:
+    std::vector<ReplymsgJobResult> jobs;
+
+    MSGPACK_DEFINE(jobs)
+};
+
 class ReplymsgReplyMessage
 {
 public:
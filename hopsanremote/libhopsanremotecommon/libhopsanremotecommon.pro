@@ -15,10 +15,12 @@ DESTDIR = $${PWD}/../../lib
 INCLUDEPATH += $${PWD}/include
 
 SOURCES += \
+    src/DataCompression.cpp \
     src/FileAccess.cpp
 
 
 HEADERS += \
+    include/hopsanremotecommon/DataCompression.h \
     include/hopsanremotecommon/DataStructs.h \
     include/hopsanremotecommon/FileAccess.h \
     include/hopsanremotecommon/FileReceiver.hpp \
@@ -0,0 +1,145 @@
+/*-----------------------------------------------------------------------------
+
+ Copyright 2017 Hopsan Group
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+
+
+ The full license is available in the file LICENSE.
+ For details about the 'Hopsan Group' or information about Authors and
+ Contributors see the HOPSANGROUP and AUTHORS files that are located in
+ the Hopsan source code root directory.
+
+-----------------------------------------------------------------------------*/
+
+//$Id$
+
+#include "hopsanremotecommon/DataCompression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Run-length control bytes: 0-127 are followed by 1-128 literal bytes, 128-255 represent 1-128 zero bytes
+#define MAXRUNLENGTH 128
+
+//! @brief Compress an array of doubles
+//! @param[in] pData The values to compress
+//! @param[in] n The number of values
+//! @returns The compressed data
+std::string compressDoubles(const double *pData, const size_t n)
+{
+    // Delta (XOR with previous value) and byte shuffle
+    const size_t nBytes = n*sizeof(double);
+    vector<unsigned char> shuffled(nBytes);
+    uint64_t prev = 0;
+    for (size_t i=0; i<n; ++i)
+    {
+        uint64_t bits;
+        memcpy(&bits, &pData[i], sizeof(double));
+        const uint64_t delta = bits ^ prev;
+        prev = bits;
+        for (size_t b=0; b<sizeof(double); ++b)
+        {
+            shuffled[b*n+i] = static_cast<unsigned char>(delta >> (8*b));
+        }
+    }
+
+    // Zero run-length encoding
+    string compressed;
+    compressed.reserve(nBytes/4);
+    size_t i=0;
+    while (i < nBytes)
+    {
+        if (shuffled[i] == 0)
+        {
+            size_t run=1;
+            while (i+run < nBytes && run < MAXRUNLENGTH && shuffled[i+run] == 0)
+            {
+                ++run;
+            }
+            compressed.push_back(static_cast<char>(127+run));
+            i += run;
+        }
+        else
+        {
+            // Single zero bytes are kept in the literal run, two or more end it
+            size_t run=1;
+            while (i+run < nBytes && run < MAXRUNLENGTH &&
+                   !(shuffled[i+run] == 0 && (i+run+1 == nBytes || shuffled[i+run+1] == 0)))
+            {
+                ++run;
+            }
+            compressed.push_back(static_cast<char>(run-1));
+            compressed.append(reinterpret_cast<const char*>(&shuffled[i]), run);
+            i += run;
+        }
+    }
+    return compressed;
+}
+
+//! @brief Decompress an array of doubles compressed by compressDoubles()
+//! @param[in] rCompressed The compressed data
+//! @param[in] n The number of values
+//! @param[out] pData Array with room for n values
+//! @returns True if the data could be decompressed into exactly n values
+bool decompressDoubles(const std::string &rCompressed, const size_t n, double *pData)
+{
+    const size_t nBytes = n*sizeof(double);
+    vector<unsigned char> shuffled(nBytes);
+    size_t pos=0, i=0;
+    while (i < rCompressed.size())
+    {
+        const unsigned char control = static_cast<unsigned char>(rCompressed[i++]);
+        if (control >= 128)
+        {
+            const size_t run = control-127;
+            if (pos+run > nBytes)
+            {
+                return false;
+            }
+            memset(&shuffled[pos], 0, run);
+            pos += run;
+        }
+        else
+        {
+            const size_t run = control+1;
+            if (pos+run > nBytes || i+run > rCompressed.size())
+            {
+                return false;
+            }
+            memcpy(&shuffled[pos], &rCompressed[i], run);
+            pos += run;
+            i += run;
+        }
+    }
+    if (pos != nBytes)
+    {
+        return false;
+    }
+
+    uint64_t prev = 0;
+    for (size_t v=0; v<n; ++v)
+    {
+        uint64_t delta = 0;
+        for (size_t b=0; b<sizeof(double); ++b)
+        {
+            delta |= static_cast<uint64_t>(shuffled[b*n+v]) << (8*b);
+        }
+        prev ^= delta;
+        memcpy(&pData[v], &prev, sizeof(double));
+    }
+    return true;
+}